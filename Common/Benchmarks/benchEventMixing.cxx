@@ -0,0 +1,63 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+///
+/// \file benchEventMixing.cxx
+/// \brief Benchmark of the event-mixing binning of collisions in z vertex and multiplicity
+///
+/// Usage: o2-bench-event-mixing [minimum time per benchmark in s]
+///
+
+#include <tuple>
+#include <vector>
+
+#include "Framework/AnalysisDataModel.h"
+#include "Framework/ASoAHelpers.h"
+#include "Common/Core/EventMixing.h"
+#include "Common/Benchmarks/benchmarkUtilities.h"
+
+using namespace o2;
+using namespace o2::framework;
+using namespace o2::analysis::benchmark;
+
+int main(int argc, char* argv[])
+{
+  const double minTime = getMinTime(argc, argv);
+  constexpr int NCollisions = 10000;
+
+  // collisions spanning the pp to Pb-Pb multiplicities
+  EventGenerator generator;
+  std::vector<float> posZ(NCollisions);
+  std::vector<int> numContrib(NCollisions);
+  for (int i = 0; i < NCollisions; i++) {
+    posZ[i] = -12. + 24. * generator.uniform();
+    numContrib[i] = static_cast<int>(NTracksPbPb * generator.uniform() * generator.uniform());
+  }
+  const std::vector<double> vtxEdges{-10., -8., -6., -4., -2., 0., 2., 4., 6., 8., 10.};
+  const std::vector<double> multEdges{0., 5., 10., 20., 30., 40., 50., 100., 200., 500., 1000., 2000., 5000.};
+
+  run("eventmixing::getMixingBin", NCollisions, [&]() {
+    for (int i = 0; i < NCollisions; i++) {
+      doNotOptimize(eventmixing::getMixingBin(vtxEdges, multEdges, static_cast<double>(posZ[i]), static_cast<double>(numContrib[i])));
+    }
+  }, minTime);
+
+  // same bins, with the variable-width axis convention of the binning policies
+  std::vector<double> vtxBins{VARIABLE_WIDTH}, multBins{VARIABLE_WIDTH};
+  vtxBins.insert(vtxBins.end(), vtxEdges.begin(), vtxEdges.end());
+  multBins.insert(multBins.end(), multEdges.begin(), multEdges.end());
+  ColumnBinningPolicy<aod::collision::PosZ, aod::collision::NumContrib> binningPolicy{{vtxBins, multBins}, true};
+  run("ColumnBinningPolicy<PosZ, NumContrib>::getBin", NCollisions, [&]() {
+    for (int i = 0; i < NCollisions; i++) {
+      doNotOptimize(binningPolicy.getBin(std::make_tuple(posZ[i], numContrib[i])));
+    }
+  }, minTime);
+  return 0;
+}
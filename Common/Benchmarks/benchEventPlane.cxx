@@ -0,0 +1,75 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+///
+/// \file benchEventPlane.cxx
+/// \brief Benchmark of the FIT Q-vector sums of EventPlaneHelper
+///
+/// The Q-vectors of FT0 and FV0 are summed over all the channels, once with the per-channel
+/// TComplex interface and once with the batched interface on the amplitude array.
+///
+/// Usage: o2-bench-event-plane [minimum time per benchmark in s]
+///
+
+#include <cmath>
+#include <vector>
+
+#include <TComplex.h>
+
+#include "Common/Core/EventPlaneHelper.h"
+#include "Common/Benchmarks/benchmarkUtilities.h"
+
+using namespace o2::analysis::benchmark;
+
+int main(int argc, char* argv[])
+{
+  const double minTime = getMinTime(argc, argv);
+  constexpr int NEvents = 1000;
+  constexpr int NChannels = EventPlaneHelper::kNChannelsFT0 + EventPlaneHelper::kNChannelsFV0;
+
+  // channel amplitudes of FT0 followed by the ones of FV0, about 1 hit per channel
+  EventGenerator generator;
+  std::vector<float> amplitudes(NEvents * NChannels);
+  for (auto& amplitude : amplitudes) {
+    amplitude = -2. * std::log(1. - generator.uniform());
+  }
+
+  EventPlaneHelper helper;
+  helper.SetOffsetFT0A(0., 0.);
+  helper.SetOffsetFT0C(0., 0.);
+  helper.SetOffsetFV0left(0., 0.);
+  helper.SetOffsetFV0right(0., 0.);
+
+  run("EventPlaneHelper::SumQvectors per channel", NEvents * NChannels, [&]() {
+    for (int iEvent = 0; iEvent < NEvents; iEvent++) {
+      const float* ampl = amplitudes.data() + iEvent * NChannels;
+      TComplex qVecFT0(0., 0.), qVecFV0(0., 0.);
+      double sumFT0 = 0., sumFV0 = 0.;
+      for (int iCh = 0; iCh < EventPlaneHelper::kNChannelsFT0; iCh++) {
+        helper.SumQvectors(0, iCh, ampl[iCh], qVecFT0, sumFT0);
+      }
+      for (int iCh = 0; iCh < EventPlaneHelper::kNChannelsFV0; iCh++) {
+        helper.SumQvectors(1, iCh, ampl[EventPlaneHelper::kNChannelsFT0 + iCh], qVecFV0, sumFV0);
+      }
+      doNotOptimize(qVecFT0.Re() + qVecFT0.Im() + qVecFV0.Re() + qVecFV0.Im() + sumFT0 + sumFV0);
+    }
+  }, minTime);
+
+  run("EventPlaneHelper::SumQvectors batched", NEvents * NChannels, [&]() {
+    for (int iEvent = 0; iEvent < NEvents; iEvent++) {
+      const float* ampl = amplitudes.data() + iEvent * NChannels;
+      double qxFT0 = 0., qyFT0 = 0., sumFT0 = 0., qxFV0 = 0., qyFV0 = 0., sumFV0 = 0.;
+      helper.SumQvectors(0, 0, ampl, EventPlaneHelper::kNChannelsFT0, 2, qxFT0, qyFT0, sumFT0);
+      helper.SumQvectors(1, 0, ampl + EventPlaneHelper::kNChannelsFT0, EventPlaneHelper::kNChannelsFV0, 2, qxFV0, qyFV0, sumFV0);
+      doNotOptimize(qxFT0 + qyFT0 + qxFV0 + qyFV0 + sumFT0 + sumFV0);
+    }
+  }, minTime);
+  return 0;
+}
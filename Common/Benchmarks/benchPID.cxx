@@ -0,0 +1,82 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+///
+/// \file benchPID.cxx
+/// \brief Benchmark of the TPC and TOF number of sigma computations
+///
+/// The TPC response is configured with the default parameters of the TPC PID task, the TOF response
+/// with the default TOFResoParamsV2 parameters.
+///
+/// Usage: o2-bench-pid [minimum time per benchmark in s]
+///
+
+#include <vector>
+
+#include "Common/Core/PID/PIDTOF.h"
+#include "Common/Core/PID/TPCPIDResponse.h"
+#include "Common/Benchmarks/benchmarkUtilities.h"
+
+using namespace o2::analysis::benchmark;
+using namespace o2::track;
+
+namespace
+{
+o2::pid::tpc::Response makeTPCResponse(bool useDefaultResolution)
+{
+  o2::pid::tpc::Response response;
+  response.SetBetheBlochParams(std::array<float, 5>{0.0320981, 19.9768, 2.52666e-16, 2.72123, 6.08092});
+  response.SetResolutionParamsDefault(std::array<float, 2>{0.07, 0.});
+  response.SetResolutionParams(std::vector<double>{5.43799e-7, 0.053044, 0.667584, 0.0142667, 0.00235175, 1.22482, 2.3501e-7, 0.031585});
+  response.SetMIP(50.f);
+  response.SetChargeFactor(2.3f);
+  response.SetMultiplicityNormalization(11000.f);
+  response.SetNClNormalization(152.f);
+  response.SetUseDefaultResolutionParam(useDefaultResolution);
+  return response;
+}
+
+void benchmarkPID(std::string const& system, int nTracks, double minTime)
+{
+  EventGenerator generator;
+  Collision collision;
+  std::vector<Track> tracks;
+  generator.generate(nTracks, collision, tracks);
+
+  for (const bool useDefaultResolution : {true, false}) {
+    const auto response = makeTPCResponse(useDefaultResolution);
+    const std::string name = std::string("TPC nsigma pi, K, p ") + (useDefaultResolution ? "default resolution " : "full resolution ") + system;
+    run(name, 3 * nTracks, [&]() {
+      for (auto const& track : tracks) {
+        doNotOptimize(response.GetNumberOfSigma(collision, track, PID::Pion));
+        doNotOptimize(response.GetNumberOfSigma(collision, track, PID::Kaon));
+        doNotOptimize(response.GetNumberOfSigma(collision, track, PID::Proton));
+      }
+    }, minTime);
+  }
+
+  const o2::pid::tof::TOFResoParamsV2 parameters;
+  run("TOF nsigma pi, K, p " + system, 3 * nTracks, [&]() {
+    for (auto const& track : tracks) {
+      doNotOptimize(o2::pid::tof::ExpTimes<Track, PID::Pion>::GetSeparation(parameters, track));
+      doNotOptimize(o2::pid::tof::ExpTimes<Track, PID::Kaon>::GetSeparation(parameters, track));
+      doNotOptimize(o2::pid::tof::ExpTimes<Track, PID::Proton>::GetSeparation(parameters, track));
+    }
+  }, minTime);
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  const double minTime = getMinTime(argc, argv);
+  benchmarkPID("pp", NTracksPp, minTime);
+  benchmarkPID("Pb-Pb", NTracksPbPb, minTime);
+  return 0;
+}
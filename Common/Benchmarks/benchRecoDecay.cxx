@@ -0,0 +1,84 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file benchRecoDecay.cxx
+/// \brief Benchmark of the RecoDecay kinematics of track pairs
+///
+/// Usage: o2-bench-recodecay [minimum time per benchmark in s]
+///
+
+#include <array>
+#include <vector>
+
+#include "Common/Core/RecoDecay.h"
+#include "Common/Benchmarks/benchmarkUtilities.h"
+
+using namespace o2::analysis::benchmark;
+
+namespace
+{
+constexpr double MassPion = 0.13957;
+
+/// Computes the invariant mass, pT, rapidity and opening angle of all the track pairs of an event.
+void benchmarkPairs(std::string const& system, int nTracks, double minTime)
+{
+  EventGenerator generator;
+  Collision collision;
+  std::vector<Track> tracks;
+  generator.generate(nTracks, collision, tracks);
+  std::vector<std::array<float, 3>> momenta;
+  for (auto const& track : tracks) {
+    momenta.push_back({track.px(), track.py(), track.pz()});
+  }
+  const std::array<double, 2> masses{MassPion, MassPion};
+  const int64_t nPairs = static_cast<int64_t>(nTracks) * (nTracks - 1) / 2;
+
+  run("RecoDecay::m " + system, nPairs, [&]() {
+    for (int i = 0; i < nTracks; i++) {
+      for (int j = i + 1; j < nTracks; j++) {
+        doNotOptimize(RecoDecay::m(std::array{momenta[i], momenta[j]}, masses));
+      }
+    }
+  }, minTime);
+  run("RecoDecay::pt " + system, nPairs, [&]() {
+    for (int i = 0; i < nTracks; i++) {
+      for (int j = i + 1; j < nTracks; j++) {
+        doNotOptimize(RecoDecay::pt(momenta[i], momenta[j]));
+      }
+    }
+  }, minTime);
+  run("RecoDecay::y " + system, nPairs, [&]() {
+    for (int i = 0; i < nTracks; i++) {
+      for (int j = i + 1; j < nTracks; j++) {
+        const auto pSum = RecoDecay::pVec(momenta[i], momenta[j]);
+        doNotOptimize(RecoDecay::y(pSum, RecoDecay::m(std::array{momenta[i], momenta[j]}, masses)));
+      }
+    }
+  }, minTime);
+  run("RecoDecay::constrainAngle " + system, nPairs, [&]() {
+    for (int i = 0; i < nTracks; i++) {
+      for (int j = i + 1; j < nTracks; j++) {
+        doNotOptimize(RecoDecay::constrainAngle(tracks[j].phi() - tracks[i].phi(), -o2::constants::math::PIHalf));
+      }
+    }
+  }, minTime);
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  const double minTime = getMinTime(argc, argv);
+  benchmarkPairs("pp", NTracksPp, minTime);
+  // the Pb-Pb pair loop is restricted to a tenth of the tracks, 4.5e5 pairs per event
+  benchmarkPairs("Pb-Pb", NTracksPbPb / 10, minTime);
+  return 0;
+}
@@ -0,0 +1,56 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+///
+/// \file benchTrackSelection.cxx
+/// \brief Benchmark of TrackSelection::IsSelected with the Run 3 global track selection
+///
+/// Usage: o2-bench-track-selection [minimum time per benchmark in s]
+///
+
+#include <vector>
+
+#include "Common/Core/TrackSelection.h"
+#include "Common/Core/TrackSelectionDefaults.h"
+#include "Common/Benchmarks/benchmarkUtilities.h"
+
+using namespace o2::analysis::benchmark;
+
+namespace
+{
+void benchmarkSelection(std::string const& system, int nTracks, double minTime)
+{
+  EventGenerator generator;
+  Collision collision;
+  std::vector<Track> tracks;
+  generator.generate(nTracks, collision, tracks);
+  TrackSelection selection = getGlobalTrackSelectionRun3ITSMatch(TrackSelection::GlobalTrackRun3ITSMatching::Run3ITSibAny);
+
+  int nSelected = 0;
+  for (auto const& track : tracks) {
+    nSelected += selection.IsSelected(track);
+  }
+  LOGF(info, "%s: %d tracks, %d selected", system.c_str(), nTracks, nSelected);
+
+  run("TrackSelection::IsSelected " + system, nTracks, [&]() {
+    for (auto const& track : tracks) {
+      doNotOptimize(selection.IsSelected(track));
+    }
+  }, minTime);
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  const double minTime = getMinTime(argc, argv);
+  benchmarkSelection("pp", NTracksPp, minTime);
+  benchmarkSelection("Pb-Pb", NTracksPbPb, minTime);
+  return 0;
+}
@@ -0,0 +1,181 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file benchmarkUtilities.h
+/// \brief Synthetic events and timing loop shared by the benchmarks of the core helpers
+///
+/// The events are generated in memory from a fixed seed, so that the benchmarks need no input file
+/// and no CCDB access and always run on the same inputs. The track and collision structs provide the
+/// accessors of the AO2D tables used by the benchmarked helpers.
+///
+
+#ifndef COMMON_BENCHMARKS_BENCHMARKUTILITIES_H_
+#define COMMON_BENCHMARKS_BENCHMARKUTILITIES_H_
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Framework/DataTypes.h"
+#include "Framework/Logger.h"
+
+namespace o2::analysis::benchmark
+{
+/// Number of charged tracks within |eta| < 0.9 of the benchmarked collision systems
+constexpr int NTracksPp = 30;     // minimum-bias pp at 13.6 TeV, tail included
+constexpr int NTracksPbPb = 3000; // 0-5% Pb-Pb at 5.36 TeV
+
+/// Track with the accessors of the Tracks, TracksExtra, TracksDCA and TOF PID tables
+struct Track {
+  float pt() const { return mPt; }
+  float eta() const { return mEta; }
+  float phi() const { return mPhi; }
+  float p() const { return mPt * std::cosh(mEta); }
+  float px() const { return mPt * std::cos(mPhi); }
+  float py() const { return mPt * std::sin(mPhi); }
+  float pz() const { return mPt * std::sinh(mEta); }
+  float tgl() const { return std::sinh(mEta); }
+  float signed1Pt() const { return mSign / mPt; }
+  short sign() const { return mSign; }
+  uint8_t trackType() const { return o2::aod::track::TrackTypeEnum::Track; }
+  uint32_t flags() const { return 0; }
+  bool hasITS() const { return mItsClusterMap != 0; }
+  bool hasTPC() const { return mTpcNClsFound > 0; }
+  bool hasTOF() const { return mHasTOF; }
+  uint8_t itsClusterMap() const { return mItsClusterMap; }
+  uint8_t itsNCls() const { return mItsNCls; }
+  float itsChi2NCl() const { return mItsChi2NCl; }
+  int16_t tpcNClsFound() const { return mTpcNClsFound; }
+  int16_t tpcNClsCrossedRows() const { return mTpcNClsCrossedRows; }
+  float tpcCrossedRowsOverFindableCls() const { return mTpcNClsCrossedRows / 152.f; }
+  float tpcChi2NCl() const { return mTpcChi2NCl; }
+  float tpcInnerParam() const { return p(); }
+  float tpcSignal() const { return mTpcSignal; }
+  float dcaXY() const { return mDcaXY; }
+  float dcaZ() const { return mDcaZ; }
+  float length() const { return mLength; }
+  float tofExpMom() const { return p(); }
+  float tofSignal() const { return mTofSignal; }
+  float tofEvTime() const { return 0.f; }
+  float tofEvTimeErr() const { return 20.f; }
+
+  float mPt = 0.f, mEta = 0.f, mPhi = 0.f;
+  short mSign = 1;
+  uint8_t mItsClusterMap = 0, mItsNCls = 0;
+  int16_t mTpcNClsFound = 0, mTpcNClsCrossedRows = 0;
+  float mItsChi2NCl = 0.f, mTpcChi2NCl = 0.f;
+  float mTpcSignal = 0.f;
+  float mDcaXY = 0.f, mDcaZ = 0.f;
+  bool mHasTOF = false;
+  float mLength = 0.f, mTofSignal = 0.f;
+};
+
+/// Collision with the accessors used by the benchmarked helpers
+struct Collision {
+  float posZ() const { return mPosZ; }
+  uint16_t numContrib() const { return mNumContrib; }
+  float multTPC() const { return mNumContrib; }
+
+  float mPosZ = 0.f;
+  uint16_t mNumContrib = 0;
+};
+
+/// Generator of reproducible synthetic events
+class EventGenerator
+{
+ public:
+  explicit EventGenerator(uint32_t seed = 12345) : mGenerator(seed) {}
+
+  /// Fills a collision with nTracks tracks, mostly pions with an exponential pT spectrum and flat in eta and phi
+  void generate(int nTracks, Collision& collision, std::vector<Track>& tracks)
+  {
+    collision.mPosZ = mVertexZ(mGenerator);
+    collision.mNumContrib = static_cast<uint16_t>(nTracks);
+    tracks.resize(nTracks);
+    for (auto& track : tracks) {
+      track.mPt = 0.1f + mPt(mGenerator);
+      track.mEta = mEta(mGenerator);
+      track.mPhi = mPhi(mGenerator);
+      track.mSign = mUniform(mGenerator) < 0.5 ? 1 : -1;
+      track.mItsClusterMap = static_cast<uint8_t>(mUniform(mGenerator) * 128.);
+      track.mItsNCls = static_cast<uint8_t>(__builtin_popcount(track.mItsClusterMap));
+      track.mItsChi2NCl = 4.f * mUniform(mGenerator);
+      track.mTpcNClsFound = static_cast<int16_t>(60 + mUniform(mGenerator) * 99);
+      track.mTpcNClsCrossedRows = static_cast<int16_t>(track.mTpcNClsFound + mUniform(mGenerator) * 10);
+      track.mTpcChi2NCl = 5.f * mUniform(mGenerator);
+      track.mTpcSignal = 50.f * (1.f + 0.06f * mGauss(mGenerator));
+      track.mDcaXY = 0.02f * mGauss(mGenerator);
+      track.mDcaZ = 0.02f * mGauss(mGenerator);
+      track.mHasTOF = mUniform(mGenerator) < 0.6;
+      track.mLength = 370.f * std::cosh(track.mEta);
+      // pion time of flight with 80 ps resolution, c = 0.0299792458 cm/ps
+      const float p = track.p();
+      track.mTofSignal = track.mLength * std::sqrt(MassPion * MassPion + p * p) / (0.0299792458f * p) + 80.f * mGauss(mGenerator);
+    }
+  }
+
+  /// Uniform random number in [0, 1)
+  double uniform() { return mUniform(mGenerator); }
+
+ private:
+  static constexpr float MassPion = 0.13957f;
+
+  std::mt19937 mGenerator;
+  std::uniform_real_distribution<float> mVertexZ{-10.f, 10.f};
+  std::exponential_distribution<float> mPt{1.f / 0.5f};
+  std::uniform_real_distribution<float> mEta{-0.9f, 0.9f};
+  std::uniform_real_distribution<float> mPhi{0.f, 6.2831853f};
+  std::uniform_real_distribution<double> mUniform{0., 1.};
+  std::normal_distribution<float> mGauss{0.f, 1.f};
+};
+
+/// Keeps a result alive, so that the compiler cannot remove the benchmarked computation
+template <typename T>
+inline void doNotOptimize(T const& value)
+{
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/// Times a kernel and prints the time per call and the throughput.
+/// \param name  name of the benchmark
+/// \param nCallsPerRun  number of calls of the benchmarked helper done by one call of kernel
+/// \param kernel  function running the benchmarked helper nCallsPerRun times
+/// \param minTime  minimum measurement time in seconds, after one warm-up call
+template <typename F>
+void run(std::string const& name, int64_t nCallsPerRun, F&& kernel, double minTime = 0.5)
+{
+  using Clock = std::chrono::steady_clock;
+  kernel();
+  int64_t nRuns = 0;
+  const auto start = Clock::now();
+  double elapsed = 0.;
+  do {
+    kernel();
+    nRuns++;
+    elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+  } while (elapsed < minTime);
+  const double nCalls = static_cast<double>(nRuns) * nCallsPerRun;
+  LOGF(info, "%-50s %10.2f ns/call %10.3f Mcalls/s (%lld calls)", name.c_str(), 1.e9 * elapsed / nCalls, 1.e-6 * nCalls / elapsed, static_cast<long long>(nCalls));
+}
+
+/// Reads the minimum measurement time in seconds from the first command-line argument, if any
+inline double getMinTime(int argc, char* argv[])
+{
+  return argc > 1 ? std::atof(argv[1]) : 0.5;
+}
+} // namespace o2::analysis::benchmark
+
+#endif // COMMON_BENCHMARKS_BENCHMARKUTILITIES_H_
@@ -21,7 +21,7 @@
 #include "Common/Core/EventPlaneHelper.h"
 
 #include <algorithm>
-#include <iterator>
+#include <cstdint>
 #include <vector>
 #include <memory>
 
@@ -40,9 +40,10 @@ double EventPlaneHelper::GetPhiFV0(int chno)
   float offsetX = 0.;
   float offsetY = 0.;
 
-  int cellsInLeft[] = {0, 1, 2, 3, 8, 9, 10, 11, 16, 17, 18, 19, 24, 25, 26, 27,
-                       32, 40, 33, 41, 34, 42, 35, 43};
-  bool isChnoInLeft = std::find(std::begin(cellsInLeft), std::end(cellsInLeft), chno) != std::end(cellsInLeft);
+  // Bit i is set if the cell i is in the left side: cells 0-3, 8-11, 16-19, 24-27,
+  // 32-35 and 40-43.
+  constexpr uint64_t cellsInLeft = 0x0F0F0F0F0F0FULL;
+  bool isChnoInLeft = chno >= 0 && chno < 64 && ((cellsInLeft >> chno) & 1);
 
   if (isChnoInLeft) {
     offsetX = mOffsetFV0leftX;
@@ -75,40 +76,104 @@ double EventPlaneHelper::GetPhiFT0(int chno)
     offsetY = mOffsetFT0AY;
   }
 
-  o2::ft0::Geometry ft0Det;
-  ft0Det.calculateChannelCenter();
-  auto chPos = ft0Det.getChannelCenter(chno);
-  /// printf("Channel id: %d X: %.3f Y: %.3f\n", chno, chPos.X(), chPos.Y());
+  // The channel centers do not depend on the offsets, they are computed only once.
+  if (mChannelCenterFT0X.empty()) {
+    o2::ft0::Geometry ft0Det;
+    ft0Det.calculateChannelCenter();
+    mChannelCenterFT0X.resize(kNChannelsFT0);
+    mChannelCenterFT0Y.resize(kNChannelsFT0);
+    for (int iCh = 0; iCh < kNChannelsFT0; iCh++) {
+      auto chPos = ft0Det.getChannelCenter(iCh);
+      mChannelCenterFT0X[iCh] = chPos.X();
+      mChannelCenterFT0Y[iCh] = chPos.Y();
+    }
+  }
+  /// printf("Channel id: %d X: %.3f Y: %.3f\n", chno, mChannelCenterFT0X[chno], mChannelCenterFT0Y[chno]);
 
-  return TMath::ATan2(chPos.Y() + offsetY, chPos.X() + offsetX);
+  return TMath::ATan2(mChannelCenterFT0Y[chno] + offsetY, mChannelCenterFT0X[chno] + offsetX);
+}
+
+void EventPlaneHelper::BuildHarmonicTables()
+{
+  /* Tabulate cos(n*phi) and sin(n*phi) for all the channels of FT0 and FV0 and the
+    harmonics n = 1 to mNHarmonics. The angles include the current offsets. */
+  mCosFT0.resize(mNHarmonics * kNChannelsFT0);
+  mSinFT0.resize(mNHarmonics * kNChannelsFT0);
+  mCosFV0.resize(mNHarmonics * kNChannelsFV0);
+  mSinFV0.resize(mNHarmonics * kNChannelsFV0);
+
+  for (int iCh = 0; iCh < kNChannelsFT0; iCh++) {
+    double phi = GetPhiFT0(iCh);
+    for (int n = 1; n <= mNHarmonics; n++) {
+      mCosFT0[(n - 1) * kNChannelsFT0 + iCh] = TMath::Cos(n * phi);
+      mSinFT0[(n - 1) * kNChannelsFT0 + iCh] = TMath::Sin(n * phi);
+    }
+  }
+  for (int iCh = 0; iCh < kNChannelsFV0; iCh++) {
+    double phi = GetPhiFV0(iCh);
+    for (int n = 1; n <= mNHarmonics; n++) {
+      mCosFV0[(n - 1) * kNChannelsFV0 + iCh] = TMath::Cos(n * phi);
+      mSinFV0[(n - 1) * kNChannelsFV0 + iCh] = TMath::Sin(n * phi);
+    }
+  }
+  mTablesValid = true;
 }
 
 void EventPlaneHelper::SumQvectors(int det, int chno, float ampl, TComplex& Qvec, double& sum)
 {
   /* Calculate the complex Q-vector for the provided detector and channel number,
     before adding it to the total Q-vector given as argument. */
-  double phi = -999.;
+  // LOKI: Note this assumes nHarmo = 2!! Likely generalise in the future.
+  double qx = 0., qy = 0.;
+  SumQvectors(det, chno, &ampl, 1, 2, qx, qy, sum);
+  Qvec += TComplex(qx, qy);
+}
 
+void EventPlaneHelper::SumQvectors(int det, int firstChno, const float* ampl, int nChannels, int harmonic,
+                                   double& qx, double& qy, double& sum)
+{
+  /* Add the amplitude-weighted cos(n*phi) and sin(n*phi) of the channels firstChno to
+    firstChno + nChannels - 1 of the detector to (qx, qy), and their amplitudes to sum.
+    The angles are taken from the harmonic tables, rebuilt if the offsets changed. */
+  if (harmonic < 1 || harmonic > mNHarmonics) {
+    printf("Harmonic %d is not tabulated, call SetNHarmonics() first.\n", harmonic);
+    return;
+  }
+  if (!mTablesValid) {
+    BuildHarmonicTables();
+  }
+
+  const double* cosTable = nullptr;
+  const double* sinTable = nullptr;
+  int nChannelsDet = 0;
   switch (det) {
-    case 0:                  // FT0. Note: the channel number for FT0-C should
-      phi = GetPhiFT0(chno); // already be given in the right range.
+    case 0: // FT0.
+      nChannelsDet = kNChannelsFT0;
+      cosTable = mCosFT0.data();
+      sinTable = mSinFT0.data();
       break;
     case 1: // FV0.
-      phi = GetPhiFV0(chno);
+      nChannelsDet = kNChannelsFV0;
+      cosTable = mCosFV0.data();
+      sinTable = mSinFV0.data();
       break;
     default:
       printf("'int det' value does not correspond to any accepted case.\n");
-      break;
+      return;
   }
-
-  /// printf("Phi: %.3f\n", phi);
-
-  if (phi < -900) {
-    printf("Error on phi. Skip\n");
-    return;
-  } // TODO: ensure proper safety check.
-  Qvec += TComplex(ampl * TMath::Cos(2. * phi), ampl * TMath::Sin(2. * phi));
-  sum += ampl;
+  cosTable += (harmonic - 1) * nChannelsDet + firstChno;
+  sinTable += (harmonic - 1) * nChannelsDet + firstChno;
+  nChannels = std::min(nChannels, nChannelsDet - firstChno);
+
+  double sumX = 0., sumY = 0., sumA = 0.;
+  for (int iCh = 0; iCh < nChannels; iCh++) {
+    sumX += ampl[iCh] * cosTable[iCh];
+    sumY += ampl[iCh] * sinTable[iCh];
+    sumA += ampl[iCh];
+  }
+  qx += sumX;
+  qy += sumY;
+  sum += sumA;
 }
 
 int EventPlaneHelper::GetCentBin(float cent)
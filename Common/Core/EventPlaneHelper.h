@@ -35,26 +35,43 @@ class EventPlaneHelper
  public:
   EventPlaneHelper() = default;
 
+  // Number of channels of each part of FIT.
+  static constexpr int kNChannelsFT0A = 96;
+  static constexpr int kNChannelsFT0C = 112;
+  static constexpr int kNChannelsFT0 = kNChannelsFT0A + kNChannelsFT0C;
+  static constexpr int kNChannelsFV0 = 48;
+
   // Setters/getters for the data members.
+  // A change of the offsets or of the harmonics invalidates the harmonic tables.
   void SetOffsetFT0A(double offsetX, double offsetY)
   {
     mOffsetFT0AX = offsetX;
     mOffsetFT0AY = offsetY;
+    mTablesValid = false;
   }
   void SetOffsetFT0C(double offsetX, double offsetY)
   {
     mOffsetFT0CX = offsetX;
     mOffsetFT0CY = offsetY;
+    mTablesValid = false;
   }
   void SetOffsetFV0left(double offsetX, double offsetY)
   {
     mOffsetFV0leftX = offsetX;
     mOffsetFV0leftY = offsetY;
+    mTablesValid = false;
   }
   void SetOffsetFV0right(double offsetX, double offsetY)
   {
     mOffsetFV0rightX = offsetX;
     mOffsetFV0rightY = offsetY;
+    mTablesValid = false;
+  }
+  // Harmonics 1 to nHarmonics are tabulated (2 by default).
+  void SetNHarmonics(int nHarmonics)
+  {
+    mNHarmonics = nHarmonics;
+    mTablesValid = false;
   }
 
   // Methods to calculate the azimuthal angles for each part of FIT, given the channel number.
@@ -65,6 +82,15 @@ class EventPlaneHelper
   // the detector and amplitude.
   void SumQvectors(int det, int chno, float ampl, TComplex& Qvec, double& sum);
 
+  // Method to add the Q-vector of harmonic n and the sum of amplitudes of nChannels
+  // consecutive channels of a detector, starting from the channel firstChno.
+  void SumQvectors(int det, int firstChno, const float* ampl, int nChannels, int harmonic,
+                   double& qx, double& qy, double& sum);
+
+  // Method to fill the tables of cos(n*phi) and sin(n*phi) of all the FIT channels,
+  // called automatically after a change of the offsets or of the harmonics.
+  void BuildHarmonicTables();
+
   // Method to get the bin corresponding to a centrality percentile, according to the
   // centClasses[] array defined in Tasks/qVectorsQA.cxx.
   // Note: Any change in one task should be reflected in the other.
@@ -105,7 +131,19 @@ class EventPlaneHelper
   double mOffsetFV0rightX = 0.; // X-coordinate of the offset of FV0-A right.
   double mOffsetFV0rightY = 0.; // Y-coordinate of the offset of FV0-A right.
 
-  ClassDefNV(EventPlaneHelper, 2)
+  // Channel centers of FT0, computed once from the geometry.
+  std::vector<double> mChannelCenterFT0X; // X-coordinate of the FT0 channel centers.
+  std::vector<double> mChannelCenterFT0Y; // Y-coordinate of the FT0 channel centers.
+
+  // Tables of cos(n*phi) and sin(n*phi) per harmonic n, index (n-1)*nChannels + chno.
+  int mNHarmonics = 2;       // Number of tabulated harmonics.
+  bool mTablesValid = false; // False if the tables need to be rebuilt.
+  std::vector<double> mCosFT0;
+  std::vector<double> mSinFT0;
+  std::vector<double> mCosFV0;
+  std::vector<double> mSinFV0;
+
+  ClassDefNV(EventPlaneHelper, 3)
 };
 
 #endif // COMMON_CORE_EVENTPLANEHELPER_H_
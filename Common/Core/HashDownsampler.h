@@ -0,0 +1,97 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file HashDownsampler.h
+/// \brief Deterministic downsampling of tracks, candidates or events for skims
+///
+/// The decision to keep an entry is taken from a hash of (run number, global BC, index in the table) instead of a
+/// random number generator. It does not depend on the processing order or on the random state of the task, so it can
+/// be taken before computing any output column and a skim produced from the same input is identical when regenerated.
+/// The fraction of kept entries can depend on pT through a table of bins.
+
+#ifndef COMMON_CORE_HASHDOWNSAMPLER_H_
+#define COMMON_CORE_HASHDOWNSAMPLER_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "Framework/Logger.h"
+
+class HashDownsampler
+{
+ public:
+  /// Sets the seed of the hash, different seeds give independent samples
+  void setSeed(uint64_t seed) { mSeed = seed; }
+
+  /// Sets the pT-dependent fraction of kept entries
+  /// \param ptBins  edges of the pT bins, entries outside the bins are always kept
+  /// \param fractions  fraction of kept entries in each bin
+  void setAcceptance(std::vector<double> const& ptBins, std::vector<double> const& fractions)
+  {
+    if (ptBins.size() != fractions.size() + 1 || !std::is_sorted(ptBins.begin(), ptBins.end())) {
+      LOGF(fatal, "HashDownsampler: %zu sorted pT bin edges are needed for %zu fractions", fractions.size() + 1, fractions.size());
+    }
+    mPtBins = ptBins;
+    mFractions = fractions;
+  }
+
+  /// Fraction of kept entries at the given pT
+  double getAcceptance(double pt) const
+  {
+    if (mFractions.empty() || pt < mPtBins.front() || pt >= mPtBins.back()) {
+      return 1.;
+    }
+    return mFractions[std::upper_bound(mPtBins.begin(), mPtBins.end(), pt) - mPtBins.begin() - 1];
+  }
+
+  /// Uniform number in [0, 1) fixed by the key of the entry
+  /// \param runNumber  run number
+  /// \param globalBC  global BC of the collision
+  /// \param index  index of the entry in its table
+  /// \param salt  to take independent decisions for the same entry (e.g. per species)
+  double getUniform(int runNumber, uint64_t globalBC, int64_t index, uint64_t salt = 0) const
+  {
+    uint64_t h = mix(mSeed ^ static_cast<uint64_t>(runNumber));
+    h = mix(h ^ globalBC);
+    h = mix(h ^ static_cast<uint64_t>(index));
+    h = mix(h ^ salt);
+    return (h >> 11) * (1. / 9007199254740992.); // 53 bits of mantissa
+  }
+
+  /// Whether the entry is kept, with the given probability
+  bool isKept(double probability, int runNumber, uint64_t globalBC, int64_t index, uint64_t salt = 0) const
+  {
+    return probability >= 1. || getUniform(runNumber, globalBC, index, salt) < probability;
+  }
+
+  /// Whether the entry is kept, with the probability of the pT table times the given factor
+  bool isKeptPt(double pt, double factor, int runNumber, uint64_t globalBC, int64_t index, uint64_t salt = 0) const
+  {
+    return isKept(factor * getAcceptance(pt), runNumber, globalBC, index, salt);
+  }
+
+ private:
+  /// splitmix64 finaliser
+  static uint64_t mix(uint64_t x)
+  {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+
+  uint64_t mSeed = 0;
+  std::vector<double> mPtBins;
+  std::vector<double> mFractions;
+};
+
+#endif // COMMON_CORE_HASHDOWNSAMPLER_H_
@@ -0,0 +1,310 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file PrimaryVertexRefitter.h
+/// \brief Primary vertex refit service with a persistent vertexer and a Kalman downdate to remove contributors
+///
+/// The PVertexer is configured once and kept for the lifetime of the owner (one per task, i.e. per device thread).
+/// It is initialised at the first prepare(), i.e. after the magnetic field has been loaded from the CCDB, and its
+/// field is updated whenever the field passed to prepare() changes (e.g. at a run change).
+/// After prepare() has been called for a collision, the vertex without a set of k contributors can be obtained either
+/// with a full PVertexer refit (refitWithout) or with a Kalman downdate of the information matrix of the fitted vertex
+/// (removeContributors), which costs O(k) instead of a full refit. The downdate removes the linearised contributions
+/// of the tracks at the original vertex, as done by AliVertexerTracks::RemoveTracksFromVertex in Run 2.
+///
+/// The downdate is an approximation of the full refit. Each contribution is scaled by the Tukey weight of the track
+/// at the fitted vertex, as in the last PVertexer iteration, so that tracks trimmed by the fit (weight 0) are not
+/// removed a second time, but the weights of the remaining tracks are not re-evaluated at the new vertex and the
+/// tracks are not re-linearised. The downdated vertex is therefore closer to the original one than the refitted
+/// vertex, by an amount that grows with the weight of the removed tracks in the fit and is small compared with the
+/// vertex resolution for vertices with many contributors. A mean vertex constraint included in the fitted covariance
+/// is kept in the downdated vertex, whereas refitWithout applies the constraint configured in init().
+
+#ifndef COMMON_CORE_PRIMARYVERTEXREFITTER_H_
+#define COMMON_CORE_PRIMARYVERTEXREFITTER_H_
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "DetectorsVertexing/PVertexer.h"
+#include "DetectorsVertexing/PVertexerParams.h"
+#include "ReconstructionDataFormats/PrimaryVertex.h"
+#include "ReconstructionDataFormats/Track.h"
+#include "ReconstructionDataFormats/Vertex.h"
+#include "Framework/Logger.h"
+
+class PrimaryVertexRefitter
+{
+ public:
+  /// Default constructor
+  PrimaryVertexRefitter() = default;
+
+  /// Configures the persistent vertexer, to be called once (e.g. in the init of the task)
+  /// The vertexer itself is initialised at the first prepare(), when the magnetic field is known.
+  /// \param useMeanVertexConstraint whether the mean vertex constraint is used in the full refit
+  void init(bool useMeanVertexConstraint = false)
+  {
+    o2::conf::ConfigurableParam::updateFromString(useMeanVertexConstraint ? "pvertexer.useMeanVertexConstraint=true" : "pvertexer.useMeanVertexConstraint=false");
+    const float tukey = o2::vertexing::PVertexerParams::Instance().tukey;
+    mTukey2I = tukey > 0.f ? 1. / (tukey * tukey) : 0.;
+    mIsConfigured = true;
+    mIsVertexerInitialised = false;
+  }
+
+  /// Sets the vertex and its contributors for the following refits
+  /// \param contributors are the PV contributors of the collision
+  /// \param vertex is the fitted primary vertex (position and covariance)
+  /// \param chi2 is the chi2 of the fitted primary vertex
+  /// \param bz is the current magnetic field, used by the full refit and to linearise the tracks at the vertex
+  /// \param prepareFullRefit whether the PVertexer is prepared, needed for refitWithout
+  /// \param prepareDowndate whether the track contributions are linearised, needed for removeContributors
+  /// \return false if the vertex cannot be refitted with the requested methods
+  bool prepare(std::vector<o2::track::TrackParCov> const& contributors, o2::dataformats::VertexBase const& vertex, float chi2, float bz, bool prepareFullRefit = true, bool prepareDowndate = true)
+  {
+    if (!mIsConfigured) {
+      LOGF(fatal, "PrimaryVertexRefitter: init() must be called before prepare()");
+    }
+    if (!mIsVertexerInitialised) {
+      mVertexer.init();
+      mVertexer.setBz(bz);
+      mBz = bz;
+      mIsVertexerInitialised = true;
+    } else if (bz != mBz) {
+      mVertexer.setBz(bz);
+      mBz = bz;
+    }
+    mVertex = vertex;
+    mChi2 = chi2;
+    mNContributors = contributors.size();
+    mIsPreparedForFullRefit = prepareFullRefit && mVertexer.prepareVertexRefit(contributors, vertex);
+    mIsPreparedForDowndate = false;
+    if (!prepareDowndate) {
+      return mIsPreparedForFullRefit;
+    }
+
+    // information matrix (inverse covariance) of the fitted vertex
+    std::array<double, 6> cov = {vertex.getSigmaX2(), vertex.getSigmaXY(), vertex.getSigmaY2(), vertex.getSigmaXZ(), vertex.getSigmaYZ(), vertex.getSigmaZ2()};
+    mIsPreparedForDowndate = invertSym3(cov, mInfo);
+    const std::array<double, 3> pos = {vertex.getX(), vertex.getY(), vertex.getZ()};
+    multiplySym3(mInfo, pos, mInfoPos);
+
+    // linearised contributions of each track at the fitted vertex
+    mContributions.resize(contributors.size());
+    for (size_t i = 0; i < contributors.size(); i++) {
+      linearise(contributors[i], bz, mContributions[i]);
+    }
+    return mIsPreparedForDowndate && (!prepareFullRefit || mIsPreparedForFullRefit);
+  }
+
+  /// Full PVertexer refit without the contributors flagged as false in isUsed
+  o2::dataformats::PrimaryVertex refitWithout(std::vector<bool> const& isUsed)
+  {
+    if (!mIsPreparedForFullRefit) {
+      o2::dataformats::PrimaryVertex vertex;
+      vertex.setChi2(-1.f);
+      return vertex;
+    }
+    return mVertexer.refitVertex(isUsed, mVertex);
+  }
+
+  /// Vertex without the contributors at the given positions in the contributor vector, obtained with a Kalman downdate
+  /// \param entries are the positions of the contributors to be removed
+  /// \return the vertex, with negative chi2 if the downdate failed (as for refitWithout)
+  o2::dataformats::PrimaryVertex removeContributors(std::vector<int> const& entries) const
+  {
+    o2::dataformats::PrimaryVertex vertex;
+    vertex.setChi2(-1.f);
+    int nRemoved = 0;
+    std::array<double, 6> info = mInfo;
+    std::array<double, 3> infoPos = mInfoPos;
+    for (const auto entry : entries) {
+      const auto& contribution = mContributions[entry];
+      if (!mIsPreparedForDowndate || !contribution.isValid) {
+        continue;
+      }
+      for (int j = 0; j < 6; j++) {
+        info[j] -= contribution.info[j];
+      }
+      for (int j = 0; j < 3; j++) {
+        infoPos[j] -= contribution.infoPos[j];
+      }
+      nRemoved++;
+    }
+    if (!mIsPreparedForDowndate || static_cast<int>(mNContributors) - nRemoved < kMinContributors) {
+      return vertex;
+    }
+    std::array<double, 6> cov;
+    if (!invertSym3(info, cov)) {
+      return vertex;
+    }
+    std::array<double, 3> pos;
+    multiplySym3(cov, infoPos, pos);
+
+    // chi2 of the remaining contributors: the full chi2 is quadratic around the fitted vertex
+    const std::array<double, 3> delta = {pos[0] - mVertex.getX(), pos[1] - mVertex.getY(), pos[2] - mVertex.getZ()};
+    std::array<double, 3> infoDelta;
+    multiplySym3(mInfo, delta, infoDelta);
+    double chi2 = mChi2 + delta[0] * infoDelta[0] + delta[1] * infoDelta[1] + delta[2] * infoDelta[2];
+    for (const auto entry : entries) {
+      const auto& contribution = mContributions[entry];
+      if (contribution.isValid) {
+        chi2 -= contribution.chi2At(pos);
+      }
+    }
+
+    vertex.setXYZ(pos[0], pos[1], pos[2]);
+    vertex.setCov(cov[0], cov[1], cov[2], cov[3], cov[4], cov[5]);
+    vertex.setChi2(chi2 > 0. ? chi2 : 0.f);
+    vertex.setNContributors(mNContributors - nRemoved);
+    return vertex;
+  }
+
+  o2::dataformats::VertexBase const& getVertex() const { return mVertex; }
+  o2::vertexing::PVertexer& getVertexer() { return mVertexer; }
+
+ private:
+  static constexpr int kMinContributors = 2; // two measurements per track, at least two tracks to constrain three coordinates
+
+  /// linearised track measurement at the vertex: residual r = c + H v, with v the vertex position in global coordinates
+  struct Contribution {
+    bool isValid = false;
+    std::array<double, 6> info{};    // H^T W H
+    std::array<double, 3> infoPos{}; // -H^T W c
+    std::array<double, 6> h{};       // rows of H (2 x 3)
+    std::array<double, 2> c{};
+    std::array<double, 3> w{}; // W = inverse of the track position covariance (yy, zy, zz)
+
+    double chi2At(std::array<double, 3> const& v) const
+    {
+      const double ry = c[0] + h[0] * v[0] + h[1] * v[1] + h[2] * v[2];
+      const double rz = c[1] + h[3] * v[0] + h[4] * v[1] + h[5] * v[2];
+      return w[0] * ry * ry + 2. * w[1] * ry * rz + w[2] * rz * rz;
+    }
+  };
+
+  void linearise(o2::track::TrackParCov track, float bz, Contribution& contribution) const
+  {
+    contribution.isValid = false;
+    if (!track.propagateToDCA(mVertex, bz)) {
+      return;
+    }
+    const double snp = track.getSnp();
+    const double csp = std::sqrt((1. - snp) * (1. + snp));
+    if (csp < 1e-6) {
+      return;
+    }
+    const double dydx = snp / csp;
+    const double dzdx = track.getTgl() / csp;
+    const double cosAlpha = std::cos(track.getAlpha());
+    const double sinAlpha = std::sin(track.getAlpha());
+
+    // measurement matrix in global coordinates: local vertex x = cos * X + sin * Y, y = -sin * X + cos * Y
+    auto& h = contribution.h;
+    h = {dydx * cosAlpha + sinAlpha, dydx * sinAlpha - cosAlpha, 0., dzdx * cosAlpha, dzdx * sinAlpha, -1.};
+    contribution.c = {track.getY() - dydx * track.getX(), track.getZ() - dzdx * track.getX()};
+
+    const double sy2 = track.getSigmaY2();
+    const double szy = track.getSigmaZY();
+    const double sz2 = track.getSigmaZ2();
+    const double det = sy2 * sz2 - szy * szy;
+    if (!(det > 0.)) {
+      return;
+    }
+    auto& w = contribution.w;
+    w = {sz2 / det, -szy / det, sy2 / det};
+
+    // W H (2 x 3)
+    std::array<double, 6> wh;
+    for (int j = 0; j < 3; j++) {
+      wh[j] = w[0] * h[j] + w[1] * h[3 + j];
+      wh[3 + j] = w[1] * h[j] + w[2] * h[3 + j];
+    }
+    // symmetric 3x3 storage: xx, xy, yy, xz, yz, zz
+    constexpr int kRow[6] = {0, 0, 1, 0, 1, 2};
+    constexpr int kCol[6] = {0, 1, 1, 2, 2, 2};
+    for (int j = 0; j < 6; j++) {
+      contribution.info[j] = h[kRow[j]] * wh[kCol[j]] + h[3 + kRow[j]] * wh[3 + kCol[j]];
+    }
+    for (int j = 0; j < 3; j++) {
+      contribution.infoPos[j] = -(wh[j] * contribution.c[0] + wh[3 + j] * contribution.c[1]);
+    }
+
+    // Tukey weight of the track in the fit, as in PVertexer: (1 - chi2 / tukey^2)^2, 0 beyond tukey^2
+    const double weight = tukeyWeight(contribution.chi2At({mVertex.getX(), mVertex.getY(), mVertex.getZ()}));
+    if (weight <= 0.) {
+      return;
+    }
+    for (int j = 0; j < 6; j++) {
+      contribution.info[j] *= weight;
+    }
+    for (int j = 0; j < 3; j++) {
+      contribution.infoPos[j] *= weight;
+    }
+    for (int j = 0; j < 3; j++) {
+      w[j] *= weight;
+    }
+    contribution.isValid = true;
+  }
+
+  double tukeyWeight(double chi2) const
+  {
+    if (mTukey2I <= 0.) {
+      return 1.;
+    }
+    const double weight = 1. - chi2 * mTukey2I;
+    return weight > 0. ? weight * weight : 0.;
+  }
+
+  /// inverts a symmetric 3x3 matrix stored as xx, xy, yy, xz, yz, zz
+  static bool invertSym3(std::array<double, 6> const& m, std::array<double, 6>& inv)
+  {
+    const double c00 = m[2] * m[5] - m[4] * m[4];
+    const double c01 = m[4] * m[3] - m[1] * m[5];
+    const double c02 = m[1] * m[4] - m[2] * m[3];
+    const double det = m[0] * c00 + m[1] * c01 + m[3] * c02;
+    if (!(det > 0.)) {
+      return false;
+    }
+    inv[0] = c00 / det;
+    inv[1] = c01 / det;
+    inv[2] = (m[0] * m[5] - m[3] * m[3]) / det;
+    inv[3] = c02 / det;
+    inv[4] = (m[1] * m[3] - m[0] * m[4]) / det;
+    inv[5] = (m[0] * m[2] - m[1] * m[1]) / det;
+    return true;
+  }
+
+  static void multiplySym3(std::array<double, 6> const& m, std::array<double, 3> const& v, std::array<double, 3>& result)
+  {
+    result[0] = m[0] * v[0] + m[1] * v[1] + m[3] * v[2];
+    result[1] = m[1] * v[0] + m[2] * v[1] + m[4] * v[2];
+    result[2] = m[3] * v[0] + m[4] * v[1] + m[5] * v[2];
+  }
+
+  o2::vertexing::PVertexer mVertexer;
+  bool mIsConfigured = false;
+  bool mIsVertexerInitialised = false;
+  float mBz = 0.f;       // magnetic field of the vertexer
+  double mTukey2I = 0.; // 1 / tukey^2, 0 for unweighted contributions
+  bool mIsPreparedForFullRefit = false;
+  bool mIsPreparedForDowndate = false;
+
+  o2::dataformats::VertexBase mVertex;
+  float mChi2 = 0.f;
+  size_t mNContributors = 0;
+  std::array<double, 6> mInfo{};
+  std::array<double, 3> mInfoPos{};
+  std::vector<Contribution> mContributions;
+};
+
+#endif // COMMON_CORE_PRIMARYVERTEXREFITTER_H_
@@ -0,0 +1,164 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+//
+// Evaluation of several track selections in one pass over the tracks
+//
+// The track variables used by the cuts (pt, eta, cluster counts, chi2, refit flags, DCA) are read once per
+// track into column buffers, in batches of kBatchSize tracks, and all the selections of the set are then
+// evaluated on the buffers. The mask of each selection is identical to TrackSelection::IsSelectedMask.
+//
+
+#ifndef COMMON_CORE_TRACKSELECTIONSET_H_
+#define COMMON_CORE_TRACKSELECTIONSET_H_
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "Framework/DataTypes.h"
+#include "Common/Core/TrackSelection.h"
+
+class TrackSelectionSet
+{
+ public:
+  using TrackCuts = TrackSelection::TrackCuts;
+  static constexpr std::size_t kBatchSize = 1024;
+  static constexpr uint16_t kAllCuts = (1 << static_cast<int>(TrackCuts::kNCuts)) - 1;
+
+  /// Adds a copy of the selection to the set
+  /// \return index of the selection in the set
+  int add(TrackSelection const& selection)
+  {
+    mSelections.push_back(selection);
+    mMasks.emplace_back();
+    return static_cast<int>(mSelections.size()) - 1;
+  }
+
+  std::size_t size() const { return mSelections.size(); }
+
+  /// Evaluates all the selections on all the tracks of the table
+  template <typename T>
+  void evaluate(T const& tracks)
+  {
+    const std::size_t nTracks = tracks.size();
+    for (auto& masks : mMasks) {
+      masks.resize(nTracks);
+    }
+    std::size_t first = 0;
+    std::size_t n = 0;
+    for (auto const& track : tracks) {
+      const bool isRun2 = track.trackType() == o2::aod::track::Run2Track || track.trackType() == o2::aod::track::Run2Tracklet;
+      mTrackType[n] = track.trackType();
+      mPt[n] = track.pt();
+      mEta[n] = track.eta();
+      mTPCNClsFound[n] = track.tpcNClsFound();
+      mTPCCrossedRows[n] = track.tpcNClsCrossedRows();
+      mTPCCrossedRowsOverFindableCls[n] = track.tpcCrossedRowsOverFindableCls();
+      mTPCChi2NCl[n] = track.tpcChi2NCl();
+      mTPCRefit[n] = isRun2 ? (track.flags() & o2::aod::track::TPCrefit) != 0 : track.hasTPC();
+      mITSNCls[n] = track.itsNCls();
+      mITSChi2NCl[n] = track.itsChi2NCl();
+      mITSRefit[n] = isRun2 ? (track.flags() & o2::aod::track::ITSrefit) != 0 : track.hasITS();
+      mITSClusterMap[n] = track.itsClusterMap();
+      mGoldenChi2[n] = !isRun2 || (track.flags() & o2::aod::track::GoldenChi2) != 0;
+      mAbsDcaXY[n] = std::abs(track.dcaXY());
+      mAbsDcaZ[n] = std::abs(track.dcaZ());
+      if (++n == kBatchSize) {
+        evaluateBatch(first, n);
+        first += n;
+        n = 0;
+      }
+    }
+    evaluateBatch(first, n);
+  }
+
+  /// Mask of the passed cuts (bits as in TrackSelection::TrackCuts) of the selection for the track at the given row
+  uint16_t getMask(int iSelection, std::size_t iTrack) const { return mMasks[iSelection][iTrack]; }
+
+  /// Whether the track at the given row passes all the cuts of the selection
+  bool isSelected(int iSelection, std::size_t iTrack) const { return mMasks[iSelection][iTrack] == kAllCuts; }
+
+ private:
+  static constexpr uint16_t bit(TrackCuts cut) { return 1 << static_cast<int>(cut); }
+
+  void evaluateBatch(std::size_t first, std::size_t n)
+  {
+    for (std::size_t iSelection = 0; iSelection < mSelections.size(); iSelection++) {
+      auto const& sel = mSelections[iSelection];
+      uint16_t* masks = mMasks[iSelection].data() + first;
+
+      // pT-dependent DCAxy cut: one call per track and selection
+      if (sel.mMaxDcaXYPtDep) {
+        for (std::size_t i = 0; i < n; i++) {
+          mMaxDcaXY[i] = sel.mMaxDcaXYPtDep(mPt[i]);
+        }
+      } else {
+        std::fill(mMaxDcaXY.begin(), mMaxDcaXY.begin() + n, sel.mMaxDcaXY);
+      }
+
+      for (std::size_t i = 0; i < n; i++) {
+        uint16_t mask = 0;
+        mask |= (mTrackType[i] == sel.mTrackType) ? bit(TrackCuts::kTrackType) : 0;
+        mask |= (mPt[i] >= sel.mMinPt && mPt[i] <= sel.mMaxPt) ? bit(TrackCuts::kPtRange) : 0;
+        mask |= (mEta[i] >= sel.mMinEta && mEta[i] <= sel.mMaxEta) ? bit(TrackCuts::kEtaRange) : 0;
+        mask |= (mTPCNClsFound[i] >= sel.mMinNClustersTPC) ? bit(TrackCuts::kTPCNCls) : 0;
+        mask |= (mTPCCrossedRows[i] >= sel.mMinNCrossedRowsTPC) ? bit(TrackCuts::kTPCCrossedRows) : 0;
+        mask |= (mTPCCrossedRowsOverFindableCls[i] >= sel.mMinNCrossedRowsOverFindableClustersTPC) ? bit(TrackCuts::kTPCCrossedRowsOverNCls) : 0;
+        mask |= (mTPCChi2NCl[i] <= sel.mMaxChi2PerClusterTPC) ? bit(TrackCuts::kTPCChi2NDF) : 0;
+        mask |= (!sel.mRequireTPCRefit || mTPCRefit[i]) ? bit(TrackCuts::kTPCRefit) : 0;
+        mask |= (mITSNCls[i] >= sel.mMinNClustersITS) ? bit(TrackCuts::kITSNCls) : 0;
+        mask |= (mITSChi2NCl[i] <= sel.mMaxChi2PerClusterITS) ? bit(TrackCuts::kITSChi2NDF) : 0;
+        mask |= (!sel.mRequireITSRefit || mITSRefit[i]) ? bit(TrackCuts::kITSRefit) : 0;
+        mask |= (!sel.mRequireGoldenChi2 || mGoldenChi2[i]) ? bit(TrackCuts::kGoldenChi2) : 0;
+        mask |= (mAbsDcaXY[i] <= mMaxDcaXY[i]) ? bit(TrackCuts::kDCAxy) : 0;
+        mask |= (mAbsDcaZ[i] <= sel.mMaxDcaZ) ? bit(TrackCuts::kDCAz) : 0;
+        masks[i] = mask;
+      }
+
+      // ITS hit requirements on the bit masks of the required layers
+      for (std::size_t i = 0; i < n; i++) {
+        bool isITSHitsSelected = true;
+        for (auto const& itsRequirement : sel.mRequiredITSHits) {
+          const int hits = std::bitset<8>(mITSClusterMap[i] & itsRequirement.second).count();
+          isITSHitsSelected &= (itsRequirement.first == -1) ? (hits == 0) : (hits >= itsRequirement.first);
+        }
+        masks[i] |= isITSHitsSelected ? bit(TrackCuts::kITSHits) : 0;
+      }
+    }
+  }
+
+  std::vector<TrackSelection> mSelections;
+  std::vector<std::vector<uint16_t>> mMasks; // per selection, per track
+
+  // column buffers of one batch of tracks
+  std::array<uint8_t, kBatchSize> mTrackType;
+  std::array<float, kBatchSize> mPt;
+  std::array<float, kBatchSize> mEta;
+  std::array<int16_t, kBatchSize> mTPCNClsFound;
+  std::array<int16_t, kBatchSize> mTPCCrossedRows;
+  std::array<float, kBatchSize> mTPCCrossedRowsOverFindableCls;
+  std::array<float, kBatchSize> mTPCChi2NCl;
+  std::array<bool, kBatchSize> mTPCRefit;
+  std::array<uint8_t, kBatchSize> mITSNCls;
+  std::array<float, kBatchSize> mITSChi2NCl;
+  std::array<bool, kBatchSize> mITSRefit;
+  std::array<uint8_t, kBatchSize> mITSClusterMap;
+  std::array<bool, kBatchSize> mGoldenChi2;
+  std::array<float, kBatchSize> mAbsDcaXY;
+  std::array<float, kBatchSize> mAbsDcaZ;
+  std::array<float, kBatchSize> mMaxDcaXY;
+};
+
+#endif // COMMON_CORE_TRACKSELECTIONSET_H_
@@ -22,7 +22,6 @@
 #include <chrono>
 #include <string>
 #include <vector>
-#include <TComplex.h>
 #include <TMath.h>
 
 // o2Physics includes.
@@ -123,6 +122,9 @@ struct qVectorsTable {
       LOGF(fatal, "Could not get the alignment parameters for FV0.");
     }
 
+    // Tabulate cos(n*phi) and sin(n*phi) of all the FIT channels with these offsets.
+    helperEP.BuildHarmonicTables();
+
     if (cfgCorr->size() < 48) {
       LOGF(fatal, "No proper correction factor assigned");
     }
@@ -201,7 +203,8 @@ struct qVectorsTable {
     float qVectBPos[2] = {0.};
     float qVectBNeg[2] = {0.};
 
-    TComplex QvecDet(0);    // Complex value of the Q-vector for any detector.
+    double qxDet = 0.;      // Real part of the Q-vector for any detector.
+    double qyDet = 0.;      // Imaginary part of the Q-vector for any detector.
     double sumAmplDet = 0.; // Sum of the amplitudes of all non-dead channels in any detector.
 
     /// First check if the collision has a found FT0. If yes, calculate the
@@ -210,23 +213,16 @@ struct qVectorsTable {
     if (coll.has_foundFT0()) {
       auto ft0 = coll.foundFT0();
 
-      // Iterate over the non-dead channels for FT0-A to get the total Q-vector
-      // and sum of amplitudes.
-      for (std::size_t iChA = 0; iChA < ft0.channelA().size(); iChA++) {
-        // Get first the corresponding amplitude.
-        float ampl = ft0.amplitudeA()[iChA];
-
-        // Update the Q-vector and sum of amplitudes using the helper function.
-        // LOKI: Note this assumes nHarmo = 2!! Likely generalise in the future.
-        helperEP.SumQvectors(0, iChA, ampl, QvecDet, sumAmplDet);
-      } // Go to the next channel iChA.
+      // Sum over the non-dead channels for FT0-A to get the total Q-vector
+      // and sum of amplitudes, using the tabulated harmonics of the helper.
+      // LOKI: Note this assumes nHarmo = 2!! Likely generalise in the future.
+      helperEP.SumQvectors(0, 0, ft0.amplitudeA().data(), ft0.amplitudeA().size(), 2, qxDet, qyDet, sumAmplDet);
 
       // Set the Qvectors for FT0A with the normalised Q-vector values if the sum of
       // amplitudes is non-zero. Otherwise, set it to a dummy 999.
       if (sumAmplDet > 1e-8) {
-        QvecDet /= sumAmplDet;
-        qVectFT0A[0] = QvecDet.Re();
-        qVectFT0A[1] = QvecDet.Im();
+        qVectFT0A[0] = qxDet / sumAmplDet;
+        qVectFT0A[1] = qyDet / sumAmplDet;
         // printf("qVectFT0A[0] = %.2f ; qVectFT0A[1] = %.2f \n", qVectFT0A[0], qVectFT0A[1]); // Debug printing.
       } else {
         qVectFT0A[0] = 999.;
@@ -235,19 +231,16 @@ struct qVectorsTable {
 
       // Repeat the procedure with FT0-C for the found FT0.
       // Start by resetting to zero the intermediate quantities.
-      QvecDet = TComplex(0., 0.);
+      qxDet = 0.;
+      qyDet = 0.;
       sumAmplDet = 0;
-      for (std::size_t iChC = 0; iChC < ft0.channelC().size(); iChC++) {
-        // iChC ranging from 0 to max 112. We need to add 96 (= max channels in FT0-A)
-        // to ensure a proper channel number in FT0 as a whole.
-        float ampl = ft0.amplitudeC()[iChC];
-        helperEP.SumQvectors(0, iChC + 96, ampl, QvecDet, sumAmplDet);
-      }
+      // The channels of FT0-C range from 0 to max 112. We need to add 96 (= max channels
+      // in FT0-A) to ensure a proper channel number in FT0 as a whole.
+      helperEP.SumQvectors(0, 96, ft0.amplitudeC().data(), ft0.amplitudeC().size(), 2, qxDet, qyDet, sumAmplDet);
 
       if (sumAmplDet > 1e-8) {
-        QvecDet /= sumAmplDet;
-        qVectFT0C[0] = QvecDet.Re();
-        qVectFT0C[1] = QvecDet.Im();
+        qVectFT0C[0] = qxDet / sumAmplDet;
+        qVectFT0C[1] = qyDet / sumAmplDet;
         // printf("qVectFT0C[0] = %.2f ; qVectFT0C[1] = %.2f \n", qVectFT0C[0], qVectFT0C[1]); // Debug printing.
       } else {
         qVectFT0C[0] = 999.;
@@ -262,20 +255,17 @@ struct qVectorsTable {
 
     /// Repeat the procedure for FV0 if one has been found for this collision.
     /// Again reset the intermediate quantities to zero.
-    QvecDet = TComplex(0., 0.);
+    qxDet = 0.;
+    qyDet = 0.;
     sumAmplDet = 0;
     if (coll.has_foundFV0()) {
       auto fv0 = coll.foundFV0();
 
-      for (std::size_t iCh = 0; iCh < fv0.channel().size(); iCh++) {
-        float ampl = fv0.amplitude()[iCh];
-        helperEP.SumQvectors(1, iCh, ampl, QvecDet, sumAmplDet);
-      }
+      helperEP.SumQvectors(1, 0, fv0.amplitude().data(), fv0.amplitude().size(), 2, qxDet, qyDet, sumAmplDet);
 
       if (sumAmplDet > 1e-8) {
-        QvecDet /= sumAmplDet;
-        qVectFV0A[0] = QvecDet.Re();
-        qVectFV0A[1] = QvecDet.Im();
+        qVectFV0A[0] = qxDet / sumAmplDet;
+        qVectFV0A[1] = qyDet / sumAmplDet;
         // printf("qVectFV0[0] = %.2f ; qVectFV0[1] = %.2f \n", qVectFV0[0], qVectFV0[1]); // Debug printing.
       } else {
         qVectFV0A[0] = 999.;
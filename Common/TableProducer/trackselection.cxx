@@ -22,6 +22,7 @@
 #include "Framework/runDataProcessing.h"
 #include "Common/Core/TrackSelection.h"
 #include "Common/Core/TrackSelectionDefaults.h"
+#include "Common/Core/TrackSelectionSet.h"
 #include "Common/DataModel/TrackSelectionTables.h"
 #include "Common/Core/trackUtilities.h"
 #include "TableHelper.h"
@@ -58,6 +59,16 @@ struct TrackSelectionTask {
   TrackSelection filtBit4;
   TrackSelection filtBit5;
 
+  // all the selections above, evaluated in one pass over the tracks
+  TrackSelectionSet selections;
+  int iGlobalTracks = -1;
+  int iGlobalTracksSDD = -1;
+  int iFiltBit1 = -1;
+  int iFiltBit2 = -1;
+  int iFiltBit3 = -1;
+  int iFiltBit4 = -1;
+  int iFiltBit5 = -1;
+
   void init(InitContext& initContext)
   {
     // Check which tables are used
@@ -123,6 +134,16 @@ struct TrackSelectionTask {
 
     LOG(info) << "setting up filtBit5 = getJEGlobalTrackSelectionRun2();";
     filtBit5 = getJEGlobalTrackSelectionRun2(); // Jet validation requires reduced set of cuts
+
+    iGlobalTracks = selections.add(globalTracks);
+    if (!isRun3) {
+      iGlobalTracksSDD = selections.add(globalTracksSDD);
+    }
+    iFiltBit1 = selections.add(filtBit1);
+    iFiltBit2 = selections.add(filtBit2);
+    iFiltBit3 = selections.add(filtBit3);
+    iFiltBit4 = selections.add(filtBit4);
+    iFiltBit5 = selections.add(filtBit5);
   }
 
   void process(soa::Join<aod::FullTracks, aod::TracksDCA> const& tracks)
@@ -136,25 +157,26 @@ struct TrackSelectionTask {
     if (produceTable == 0 && produceFBextendedTable == 0) {
       return;
     }
+    selections.evaluate(tracks);
     if (isRun3) {
-      for (auto& track : tracks) {
+      for (std::size_t iTrack = 0; iTrack < tracks.size(); iTrack++) {
 
         if (produceTable == 1) {
           filterTable((uint8_t)0,
-                      globalTracks.IsSelectedMask(track),
-                      filtBit1.IsSelected(track),
-                      filtBit2.IsSelected(track),
-                      filtBit3.IsSelected(track),
-                      filtBit4.IsSelected(track),
-                      filtBit5.IsSelected(track));
+                      selections.getMask(iGlobalTracks, iTrack),
+                      selections.isSelected(iFiltBit1, iTrack),
+                      selections.isSelected(iFiltBit2, iTrack),
+                      selections.isSelected(iFiltBit3, iTrack),
+                      selections.isSelected(iFiltBit4, iTrack),
+                      selections.isSelected(iFiltBit5, iTrack));
         }
         if (produceFBextendedTable == 1) {
-          o2::aod::track::TrackSelectionFlags::flagtype trackflagGlob = globalTracks.IsSelectedMask(track);
-          o2::aod::track::TrackSelectionFlags::flagtype trackflagFB1 = filtBit1.IsSelectedMask(track);
-          o2::aod::track::TrackSelectionFlags::flagtype trackflagFB2 = filtBit2.IsSelectedMask(track);
-          // o2::aod::track::TrackSelectionFlags::flagtype trackflagFB3 = filtBit3.IsSelectedMask(track); // only temporarily commented, will be used
-          // o2::aod::track::TrackSelectionFlags::flagtype trackflagFB4 = filtBit4.IsSelectedMask(track);
-          // o2::aod::track::TrackSelectionFlags::flagtype trackflagFB5 = filtBit5.IsSelectedMask(track);
+          o2::aod::track::TrackSelectionFlags::flagtype trackflagGlob = selections.getMask(iGlobalTracks, iTrack);
+          o2::aod::track::TrackSelectionFlags::flagtype trackflagFB1 = selections.getMask(iFiltBit1, iTrack);
+          o2::aod::track::TrackSelectionFlags::flagtype trackflagFB2 = selections.getMask(iFiltBit2, iTrack);
+          // o2::aod::track::TrackSelectionFlags::flagtype trackflagFB3 = selections.getMask(iFiltBit3, iTrack); // only temporarily commented, will be used
+          // o2::aod::track::TrackSelectionFlags::flagtype trackflagFB4 = selections.getMask(iFiltBit4, iTrack);
+          // o2::aod::track::TrackSelectionFlags::flagtype trackflagFB5 = selections.getMask(iFiltBit5, iTrack);
 
           filterTableDetail(o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kTrackType),
                             o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kPtRange),
@@ -178,16 +200,16 @@ struct TrackSelectionTask {
       return;
     }
 
-    for (auto& track : tracks) {
-      o2::aod::track::TrackSelectionFlags::flagtype trackflagGlob = globalTracks.IsSelectedMask(track);
+    for (std::size_t iTrack = 0; iTrack < tracks.size(); iTrack++) {
+      o2::aod::track::TrackSelectionFlags::flagtype trackflagGlob = selections.getMask(iGlobalTracks, iTrack);
       if (produceTable == 1) {
-        filterTable((uint8_t)globalTracksSDD.IsSelected(track),
-                    globalTracks.IsSelectedMask(track),
-                    filtBit1.IsSelected(track),
-                    filtBit2.IsSelected(track),
-                    filtBit3.IsSelected(track),
-                    filtBit4.IsSelected(track),
-                    filtBit5.IsSelected(track));
+        filterTable((uint8_t)selections.isSelected(iGlobalTracksSDD, iTrack),
+                    trackflagGlob,
+                    selections.isSelected(iFiltBit1, iTrack),
+                    selections.isSelected(iFiltBit2, iTrack),
+                    selections.isSelected(iFiltBit3, iTrack),
+                    selections.isSelected(iFiltBit4, iTrack),
+                    selections.isSelected(iFiltBit5, iTrack));
       }
       if (produceFBextendedTable == 1) {
         filterTableDetail(o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kTrackType),
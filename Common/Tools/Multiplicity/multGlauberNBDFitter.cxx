@@ -26,6 +26,8 @@
  **********************************************/
 
 #include "multGlauberNBDFitter.h"
+#include <algorithm>
+#include <thread>
 #include "TList.h"
 #include "TFile.h"
 #include "TF1.h"
@@ -36,12 +38,23 @@
 
 using namespace std;
 
+namespace
+{
+//Contributions of an ancestor below this fraction of its maximum are neglected in fast mode
+constexpr Double_t kNBDRelativeCutoff = 1.e-18;
+//Above this distance between two fit points, the NBD is evaluated directly instead of by recurrence
+constexpr Long_t kMaxRecurrenceSteps = 64;
+//Maximum number of cached ancestor distributions
+constexpr std::size_t kMaxCachedAncestors = 64;
+} // namespace
+
 ClassImp(multGlauberNBDFitter);
 
 multGlauberNBDFitter::multGlauberNBDFitter() : TNamed(),
                                                fNBD(0x0),
                                                fhNanc(0x0),
                                                fhNpNc(0x0),
+                                               fhV0M(0x0),
                                                ffChanged(kTRUE),
                                                fCurrentf(-1),
                                                fAncestorMode(2),
@@ -56,7 +69,11 @@ multGlauberNBDFitter::multGlauberNBDFitter() : TNamed(),
                                                ff(0.8),
                                                fnorm(100),
                                                fFitOptions("R0"),
-                                               fFitNpx(5000)
+                                               fFitNpx(5000),
+                                               fFastMode(kFALSE),
+                                               fNThreads(0),
+                                               fFirstFitPoint(0),
+                                               fCurveValid(kFALSE)
 {
   // Constructor
   fNpart = new Double_t[fMaxNpNcPairs];
@@ -89,6 +106,7 @@ multGlauberNBDFitter::multGlauberNBDFitter(const char* name, const char* title)
                                                                                   fNBD(0x0),
                                                                                   fhNanc(0x0),
                                                                                   fhNpNc(0x0),
+                                                                                  fhV0M(0x0),
                                                                                   ffChanged(kTRUE),
                                                                                   fCurrentf(-1),
                                                                                   fAncestorMode(2),
@@ -103,7 +121,11 @@ multGlauberNBDFitter::multGlauberNBDFitter(const char* name, const char* title)
                                                                                   ff(0.8),
                                                                                   fnorm(100),
                                                                                   fFitOptions("R0"),
-                                                                                  fFitNpx(5000)
+                                                                                  fFitNpx(5000),
+                                                                                  fFastMode(kFALSE),
+                                                                                  fNThreads(0),
+                                                                                  fFirstFitPoint(0),
+                                                                                  fCurveValid(kFALSE)
 {
   //Named constructor
   fNpart = new Double_t[fMaxNpNcPairs];
@@ -159,6 +181,9 @@ multGlauberNBDFitter::~multGlauberNBDFitter()
 Double_t multGlauberNBDFitter::ProbDistrib(Double_t* x, Double_t* par)
 //Master fitter function
 {
+  if (fFastMode)
+    return ProbDistribFast(x, par);
+
   Double_t lMultValue = x[0];
   Double_t lProbability = 0.0;
   ffChanged = kTRUE;
@@ -170,26 +195,8 @@ Double_t multGlauberNBDFitter::ProbDistrib(Double_t* x, Double_t* par)
   //______________________________________________________
   //Recalculate the ancestor distribution in case f changed
   if (ffChanged) {
-    fCurrentf = par[2];
-    fhNanc->Reset();
-
-    for (int ibin = 0; ibin < fNNpNcPairs; ibin++) {
-      Double_t lOption0 = (Int_t)(fNpart[ibin] * par[2] + fNcoll[ibin] * (1.0 - par[2]));
-      Double_t lOption1 = TMath::Floor(fNpart[ibin] * par[2] + fNcoll[ibin] * (1.0 - par[2]) + 0.5);
-      Double_t lOption2 = (fNpart[ibin] * par[2] + fNcoll[ibin] * (1.0 - par[2]));
-      if (fAncestorMode == 0)
-        fhNanc->Fill(lOption0, fContent[ibin]);
-      if (fAncestorMode == 1)
-        fhNanc->Fill(lOption1, fContent[ibin]);
-      if (fAncestorMode == 2)
-        fhNanc->Fill(lOption2, fContent[ibin]);
-    }
-    if (fhNanc->Integral() < 1) {
-      cout << "ERROR: ANCESTOR HISTOGRAM EMPTY" << endl;
-      cout << "Will not do anything. Call InitializeNpNc if you want to plot without fitting" << endl;
+    if (!FillAncestorHistogram(par[2]))
       return 0;
-    }
-    fhNanc->Scale(1. / fhNanc->Integral());
   }
   //______________________________________________________
   //Actually evaluate function
@@ -214,6 +221,238 @@ Double_t multGlauberNBDFitter::ProbDistrib(Double_t* x, Double_t* par)
   return par[3] * lProbability;
 }
 
+//______________________________________________________
+Bool_t multGlauberNBDFitter::FillAncestorHistogram(Double_t lf)
+{
+  fCurrentf = lf;
+  fhNanc->Reset();
+
+  for (int ibin = 0; ibin < fNNpNcPairs; ibin++) {
+    Double_t lOption0 = (Int_t)(fNpart[ibin] * lf + fNcoll[ibin] * (1.0 - lf));
+    Double_t lOption1 = TMath::Floor(fNpart[ibin] * lf + fNcoll[ibin] * (1.0 - lf) + 0.5);
+    Double_t lOption2 = (fNpart[ibin] * lf + fNcoll[ibin] * (1.0 - lf));
+    if (fAncestorMode == 0)
+      fhNanc->Fill(lOption0, fContent[ibin]);
+    if (fAncestorMode == 1)
+      fhNanc->Fill(lOption1, fContent[ibin]);
+    if (fAncestorMode == 2)
+      fhNanc->Fill(lOption2, fContent[ibin]);
+  }
+  if (fhNanc->Integral() < 1) {
+    cout << "ERROR: ANCESTOR HISTOGRAM EMPTY" << endl;
+    cout << "Will not do anything. Call InitializeNpNc if you want to plot without fitting" << endl;
+    return kFALSE;
+  }
+  fhNanc->Scale(1. / fhNanc->Integral());
+  return kTRUE;
+}
+
+//______________________________________________________
+Double_t multGlauberNBDFitter::ProbDistribFast(Double_t* x, Double_t* par)
+//Same as ProbDistrib, but the convolution is computed at all the fit points
+//whenever mu, k, f or dMu/dNanc change and then looked up
+{
+  const AncestorDistribution* lAncestors = GetAncestorDistribution(par[2]);
+  if (!lAncestors)
+    return 0;
+
+  Double_t lMultValue = x[0];
+  auto lPoint = std::lower_bound(fFitPointsX.begin(), fFitPointsX.end(), lMultValue - 1.e-9);
+  if (lPoint != fFitPointsX.end() && TMath::Abs(*lPoint - lMultValue) < 1.e-9) {
+    if (!fCurveValid || fCurvePar[0] != par[0] || fCurvePar[1] != par[1] || fCurvePar[2] != par[2] || fCurvePar[3] != par[4]) {
+      ComputeCurve(*lAncestors, par);
+      fCurvePar[0] = par[0];
+      fCurvePar[1] = par[1];
+      fCurvePar[2] = par[2];
+      fCurvePar[3] = par[4];
+      fCurveValid = kTRUE;
+    }
+    return par[3] * fCurve[lPoint - fFitPointsX.begin()];
+  }
+
+  //Not a fit point (e.g. when drawing): direct evaluation
+  if (lMultValue <= 1e-6)
+    return 0;
+  Double_t lN = fAncestorMode != 2 ? TMath::Floor(lMultValue) : lMultValue;
+  Double_t lProbability = 0.0;
+  for (std::size_t iNanc = 0; iNanc < lAncestors->fNanc.size(); iNanc++) {
+    Double_t lNancestors = lAncestors->fNanc[iNanc];
+    Double_t lThisMu = lNancestors * (par[0] + par[4] * lNancestors);
+    Double_t lThisk = lNancestors * par[1];
+    lProbability += lAncestors->fWeight[iNanc] * TMath::Exp(LnNBD(lN, lThisMu, lThisk));
+  }
+  return par[3] * lProbability;
+}
+
+//______________________________________________________
+void multGlauberNBDFitter::PrepareFitPoints()
+{
+  //The fit evaluates the function at the bin centers of the input histogram
+  fFitPointsX.clear();
+  fFitPointsN.clear();
+  fFirstFitPoint = 0;
+  fCurveValid = kFALSE;
+  if (!fhV0M)
+    return;
+  for (int ibin = 1; ibin <= fhV0M->GetNbinsX(); ibin++) {
+    Double_t lMultValue = fhV0M->GetBinCenter(ibin);
+    fFitPointsX.push_back(lMultValue);
+    //the NBD is evaluated at the truncated multiplicity unless taken as continuous
+    fFitPointsN.push_back(fAncestorMode != 2 ? TMath::Floor(lMultValue) : lMultValue);
+    if (lMultValue <= 1e-6)
+      fFirstFitPoint = fFitPointsX.size();
+  }
+  fCurve.assign(fFitPointsX.size(), 0.);
+}
+
+//______________________________________________________
+const multGlauberNBDFitter::AncestorDistribution* multGlauberNBDFitter::GetAncestorDistribution(Double_t lf)
+{
+  auto lCached = fAncestorCache.find(lf);
+  if (lCached != fAncestorCache.end())
+    return &lCached->second;
+
+  if (!FillAncestorHistogram(lf))
+    return nullptr;
+  if (fAncestorCache.size() >= kMaxCachedAncestors)
+    fAncestorCache.clear();
+  AncestorDistribution& lAncestors = fAncestorCache[lf];
+  Int_t lStartBin = fhNanc->FindBin(0.0) + 1;
+  for (Long_t iNanc = lStartBin; iNanc < fhNanc->GetNbinsX() + 1; iNanc++) {
+    if (fhNanc->GetBinContent(iNanc) == 0)
+      continue;
+    lAncestors.fNanc.push_back(fhNanc->GetBinCenter(iNanc));
+    lAncestors.fWeight.push_back(fhNanc->GetBinContent(iNanc));
+  }
+  return &lAncestors;
+}
+
+//______________________________________________________
+void multGlauberNBDFitter::ComputeCurve(const AncestorDistribution& lAncestors, const Double_t* par)
+{
+  //Ancestors are distributed round-robin among the threads, each thread
+  //accumulates its own partial convolution: the result does not depend on timing
+  const std::size_t lNAncestors = lAncestors.fNanc.size();
+  Int_t lNThreads = fNThreads > 0 ? fNThreads : std::max(1u, std::thread::hardware_concurrency());
+  lNThreads = std::max(1, std::min<Int_t>(lNThreads, lNAncestors));
+  fThreadCurves.resize(lNThreads);
+
+  auto lConvolve = [&](Int_t iThread) {
+    std::vector<Double_t>& lCurve = fThreadCurves[iThread];
+    lCurve.assign(fFitPointsX.size(), 0.);
+    for (std::size_t iNanc = iThread; iNanc < lNAncestors; iNanc += lNThreads)
+      AddAncestorNBD(lAncestors.fNanc[iNanc], lAncestors.fWeight[iNanc], par, lCurve.data());
+  };
+  std::vector<std::thread> lThreads;
+  for (Int_t iThread = 1; iThread < lNThreads; iThread++)
+    lThreads.emplace_back(lConvolve, iThread);
+  lConvolve(0);
+  for (auto& lThread : lThreads)
+    lThread.join();
+
+  fCurve = fThreadCurves[0];
+  for (Int_t iThread = 1; iThread < lNThreads; iThread++) {
+    for (std::size_t iPoint = 0; iPoint < fCurve.size(); iPoint++)
+      fCurve[iPoint] += fThreadCurves[iThread][iPoint];
+  }
+}
+
+//______________________________________________________
+void multGlauberNBDFitter::AddAncestorNBD(Double_t lNancestors, Double_t lWeight, const Double_t* par, Double_t* lCurve) const
+{
+  //Adds the NBD of one ancestor value to the convolution at the fit points.
+  //The NBD is evaluated directly at the fit point closest to its maximum and
+  //from there by recurrence in both directions, until it becomes negligible
+  const Long_t lNPoints = fFitPointsN.size();
+  if (fFirstFitPoint >= lNPoints)
+    return;
+  Double_t lThisMu = lNancestors * (par[0] + par[4] * lNancestors);
+  Double_t lThisk = lNancestors * par[1];
+
+  Double_t lNMaximum = lThisMu * (lThisk - 1.) / lThisk;
+  Long_t lStart = std::lower_bound(fFitPointsN.begin() + fFirstFitPoint, fFitPointsN.end(), lNMaximum) - fFitPointsN.begin();
+  lStart = std::min(lStart, lNPoints - 1);
+  Double_t lPeak = TMath::Exp(LnNBD(fFitPointsN[lStart], lThisMu, lThisk));
+  lCurve[lStart] += lWeight * lPeak;
+  if (!(lPeak > 0.)) // underflow or invalid parameters
+    return;
+  const Double_t lCutoff = lPeak * kNBDRelativeCutoff;
+
+  Double_t lProb = lPeak;
+  for (Long_t iPoint = lStart + 1; iPoint < lNPoints; iPoint++) {
+    lProb = StepNBD(fFitPointsN[iPoint - 1], fFitPointsN[iPoint], lProb, lThisMu, lThisk);
+    if (lProb < lCutoff)
+      break;
+    lCurve[iPoint] += lWeight * lProb;
+  }
+  lProb = lPeak;
+  for (Long_t iPoint = lStart - 1; iPoint >= fFirstFitPoint; iPoint--) {
+    lProb = StepNBD(fFitPointsN[iPoint + 1], fFitPointsN[iPoint], lProb, lThisMu, lThisk);
+    if (lProb < lCutoff)
+      break;
+    lCurve[iPoint] += lWeight * lProb;
+  }
+}
+
+//______________________________________________________
+Double_t multGlauberNBDFitter::LnNBD(Double_t n, Double_t mu, Double_t k)
+{
+  //Logarithm of ContinuousNBD
+  return TMath::LnGamma(n + k) - TMath::LnGamma(n + 1.) - TMath::LnGamma(k) + n * TMath::Log(mu / k) - (n + k) * TMath::Log(1.0 + mu / k);
+}
+
+//______________________________________________________
+Double_t multGlauberNBDFitter::StepNBD(Double_t nFrom, Double_t nTo, Double_t lProb, Double_t mu, Double_t k)
+{
+  //NBD at nTo from its value lProb at nFrom, with the recurrence
+  //P(n+1) = P(n) * (n+k)/(n+1) * mu/(mu+k), valid also for non-integer n
+  Double_t lGap = nTo - nFrom;
+  Long_t lSteps = TMath::Nint(lGap);
+  if (TMath::Abs(lGap - lSteps) > 1e-9 || TMath::Abs(lSteps) > kMaxRecurrenceSteps)
+    return TMath::Exp(LnNBD(nTo, mu, k));
+  const Double_t lRatio = mu / (mu + k);
+  for (Long_t iStep = 0; iStep < lSteps; iStep++)
+    lProb *= (nFrom + iStep + k) / (nFrom + iStep + 1.) * lRatio;
+  for (Long_t iStep = 0; iStep > lSteps; iStep--)
+    lProb *= (nFrom + iStep) / ((nFrom + iStep - 1. + k) * lRatio);
+  return lProb;
+}
+
+//______________________________________________________
+Double_t multGlauberNBDFitter::GetFastModeDeviation()
+{
+  InitAncestor();
+  if (fNNpNcPairs < 0 && !InitializeNpNc())
+    return -1;
+  fAncestorCache.clear();
+  PrepareFitPoints();
+
+  Bool_t lFastMode = fFastMode;
+  Double_t lPar[5] = {fMu, fk, ff, fnorm, fdMu};
+  std::vector<Double_t> lFast(fFitPointsX.size()), lStandard(fFitPointsX.size());
+  for (std::size_t iPoint = 0; iPoint < fFitPointsX.size(); iPoint++) {
+    Double_t lMultValue = fFitPointsX[iPoint];
+    fFastMode = kTRUE;
+    lFast[iPoint] = ProbDistrib(&lMultValue, lPar);
+    fFastMode = kFALSE;
+    lStandard[iPoint] = ProbDistrib(&lMultValue, lPar);
+  }
+  fFastMode = lFastMode;
+
+  //relative to the maximum of the distribution in the tails
+  Double_t lMaximum = 0.0;
+  for (auto lValue : lStandard)
+    lMaximum = TMath::Max(lMaximum, TMath::Abs(lValue));
+  Double_t lDeviation = 0.0;
+  for (std::size_t iPoint = 0; iPoint < fFitPointsX.size(); iPoint++) {
+    Double_t lScale = TMath::Max(TMath::Abs(lStandard[iPoint]), 1.e-12 * lMaximum);
+    if (lScale > 0)
+      lDeviation = TMath::Max(lDeviation, TMath::Abs(lFast[iPoint] - lStandard[iPoint]) / lScale);
+  }
+  cout << "---> Maximum relative deviation of the fast mode: " << lDeviation << endl;
+  return lDeviation;
+}
+
 //________________________________________________________________
 Bool_t multGlauberNBDFitter::SetNpartNcollCorrelation(TH2* hNpNc)
 {
@@ -294,6 +533,11 @@ Bool_t multGlauberNBDFitter::DoFit()
     cout << "---> Config: Nancestors will be rounded" << endl;
   if (fAncestorMode == 2)
     cout << "---> Config: Nancestors will be taken as float" << endl;
+  if (fFastMode) {
+    cout << "---> Config: fast mode, " << (fNThreads > 0 ? fNThreads : std::thread::hardware_concurrency()) << " threads" << endl;
+    fAncestorCache.clear();
+    PrepareFitPoints();
+  }
   cout << "---> Now fitting, please wait..." << endl;
 
   fGlauberNBD->SetNpx(fFitNpx);
@@ -310,6 +554,11 @@ Bool_t multGlauberNBDFitter::DoFit()
   ff = fGlauberNBD->GetParameter(2);
   fnorm = fGlauberNBD->GetParameter(3);
 
+  //In fast mode the cached ancestor distributions are reused without refilling
+  //fhNanc: refill it for the fitted f, as returned by GetAncestorHistogram
+  if (fFastMode && TMath::Abs(fCurrentf - ff) > 1.e-13)
+    FillAncestorHistogram(ff);
+
   return fitptr.Get()->IsValid();
 }
 
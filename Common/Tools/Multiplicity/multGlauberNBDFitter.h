@@ -13,6 +13,8 @@
 #define MULTGLAUBERNBDFITTER_H
 
 #include <iostream>
+#include <map>
+#include <vector>
 #include "TNamed.h"
 #include "TF1.h"
 #include "TH1.h"
@@ -32,6 +34,9 @@ class multGlauberNBDFitter : public TNamed
   //Master fitter function
   Double_t ProbDistrib(Double_t* x, Double_t* par);
 
+  //Fast evaluation of the master function, see SetFastMode
+  Double_t ProbDistribFast(Double_t* x, Double_t* par);
+
   void InitAncestor();
 
   //Do Fit: where everything happens
@@ -55,6 +60,18 @@ class multGlauberNBDFitter : public TNamed
   Int_t GetAncestorMode() { return fAncestorMode; }
   TH1D* GetAncestorHistogram() { return fhNanc; }
 
+  //Fast mode: the NBD is evaluated with its recurrence relation at all the bins
+  //of the fitted histogram at once, ancestor distributions are cached per f and
+  //the convolution over ancestors is shared among lNThreads threads (0: all cores)
+  void SetFastMode(Bool_t lFastMode = kTRUE) { fFastMode = lFastMode; }
+  Bool_t GetFastMode() { return fFastMode; }
+  void SetNThreads(Int_t lNThreads) { fNThreads = lNThreads; }
+  Int_t GetNThreads() { return fNThreads; }
+
+  //Maximum relative difference of the fast and standard evaluations at the
+  //bins of the fitted histogram, with the current parameters
+  Double_t GetFastModeDeviation();
+
   //Interface to set vals
   void SetMu(Double_t lVal) { fMu = lVal; }
   void Setk(Double_t lVal) { fk = lVal; }
@@ -80,6 +97,23 @@ class multGlauberNBDFitter : public TNamed
   //void    Print(Option_t *option="") const;
 
  private:
+  //Non-empty bins of the ancestor histogram for a given f
+  struct AncestorDistribution {
+    std::vector<Double_t> fNanc;
+    std::vector<Double_t> fWeight;
+  };
+
+  //Fills fhNanc for a given f, returns kFALSE if it is empty
+  Bool_t FillAncestorHistogram(Double_t lf);
+
+  //Helpers of the fast mode
+  void PrepareFitPoints();
+  const AncestorDistribution* GetAncestorDistribution(Double_t lf);
+  void ComputeCurve(const AncestorDistribution& lAncestors, const Double_t* par);
+  void AddAncestorNBD(Double_t lNancestors, Double_t lWeight, const Double_t* par, Double_t* lCurve) const;
+  static Double_t LnNBD(Double_t n, Double_t mu, Double_t k);
+  static Double_t StepNBD(Double_t nFrom, Double_t nTo, Double_t lProb, Double_t mu, Double_t k);
+
   //This function serves as the (analytical) NBD
   TF1* fNBD;
 
@@ -115,6 +149,18 @@ class multGlauberNBDFitter : public TNamed
   TString fFitOptions;
   Long_t fFitNpx;
 
-  ClassDef(multGlauberNBDFitter, 1);
+  //Fast mode
+  Bool_t fFastMode;
+  Int_t fNThreads;
+  std::vector<Double_t> fFitPointsX;                         //! bin centers of the fitted histogram
+  std::vector<Double_t> fFitPointsN;                         //! multiplicity at which the NBD is evaluated
+  Long_t fFirstFitPoint;                                     //! first point with non-zero probability
+  std::vector<Double_t> fCurve;                              //! convolution at the fit points, without norm
+  Double_t fCurvePar[4];                                     //! mu, k, f, dMu/dNanc of fCurve
+  Bool_t fCurveValid;                                        //!
+  std::vector<std::vector<Double_t>> fThreadCurves;          //! partial convolutions of each thread
+  std::map<Double_t, AncestorDistribution> fAncestorCache;   //! ancestor distributions per f
+
+  ClassDef(multGlauberNBDFitter, 2);
 };
 #endif
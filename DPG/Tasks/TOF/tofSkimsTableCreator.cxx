@@ -18,6 +18,7 @@
 
 #include "Framework/AnalysisTask.h"
 #include "Framework/runDataProcessing.h"
+#include "Common/Core/HashDownsampler.h"
 #include "Common/DataModel/PIDResponse.h"
 #include "Common/DataModel/Multiplicity.h"
 #include "Common/DataModel/TrackSelectionTables.h"
@@ -46,11 +47,12 @@ struct tofSkimsTableCreator {
   Configurable<int> trackSelection{"trackSelection", 1, "Track selection: 0 -> No Cut, 1 -> kGlobalTrack, 2 -> kGlobalTrackWoPtEta, 3 -> kGlobalTrackWoDCA, 4 -> kQualityTracks, 5 -> kInAcceptanceTracks"};
   Configurable<bool> keepTpcOnly{"keepTpcOnly", false, "Flag to keep the TPC only tracks as well"};
   Configurable<float> fractionOfEvents{"fractionOfEvents", 0.1, "Fractions of events to keep"};
+  Configurable<int> downsamplingSeed{"downsamplingSeed", 0, "seed of the hash of (run, BC, collision index) used to sample the events"};
 
-  unsigned int randomSeed = 0;
+  HashDownsampler downsampler;
   void init(o2::framework::InitContext& initContext)
   {
-    randomSeed = static_cast<unsigned int>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+    downsampler.setSeed(downsamplingSeed);
     switch (applyEvSel.value) {
       case 0:
       case 1:
@@ -85,10 +87,14 @@ struct tofSkimsTableCreator {
                        ((trackSelection.node() == 5) && requireInAcceptanceTracksInFilter());
 
   void process(soa::Filtered<Coll>::iterator const& collision,
-               soa::Filtered<Trks> const& tracks)
+               soa::Filtered<Trks> const& tracks,
+               aod::BCs const&)
   {
-    if (fractionOfEvents < 1.f && (static_cast<float>(rand_r(&randomSeed)) / static_cast<float>(RAND_MAX)) > fractionOfEvents) { // Skip events that are not sampled
-      return;
+    if (fractionOfEvents < 1.f) { // Skip events that are not sampled
+      auto bc = collision.bc_as<aod::BCs>();
+      if (!downsampler.isKept(fractionOfEvents, bc.runNumber(), bc.globalBC(), collision.globalIndex())) {
+        return;
+      }
     }
     tableRow.reserve(tracks.size());
     float evTimeT0AC = 0.f;
@@ -168,6 +168,12 @@ struct HfFilter { // Main struct for HF triggers
   // helper object
   HfFilterHelper helper;
 
+  // inputs and output scores of the ML models for the candidates of one collision, each model runs once per collision
+  std::array<std::vector<float>, kNCharmParticles> featuresML{};
+  std::array<std::vector<double>, kNCharmParticles> featuresDoML{};
+  std::array<std::vector<float>, kNCharmParticles> scoresML{};
+  std::array<int, kNCharmParticles> nCandidatesML{};
+
   void init(InitContext&)
   {
     helper.setPtBinsSingleTracks(pTBinsTrack);
@@ -290,6 +296,57 @@ struct HfFilter { // Main struct for HF triggers
   Preslice<aod::Hf3Prongs> hf3ProngPerCollision = aod::track_association::collisionId;
   Preslice<aod::CascDatas> cascPerCollision = aod::cascdata::collisionId;
 
+  // preselected candidates of one collision, kept between the collection of the ML inputs and the trigger selections
+  struct Candidate2Prong {
+    BigTracksPID::iterator trackPos, trackNeg;
+    std::array<float, 3> pVecPos, pVecNeg;
+    int8_t preselD0;
+    int indexML; // index of the candidate in the batch of the D0 model, -1 if not evaluated
+  };
+  struct Candidate3Prong {
+    BigTracksPID::iterator trackFirst, trackSecond, trackThird;
+    std::array<float, 3> pVecFirst, pVecSecond, pVecThird;
+    std::array<int8_t, kNCharmParticles - 1> is3Prong;
+    std::array<int, kNCharmParticles - 1> indexML; // index of the candidate in the batch of each model, -1 if not evaluated
+  };
+  std::vector<Candidate2Prong> candidates2Prong{};
+  std::vector<Candidate3Prong> candidates3Prong{};
+
+  /// Adds a candidate to the input of the ML model of a charm hadron
+  /// \param iCharmPart is the index of the charm hadron
+  /// \param features are the input features of the candidate
+  /// \return the index of the candidate in the batch
+  template <std::size_t N>
+  int addCandidateML(int iCharmPart, const std::array<float, N>& features)
+  {
+    if (dataTypeML[iCharmPart] == 11) {
+      featuresDoML[iCharmPart].insert(featuresDoML[iCharmPart].end(), features.begin(), features.end());
+    } else {
+      featuresML[iCharmPart].insert(featuresML[iCharmPart].end(), features.begin(), features.end());
+    }
+    return nCandidatesML[iCharmPart]++;
+  }
+
+  /// Runs the ML model of a charm hadron once on all the candidates added to its input
+  /// \param iCharmPart is the index of the charm hadron
+  void predictML(int iCharmPart)
+  {
+    if (dataTypeML[iCharmPart] == 1) {
+      helper.predictONNXBatch(featuresML[iCharmPart], nCandidatesML[iCharmPart], sessionML[iCharmPart], inputShapesML[iCharmPart], scoresML[iCharmPart]);
+    } else if (dataTypeML[iCharmPart] == 11) {
+      helper.predictONNXBatch(featuresDoML[iCharmPart], nCandidatesML[iCharmPart], sessionML[iCharmPart], inputShapesML[iCharmPart], scoresML[iCharmPart]);
+    } else {
+      if (iCharmPart == kD0) {
+        LOG(fatal) << "Error running model inference for D0: Unexpected input data type.";
+      }
+      LOG(error) << "Error running model inference for " << charmParticleNames[iCharmPart].data() << ": Unexpected input data type.";
+      scoresML[iCharmPart].assign(3 * nCandidatesML[iCharmPart], -1.f);
+    }
+    featuresML[iCharmPart].clear();
+    featuresDoML[iCharmPart].clear();
+    nCandidatesML[iCharmPart] = 0;
+  }
+
   void process(CollsWithEvSel const& collisions,
                aod::BCsWithTimestamps const&,
                aod::V0Datas const& theV0s,
@@ -343,6 +400,8 @@ struct HfFilter { // Main struct for HF triggers
 
       std::vector<std::vector<int64_t>> indicesDau2Prong{};
 
+      // collect the preselected D0 candidates and the inputs of the ML model
+      candidates2Prong.clear();
       auto cand2ProngsThisColl = cand2Prongs.sliceBy(hf2ProngPerCollision, thisCollId);
       for (const auto& cand2Prong : cand2ProngsThisColl) {                                // start loop over 2 prongs
         if (!TESTBIT(cand2Prong.hfflag(), o2::aod::hf_cand_2prong::DecayType::D0ToPiK)) { // check if it's a D0
@@ -372,36 +431,32 @@ struct HfFilter { // Main struct for HF triggers
           getPxPyPz(trackParNeg, pVecNeg);
         }
 
+        int indexML{-1};
+        if (applyML && onnxFiles[kD0] != "") {
+          // TODO: add more feature configurations
+          indexML = addCandidateML(kD0, std::array{trackParPos.getPt(), dcaPos[0], dcaPos[1], trackParNeg.getPt(), dcaNeg[0], dcaNeg[1]});
+        }
+        candidates2Prong.push_back({trackPos, trackNeg, pVecPos, pVecNeg, preselD0, indexML});
+      }
+
+      // apply ML models, once on all the candidates
+      if (applyML && onnxFiles[kD0] != "") {
+        predictML(kD0);
+      }
+
+      for (const auto& [trackPos, trackNeg, pVecPos, pVecNeg, preselD0, indexML] : candidates2Prong) { // start loop over selected 2 prongs
         bool isCharmTagged{true}, isBeautyTagged{true};
 
-        // apply ML models
         int tagBDT = 0;
         float scoresToFill[3] = {-1., -1., -1.};
-        if (applyML && onnxFiles[kD0] != "") {
-          isCharmTagged = false;
-          isBeautyTagged = false;
-
-          // TODO: add more feature configurations
-          std::vector<float> inputFeaturesD0{trackParPos.getPt(), dcaPos[0], dcaPos[1], trackParNeg.getPt(), dcaNeg[0], dcaNeg[1]};
-          std::vector<double> inputFeaturesDoD0{trackParPos.getPt(), dcaPos[0], dcaPos[1], trackParNeg.getPt(), dcaNeg[0], dcaNeg[1]};
-
-          if (dataTypeML[kD0] == 1) {
-            auto scores = helper.predictONNX(inputFeaturesD0, sessionML[kD0], inputShapesML[kD0]);
-            tagBDT = helper.isBDTSelected(scores, thresholdBDTScores[kD0]);
-            for (int iScore{0}; iScore < 3; ++iScore) {
-              scoresToFill[iScore] = scores[iScore];
-            }
-          } else if (dataTypeML[kD0] == 11) {
-            auto scores = helper.predictONNX(inputFeaturesDoD0, sessionML[kD0], inputShapesML[kD0]);
-            tagBDT = helper.isBDTSelected(scores, thresholdBDTScores[kD0]);
-            for (int iScore{0}; iScore < 3; ++iScore) {
-              scoresToFill[iScore] = scores[iScore];
-            }
-          } else {
-            LOG(fatal) << "Error running model inference for D0: Unexpected input data type.";
+        if (indexML >= 0) {
+          auto scores = std::array{scoresML[kD0][3 * indexML], scoresML[kD0][3 * indexML + 1], scoresML[kD0][3 * indexML + 2]};
+          tagBDT = helper.isBDTSelected(scores, thresholdBDTScores[kD0]);
+          for (int iScore{0}; iScore < 3; ++iScore) {
+            scoresToFill[iScore] = scores[iScore];
           }
 
-          if (applyML && activateQA > 1) {
+          if (activateQA > 1) {
             hBDTScoreBkg[kD0]->Fill(scoresToFill[0]);
             hBDTScorePrompt[kD0]->Fill(scoresToFill[1]);
             hBDTScoreNonPrompt[kD0]->Fill(scoresToFill[2]);
@@ -636,6 +691,9 @@ struct HfFilter { // Main struct for HF triggers
       } // end loop over 2-prong candidates
 
       std::vector<std::vector<int64_t>> indicesDau3Prong{};
+
+      // collect the preselected 3-prong candidates and the inputs of the ML models
+      candidates3Prong.clear();
       auto cand3ProngsThisColl = cand3Prongs.sliceBy(hf3ProngPerCollision, thisCollId);
       for (const auto& cand3Prong : cand3ProngsThisColl) { // start loop over 3 prongs
         std::array<int8_t, kNCharmParticles - 1> is3Prong = {
@@ -689,6 +747,29 @@ struct HfFilter { // Main struct for HF triggers
           }
         }
 
+        std::array<int, kNCharmParticles - 1> indexML{-1, -1, -1, -1};
+        if (applyML) {
+          // TODO: add more feature configurations
+          auto features = std::array{trackParFirst.getPt(), dcaFirst[0], dcaFirst[1], trackParSecond.getPt(), dcaSecond[0], dcaSecond[1], trackParThird.getPt(), dcaThird[0], dcaThird[1]};
+          for (auto iCharmPart{0}; iCharmPart < kNCharmParticles - 1; ++iCharmPart) {
+            if (is3Prong[iCharmPart] && onnxFiles[iCharmPart + 1] != "") {
+              indexML[iCharmPart] = addCandidateML(iCharmPart + 1, features);
+            }
+          }
+        }
+        candidates3Prong.push_back({trackFirst, trackSecond, trackThird, pVecFirst, pVecSecond, pVecThird, is3Prong, indexML});
+      }
+
+      // apply ML models, once per charm hadron on all the candidates
+      if (applyML) {
+        for (auto iCharmPart{1}; iCharmPart < kNCharmParticles; ++iCharmPart) {
+          if (onnxFiles[iCharmPart] != "") {
+            predictML(iCharmPart);
+          }
+        }
+      }
+
+      for (const auto& [trackFirst, trackSecond, trackThird, pVecFirst, pVecSecond, pVecThird, is3Prong, indexML] : candidates3Prong) { // start loop over selected 3 prongs
         std::array<int8_t, kNCharmParticles - 1> isCharmTagged = is3Prong;
         std::array<int8_t, kNCharmParticles - 1> isBeautyTagged = is3Prong;
 
@@ -696,35 +777,20 @@ struct HfFilter { // Main struct for HF triggers
         for (int i = 0; i < kNCharmParticles - 1; i++) {
           std::fill_n(scoresToFill[i], 3, -1);
         } // initialize BDT scores array outside ML loop
-        // apply ML models
         if (applyML) {
           isCharmTagged = std::array<int8_t, kNCharmParticles - 1>{0};
           isBeautyTagged = std::array<int8_t, kNCharmParticles - 1>{0};
 
-          // TODO: add more feature configurations
-          std::vector<float> inputFeatures{trackParFirst.getPt(), dcaFirst[0], dcaFirst[1], trackParSecond.getPt(), dcaSecond[0], dcaSecond[1], trackParThird.getPt(), dcaThird[0], dcaThird[1]};
-          std::vector<double> inputFeaturesD{trackParFirst.getPt(), dcaFirst[0], dcaFirst[1], trackParSecond.getPt(), dcaSecond[0], dcaSecond[1], trackParThird.getPt(), dcaThird[0], dcaThird[1]};
           for (auto iCharmPart{0}; iCharmPart < kNCharmParticles - 1; ++iCharmPart) {
-            if (!is3Prong[iCharmPart] || onnxFiles[iCharmPart + 1] == "") {
+            if (indexML[iCharmPart] < 0) {
               continue;
             }
 
-            int tagBDT = 0;
-            if (dataTypeML[iCharmPart + 1] == 1) {
-              auto scores = helper.predictONNX(inputFeatures, sessionML[iCharmPart + 1], inputShapesML[iCharmPart + 1]);
-              tagBDT = helper.isBDTSelected(scores, thresholdBDTScores[iCharmPart + 1]);
-              for (int iScore{0}; iScore < 3; ++iScore) {
-                scoresToFill[iCharmPart][iScore] = scores[iScore];
-              }
-            } else if (dataTypeML[iCharmPart + 1] == 11) {
-              auto scores = helper.predictONNX(inputFeaturesD, sessionML[iCharmPart + 1], inputShapesML[iCharmPart + 1]);
-              tagBDT = helper.isBDTSelected(scores, thresholdBDTScores[iCharmPart + 1]);
-              for (int iScore{0}; iScore < 3; ++iScore) {
-                scoresToFill[iCharmPart][iScore] = scores[iScore];
-              }
-            } else {
-              LOG(error) << "Error running model inference for " << charmParticleNames[iCharmPart + 1].data() << ": Unexpected input data type.";
+            const float* scores = scoresML[iCharmPart + 1].data() + 3 * indexML[iCharmPart];
+            for (int iScore{0}; iScore < 3; ++iScore) {
+              scoresToFill[iCharmPart][iScore] = scores[iScore];
             }
+            int tagBDT = helper.isBDTSelected(std::array{scores[0], scores[1], scores[2]}, thresholdBDTScores[iCharmPart + 1]);
 
             isCharmTagged[iCharmPart] = TESTBIT(tagBDT, RecoDecay::OriginType::Prompt);
             isBeautyTagged[iCharmPart] = TESTBIT(tagBDT, RecoDecay::OriginType::NonPrompt);
@@ -342,6 +342,8 @@ class HfFilterHelper
   Ort::Experimental::Session* initONNXSession(std::string& onnxFile, std::string partName, Ort::Env& env, Ort::SessionOptions& sessionOpt, std::vector<std::vector<int64_t>>& inputShapes, int& dataType, bool loadModelsFromCCDB, o2::ccdb::CcdbApi& ccdbApi, std::string mlModelPathCCDB, int64_t timestampCCDB);
   template <typename T>
   std::array<T, 3> predictONNX(std::vector<T>& inputFeatures, std::shared_ptr<Ort::Experimental::Session>& session, std::vector<std::vector<int64_t>>& inputShapes);
+  template <typename T, typename U>
+  void predictONNXBatch(std::vector<T>& inputFeatures, int nCandidates, std::shared_ptr<Ort::Experimental::Session>& session, std::vector<std::vector<int64_t>>& inputShapes, std::vector<U>& scores);
 
  private:
   // selections
@@ -1250,8 +1252,7 @@ inline Ort::Experimental::Session* HfFilterHelper::initONNXSession(std::string&
     session = new Ort::Experimental::Session{env, onnxFile, sessionOpt};
     inputShapes = session->GetInputShapes();
     if (inputShapes[0][0] < 0) {
-      LOGF(warning, Form("Model for %s with negative input shape likely because converted with hummingbird, setting it to 1.", partName.data()));
-      inputShapes[0][0] = 1;
+      LOGF(info, Form("Model for %s with negative input shape likely because converted with hummingbird, the candidates are evaluated in batches.", partName.data()));
     }
 
     Ort::TypeInfo typeInfo = session->GetInputTypeInfo(0);
@@ -1273,12 +1274,16 @@ template <typename T>
 inline std::array<T, 3> HfFilterHelper::predictONNX(std::vector<T>& inputFeatures, std::shared_ptr<Ort::Experimental::Session>& session, std::vector<std::vector<int64_t>>& inputShapes)
 {
   std::array<T, 3> scores{-1., 2., 2.};
+  std::vector<int64_t> inputShape = inputShapes[0];
+  if (inputShape[0] < 0) { // one candidate for models with variable batch size
+    inputShape[0] = 1;
+  }
   std::vector<Ort::Value> inputTensor{};
-  inputTensor.push_back(Ort::Experimental::Value::CreateTensor<T>(inputFeatures.data(), inputFeatures.size(), inputShapes[0]));
+  inputTensor.push_back(Ort::Experimental::Value::CreateTensor<T>(inputFeatures.data(), inputFeatures.size(), inputShape));
 
   // double-check the dimensions of the input tensor
   if (inputTensor[0].GetTensorTypeAndShapeInfo().GetShape()[0] > 0) { // vectorial models can have negative shape if the shape is unknown
-    assert(inputTensor[0].IsTensor() && inputTensor[0].GetTensorTypeAndShapeInfo().GetShape() == inputShapes[0]);
+    assert(inputTensor[0].IsTensor() && inputTensor[0].GetTensorTypeAndShapeInfo().GetShape() == inputShape);
   }
   try {
     auto outputTensor = session->Run(session->GetInputNames(), inputTensor, session->GetOutputNames());
@@ -1295,6 +1300,54 @@ inline std::array<T, 3> HfFilterHelper::predictONNX(std::vector<T>& inputFeature
   return scores;
 }
 
+/// Inference of the ONNX model on a batch of candidates
+/// \param inputFeatures is the vector with the input features of all the candidates, one candidate after the other
+/// \param nCandidates is the number of candidates
+/// \param session is the ONNX Ort::Experimental::Session
+/// \param inputShapes is the input shape, the first dimension is the batch size (negative if variable)
+/// \param scores is the vector filled with the three output scores of each candidate, {-1, 2, 2} if the inference failed
+template <typename T, typename U>
+inline void HfFilterHelper::predictONNXBatch(std::vector<T>& inputFeatures, int nCandidates, std::shared_ptr<Ort::Experimental::Session>& session, std::vector<std::vector<int64_t>>& inputShapes, std::vector<U>& scores)
+{
+  scores.resize(3 * nCandidates);
+  if (nCandidates == 0) {
+    return;
+  }
+  const int64_t nFeatures = static_cast<int64_t>(inputFeatures.size()) / nCandidates;
+
+  // models with variable batch size run once on all the candidates, the others on chunks of their batch size
+  std::vector<int64_t> inputShape = inputShapes[0];
+  const int64_t batchSize = inputShape[0] > 0 ? inputShape[0] : nCandidates;
+  inputShape[0] = batchSize;
+  std::vector<T> paddedFeatures{};
+  for (int64_t first{0}; first < nCandidates; first += batchSize) {
+    const int64_t nInBatch = std::min(batchSize, nCandidates - first);
+    T* features = inputFeatures.data() + first * nFeatures;
+    if (nInBatch < batchSize) { // last chunk of a model with fixed batch size, padded with zeros
+      paddedFeatures.assign(batchSize * nFeatures, 0);
+      std::copy(features, features + nInBatch * nFeatures, paddedFeatures.begin());
+      features = paddedFeatures.data();
+    }
+    for (int64_t iCand{first}; iCand < first + nInBatch; ++iCand) {
+      scores[3 * iCand] = -1.;
+      scores[3 * iCand + 1] = 2.;
+      scores[3 * iCand + 2] = 2.;
+    }
+    std::vector<Ort::Value> inputTensor{};
+    inputTensor.push_back(Ort::Experimental::Value::CreateTensor<T>(features, batchSize * nFeatures, inputShape));
+    try {
+      auto outputTensor = session->Run(session->GetInputNames(), inputTensor, session->GetOutputNames());
+      assert(outputTensor.size() == session->GetOutputNames().size() && outputTensor[1].IsTensor());
+      auto typeInfo = outputTensor[1].GetTensorTypeAndShapeInfo();
+      assert(typeInfo.GetElementCount() == static_cast<size_t>(3 * batchSize)); // we need multiclass
+      const T* outputScores = outputTensor[1].GetTensorMutableData<T>();
+      std::copy(outputScores, outputScores + 3 * nInBatch, scores.begin() + 3 * first);
+    } catch (const Ort::Exception& exception) {
+      LOG(error) << "Error running model inference: " << exception.what();
+    }
+  }
+}
+
 /// PID postcalibrations
 
 /// load the TPC spline from the CCDB
@@ -10,9 +10,12 @@
 // or submit itself to any jurisdiction.
 // O2 includes
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
 #include <iostream>
 #include <cstdio>
-#include <random>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -28,6 +31,7 @@
 #include "Framework/AnalysisDataModel.h"
 #include "Framework/ASoAHelpers.h"
 #include "Framework/HistogramRegistry.h"
+#include "Common/Core/HashDownsampler.h"
 #include "Common/DataModel/EventSelection.h"
 #include "Common/DataModel/TrackSelectionTables.h"
 #include "CommonConstants/LHCConstants.h"
@@ -69,6 +73,19 @@ bool readJsonFile(std::string& config, Document& d)
   return true;
 }
 
+/// Reads nBits (<= 64) bits of an Arrow bitmap starting at bit offset, the first bit in the least significant position
+uint64_t readBitmapWord(const uint8_t* bitmap, int64_t offset, int nBits)
+{
+  const int shift = offset % 8;
+  uint8_t bytes[16]{0};
+  std::memcpy(bytes, bitmap + offset / 8, (shift + nBits + 7) / 8);
+  uint64_t low, high;
+  std::memcpy(&low, bytes, sizeof(low));
+  std::memcpy(&high, bytes + 8, sizeof(high));
+  uint64_t word = shift ? (low >> shift) | (high << (64 - shift)) : low;
+  return nBits < 64 ? word & ((uint64_t(1) << nBits) - 1) : word;
+}
+
 std::unordered_map<std::string, std::unordered_map<std::string, float>> mDownscaling;
 static const std::vector<std::string> downscalingName{"Downscaling"};
 static const float defaultDownscaling[128][1]{
@@ -231,6 +248,14 @@ struct centralEventFilterTask {
   int mRunNumber{-1};
   o2::InteractionRecord mEndOfITSramp{0, 0};
 
+  // counts of the current dataframe, per trigger bit, added to the histograms once per dataframe
+  std::array<uint64_t, 64> mScalerCounts{};
+  std::array<uint64_t, 64> mFilteredCounts{};
+  std::array<std::array<uint64_t, 64>, 64> mCovarianceCounts{};
+
+  // downscaling decision from the hash of (run number, global BC, collision index, trigger bit)
+  HashDownsampler mDownsampler;
+
   void init(o2::framework::InitContext& initc)
   {
     ccdb->setURL("http://alice-ccdb.cern.ch");
@@ -346,7 +371,11 @@ struct centralEventFilterTask {
 
     int64_t nEvents{-1};
     std::vector<uint64_t> outTrigger, outDecision;
-    int64_t nSelected{0};
+    mScalerCounts.fill(0u);
+    mFilteredCounts.fill(0u);
+    for (auto& row : mCovarianceCounts) {
+      row.fill(0u);
+    }
     for (auto& tableName : mDownscaling) {
       if (!pc.inputs().isValid(tableName.first)) {
         LOG(fatal) << tableName.first << " table is not valid.";
@@ -367,52 +396,82 @@ struct centralEventFilterTask {
       auto schema{tablePtr->schema()};
       for (auto& colName : tableName.second) {
         int bin{mScalers->GetXaxis()->FindBin(colName.first.data())};
-        double binCenter{mScalers->GetXaxis()->GetBinCenter(bin)};
-        uint64_t triggerBit{BIT(bin - 2)};
+        int iBit{bin - 2};
+        uint64_t triggerBit{BIT(iBit)};
         auto column{tablePtr->GetColumnByName(colName.first)};
         double downscaling{colName.second};
         if (column) {
-          int entry = 0;
+          int64_t entry = 0;
           for (int64_t iC{0}; iC < column->num_chunks(); ++iC) {
-            auto chunk{column->chunk(iC)};
-            auto boolArray = std::static_pointer_cast<arrow::BooleanArray>(chunk);
-            for (int64_t iS{startCollision}; iS < chunk->length(); ++iS) {
-              if (boolArray->Value(iS)) {
-                mScalers->Fill(binCenter);
-                outTrigger[entry] |= triggerBit;
-                if (mUniformGenerator(mGeneratorEngine) < downscaling) {
-                  mFiltered->Fill(binCenter);
-                  outDecision[entry] |= triggerBit;
-                  nSelected++;
+            auto boolArray = std::static_pointer_cast<arrow::BooleanArray>(column->chunk(iC));
+            const uint8_t* values{boolArray->values()->data()};
+            const uint8_t* validity{boolArray->null_bitmap_data()};
+            // 64 events at a time, from the value and validity bitmaps
+            for (int64_t iW{0}; iW < boolArray->length(); iW += 64) {
+              int nBits = std::min<int64_t>(64, boolArray->length() - iW);
+              uint64_t fired{readBitmapWord(values, boolArray->offset() + iW, nBits)};
+              if (validity) {
+                fired &= readBitmapWord(validity, boolArray->offset() + iW, nBits);
+              }
+              int64_t nSkipped{startCollision - entry - iW};
+              if (nSkipped > 0) {
+                fired = nSkipped < 64 ? fired & (~uint64_t(0) << nSkipped) : 0u;
+              }
+              mScalerCounts[iBit] += std::popcount(fired);
+              for (; fired; fired &= fired - 1) {
+                int64_t iEvent{entry + iW + std::countr_zero(fired)};
+                outTrigger[iEvent] |= triggerBit;
+                if (downscaling > 0. && mDownsampler.isKept(downscaling, mRunNumber, GloBCArray->Value(CollBCIdArray->Value(iEvent)), iEvent, iBit)) {
+                  outDecision[iEvent] |= triggerBit;
+                  mFilteredCounts[iBit]++;
                 }
               }
-              entry++;
             }
+            entry += boolArray->length();
           }
         }
       }
     }
-    mScalers->SetBinContent(1, mScalers->GetBinContent(1) + nEvents - startCollision);
-    mFiltered->SetBinContent(1, mFiltered->GetBinContent(1) + nEvents - startCollision);
 
+    uint64_t nTriggered{0u}, nFiltered{0u};
     for (uint64_t iE{0}; iE < outTrigger.size(); ++iE) {
-      for (int iB{0}; iB < 64; ++iB) {
-        if (!(outTrigger[iE] & BIT(iB))) {
-          continue;
-        }
-        for (int iC{iB}; iC < 64; ++iC) {
-          if (outTrigger[iE] & BIT(iC)) {
-            mCovariance->Fill(iB, iC);
-          }
+      const uint64_t trigger{outTrigger[iE]};
+      for (uint64_t bitsB{trigger}; bitsB; bitsB &= bitsB - 1) {
+        const int iB{std::countr_zero(bitsB)};
+        for (uint64_t bitsC{bitsB}; bitsC; bitsC &= bitsC - 1) {
+          mCovarianceCounts[iB][std::countr_zero(bitsC)]++;
         }
       }
-      if (outTrigger[iE]) {
-        mScalers->Fill(mScalers->GetNbinsX() - 1);
+      nTriggered += trigger != 0;
+      nFiltered += outDecision[iE] != 0;
+    }
+
+    // histograms updated once per dataframe
+    const int64_t nProcessed{std::max<int64_t>(nEvents - startCollision, 0)};
+    mScalers->AddBinContent(1, nProcessed);
+    mFiltered->AddBinContent(1, nProcessed);
+    uint64_t nScalerEntries{0u}, nFilteredEntries{0u}, nCovarianceEntries{0u};
+    for (int iB{0}; iB < 64; ++iB) {
+      if (mScalerCounts[iB]) {
+        mScalers->AddBinContent(iB + 2, mScalerCounts[iB]);
+        nScalerEntries += mScalerCounts[iB];
       }
-      if (outDecision[iE]) {
-        mFiltered->Fill(mFiltered->GetNbinsX() - 1);
+      if (mFilteredCounts[iB]) {
+        mFiltered->AddBinContent(iB + 2, mFilteredCounts[iB]);
+        nFilteredEntries += mFilteredCounts[iB];
+      }
+      for (int iC{iB}; iC < 64; ++iC) {
+        if (mCovarianceCounts[iB][iC]) {
+          mCovariance->AddBinContent(mCovariance->GetBin(iB + 1, iC + 1), mCovarianceCounts[iB][iC]);
+          nCovarianceEntries += mCovarianceCounts[iB][iC];
+        }
       }
     }
+    mScalers->AddBinContent(mScalers->GetNbinsX(), nTriggered);
+    mFiltered->AddBinContent(mFiltered->GetNbinsX(), nFiltered);
+    mScalers->SetEntries(mScalers->GetEntries() + nScalerEntries + nTriggered);
+    mFiltered->SetEntries(mFiltered->GetEntries() + nFilteredEntries + nFiltered);
+    mCovariance->SetEntries(mCovariance->GetEntries() + nCovarianceEntries);
 
     /// Filling the output table
     if (outDecision.size() != static_cast<uint64_t>(collTabPtr->num_rows())) {
@@ -434,9 +493,6 @@ struct centralEventFilterTask {
   void process(CCs const& collisions, BCs const& bcs)
   {
   }
-
-  std::mt19937_64 mGeneratorEngine;
-  std::uniform_real_distribution<double> mUniformGenerator = std::uniform_real_distribution<double>(0., 1.);
 };
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfg)
@@ -0,0 +1,222 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef O2_ANALYSIS_PAIRACCUMULATOR_H
+#define O2_ANALYSIS_PAIRACCUMULATOR_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <TArray.h>
+#include <TAxis.h>
+
+#include "Framework/Logger.h"
+#include "Framework/StepTHn.h"
+
+// Helpers for a staged pair loop which avoids the per-pair StepTHn::Fill
+//
+// StagedTracks keeps the per-event track quantities needed in the pair loop in SoA form
+// together with precomputed bin indices. DensePairAccumulator collects the pair weights
+// of one event (fixed multiplicity and vertex bin) in a dense buffer and adds them to the
+// StepTHn containers at flush time. In the pair loop, the first stages of the pair cuts are
+// evaluated for one trigger against all staged associated tracks at once (see
+// PairCuts::conversionCutCandidates and PairCuts::twoTrackCutCandidates), and the full cuts
+// only for the pairs which they flag.
+
+class FastAxis
+{
+ public:
+  void init(const TAxis* axis)
+  {
+    mNbins = axis->GetNbins();
+    mMin = axis->GetXmin();
+    mMax = axis->GetXmax();
+    mEdges.clear();
+    if (axis->GetXbins()->GetSize() > 0) {
+      mEdges.assign(axis->GetXbins()->GetArray(), axis->GetXbins()->GetArray() + axis->GetXbins()->GetSize());
+    }
+  }
+
+  int getNbins() const { return mNbins; }
+
+  // returns the bin starting from 0, -1 for under- and overflow (same binning decision as TAxis::FindBin)
+  int findBin(double x) const
+  {
+    if (!(x >= mMin) || !(x < mMax)) {
+      return -1;
+    }
+    if (mEdges.empty()) {
+      return static_cast<int>(mNbins * (x - mMin) / (mMax - mMin));
+    }
+    return static_cast<int>(std::upper_bound(mEdges.begin(), mEdges.end(), x) - mEdges.begin()) - 1;
+  }
+
+ private:
+  int mNbins = 0;
+  double mMin = 0;
+  double mMax = 0;
+  std::vector<double> mEdges;
+};
+
+// light-weight view on a staged track which provides the interface expected by PairCuts
+struct StagedTrackView {
+  float mEta;
+  float mPhi;
+  float mPt;
+  int mSign;
+
+  float eta() const { return mEta; }
+  float phi() const { return mPhi; }
+  float pt() const { return mPt; }
+  int sign() const { return mSign; }
+};
+
+struct StagedTracks {
+  std::vector<float> eta;
+  std::vector<float> phi;
+  std::vector<float> pt;
+  std::vector<int8_t> sign;
+  std::vector<int64_t> globalIndex;
+  std::vector<float> weight; // efficiency correction (1 if not applied)
+  std::vector<int> ptBin;    // bin in the pt axis of the role (trigger or associated), -1 if outside
+
+  void clear()
+  {
+    eta.clear();
+    phi.clear();
+    pt.clear();
+    sign.clear();
+    globalIndex.clear();
+    weight.clear();
+    ptBin.clear();
+  }
+
+  void reserve(size_t n)
+  {
+    eta.reserve(n);
+    phi.reserve(n);
+    pt.reserve(n);
+    sign.reserve(n);
+    globalIndex.reserve(n);
+    weight.reserve(n);
+    ptBin.reserve(n);
+  }
+
+  void push_back(float eta_, float phi_, float pt_, int sign_, int64_t globalIndex_, float weight_, int ptBin_)
+  {
+    eta.push_back(eta_);
+    phi.push_back(phi_);
+    pt.push_back(pt_);
+    sign.push_back(sign_);
+    globalIndex.push_back(globalIndex_);
+    weight.push_back(weight_);
+    ptBin.push_back(ptBin_);
+  }
+
+  size_t size() const { return eta.size(); }
+
+  StagedTrackView view(size_t i) const { return {eta[i], phi[i], pt[i], sign[i]}; }
+};
+
+class DensePairAccumulator
+{
+ public:
+  // pair histogram axes: 0 = delta eta, 1 = pT assoc, 2 = pT trigger, 3 = multiplicity, 4 = delta phi, 5 = vertex
+  static constexpr int kNAxes = 6;
+
+  bool init(StepTHn* pairHist)
+  {
+    if (pairHist->getNVar() != kNAxes) {
+      LOGF(info, "DensePairAccumulator: pair histogram has %d axes instead of %d, staged filling not possible", pairHist->getNVar(), kNAxes);
+      return false;
+    }
+    for (int i = 0; i < kNAxes; i++) {
+      mAxes[i].init(pairHist->GetAxis(i));
+    }
+    mSumw.assign(static_cast<size_t>(mAxes[0].getNbins()) * mAxes[1].getNbins() * mAxes[2].getNbins() * mAxes[4].getNbins(), 0);
+    mSumw2.assign(mSumw.size(), 0);
+    mTouched.reserve(mSumw.size());
+    LOGF(info, "DensePairAccumulator: using buffer with %zu bins per event", mSumw.size());
+    return true;
+  }
+
+  const FastAxis& axis(int i) const { return mAxes[i]; }
+
+  // the staged values can only be added to the StepTHn containers when they have been created by a previous fill
+  // and when a non-unit weight does not require the creation of the sumw2 container
+  static bool canFlush(StepTHn* pairHist, int step, bool unitWeights)
+  {
+    return pairHist->getValues(step) != nullptr && (unitWeights || pairHist->getSumw2(step) != nullptr);
+  }
+
+  // sets the event bins, returns false if the event is outside of the histogram range
+  bool beginEvent(double multiplicity, double posZ)
+  {
+    mMultBin = mAxes[3].findBin(multiplicity);
+    mVertexBin = mAxes[5].findBin(posZ);
+    return mMultBin >= 0 && mVertexBin >= 0;
+  }
+
+  void add(int etaBin, int ptAssocBin, int ptTriggerBin, int phiBin, double weight)
+  {
+    size_t bin = ((static_cast<size_t>(etaBin) * mAxes[1].getNbins() + ptAssocBin) * mAxes[2].getNbins() + ptTriggerBin) * mAxes[4].getNbins() + phiBin;
+    if (mSumw2[bin] == 0) {
+      mTouched.push_back(bin);
+    }
+    mSumw[bin] += weight;
+    mSumw2[bin] += weight * weight;
+  }
+
+  void flush(StepTHn* pairHist, int step)
+  {
+    TArray* values = pairHist->getValues(step);
+    TArray* sumw2 = pairHist->getSumw2(step);
+
+    const size_t nPhi = mAxes[4].getNbins();
+    const size_t nPtTrigger = mAxes[2].getNbins();
+    const size_t nPtAssoc = mAxes[1].getNbins();
+    const Long64_t nMult = mAxes[3].getNbins();
+    const Long64_t nVertex = mAxes[5].getNbins();
+
+    for (auto bin : mTouched) {
+      Long64_t phiBin = bin % nPhi;
+      Long64_t rest = bin / nPhi;
+      Long64_t ptTriggerBin = rest % nPtTrigger;
+      rest /= nPtTrigger;
+      Long64_t ptAssocBin = rest % nPtAssoc;
+      Long64_t etaBin = rest / nPtAssoc;
+
+      // same global bin ordering as in StepTHn::Fill
+      Int_t globalBin = static_cast<Int_t>((((((etaBin * nPtAssoc + ptAssocBin) * nPtTrigger + ptTriggerBin) * nMult + mMultBin) * mAxes[4].getNbins() + phiBin) * nVertex + mVertexBin));
+
+      values->SetAt(values->GetAt(globalBin) + mSumw[bin], globalBin);
+      if (sumw2) {
+        sumw2->SetAt(sumw2->GetAt(globalBin) + mSumw2[bin], globalBin);
+      }
+
+      mSumw[bin] = 0;
+      mSumw2[bin] = 0;
+    }
+    mTouched.clear();
+  }
+
+ private:
+  FastAxis mAxes[kNAxes];
+  int mMultBin = -1;
+  int mVertexBin = -1;
+
+  std::vector<double> mSumw;
+  std::vector<double> mSumw2;
+  std::vector<size_t> mTouched; // bins filled since the last flush
+};
+
+#endif
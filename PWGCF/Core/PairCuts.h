@@ -13,6 +13,8 @@
 #define O2_ANALYSIS_PAIRCUTS_H
 
 #include <cmath>
+#include <cstdint>
+#include <vector>
 
 #include "Framework/Logger.h"
 #include "Framework/HistogramRegistry.h"
@@ -65,6 +67,12 @@ class PairCuts
   template <typename T>
   bool twoTrackCut(T const& track1, T const& track2, int magField);
 
+  // Batched first stages of conversionCuts and twoTrackCut for one track against an array of tracks.
+  // A pair which is not flagged is certainly not removed by the corresponding cut, so that the full cut
+  // only needs to be evaluated for the flagged pairs. The loops have no branches and are vectorised.
+  void conversionCutCandidates(int sign1, std::vector<int8_t> const& sign2, std::vector<uint8_t>& candidates) const;
+  void twoTrackCutCandidates(float eta1, std::vector<float> const& eta2, std::vector<uint8_t>& candidates) const;
+
  protected:
   float mCuts[ParticlesLastEntry] = {-1};
   float mTwoTrackDistance = -1; // distance below which the pair is flagged as to be removed
@@ -110,6 +118,27 @@ bool PairCuts::conversionCuts(T const& track1, T const& track2)
   return false;
 }
 
+inline void PairCuts::conversionCutCandidates(int sign1, std::vector<int8_t> const& sign2, std::vector<uint8_t>& candidates) const
+{
+  // like-sign pairs are skipped by conversionCuts
+  const size_t n = sign2.size();
+  candidates.resize(n);
+  for (size_t j = 0; j < n; j++) {
+    candidates[j] = sign1 * sign2[j] <= 0;
+  }
+}
+
+inline void PairCuts::twoTrackCutCandidates(float eta1, std::vector<float> const& eta2, std::vector<uint8_t>& candidates) const
+{
+  // same condition as the optimization in twoTrackCut
+  const double limit = mTwoTrackDistance * 2.5 * 3;
+  const size_t n = eta2.size();
+  candidates.resize(n);
+  for (size_t j = 0; j < n; j++) {
+    candidates[j] = std::fabs(eta1 - eta2[j]) < limit;
+  }
+}
+
 template <typename T>
 bool PairCuts::twoTrackCut(T const& track1, T const& track2, int magField)
 {
@@ -16,7 +16,9 @@
 #define JFFLUC_ANALYSIS_H
 
 #include "JHistManager.h"
-#include <TComplex.h>
+#include <TMath.h>
+#include <cmath>
+#include <complex>
 
 class JFFlucAnalysis
 {
@@ -27,11 +29,14 @@ class JFFlucAnalysis
   JFFlucAnalysis& operator=(const JFFlucAnalysis& ap); // not implemented
 
   ~JFFlucAnalysis();
+
+  typedef std::complex<double> Complex;
+
   void UserCreateOutputObjects();
   void Init();
-  TComplex Q(int n, int p);
-  TComplex Two(int n1, int n2);
-  TComplex Four(int n1, int n2, int n3, int n4);
+  Complex Q(int n, int p);
+  Complex Two(int n1, int n2);
+  Complex Four(int n1, int n2, int n3, int n4);
   void UserExec(Option_t* option);
   void Terminate(Option_t*);
 
@@ -73,7 +78,8 @@ class JFFlucAnalysis
   }
   enum {
     kFlucPhiCorrection = 0x2,
-    kFlucEbEWeighting = 0x4
+    kFlucEbEWeighting = 0x4,
+    kFlucMoments = 0x8 // accumulate weighted moments into h_moments instead of filling the per-observable histograms
   };
   inline void AddFlags(UInt_t _flags)
   {
@@ -119,9 +125,9 @@ class JFFlucAnalysis
     // calculate Q-vector for QC method ( no subgroup )
     for (UInt_t ih = 0; ih < kNH; ih++) {
       for (UInt_t ik = 0; ik < nKL; ++ik) {
-        QvectorQC[ih][ik] = TComplex(0, 0);
+        QvectorQC[ih][ik] = Complex(0, 0);
         for (UInt_t isub = 0; isub < 2; isub++)
-          QvectorQCgap[isub][ih][ik] = TComplex(0, 0);
+          QvectorQCgap[isub][ih][ik] = Complex(0, 0);
       }
     } // for max harmonics
     for (auto& track : inputInst) {
@@ -133,18 +139,22 @@ class JFFlucAnalysis
       Double_t phiNUACorr = 1.0; // itrack->GetWeight(); //XXXXXX
 
       UInt_t isub = (UInt_t)(track.eta() > 0.0);
+      bool gap = TMath::Abs(track.eta()) > fEta_min;
+
+      // powers of the weight and exp(i*h*phi) by recursion instead of cos/sin per harmonic
+      Double_t tf[nKL];
+      tf[0] = 1.0;
+      for (UInt_t ik = 1; ik < nKL; ik++)
+        tf[ik] = tf[ik - 1] / (phiNUACorr * effCorr);
+      const Complex u(TMath::Cos(track.phi()), TMath::Sin(track.phi()));
+      Complex un(1.0, 0.0);
       for (UInt_t ih = 0; ih < kNH; ih++) {
-        Double_t tf = 1.0;
-        TComplex q[nKL];
         for (UInt_t ik = 0; ik < nKL; ik++) {
-          q[ik] = TComplex(tf * TMath::Cos(ih * track.phi()), tf * TMath::Sin(ih * track.phi()));
-          QvectorQC[ih][ik] += q[ik];
-
-          if (TMath::Abs(track.eta()) > fEta_min)
-            QvectorQCgap[isub][ih][ik] += q[ik];
-
-          tf *= 1.0 / (phiNUACorr * effCorr);
+          QvectorQC[ih][ik] += tf[ik] * un;
+          if (gap)
+            QvectorQCgap[isub][ih][ik] += tf[ik] * un;
         }
+        un *= u;
       }
     }
   };
@@ -173,6 +183,17 @@ class JFFlucAnalysis
          kK4,
          nKL };  // order
 #define kcNH kH6 // max second dimension + 1
+  enum { kNCorrelators = 28 };
+  // observable offsets in a row of h_moments (kFlucMoments), each observable takes 3 bins: sum(w), sum(w*x), sum(w*x^2)
+  enum { kMomVn = 0,                                         // [ih][ik]
+         kMomVna = kMomVn + kNH * nKL,                       // [ih][ik]
+         kMomVnVn = kMomVna + kNH * nKL,                     // [ih][ik][ihh][ikk]
+         kMomCorrelator = kMomVnVn + kNH * nKL * kcNH * nKL, // [ic]
+         kMomSC4 = kMomCorrelator + kNCorrelators,           // [ih][ihh]
+         kMomSC2 = kMomSC4 + kNH * kcNH,                     // [ih]
+         kMomSC2Gap = kMomSC2 + kNH,                         // [ih]
+         kNMomObs = kMomSC2Gap + kNH };
+
  private:
   const Double_t* fVertex; //!
   Float_t fCent;
@@ -189,8 +210,18 @@ class JFFlucAnalysis
   Double_t fEta_min;
   Double_t fEta_max;
 
-  TComplex QvectorQC[kNH][nKL];
-  TComplex QvectorQCgap[2][kNH][nKL]; // ksub
+  inline void FillMoment(UInt_t iobs, Double_t x, Double_t w)
+  {
+    if (!std::isfinite(x) || !std::isfinite(w))
+      return;
+    Double_t* m = fMomentBuffer + (fCBin + 1) * (3 * kNMomObs + 2) + 1 + 3 * iobs; // TH2D row including under/overflow
+    m[0] += w;
+    m[1] += w * x;
+    m[2] += w * x * x;
+  }
+
+  Complex QvectorQC[kNH][nKL];       //!
+  Complex QvectorQCgap[2][kNH][nKL]; //! // ksub
 
   JHistManager* fHMG; //!
 
@@ -223,6 +254,9 @@ class JFFlucAnalysis
   JTH1D fh_vna;     //! // single vn^k with autocorrelation removed (up to a limited order)
   JTH1D fh_vn_vn;   //! // combination for <vn*vn> [ih][ik][ihh][ikk][iCent]
 
+  JTH2D fh_moments;        //! // moments of all observables [iCent] (kFlucMoments)
+  Double_t* fMomentBuffer; //! // bin array of fh_moments
+
   JTH1D fh_correlator;            //! // some more complex correlators
   JTH2D fh_TrkQA_TPCvsGlob;       //! // QA histos
   JTH2D fh_TrkQA_TPCvsCent;       //! // QA histos
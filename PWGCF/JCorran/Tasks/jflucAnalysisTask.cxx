@@ -43,6 +43,7 @@ struct jflucAnalysisTask {
 
   O2_DEFINE_CONFIGURABLE(etamin, double, 0.4, "Minimal eta for tracks");
   O2_DEFINE_CONFIGURABLE(etamax, double, 0.8, "Maximal eta for tracks");
+  O2_DEFINE_CONFIGURABLE(momentsOnly, bool, false, "Store weighted moments of the correlators in one histogram per centrality bin instead of one histogram per observable");
 
   OutputObj<TDirectory> output{"jflucO2"};
 
@@ -52,6 +53,8 @@ struct jflucAnalysisTask {
     pcf = new JFFlucAnalysis("jflucAnalysis");
     pcf->SetNumBins(sizeof(jflucCentBins) / sizeof(jflucCentBins[0]));
     pcf->AddFlags(JFFlucAnalysis::kFlucEbEWeighting);
+    if (momentsOnly)
+      pcf->AddFlags(JFFlucAnalysis::kFlucMoments);
 
     output->cd();
     pcf->UserCreateOutputObjects();
@@ -24,10 +24,12 @@
 #include "PWGCF/DataModel/CorrelationsDerived.h"
 #include "PWGCF/Core/CorrelationContainer.h"
 #include "PWGCF/Core/PairCuts.h"
+#include "PWGCF/Core/PairAccumulator.h"
 #include "DataFormatsParameters/GRPObject.h"
 #include "DataFormatsParameters/GRPMagField.h"
 
 #include <TH1F.h>
+#include <algorithm>
 #include <cmath>
 #include <TDirectory.h>
 #include <THn.h>
@@ -76,6 +78,8 @@ struct CorrelationTask {
 
   O2_DEFINE_CONFIGURABLE(cfgNoMixedEvents, int, 5, "Number of mixed events per event")
 
+  O2_DEFINE_CONFIGURABLE(cfgStagedPairFill, int, 1, "Fill pairs from staged track arrays into a dense per-event buffer instead of StepTHn::Fill per pair (0 = OFF, 1 = ON)")
+
   O2_DEFINE_CONFIGURABLE(cfgVerbosity, int, 1, "Verbosity level (0 = major, 1 = per collision)")
 
   ConfigurableAxis axisVertex{"axisVertex", {7, -7, 7}, "vertex axis for histograms"};
@@ -111,11 +115,19 @@ struct CorrelationTask {
     THn* mEfficiencyTrigger = nullptr;
     THn* mEfficiencyAssociated = nullptr;
     bool efficiencyLoaded = false;
+    bool mStagedPairFill = false;
   } cfg;
 
   HistogramRegistry registry{"registry"};
   PairCuts mPairCuts;
 
+  // buffers for the staged pair loop, reused between events
+  StagedTracks mStagedTriggers;
+  StagedTracks mStagedAssociated;
+  DensePairAccumulator mPairAccumulator;
+  std::vector<uint8_t> mConversionCutCandidates; // per associated track, pairs which need the conversion cuts
+  std::vector<uint8_t> mTwoTrackCutCandidates;   // per associated track, pairs which need the two-track cut
+
   Service<o2::ccdb::BasicCCDBManager> ccdb;
 
   using aodCollisions = soa::Filtered<soa::Join<aod::Collisions, aod::EvSels, aod::CentRun2V0Ms>>;
@@ -165,6 +177,11 @@ struct CorrelationTask {
     same->setTrackEtaCut(cfgCutEta);
     mixed->setTrackEtaCut(cfgCutEta);
 
+    // same and mixed event containers have identical binning, therefore one accumulator serves both
+    if (cfgStagedPairFill) {
+      cfg.mStagedPairFill = mPairAccumulator.init(same->getPairHist());
+    }
+
     // o2-ccdb-upload -p Users/jgrosseo/correlations/LHC15o -f /tmp/correction_2011_global.root -k correction
 
     ccdb->setURL("http://alice-ccdb.cern.ch");
@@ -229,9 +246,148 @@ struct CorrelationTask {
     return true;
   }
 
+  template <CorrelationContainer::CFStep step, typename TTracks>
+  void stageTracks(StagedTracks& staged, TTracks& tracks, THn* efficiency, const FastAxis& ptAxis, float multiplicity, float posZ)
+  {
+    staged.clear();
+    staged.reserve(tracks.size());
+    for (auto& track : tracks) {
+      if constexpr (step <= CorrelationContainer::kCFStepTracked) {
+        if (!checkObject<step>(track)) {
+          continue;
+        }
+      }
+
+      float weight = 1.0f;
+      if constexpr (step == CorrelationContainer::kCFStepCorrected) {
+        if (efficiency) {
+          weight = getEfficiencyCorrection(efficiency, track.eta(), track.pt(), multiplicity, posZ);
+        }
+      }
+
+      staged.push_back(track.eta(), track.phi(), track.pt(), track.sign(), track.globalIndex(), weight, ptAxis.findBin(track.pt()));
+    }
+  }
+
+  // Same result as the loop in fillCorrelations, but the tracks are staged once per call with their pT bins and the pairs are
+  // accumulated in a dense buffer which is added to the pair histogram at the end. Returns false if nothing has been filled,
+  // which is the case when the StepTHn containers for this step do not exist yet (they are created by the first regular fill).
+  template <CorrelationContainer::CFStep step, typename TTarget, typename TTracks>
+  bool fillCorrelationsStaged(TTarget target, TTracks& tracks1, TTracks& tracks2, float multiplicity, float posZ, int magField, float eventWeight)
+  {
+    stageTracks<step>(mStagedTriggers, tracks1, cfg.mEfficiencyTrigger, mPairAccumulator.axis(2), multiplicity, posZ);
+    stageTracks<step>(mStagedAssociated, tracks2, cfg.mEfficiencyAssociated, mPairAccumulator.axis(1), multiplicity, posZ);
+
+    auto isUnit = [](float weight) { return weight == 1.0f; };
+    bool unitWeights = eventWeight == 1.0f && std::all_of(mStagedTriggers.weight.begin(), mStagedTriggers.weight.end(), isUnit) && std::all_of(mStagedAssociated.weight.begin(), mStagedAssociated.weight.end(), isUnit);
+    if (!DensePairAccumulator::canFlush(target->getPairHist(), step, unitWeights)) {
+      return false;
+    }
+
+    const bool eventInRange = mPairAccumulator.beginEvent(multiplicity, posZ);
+    const FastAxis& etaAxis = mPairAccumulator.axis(0);
+    const FastAxis& phiAxis = mPairAccumulator.axis(4);
+
+    const int ptOrder = cfgPtOrder;
+    const int triggerCharge = cfgTriggerCharge;
+    const int associatedCharge = cfgAssociatedCharge;
+    const int pairCharge = cfgPairCharge;
+    const float twoTrackCut = cfgTwoTrackCut;
+
+    const auto& triggers = mStagedTriggers;
+    const auto& associated = mStagedAssociated;
+
+    for (size_t i = 0; i < triggers.size(); i++) {
+      if (triggerCharge != 0 && triggerCharge * triggers.sign[i] < 0) {
+        continue;
+      }
+
+      const float triggerWeight = eventWeight * triggers.weight[i];
+      target->getTriggerHist()->Fill(step, triggers.pt[i], multiplicity, posZ, triggerWeight);
+
+      const int ptTriggerBin = triggers.ptBin[i];
+      if (!eventInRange || ptTriggerBin < 0) {
+        continue;
+      }
+
+      const float eta1 = triggers.eta[i];
+      const float phi1 = triggers.phi[i];
+      const float pt1 = triggers.pt[i];
+      const int sign1 = triggers.sign[i];
+      const int64_t index1 = triggers.globalIndex[i];
+
+      // first stages of the pair cuts for all associated tracks at once, the full cuts are evaluated for the flagged pairs only
+      bool applyConversionCuts = false;
+      bool applyTwoTrackCut = false;
+      if constexpr (step >= CorrelationContainer::kCFStepReconstructed) {
+        applyConversionCuts = cfg.mPairCuts;
+        applyTwoTrackCut = twoTrackCut > 0;
+        if (applyConversionCuts) {
+          mPairCuts.conversionCutCandidates(sign1, associated.sign, mConversionCutCandidates);
+        }
+        if (applyTwoTrackCut) {
+          mPairCuts.twoTrackCutCandidates(eta1, associated.eta, mTwoTrackCutCandidates);
+        }
+      }
+
+      for (size_t j = 0; j < associated.size(); j++) {
+        if (index1 == associated.globalIndex[j]) {
+          continue;
+        }
+        if (ptOrder != 0 && associated.pt[j] >= pt1) {
+          continue;
+        }
+        if (associatedCharge != 0 && associatedCharge * associated.sign[j] < 0) {
+          continue;
+        }
+        if (pairCharge != 0 && pairCharge * sign1 * associated.sign[j] < 0) {
+          continue;
+        }
+
+        if constexpr (step >= CorrelationContainer::kCFStepReconstructed) {
+          const bool checkConversion = applyConversionCuts && mConversionCutCandidates[j];
+          const bool checkTwoTrack = applyTwoTrackCut && mTwoTrackCutCandidates[j];
+          if (checkConversion || checkTwoTrack) {
+            const auto view1 = triggers.view(i);
+            const auto view2 = associated.view(j);
+            if (checkConversion && mPairCuts.conversionCuts(view1, view2)) {
+              continue;
+            }
+            if (checkTwoTrack && mPairCuts.twoTrackCut(view1, view2, magField)) {
+              continue;
+            }
+          }
+        }
+
+        float deltaPhi = phi1 - associated.phi[j];
+        if (deltaPhi > 1.5f * PI) {
+          deltaPhi -= TwoPI;
+        }
+        if (deltaPhi < -PIHalf) {
+          deltaPhi += TwoPI;
+        }
+
+        const int etaBin = etaAxis.findBin(eta1 - associated.eta[j]);
+        const int phiBin = phiAxis.findBin(deltaPhi);
+        if (etaBin < 0 || phiBin < 0 || associated.ptBin[j] < 0) {
+          continue;
+        }
+
+        mPairAccumulator.add(etaBin, associated.ptBin[j], ptTriggerBin, phiBin, triggerWeight * associated.weight[j]);
+      }
+    }
+
+    mPairAccumulator.flush(target->getPairHist(), step);
+    return true;
+  }
+
   template <CorrelationContainer::CFStep step, typename TTarget, typename TTracks>
   void fillCorrelations(TTarget target, TTracks& tracks1, TTracks& tracks2, float multiplicity, float posZ, int magField, float eventWeight)
   {
+    if (cfg.mStagedPairFill && fillCorrelationsStaged<step>(target, tracks1, tracks2, multiplicity, posZ, magField, eventWeight)) {
+      return;
+    }
+
     // Cache efficiency for particles (too many FindBin lookups)
     float* efficiencyAssociated = nullptr;
     if constexpr (step == CorrelationContainer::kCFStepCorrected) {
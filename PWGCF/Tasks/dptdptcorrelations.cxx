@@ -21,8 +21,12 @@
 #include <TProfile3D.h>
 #include <TROOT.h>
 #include <TVector2.h>
+#include <algorithm>
 #include <cmath>
 #include <ctime>
+#include <memory>
+#include <thread>
+#include <vector>
 
 #include "Common/Core/TrackSelection.h"
 #include "Common/DataModel/Centrality.h"
@@ -63,12 +67,118 @@ float deltaphiup = constants::math::TwoPI - deltaphibinwidth / 2.0;
 bool processpairs = false;
 bool processmixedevents = false;
 bool ptorder = false;
+int npairthreads = 1;               ///< number of threads sharing the pair loop of a collision
+int64_t minpairsperthread = 200000; ///< minimum number of pairs of a collision per pair loop thread
+constexpr std::size_t pairblocksize = 16; ///< number of consecutive first tracks processed by a pair loop thread
 
 PairCuts fPairCuts;              // pair suppression engine
 bool fUseConversionCuts = false; // suppress resonances and conversions
 bool fUseTwoTrackCut = false;    // suppress too close tracks
 
 std::vector<std::string> tname = {"O", "T"}; ///< the track names
+
+/// \brief Track magnitudes staged once per collision for the pair loop
+/// It offers the accessors used by the pair cuts engine
+struct PairTrack {
+  int64_t gindex = -1; ///< global index of the track, to exclude autocorrelations
+  float tpt = 0.0f;
+  float teta = 0.0f;
+  float tphi = 0.0f;
+  float corr = 1.0f;  ///< NUA&NUE correction
+  float ptavg = 0.0f; ///< average \f$p_T\f$ at the track \f$\eta,\;\phi\f$
+  int8_t tsign = 0;
+  int species = 0;   ///< the track accepted id
+  int etaix = 0;     ///< zero based \f$\eta\f$ bin index
+  int phiix = 0;     ///< zero based, origin shifted, \f$\varphi\f$ bin index
+
+  int64_t index() const { return gindex; }
+  float pt() const { return tpt; }
+  float eta() const { return teta; }
+  float phi() const { return tphi; }
+  int8_t sign() const { return tsign; }
+};
+
+/// \brief Fills of a TH2 accumulated to be incorporated in one go
+/// The bin contents, the sum of squared weights, the statistics and the
+/// number of entries are left as a per fill TH2::Fill would leave them
+struct TH2FillBuffer {
+  std::vector<double> content;
+  std::vector<double> sumw2;
+  double stats[7] = {0.0};         ///< sum of w, w^2, wx, wx^2, wy, wy^2, wxy for fills within the axes ranges
+  double statsoverflow[7] = {0.0}; ///< the same for under/overflow fills
+  double entries = 0.0;
+  bool nonunitweight = false;
+  const TAxis* xaxis = nullptr;
+  const TAxis* yaxis = nullptr;
+  int nxbins = 0;
+  int nybins = 0;
+
+  void init(TH2* h)
+  {
+    xaxis = h->GetXaxis();
+    yaxis = h->GetYaxis();
+    nxbins = xaxis->GetNbins();
+    nybins = yaxis->GetNbins();
+    content.assign((nxbins + 2) * (nybins + 2), 0.0);
+    sumw2.assign(content.size(), 0.0);
+  }
+
+  void fill(double x, double y, double w)
+  {
+    int binx = xaxis->FindFixBin(x);
+    int biny = yaxis->FindFixBin(y);
+    int bin = biny * (nxbins + 2) + binx;
+    content[bin] += w;
+    sumw2[bin] += w * w;
+    entries += 1;
+    nonunitweight = nonunitweight || (w != 1.0);
+    double* s = (binx == 0 || binx > nxbins || biny == 0 || biny > nybins) ? statsoverflow : stats;
+    s[0] += w;
+    s[1] += w * w;
+    s[2] += w * x;
+    s[3] += w * x * x;
+    s[4] += w * y;
+    s[5] += w * y * y;
+    s[6] += w * x * y;
+  }
+
+  void flush(TH2* h)
+  {
+    if (entries == 0) {
+      return;
+    }
+    /* the statistics have to be retrieved before touching the bin contents */
+    double hstats[TH1::kNstat];
+    h->GetStats(hstats);
+    bool statoverflows = h->GetStatOverflowsBehaviour();
+    for (int i = 0; i < 7; ++i) {
+      hstats[i] += stats[i] + (statoverflows ? statsoverflow[i] : 0.0);
+      stats[i] = 0.0;
+      statsoverflow[i] = 0.0;
+    }
+    /* TH2::Fill creates the sum of squared weights at the first non unit weight */
+    if (h->GetSumw2N() == 0 && nonunitweight && !h->TestBit(TH1::kIsNotW)) {
+      h->Sumw2();
+    }
+    bool hassumw2 = h->GetSumw2N() > 0;
+    for (std::size_t bin = 0; bin < content.size(); ++bin) {
+      if (content[bin] != 0.0) {
+        h->AddBinContent(bin, content[bin]);
+        content[bin] = 0.0;
+      }
+      if (sumw2[bin] != 0.0) {
+        if (hassumw2) {
+          (*h->GetSumw2())[bin] += sumw2[bin];
+        }
+        sumw2[bin] = 0.0;
+      }
+    }
+    h->PutStats(hstats);
+    h->SetEntries(h->GetEntries() + entries);
+    entries = 0.0;
+    nonunitweight = false;
+  }
+};
 } // namespace correlationstask
 
 // Task for building <dpt,dpt> correlations
@@ -114,6 +224,42 @@ struct DptDptCorrelationsTask {
     std::vector<std::vector<std::string>> trackPairsNames = {{"OO", "OT"}, {"TO", "TT"}};
     bool ccdbstored = false;
 
+    /// \brief Pair loop accumulator of one thread, persistent across collisions
+    /// Flat arrays are indexed by species combination, species1 * nch + species2,
+    /// and, for the differential histograms, by the global bin within the combination
+    struct alignas(64) PairAccumulator {
+      /* per collision magnitudes */
+      std::vector<double> n2;           ///< weighted number of track 1 track 2 pairs
+      std::vector<double> n2sup;        ///< weighted number of track 1 track 2 suppressed pairs
+      std::vector<double> sum2PtPt;     ///< accumulated sum of weighted track 1 track 2 \f${p_T}_1 {p_T}_2\f$
+      std::vector<double> sum2DptDpt;   ///< accumulated sum of weighted number of track 1 tracks times weighted track 2 \f$p_T\f$
+      std::vector<double> n2nw;         ///< not weighted number of track1 track 2 pairs
+      std::vector<double> sum2PtPtnw;   ///< accumulated sum of not weighted track 1 track 2 \f${p_T}_1 {p_T}_2\f$
+      std::vector<double> sum2DptDptnw; ///< accumulated sum of not weighted number of track 1 tracks times not weighted track 2 \f$p_T\f$
+      /* differential histogram contents, only used when the pair loop is shared among threads */
+      std::vector<double> binsN2;
+      std::vector<double> binsSum2PtPt;
+      std::vector<double> binsSum2DptDpt;
+      std::vector<double> binsSupN1N1;
+      std::vector<double> binsSupPt1Pt1;
+      std::vector<correlationstask::TH2FillBuffer> n2cont;
+      std::vector<correlationstask::TH2FillBuffer> ptpt;
+
+      void resetSums(std::size_t ncombinations)
+      {
+        for (auto* v : {&n2, &n2sup, &sum2PtPt, &sum2DptDpt, &n2nw, &sum2PtPtnw, &sum2DptDptnw}) {
+          v->assign(ncombinations, 0.0);
+        }
+      }
+    };
+
+    /* the pair loop buffers, persistent across collisions */
+    std::vector<correlationstask::PairTrack> fPairTracks1;                     ///< staged tracks one
+    std::vector<correlationstask::PairTrack> fPairTracks2;                     ///< staged tracks two, for mixed events
+    std::vector<std::unique_ptr<PairAccumulator>> fPairAccumulators;          ///< one per pair loop thread
+    int fNBinsDEtaDPhi = 0;                                                   ///< number of global bins of the differential histograms
+    int fNxBinsDEtaDPhi = 0;                                                  ///< number of x global bins, including under/overflow, of the differential histograms
+
     float isCCDBstored()
     {
       return ccdbstored;
@@ -158,40 +304,6 @@ struct DptDptCorrelationsTask {
       return etaix * phibins + phiix;
     }
 
-    /// \brief Returns the TH2 global index for the differential histograms
-    /// \param t1 the intended track one
-    /// \param t2 the intended track two
-    /// \return the globl TH2 bin for delta eta delta phi
-    ///
-    /// WARNING: for performance reasons no checks are done about the consistency
-    /// of tracks' eta and phi within the corresponding ranges so, it is suppossed
-    /// the tracks have been accepted and they are within that ranges
-    /// IF THAT IS NOT THE CASE THE ROUTINE WILL PRODUCE NONSENSE RESULTS
-    template <typename TrackObject>
-    int GetDEtaDPhiGlobalIndex(TrackObject const& t1, TrackObject const& t2)
-    {
-      using namespace correlationstask;
-      using namespace o2::analysis::dptdptfilter;
-
-      /* rule: ix are always zero based while bins are always one based */
-      int etaix_1 = static_cast<int>((t1.eta() - etalow) / etabinwidth);
-      /* consider a potential phi origin shift */
-      float phi = GetShiftedPhi(t1.phi());
-      int phiix_1 = static_cast<int>((phi - philow) / phibinwidth);
-      int etaix_2 = static_cast<int>((t2.eta() - etalow) / etabinwidth);
-      /* consider a potential phi origin shift */
-      phi = GetShiftedPhi(t2.phi());
-      int phiix_2 = static_cast<int>((phi - philow) / phibinwidth);
-
-      int deltaeta_ix = etaix_1 - etaix_2 + etabins - 1;
-      int deltaphi_ix = phiix_1 - phiix_2;
-      if (deltaphi_ix < 0) {
-        deltaphi_ix += phibins;
-      }
-
-      return fhN2_vsDEtaDPhi[0][0]->GetBin(deltaeta_ix + 1, deltaphi_ix + 1);
-    }
-
     void storeTrackCorrections(std::vector<TH3*> corrs)
     {
       LOGF(info, "Stored NUA&NUE corrections for %d track ids", corrs.size());
@@ -247,8 +359,8 @@ struct DptDptCorrelationsTask {
       for (auto& t : tracks) {
         if (fhPtAvg_vsEtaPhi[t.trackacceptedid()] != nullptr) {
           (*ptavg)[index] = fhPtAvg_vsEtaPhi[t.trackacceptedid()]->GetBinContent(fhPtAvg_vsEtaPhi[t.trackacceptedid()]->FindFixBin(t.eta(), t.phi()));
-          index++;
         }
+        index++;
       }
       return ptavg;
     }
@@ -308,53 +420,78 @@ struct DptDptCorrelationsTask {
       }
     }
 
-    /// \brief fills the pair histograms in pair execution mode
-    /// \param trks1 filtered table with the tracks associated to the first track in the pair
-    /// \param trks2 filtered table with the tracks associated to the second track in the pair
-    /// \param cmul centrality - multiplicity for the collision being analyzed
-    /// Be aware that in most of the cases traks1 and trks2 will have the same content (exception: mixed events)
-    template <bool doptorder, typename TrackOneListObject, typename TrackTwoListObject>
-    void processTrackPairs(TrackOneListObject const& trks1, TrackTwoListObject const& trks2, std::vector<float>* corrs1, std::vector<float>* corrs2, std::vector<float>* ptavgs1, std::vector<float>* ptavgs2, float cmul, int bfield)
+    /// \brief stages the track magnitudes used in the pair loop
+    /// \param tracks filtered table with the tracks to stage
+    /// \param staged the staged tracks, in the same order as in the table
+    template <typename TrackListObject>
+    void stagePairTracks(TrackListObject const& tracks, std::vector<float>* corrs, std::vector<float>* ptavgs, std::vector<correlationstask::PairTrack>& staged)
     {
       using namespace correlationstask;
 
-      /* process pair magnitudes */
-      std::vector<std::vector<double>> n2(nch, std::vector<double>(nch, 0.0));           ///< weighted number of track 1 track 2 pairs for current collision
-      std::vector<std::vector<double>> n2sup(nch, std::vector<double>(nch, 0.0));        ///< weighted number of track 1 track 2 suppressed pairs for current collision
-      std::vector<std::vector<double>> sum2PtPt(nch, std::vector<double>(nch, 0.0));     ///< accumulated sum of weighted track 1 track 2 \f${p_T}_1 {p_T}_2\f$ for current collision
-      std::vector<std::vector<double>> sum2DptDpt(nch, std::vector<double>(nch, 0.0));   ///< accumulated sum of weighted number of track 1 tracks times weighted track 2 \f$p_T\f$ for current collision
-      std::vector<std::vector<double>> n2nw(nch, std::vector<double>(nch, 0.0));         ///< not weighted number of track1 track 2 pairs for current collision
-      std::vector<std::vector<double>> sum2PtPtnw(nch, std::vector<double>(nch, 0.0));   ///< accumulated sum of not weighted track 1 track 2 \f${p_T}_1 {p_T}_2\f$ for current collision
-      std::vector<std::vector<double>> sum2DptDptnw(nch, std::vector<double>(nch, 0.0)); ///< accumulated sum of not weighted number of track 1 tracks times not weighted track 2 \f$p_T\f$ for current collision
-      int index1 = 0;
-
-      for (auto& track1 : trks1) {
-        double ptavg_1 = (*ptavgs1)[index1];
-        double corr1 = (*corrs1)[index1];
-        int index2 = 0;
-        for (auto& track2 : trks2) {
+      staged.resize(tracks.size());
+      int index = 0;
+      for (auto& track : tracks) {
+        PairTrack& st = staged[index];
+        st.gindex = track.globalIndex();
+        st.tpt = track.pt();
+        st.teta = track.eta();
+        st.tphi = track.phi();
+        st.corr = (*corrs)[index];
+        st.ptavg = (*ptavgs)[index];
+        st.tsign = track.sign();
+        st.species = track.trackacceptedid();
+        st.etaix = static_cast<int>((track.eta() - etalow) / etabinwidth);
+        /* consider a potential phi origin shift */
+        st.phiix = static_cast<int>((GetShiftedPhi(track.phi()) - philow) / phibinwidth);
+        index++;
+      }
+    }
+
+    /// \brief processes the pairs formed by a block of staged tracks one with all the staged tracks two
+    /// \param first1 the first track one of the block
+    /// \param last1 one past the last track one of the block
+    /// \param acc the accumulator of the pair magnitudes
+    /// If buffered the differential histograms are accumulated in the accumulator
+    /// instead of directly in the histograms
+    template <bool doptorder, bool buffered>
+    void processPairsBlock(std::vector<correlationstask::PairTrack> const& trks1, std::vector<correlationstask::PairTrack> const& trks2, std::size_t first1, std::size_t last1, PairAccumulator& acc, int bfield)
+    {
+      using namespace correlationstask;
+
+      for (std::size_t i1 = first1; i1 < last1; ++i1) {
+        const PairTrack& track1 = trks1[i1];
+        double ptavg_1 = track1.ptavg;
+        double corr1 = track1.corr;
+        for (const PairTrack& track2 : trks2) {
           /* checking the same track id condition */
-          if (track1 == track2) {
+          if (track1.gindex == track2.gindex) {
             /* exclude autocorrelations */
             continue;
           }
 
           if constexpr (doptorder) {
-            if (track2.pt() >= track1.pt()) {
+            if (track2.tpt >= track1.tpt) {
               continue;
             }
           }
           /* process pair magnitudes */
-          double ptavg_2 = (*ptavgs2)[index2];
-          double corr2 = (*corrs2)[index2];
+          int ixcomb = track1.species * nch + track2.species;
+          double ptavg_2 = track2.ptavg;
+          double corr2 = track2.corr;
           double corr = corr1 * corr2;
-          double dptdptnw = (track1.pt() - ptavg_1) * (track2.pt() - ptavg_2);
-          double dptdptw = (corr1 * track1.pt() - ptavg_1) * (corr2 * track2.pt() - ptavg_2);
+          float ptpt = track1.tpt * track2.tpt;
+          double dptdptnw = (track1.tpt - ptavg_1) * (track2.tpt - ptavg_2);
+          double dptdptw = (corr1 * track1.tpt - ptavg_1) * (corr2 * track2.tpt - ptavg_2);
 
           /* get the global bin for filling the differential histograms */
-          int globalbin = GetDEtaDPhiGlobalIndex(track1, track2);
-          float deltaeta = track1.eta() - track2.eta();
-          float deltaphi = track1.phi() - track2.phi();
+          int deltaeta_ix = track1.etaix - track2.etaix + etabins - 1;
+          int deltaphi_ix = track1.phiix - track2.phiix;
+          if (deltaphi_ix < 0) {
+            deltaphi_ix += phibins;
+          }
+          int globalbin = (deltaphi_ix + 1) * fNxBinsDEtaDPhi + deltaeta_ix + 1;
+          float deltaeta = track1.teta - track2.teta;
+          float deltaphi = track1.tphi - track2.tphi;
           while (deltaphi >= deltaphiup) {
             deltaphi -= constants::math::TwoPI;
           }
@@ -363,42 +500,167 @@ struct DptDptCorrelationsTask {
           }
           if ((fUseConversionCuts && fPairCuts.conversionCuts(track1, track2)) || (fUseTwoTrackCut && fPairCuts.twoTrackCut(track1, track2, bfield))) {
             /* suppress the pair */
-            fhSupN1N1_vsDEtaDPhi[track1.trackacceptedid()][track2.trackacceptedid()]->AddBinContent(globalbin, corr);
-            fhSupPt1Pt1_vsDEtaDPhi[track1.trackacceptedid()][track2.trackacceptedid()]->AddBinContent(globalbin, track1.pt() * track2.pt() * corr);
-            n2sup[track1.trackacceptedid()][track2.trackacceptedid()] += corr;
+            if constexpr (buffered) {
+              acc.binsSupN1N1[ixcomb * fNBinsDEtaDPhi + globalbin] += corr;
+              acc.binsSupPt1Pt1[ixcomb * fNBinsDEtaDPhi + globalbin] += ptpt * corr;
+            } else {
+              fhSupN1N1_vsDEtaDPhi[track1.species][track2.species]->AddBinContent(globalbin, corr);
+              fhSupPt1Pt1_vsDEtaDPhi[track1.species][track2.species]->AddBinContent(globalbin, ptpt * corr);
+            }
+            acc.n2sup[ixcomb] += corr;
           } else {
             /* count the pair */
-            n2[track1.trackacceptedid()][track2.trackacceptedid()] += corr;
-            sum2PtPt[track1.trackacceptedid()][track2.trackacceptedid()] += track1.pt() * track2.pt() * corr;
-            sum2DptDpt[track1.trackacceptedid()][track2.trackacceptedid()] += dptdptw;
-            n2nw[track1.trackacceptedid()][track2.trackacceptedid()] += 1;
-            sum2PtPtnw[track1.trackacceptedid()][track2.trackacceptedid()] += track1.pt() * track2.pt();
-            sum2DptDptnw[track1.trackacceptedid()][track2.trackacceptedid()] += dptdptnw;
-
-            fhN2_vsDEtaDPhi[track1.trackacceptedid()][track2.trackacceptedid()]->AddBinContent(globalbin, corr);
-            fhN2cont_vsDEtaDPhi[track1.trackacceptedid()][track2.trackacceptedid()]->Fill(deltaeta, deltaphi, corr);
-            fhSum2DptDpt_vsDEtaDPhi[track1.trackacceptedid()][track2.trackacceptedid()]->AddBinContent(globalbin, dptdptw);
-            fhSum2PtPt_vsDEtaDPhi[track1.trackacceptedid()][track2.trackacceptedid()]->AddBinContent(globalbin, track1.pt() * track2.pt() * corr);
+            acc.n2[ixcomb] += corr;
+            acc.sum2PtPt[ixcomb] += ptpt * corr;
+            acc.sum2DptDpt[ixcomb] += dptdptw;
+            acc.n2nw[ixcomb] += 1;
+            acc.sum2PtPtnw[ixcomb] += ptpt;
+            acc.sum2DptDptnw[ixcomb] += dptdptnw;
+
+            if constexpr (buffered) {
+              acc.binsN2[ixcomb * fNBinsDEtaDPhi + globalbin] += corr;
+              acc.n2cont[ixcomb].fill(deltaeta, deltaphi, corr);
+              acc.binsSum2DptDpt[ixcomb * fNBinsDEtaDPhi + globalbin] += dptdptw;
+              acc.binsSum2PtPt[ixcomb * fNBinsDEtaDPhi + globalbin] += ptpt * corr;
+            } else {
+              fhN2_vsDEtaDPhi[track1.species][track2.species]->AddBinContent(globalbin, corr);
+              fhN2cont_vsDEtaDPhi[track1.species][track2.species]->Fill(deltaeta, deltaphi, corr);
+              fhSum2DptDpt_vsDEtaDPhi[track1.species][track2.species]->AddBinContent(globalbin, dptdptw);
+              fhSum2PtPt_vsDEtaDPhi[track1.species][track2.species]->AddBinContent(globalbin, ptpt * corr);
+            }
+          }
+          if constexpr (buffered) {
+            acc.ptpt[ixcomb].fill(track1.tpt, track2.tpt, corr);
+          } else {
+            fhN2_vsPtPt[track1.species][track2.species]->Fill(track1.tpt, track2.tpt, corr);
+          }
+        }
+      }
+    }
+
+    /// \brief incorporates the differential histogram contents of a pair accumulator to the histograms
+    void flushPairAccumulator(PairAccumulator& acc)
+    {
+      auto flushbins = [&](std::vector<double>& bins, TH2F* h, int ixcomb) {
+        double* b = bins.data() + ixcomb * fNBinsDEtaDPhi;
+        for (int bin = 0; bin < fNBinsDEtaDPhi; ++bin) {
+          if (b[bin] != 0.0) {
+            h->AddBinContent(bin, b[bin]);
+            b[bin] = 0.0;
+          }
+        }
+      };
+      for (uint pid1 = 0; pid1 < nch; ++pid1) {
+        for (uint pid2 = 0; pid2 < nch; ++pid2) {
+          int ixcomb = pid1 * nch + pid2;
+          flushbins(acc.binsN2, fhN2_vsDEtaDPhi[pid1][pid2], ixcomb);
+          flushbins(acc.binsSum2PtPt, fhSum2PtPt_vsDEtaDPhi[pid1][pid2], ixcomb);
+          flushbins(acc.binsSum2DptDpt, fhSum2DptDpt_vsDEtaDPhi[pid1][pid2], ixcomb);
+          flushbins(acc.binsSupN1N1, fhSupN1N1_vsDEtaDPhi[pid1][pid2], ixcomb);
+          flushbins(acc.binsSupPt1Pt1, fhSupPt1Pt1_vsDEtaDPhi[pid1][pid2], ixcomb);
+          acc.n2cont[ixcomb].flush(fhN2cont_vsDEtaDPhi[pid1][pid2]);
+          acc.ptpt[ixcomb].flush(fhN2_vsPtPt[pid1][pid2]);
+        }
+      }
+    }
+
+    /// \brief fills the pair histograms in pair execution mode
+    /// \param trks1 filtered table with the tracks associated to the first track in the pair
+    /// \param trks2 filtered table with the tracks associated to the second track in the pair
+    /// \param cmul centrality - multiplicity for the collision being analyzed
+    /// Be aware that in most of the cases traks1 and trks2 will have the same content (exception: mixed events)
+    /// For large enough collisions the pair loop is shared among threads by blocks of tracks one,
+    /// each thread accumulating in its own buffers which are incorporated to the histograms at the end
+    template <bool doptorder, typename TrackOneListObject, typename TrackTwoListObject>
+    void processTrackPairs(TrackOneListObject const& trks1, TrackTwoListObject const& trks2, std::vector<float>* corrs1, std::vector<float>* corrs2, std::vector<float>* ptavgs1, std::vector<float>* ptavgs2, float cmul, int bfield)
+    {
+      using namespace correlationstask;
+
+      /* stage the track magnitudes, only once for same event pairs */
+      stagePairTracks(trks1, corrs1, ptavgs1, fPairTracks1);
+      const std::vector<PairTrack>* pairtracks2 = &fPairTracks1;
+      if (static_cast<const void*>(&trks1) != static_cast<const void*>(&trks2)) {
+        stagePairTracks(trks2, corrs2, ptavgs2, fPairTracks2);
+        pairtracks2 = &fPairTracks2;
+      }
+
+      /* the number of threads for the pair loop of this collision */
+      int64_t npairs = static_cast<int64_t>(fPairTracks1.size()) * static_cast<int64_t>(pairtracks2->size());
+      int nthreads = static_cast<int>(std::max<int64_t>(1, std::min<int64_t>(npairthreads, npairs / std::max<int64_t>(1, minpairsperthread))));
+      while (static_cast<int>(fPairAccumulators.size()) < nthreads) {
+        fPairAccumulators.push_back(std::make_unique<PairAccumulator>());
+      }
+      for (int ithread = 0; ithread < nthreads; ++ithread) {
+        fPairAccumulators[ithread]->resetSums(nch * nch);
+      }
+
+      if (nthreads == 1) {
+        processPairsBlock<doptorder, false>(fPairTracks1, *pairtracks2, 0, fPairTracks1.size(), *fPairAccumulators[0], bfield);
+      } else {
+        for (int ithread = 0; ithread < nthreads; ++ithread) {
+          PairAccumulator& acc = *fPairAccumulators[ithread];
+          if (acc.binsN2.empty()) {
+            for (auto* v : {&acc.binsN2, &acc.binsSum2PtPt, &acc.binsSum2DptDpt, &acc.binsSupN1N1, &acc.binsSupPt1Pt1}) {
+              v->assign(nch * nch * fNBinsDEtaDPhi, 0.0);
+            }
+            acc.n2cont.resize(nch * nch);
+            acc.ptpt.resize(nch * nch);
+            for (uint pid1 = 0; pid1 < nch; ++pid1) {
+              for (uint pid2 = 0; pid2 < nch; ++pid2) {
+                acc.n2cont[pid1 * nch + pid2].init(fhN2cont_vsDEtaDPhi[pid1][pid2]);
+                acc.ptpt[pid1 * nch + pid2].init(fhN2_vsPtPt[pid1][pid2]);
+              }
+            }
+          }
+        }
+        auto pairloop = [&](int ithread) {
+          for (std::size_t first1 = ithread * pairblocksize; first1 < fPairTracks1.size(); first1 += nthreads * pairblocksize) {
+            processPairsBlock<doptorder, true>(fPairTracks1, *pairtracks2, first1, std::min(first1 + pairblocksize, fPairTracks1.size()), *fPairAccumulators[ithread], bfield);
+          }
+        };
+        std::vector<std::thread> threads;
+        for (int ithread = 1; ithread < nthreads; ++ithread) {
+          threads.emplace_back(pairloop, ithread);
+        }
+        pairloop(0);
+        for (auto& thread : threads) {
+          thread.join();
+        }
+        /* reduce into the histograms and into the first accumulator */
+        PairAccumulator& acc0 = *fPairAccumulators[0];
+        for (int ithread = 0; ithread < nthreads; ++ithread) {
+          PairAccumulator& acc = *fPairAccumulators[ithread];
+          flushPairAccumulator(acc);
+          if (ithread > 0) {
+            for (uint ixcomb = 0; ixcomb < nch * nch; ++ixcomb) {
+              acc0.n2[ixcomb] += acc.n2[ixcomb];
+              acc0.n2sup[ixcomb] += acc.n2sup[ixcomb];
+              acc0.sum2PtPt[ixcomb] += acc.sum2PtPt[ixcomb];
+              acc0.sum2DptDpt[ixcomb] += acc.sum2DptDpt[ixcomb];
+              acc0.n2nw[ixcomb] += acc.n2nw[ixcomb];
+              acc0.sum2PtPtnw[ixcomb] += acc.sum2PtPtnw[ixcomb];
+              acc0.sum2DptDptnw[ixcomb] += acc.sum2DptDptnw[ixcomb];
+            }
           }
-          fhN2_vsPtPt[track1.trackacceptedid()][track2.trackacceptedid()]->Fill(track1.pt(), track2.pt(), corr);
-          index2++;
         }
-        index1++;
       }
+
+      const PairAccumulator& acc = *fPairAccumulators[0];
       for (uint pid1 = 0; pid1 < nch; ++pid1) {
         for (uint pid2 = 0; pid2 < nch; ++pid2) {
-          fhN2_vsC[pid1][pid2]->Fill(cmul, n2[pid1][pid2]);
-          fhSum2PtPt_vsC[pid1][pid2]->Fill(cmul, sum2PtPt[pid1][pid2]);
-          fhSum2DptDpt_vsC[pid1][pid2]->Fill(cmul, sum2DptDpt[pid1][pid2]);
-          fhN2nw_vsC[pid1][pid2]->Fill(cmul, n2nw[pid1][pid2]);
-          fhSum2PtPtnw_vsC[pid1][pid2]->Fill(cmul, sum2PtPtnw[pid1][pid2]);
-          fhSum2DptDptnw_vsC[pid1][pid2]->Fill(cmul, sum2DptDptnw[pid1][pid2]);
+          int ixcomb = pid1 * nch + pid2;
+          fhN2_vsC[pid1][pid2]->Fill(cmul, acc.n2[ixcomb]);
+          fhSum2PtPt_vsC[pid1][pid2]->Fill(cmul, acc.sum2PtPt[ixcomb]);
+          fhSum2DptDpt_vsC[pid1][pid2]->Fill(cmul, acc.sum2DptDpt[ixcomb]);
+          fhN2nw_vsC[pid1][pid2]->Fill(cmul, acc.n2nw[ixcomb]);
+          fhSum2PtPtnw_vsC[pid1][pid2]->Fill(cmul, acc.sum2PtPtnw[ixcomb]);
+          fhSum2DptDptnw_vsC[pid1][pid2]->Fill(cmul, acc.sum2DptDptnw[ixcomb]);
           /* let's also update the number of entries in the differential histograms */
-          fhN2_vsDEtaDPhi[pid1][pid2]->SetEntries(fhN2_vsDEtaDPhi[pid1][pid2]->GetEntries() + n2[pid1][pid2]);
-          fhSum2DptDpt_vsDEtaDPhi[pid1][pid2]->SetEntries(fhSum2DptDpt_vsDEtaDPhi[pid1][pid2]->GetEntries() + n2[pid1][pid2]);
-          fhSum2PtPt_vsDEtaDPhi[pid1][pid2]->SetEntries(fhSum2PtPt_vsDEtaDPhi[pid1][pid2]->GetEntries() + n2[pid1][pid2]);
-          fhSupN1N1_vsDEtaDPhi[pid1][pid2]->SetEntries(fhSupN1N1_vsDEtaDPhi[pid1][pid2]->GetEntries() + n2sup[pid1][pid2]);
-          fhSupPt1Pt1_vsDEtaDPhi[pid1][pid2]->SetEntries(fhSupPt1Pt1_vsDEtaDPhi[pid1][pid2]->GetEntries() + n2sup[pid1][pid2]);
+          fhN2_vsDEtaDPhi[pid1][pid2]->SetEntries(fhN2_vsDEtaDPhi[pid1][pid2]->GetEntries() + acc.n2[ixcomb]);
+          fhSum2DptDpt_vsDEtaDPhi[pid1][pid2]->SetEntries(fhSum2DptDpt_vsDEtaDPhi[pid1][pid2]->GetEntries() + acc.n2[ixcomb]);
+          fhSum2PtPt_vsDEtaDPhi[pid1][pid2]->SetEntries(fhSum2PtPt_vsDEtaDPhi[pid1][pid2]->GetEntries() + acc.n2[ixcomb]);
+          fhSupN1N1_vsDEtaDPhi[pid1][pid2]->SetEntries(fhSupN1N1_vsDEtaDPhi[pid1][pid2]->GetEntries() + acc.n2sup[ixcomb]);
+          fhSupPt1Pt1_vsDEtaDPhi[pid1][pid2]->SetEntries(fhSupPt1Pt1_vsDEtaDPhi[pid1][pid2]->GetEntries() + acc.n2sup[ixcomb]);
         }
       }
     }
@@ -646,6 +908,9 @@ struct DptDptCorrelationsTask {
             fOutputList->Add(fhSum2DptDptnw_vsC[i][j]);
           }
         }
+        /* the global bin structure of the differential histograms for the pair loop */
+        fNxBinsDEtaDPhi = fhN2_vsDEtaDPhi[0][0]->GetNbinsX() + 2;
+        fNBinsDEtaDPhi = fNxBinsDEtaDPhi * (fhN2_vsDEtaDPhi[0][0]->GetNbinsY() + 2);
       }
       TH1::AddDirectory(oldstatus);
     }
@@ -684,6 +949,8 @@ struct DptDptCorrelationsTask {
                                                            {28, -7.0, 7.0, 18, 0.2, 2.0, 16, -0.8, 0.8, 72, 0.5},
                                                            "triplets - nbins, min, max - for z_vtx, pT, eta and phi, binning plus bin fraction of phi origin shift"};
   Configurable<bool> cfgPtOrder{"ptorder", false, "enforce pT_1 < pT_2. Defalut: false"};
+  Configurable<int> cfgPairThreads{"pairthreads", 1, "Number of threads sharing the pair loop of a collision. Default: 1"};
+  Configurable<int> cfgMinPairsPerThread{"minpairsperthread", 200000, "Minimum number of track pairs of a collision per pair loop thread. Default: 200000"};
   struct : ConfigurableGroup {
     Configurable<std::string> cfgCCDBUrl{"input_ccdburl", "http://ccdb-test.cern.ch:8080", "The CCDB url for the input file"};
     Configurable<std::string> cfgCCDBPathName{"input_ccdbpath", "", "The CCDB path for the input file. Default \"\", i.e. don't load from CCDB"};
@@ -714,6 +981,8 @@ struct DptDptCorrelationsTask {
     processpairs = cfgProcessPairs.value;
     processmixedevents = cfgProcessME.value;
     ptorder = cfgPtOrder.value;
+    npairthreads = cfgPairThreads.value;
+    minpairsperthread = cfgMinPairsPerThread.value;
     loadfromccdb = cfginputfile.cfgCCDBPathName->length() > 0;
     /* update the potential binning change */
     etabinwidth = (etaup - etalow) / static_cast<float>(etabins);
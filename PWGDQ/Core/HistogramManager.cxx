@@ -685,9 +685,32 @@ void HistogramManager::FillHistClass(const char* className, Float_t* values)
   //
   //  fill a class of histograms
   //
+  FillHistClass(GetHistClassHandle(className), values);
+}
+
+//__________________________________________________________________
+HistogramManager::HistClassHandle HistogramManager::GetHistClassHandle(const char* className)
+{
+  //
+  //  get the histogram list and the variable identifiers of a class
+  //
+  HistClassHandle handle;
+  handle.fList = reinterpret_cast<TList*>(fMainList->FindObject(className));
+  if (handle.fList) {
+    handle.fVars = &fVariablesMap[className];
+  }
+  return handle;
+}
+
+//__________________________________________________________________
+void HistogramManager::FillHistClass(const HistClassHandle& handle, Float_t* values)
+{
+  //
+  //  fill a class of histograms from its handle
+  //
 
   // get the needed histogram list
-  auto* hList = reinterpret_cast<TList*>(fMainList->FindObject(className));
+  auto* hList = handle.fList;
   if (!hList) {
     // TODO: add some meaningfull error message
     /*LOG(warn) << "HistogramManager::FillHistClass(): Histogram list " << className << " not found!";
@@ -696,7 +719,7 @@ void HistogramManager::FillHistClass(const char* className, Float_t* values)
   }
 
   // get the corresponding std::list containng identifiers to the needed variables to be filled
-  list varList = fVariablesMap[className];
+  const list<vector<int>>& varList = *handle.fVars;
 
   TIter next(hList);
 
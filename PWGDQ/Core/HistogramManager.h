@@ -86,6 +86,14 @@ class HistogramManager : public TNamed
 
   void FillHistClass(const char* className, float* values);
 
+  // Histogram class resolved once, to be filled without looking up its name
+  struct HistClassHandle {
+    TList* fList = nullptr;                              // list of histograms of the class, nullptr if the class does not exist
+    const std::list<std::vector<int>>* fVars = nullptr; // identifiers of the variables of each histogram
+  };
+  HistClassHandle GetHistClassHandle(const char* className);
+  void FillHistClass(const HistClassHandle& handle, float* values);
+
   void SetUseDefaultVariableNames(bool flag) { fUseDefaultVariableNames = flag; };
   void SetDefaultVarNames(TString* vars, TString* units);
   const bool* GetUsedVars() const { return fUsedVars; }
@@ -12,6 +12,7 @@
 // Contact: iarsene@cern.ch, i.c.arsene@fys.uio.no
 //
 #include <iostream>
+#include <array>
 #include <vector>
 #include <algorithm>
 #include <TH1F.h>
@@ -114,6 +115,10 @@ constexpr static int pairTypeEMu = VarManager::kElectronMuon;
 // Global function used to define needed histogram classes
 void DefineHistograms(HistogramManager* histMan, TString histClasses, Configurable<std::string> configVar); // defines histograms for all tasks
 
+// Handles of the pair histogram classes, for each cut the classes of +-, ++ and -- pairs
+using PairHistHandles = std::vector<std::array<HistogramManager::HistClassHandle, 3>>;
+PairHistHandles GetPairHistHandles(HistogramManager* histMan, const std::vector<std::vector<TString>>& histNames);
+
 struct AnalysisEventSelection {
   Produces<aod::EventCuts> eventSel;
   Produces<aod::MixingHashes> hash;
@@ -433,7 +438,7 @@ struct AnalysisPrefilterSelection {
 
   Partition<soa::Filtered<MyBarrelTracksSelected>> barrelTracksSelected = aod::dqanalysisflags::isBarrelSelected > 0;
 
-  std::map<int, bool> fPrefiltermap;
+  std::vector<bool> fPrefilterFlags; // per track global index, true if the track forms a pair passing the prefilter pair cut
   AnalysisCompositeCut* fPairCut;
 
   void init(o2::framework::InitContext& context)
@@ -458,13 +463,17 @@ struct AnalysisPrefilterSelection {
       if (track1.sign() * track2.sign() > 0) {
         continue;
       }
+      // the pair cannot change the flags if both tracks are already flagged
+      if (fPrefilterFlags[track1.globalIndex()] && fPrefilterFlags[track2.globalIndex()]) {
+        continue;
+      }
 
       // pairing
       VarManager::FillPair<TPairType, TTrackFillMap>(track1, track2);
 
       if (fPairCut->IsSelected(VarManager::fgValues)) {
-        fPrefiltermap[track1.globalIndex()] = true;
-        fPrefiltermap[track2.globalIndex()] = true;
+        fPrefilterFlags[track1.globalIndex()] = true;
+        fPrefilterFlags[track2.globalIndex()] = true;
       }
     }
   }
@@ -472,7 +481,7 @@ struct AnalysisPrefilterSelection {
   void processBarrelSkimmed(MyEventsSelected const& events, soa::Filtered<MyBarrelTracksSelected> const& filteredTracks, MyBarrelTracks const& tracks)
   {
     const int pairType = VarManager::kDecayToEE;
-    fPrefiltermap.clear();
+    fPrefilterFlags.assign(tracks.size(), false);
 
     for (auto& event : events) {
       if (event.isEventSelected()) {
@@ -484,7 +493,7 @@ struct AnalysisPrefilterSelection {
 
     // Fill Prefilter bits for all tracks to have something joinable to MyBarrelTracksSelected
     for (auto& track : tracks) {
-      prefilter(static_cast<int>(fPrefiltermap[track.globalIndex()]));
+      prefilter(static_cast<int>(fPrefilterFlags[track.globalIndex()]));
     }
   }
 
@@ -518,6 +527,9 @@ struct AnalysisEventMixing {
   std::vector<std::vector<TString>> fTrackHistNames;
   std::vector<std::vector<TString>> fMuonHistNames;
   std::vector<std::vector<TString>> fTrackMuonHistNames;
+  PairHistHandles fTrackHistHandles;
+  PairHistHandles fMuonHistHandles;
+  PairHistHandles fTrackMuonHistHandles;
 
   NoBinningPolicy<aod::dqanalysisflags::MixingHash> hashBin;
 
@@ -584,22 +596,23 @@ struct AnalysisEventMixing {
     DefineHistograms(fHistMan, histNames.Data(), fConfigAddEventMixingHistogram); // define all histograms
     VarManager::SetUseVars(fHistMan->GetUsedVars());                              // provide the list of required variables so that VarManager knows what to fill
     fOutputList.setObject(fHistMan->GetMainHistogramList());
+
+    fTrackHistHandles = GetPairHistHandles(fHistMan, fTrackHistNames);
+    fMuonHistHandles = GetPairHistHandles(fHistMan, fMuonHistNames);
+    fTrackMuonHistHandles = GetPairHistHandles(fHistMan, fTrackMuonHistNames);
   }
 
   template <int TPairType, typename TTracks1, typename TTracks2>
   void runMixedPairing(TTracks1 const& tracks1, TTracks2 const& tracks2)
   {
-
-    unsigned int ncuts = fTrackHistNames.size();
-    std::vector<std::vector<TString>> histNames = fTrackHistNames;
+    const PairHistHandles* histHandles = &fTrackHistHandles;
     if constexpr (TPairType == pairTypeMuMu) {
-      ncuts = fMuonHistNames.size();
-      histNames = fMuonHistNames;
+      histHandles = &fMuonHistHandles;
     }
     if constexpr (TPairType == pairTypeEMu) {
-      ncuts = fTrackMuonHistNames.size();
-      histNames = fTrackMuonHistNames;
+      histHandles = &fTrackMuonHistHandles;
     }
+    unsigned int ncuts = histHandles->size();
 
     uint32_t twoTrackFilter = 0;
     for (auto& track1 : tracks1) {
@@ -624,17 +637,10 @@ struct AnalysisEventMixing {
           VarManager::FillPairVn<TPairType>(track1, track2);
         }
 
+        const int iSign = (track1.sign() * track2.sign() < 0) ? 0 : (track1.sign() > 0 ? 1 : 2);
         for (unsigned int icut = 0; icut < ncuts; icut++) {
           if (twoTrackFilter & (uint32_t(1) << icut)) {
-            if (track1.sign() * track2.sign() < 0) {
-              fHistMan->FillHistClass(histNames[icut][0].Data(), VarManager::fgValues);
-            } else {
-              if (track1.sign() > 0) {
-                fHistMan->FillHistClass(histNames[icut][1].Data(), VarManager::fgValues);
-              } else {
-                fHistMan->FillHistClass(histNames[icut][2].Data(), VarManager::fgValues);
-              }
-            }
+            fHistMan->FillHistClass((*histHandles)[icut][iSign], VarManager::fgValues);
           } // end if (filter bits)
         }   // end for (cuts)
       }     // end for (track2)
@@ -771,6 +777,9 @@ struct AnalysisSameEventPairing {
   std::vector<std::vector<TString>> fTrackHistNames;
   std::vector<std::vector<TString>> fMuonHistNames;
   std::vector<std::vector<TString>> fTrackMuonHistNames;
+  PairHistHandles fTrackHistHandles;
+  PairHistHandles fMuonHistHandles;
+  PairHistHandles fTrackMuonHistHandles;
   std::vector<AnalysisCompositeCut> fPairCuts;
 
   void init(o2::framework::InitContext& context)
@@ -914,6 +923,14 @@ struct AnalysisSameEventPairing {
     DefineHistograms(fHistMan, histNames.Data(), fConfigAddSEPHistogram); // define all histograms
     VarManager::SetUseVars(fHistMan->GetUsedVars());                      // provide the list of required variables so that VarManager knows what to fill
     fOutputList.setObject(fHistMan->GetMainHistogramList());
+
+    // the histogram classes of each track cut are followed by the ones of each pair cut
+    if (fPairCuts.size() > 64) {
+      LOG(fatal) << "At most 64 pair cuts are supported, " << fPairCuts.size() << " were requested";
+    }
+    fTrackHistHandles = GetPairHistHandles(fHistMan, fTrackHistNames);
+    fMuonHistHandles = GetPairHistHandles(fHistMan, fMuonHistNames);
+    fTrackMuonHistHandles = GetPairHistHandles(fHistMan, fTrackMuonHistNames);
   }
 
   // Template function to run same event pairing (barrel-barrel, muon-muon, barrel-muon)
@@ -945,18 +962,15 @@ struct AnalysisSameEventPairing {
       fCurrentRun = event.runNumber();
     }
 
-    TString cutNames = fConfigTrackCuts.value;
-    std::vector<std::vector<TString>> histNames = fTrackHistNames;
+    const PairHistHandles* histHandles = &fTrackHistHandles;
     if constexpr (TPairType == pairTypeMuMu) {
-      cutNames = fConfigMuonCuts.value;
-      histNames = fMuonHistNames;
+      histHandles = &fMuonHistHandles;
     }
     if constexpr (TPairType == pairTypeEMu) {
-      cutNames = fConfigMuonCuts.value;
-      histNames = fTrackMuonHistNames;
+      histHandles = &fTrackMuonHistHandles;
     }
-    std::unique_ptr<TObjArray> objArray(cutNames.Tokenize(","));
-    int ncuts = objArray->GetEntries();
+    const unsigned int nHistsPerCut = fPairCuts.size() + 1;
+    const unsigned int ncuts = histHandles->size() / nHistsPerCut;
 
     uint32_t twoTrackFilter = 0;
     uint32_t dileptonFilterMap = 0;
@@ -1035,37 +1049,26 @@ struct AnalysisSameEventPairing {
         dileptonFlowList(VarManager::fgValues[VarManager::kU2Q2], VarManager::fgValues[VarManager::kU3Q3], VarManager::fgValues[VarManager::kCos2DeltaPhi], VarManager::fgValues[VarManager::kCos3DeltaPhi]);
       }
 
-      int iCut = 0;
-      for (int icut = 0; icut < ncuts; icut++) {
-        if (twoTrackFilter & (uint32_t(1) << icut)) {
-          if (t1.sign() * t2.sign() < 0) {
-            fHistMan->FillHistClass(histNames[iCut][0].Data(), VarManager::fgValues);
-          } else {
-            if (t1.sign() > 0) {
-              fHistMan->FillHistClass(histNames[iCut][1].Data(), VarManager::fgValues);
-            } else {
-              fHistMan->FillHistClass(histNames[iCut][2].Data(), VarManager::fgValues);
-            }
-          }
-          iCut++;
-          for (unsigned int iPairCut = 0; iPairCut < fPairCuts.size(); iPairCut++, iCut++) {
-            AnalysisCompositeCut cut = fPairCuts.at(iPairCut);
-            if (!(cut.IsSelected(VarManager::fgValues))) // apply pair cuts
-              continue;
-            if (t1.sign() * t2.sign() < 0) {
-              fHistMan->FillHistClass(histNames[iCut][0].Data(), VarManager::fgValues);
-            } else {
-              if (t1.sign() > 0) {
-                fHistMan->FillHistClass(histNames[iCut][1].Data(), VarManager::fgValues);
-              } else {
-                fHistMan->FillHistClass(histNames[iCut][2].Data(), VarManager::fgValues);
-              }
-            }
-          }      // end loop (pair cuts)
-        } else { // end if (filter bits)
-          iCut++;
+      // the pair cuts do not depend on the track cut, they are applied once per pair
+      uint64_t pairCutFilter = 0;
+      for (unsigned int iPairCut = 0; iPairCut < fPairCuts.size(); iPairCut++) {
+        if (fPairCuts[iPairCut].IsSelected(VarManager::fgValues)) {
+          pairCutFilter |= (uint64_t(1) << iPairCut);
+        }
+      }
+      const int iSign = (t1.sign() * t2.sign() < 0) ? 0 : (t1.sign() > 0 ? 1 : 2);
+      for (unsigned int icut = 0; icut < ncuts; icut++) {
+        if (!(twoTrackFilter & (uint32_t(1) << icut))) {
+          continue;
         }
-      } // end loop (cuts)
+        const unsigned int iCut = icut * nHistsPerCut;
+        fHistMan->FillHistClass((*histHandles)[iCut][iSign], VarManager::fgValues);
+        for (unsigned int iPairCut = 0; iPairCut < fPairCuts.size(); iPairCut++) {
+          if (pairCutFilter & (uint64_t(1) << iPairCut)) {
+            fHistMan->FillHistClass((*histHandles)[iCut + 1 + iPairCut][iSign], VarManager::fgValues);
+          }
+        } // end loop (pair cuts)
+      }   // end loop (cuts)
     }   // end loop over pairs
   }
 
@@ -1375,6 +1378,18 @@ WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
     adaptAnalysisTask<AnalysisDileptonHadron>(cfgc)};
 }
 
+PairHistHandles GetPairHistHandles(HistogramManager* histMan, const std::vector<std::vector<TString>>& histNames)
+{
+  //
+  // Resolve the pair histogram classes once, so that the pairing does not look them up by name
+  //
+  PairHistHandles handles;
+  for (const auto& names : histNames) {
+    handles.push_back({histMan->GetHistClassHandle(names[0].Data()), histMan->GetHistClassHandle(names[1].Data()), histMan->GetHistClassHandle(names[2].Data())});
+  }
+  return handles;
+}
+
 void DefineHistograms(HistogramManager* histMan, TString histClasses, Configurable<std::string> configVar)
 {
   //
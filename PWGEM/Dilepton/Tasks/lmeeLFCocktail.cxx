@@ -12,6 +12,7 @@
 //
 // Analysis task for lmee light flavour cocktail
 
+#include <algorithm>
 #include <vector>
 #include "Framework/Task.h"
 #include "Framework/runDataProcessing.h"
@@ -20,13 +21,14 @@
 #include "Framework/Logger.h"
 #include "SimulationDataFormat/MCTrack.h"
 #include "PWGEM/Dilepton/Utils/MomentumSmearer.h"
+#include "PWGEM/Dilepton/Utils/HistogramSampler.h"
 #include "Math/Vector4D.h"
 #include "Math/Vector3D.h"
 #include "TFile.h"
 #include "TF1.h"
 #include "TRandom.h"
 #include "TDatabasePDG.h"
-#include "TGenPhaseSpace.h"
+#include "TLorentzVector.h"
 #include "TGrid.h"
 #include "TTree.h"
 #include <nlohmann/json.hpp>
@@ -98,7 +100,7 @@ struct lmeelfcocktail {
   TH1F* fhwMultmT;
   TH1F* fhwMultpT2;
   TH1F* fhwMultmT2;
-  TH1F* fhKW;
+  HistogramSampler fKWSampler;
   TF1* ffVPHpT;
 
   std::vector<std::shared_ptr<TH1>> fmee_orig, fmotherpT_orig, fphi_orig, frap_orig, fmee_orig_wALT, fmotherpT_orig_wALT, fmee, fphi, frap, fmee_wALT;
@@ -108,13 +110,14 @@ struct lmeelfcocktail {
 
   std::vector<double> DCATemplateEdges;
   int nbDCAtemplate;
-  TH1F** fh_DCAtemplates;
+  std::vector<HistogramSampler> fDCATemplateSamplers;
 
   MomentumSmearer smearer;
 
   Double_t eMass;
 
   Configurable<int> fCollisionSystem{"cfgCollisionSystem", 200, "set the collision system"};
+  Configurable<int> fConfigSeed{"cfgSeed", -1, "seed of gRandom, -1 keeps the default seed, 0 gives a unique seed"};
   Configurable<bool> fConfigWriteTTree{"cfgWriteTTree", false, "write tree output"};
   Configurable<bool> fConfigDoPairing{"cfgDoPairing", true, "do like and unlike sign pairing"};
   Configurable<float> fConfigMaxEta{"cfgMaxEta", 0.8, "maxium |eta|"};
@@ -160,6 +163,9 @@ struct lmeelfcocktail {
 
   void init(o2::framework::InitContext& ic)
   {
+    if (fConfigSeed >= 0) {
+      gRandom->SetSeed(fConfigSeed);
+    }
     if (fConfigWriteTTree) {
       SetTree();
     }
@@ -450,13 +456,13 @@ struct lmeelfcocktail {
             treeWords.fpass = false;
 
           // get the pair DCA (based in smeared pT)
-          for (int jj = 0; jj < nbDCAtemplate; jj++) { // loop over DCA templates
-            if (dau1.Pt() >= DCATemplateEdges[jj] && dau1.Pt() < DCATemplateEdges[jj + 1]) {
-              treeWords.fd1DCA = fh_DCAtemplates[jj]->GetRandom();
-            }
-            if (dau2.Pt() >= DCATemplateEdges[jj] && dau2.Pt() < DCATemplateEdges[jj + 1]) {
-              treeWords.fd2DCA = fh_DCAtemplates[jj]->GetRandom();
-            }
+          int dcaTemplate = getDCATemplate(dau1.Pt());
+          if (dcaTemplate >= 0) {
+            treeWords.fd1DCA = fDCATemplateSamplers[dcaTemplate].sample();
+          }
+          dcaTemplate = getDCATemplate(dau2.Pt());
+          if (dcaTemplate >= 0) {
+            treeWords.fd2DCA = fDCATemplateSamplers[dcaTemplate].sample();
           }
           treeWords.fpairDCA = sqrt((pow(treeWords.fd1DCA, 2) + pow(treeWords.fd2DCA, 2)) / 2);
 
@@ -559,24 +565,16 @@ struct lmeelfcocktail {
             if (mother.GetPdgCode() == 111) {
               // get mass and pt from histos and flat eta and phi
               Double_t VPHpT = ffVPHpT->GetRandom();
-              Double_t VPHmass = fhKW->GetRandom();
+              Double_t VPHmass = fKWSampler.sample();
               Double_t VPHeta = -1. + gRandom->Rndm() * 2.;
               Double_t VPHphi = 2.0 * TMath::ACos(-1.) * gRandom->Rndm();
               TLorentzVector beam;
               beam.SetPtEtaPhiM(VPHpT, VPHeta, VPHphi, VPHmass);
-              Double_t decaymasses[2] = {(TDatabasePDG::Instance()->GetParticle(11))->Mass(), (TDatabasePDG::Instance()->GetParticle(11))->Mass()};
-              TGenPhaseSpace VPHgen;
-              Bool_t SetDecay;
-              SetDecay = VPHgen.SetDecay(beam, 2, decaymasses);
-              if (SetDecay == 0)
+              if (VPHmass <= 2. * eMass)
                 LOGP(error, "Decay not permitted by kinematics");
-              Double_t VPHweight = VPHgen.Generate();
-              // get electrons from the decay
-              TLorentzVector *decay1, *decay2;
-              decay1 = VPHgen.GetDecay(0);
-              decay2 = VPHgen.GetDecay(1);
-              dau1.SetPxPyPzE(decay1->Px(), decay1->Py(), decay1->Pz(), decay1->E());
-              dau2.SetPxPyPzE(decay2->Px(), decay2->Py(), decay2->Pz(), decay2->E());
+              // get electrons from the decay, the phase-space weight of a two-body decay is 1
+              Double_t VPHweight = 1.;
+              decayToElectrons(beam, dau1, dau2);
 
               // create dielectron before resolution effects:
               ee = dau1 + dau2;
@@ -707,6 +705,33 @@ struct lmeelfcocktail {
     return outPhiV;
   }
 
+  // isotropic decay of a virtual photon into an electron pair, as done by TGenPhaseSpace with the same random numbers
+  void decayToElectrons(TLorentzVector const& mother, PxPyPzEVector& dau1, PxPyPzEVector& dau2)
+  {
+    const double mass = mother.M();
+    const double pStar = 0.5 * sqrt(std::max(mass * mass - 4. * eMass * eMass, 0.));
+    const double eStar = sqrt(pStar * pStar + eMass * eMass);
+    const double cZ = 2. * gRandom->Rndm() - 1.;
+    const double sZ = sqrt(1. - cZ * cZ);
+    const double angY = 2. * TMath::Pi() * gRandom->Rndm();
+    const double cY = cos(angY);
+    const double sY = sin(angY);
+    TLorentzVector decay1(-cY * sZ * pStar, cZ * pStar, -sY * sZ * pStar, eStar);
+    TLorentzVector decay2(-decay1.Px(), -decay1.Py(), -decay1.Pz(), eStar);
+    const TVector3 beta = mother.BoostVector();
+    decay1.Boost(beta);
+    decay2.Boost(beta);
+    dau1.SetPxPyPzE(decay1.Px(), decay1.Py(), decay1.Pz(), decay1.E());
+    dau2.SetPxPyPzE(decay2.Px(), decay2.Py(), decay2.Pz(), decay2.E());
+  }
+
+  // index of the DCA template of a pT, -1 outside of the template edges or without templates
+  int getDCATemplate(double pt)
+  {
+    const int index = std::upper_bound(DCATemplateEdges.begin(), DCATemplateEdges.end(), pt) - DCATemplateEdges.begin() - 1;
+    return index < static_cast<int>(fDCATemplateSamplers.size()) ? index : -1;
+  }
+
   PxPyPzEVector applySmearingPxPyPzE(int ch, PxPyPzEVector vec)
   {
     PxPyPzEVector vecsmeared;
@@ -873,10 +898,11 @@ struct lmeelfcocktail {
       LOGP(error, "Could not open DCATemplate file {}", filename.Data());
       return;
     }
-    fh_DCAtemplates = new TH1F*[nbDCAtemplate];
+    // the templates are turned into samplers once
+    fDCATemplateSamplers.resize(nbDCAtemplate);
     for (int jj = 0; jj < nbDCAtemplate; jj++) {
       if (fFile->GetListOfKeys()->Contains(Form("%s%d", histname.Data(), jj + 1))) {
-        fh_DCAtemplates[jj] = reinterpret_cast<TH1F*>(fFile->Get(Form("%s%d", histname.Data(), jj + 1)));
+        fDCATemplateSamplers[jj].init(reinterpret_cast<TH1F*>(fFile->Get(Form("%s%d", histname.Data(), jj + 1))));
       } else {
         LOGP(error, "Could not open {}{} from file {}", histname.Data(), jj + 1, filename.Data());
       }
@@ -975,11 +1001,13 @@ struct lmeelfcocktail {
     Int_t KWnbins = 10000;
     Float_t KWmin = 2. * eMass;
     Double_t KWbinwidth = (fConfigKWMax - KWmin) / (Double_t)KWnbins;
-    fhKW = new TH1F("fhKW", "fhKW", KWnbins, KWmin, fConfigKWMax);
+    TH1F hKW("fhKW", "fhKW", KWnbins, KWmin, fConfigKWMax);
+    hKW.SetDirectory(nullptr);
     for (Int_t ibin = 1; ibin <= KWnbins; ibin++) {
       KWmass = KWmin + (Double_t)(ibin - 1) * KWbinwidth + KWbinwidth / 2.0;
-      fhKW->AddBinContent(ibin, 2. * (1. / 137.03599911) / 3. / 3.14159265359 / KWmass * sqrt(1. - 4. * eMass * eMass / KWmass / KWmass) * (1. + 2. * eMass * eMass / KWmass / KWmass));
+      hKW.AddBinContent(ibin, 2. * (1. / 137.03599911) / 3. / 3.14159265359 / KWmass * sqrt(1. - 4. * eMass * eMass / KWmass / KWmass) * (1. + 2. * eMass * eMass / KWmass / KWmass));
     }
+    fKWSampler.init(&hKW);
   }
 };
 
@@ -0,0 +1,131 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//
+//
+// Class to sample random numbers from a histogram in constant time
+//
+// The bin contents are turned into a Walker alias table once, so that a random number costs one
+// table lookup instead of the binary search of TH1::GetRandom. The distribution is the one of
+// TH1::GetRandom: the bins are chosen with a probability proportional to their content, under- and
+// overflow excluded, and the value is uniform within the bin. A histogram with no positive content
+// gives 0, as TH1::GetRandom.
+
+#ifndef PWGEM_DILEPTON_UTILS_HISTOGRAMSAMPLER_H_
+#define PWGEM_DILEPTON_UTILS_HISTOGRAMSAMPLER_H_
+
+#include <vector>
+
+#include <TH1.h>
+#include <TRandom.h>
+#include "Framework/Logger.h"
+
+class HistogramSampler
+{
+ public:
+  /// Default constructor
+  HistogramSampler() = default;
+
+  /// Constructor from a histogram
+  explicit HistogramSampler(const TH1* hist) { init(hist); }
+
+  /// Default destructor
+  ~HistogramSampler() = default;
+
+  void init(const TH1* hist)
+  {
+    fLowEdge.clear();
+    fWidth.clear();
+    fProbability.clear();
+    fAlias.clear();
+    fHasEntries = hist != nullptr && hist->GetEntries() > 0;
+    if (!hist) {
+      return;
+    }
+    const int nBins = hist->GetNbinsX();
+    std::vector<double> content(nBins);
+    double integral = 0.;
+    for (int iBin = 0; iBin < nBins; iBin++) {
+      content[iBin] = hist->GetBinContent(iBin + 1);
+      if (content[iBin] < 0.) {
+        LOGP(error, "Histogram {} has negative bin contents and cannot be sampled", hist->GetName());
+        return;
+      }
+      integral += content[iBin];
+    }
+    if (integral <= 0.) {
+      return;
+    }
+    fLowEdge.resize(nBins);
+    fWidth.resize(nBins);
+    fProbability.resize(nBins);
+    fAlias.resize(nBins);
+    std::vector<int> small, large;
+    for (int iBin = 0; iBin < nBins; iBin++) {
+      fLowEdge[iBin] = hist->GetXaxis()->GetBinLowEdge(iBin + 1);
+      fWidth[iBin] = hist->GetXaxis()->GetBinWidth(iBin + 1);
+      fAlias[iBin] = iBin;
+      content[iBin] *= nBins / integral; // average 1
+      if (content[iBin] < 1.) {
+        small.push_back(iBin);
+      } else {
+        large.push_back(iBin);
+      }
+    }
+    // Walker/Vose construction: each small bin is topped up to 1 by a large bin
+    while (!small.empty() && !large.empty()) {
+      const int iSmall = small.back(), iLarge = large.back();
+      small.pop_back();
+      fProbability[iSmall] = content[iSmall];
+      fAlias[iSmall] = iLarge;
+      content[iLarge] -= 1. - content[iSmall];
+      if (content[iLarge] < 1.) {
+        large.pop_back();
+        small.push_back(iLarge);
+      }
+    }
+    // what is left is 1 up to rounding
+    for (const int iBin : large) {
+      fProbability[iBin] = 1.;
+    }
+    for (const int iBin : small) {
+      fProbability[iBin] = 1.;
+    }
+  }
+
+  /// Whether the histogram had entries, as checked with TH1::GetEntries before sampling
+  bool hasEntries() const { return fHasEntries; }
+
+  /// Random number distributed as the histogram, using gRandom by default
+  double sample(TRandom* random = gRandom) const
+  {
+    if (fProbability.empty()) {
+      return 0.;
+    }
+    const double u = random->Rndm() * fProbability.size();
+    int iBin = static_cast<int>(u);
+    if (iBin >= static_cast<int>(fProbability.size())) {
+      iBin = fProbability.size() - 1;
+    }
+    if (u - iBin >= fProbability[iBin]) {
+      iBin = fAlias[iBin];
+    }
+    return fLowEdge[iBin] + fWidth[iBin] * random->Rndm();
+  }
+
+ private:
+  bool fHasEntries = false;
+  std::vector<double> fLowEdge;
+  std::vector<double> fWidth;
+  std::vector<double> fProbability; // probability to keep the bin rather than its alias
+  std::vector<int> fAlias;
+};
+
+#endif // PWGEM_DILEPTON_UTILS_HISTOGRAMSAMPLER_H_
@@ -15,12 +15,15 @@
 #ifndef PWGEM_DILEPTON_UTILS_MOMENTUMSMEARER_H_
 #define PWGEM_DILEPTON_UTILS_MOMENTUMSMEARER_H_
 
+#include <vector>
 #include <TH1D.h>
+#include <TH2D.h>
 #include <TString.h>
 #include <TGrid.h>
 #include <TObjArray.h>
 #include <TFile.h>
 #include "Framework/Logger.h"
+#include "PWGEM/Dilepton/Utils/HistogramSampler.h"
 
 class MomentumSmearer
 {
@@ -93,57 +96,40 @@ class MomentumSmearer
     fArrResoPhi_Neg = ArrResoPhi_Neg;
     fFile->Close();
 
+    // the resolution histograms are turned into samplers once
+    buildSamplers(fArrResoPt, fPtAxisResoPt, fSamplersResoPt);
+    buildSamplers(fArrResoEta, fPtAxisResoEta, fSamplersResoEta);
+    buildSamplers(fArrResoPhi_Pos, fPtAxisResoPhi, fSamplersResoPhi_Pos);
+    TAxis* ptAxisResoPhiNeg = nullptr;
+    buildSamplers(fArrResoPhi_Neg, ptAxisResoPhiNeg, fSamplersResoPhi_Neg);
+
     fInitialized = true;
   }
 
   void applySmearing(const int ch, const float ptgen, const float etagen, const float phigen, float& ptsmeared, float& etasmeared, float& phismeared)
   {
     // smear pt
-    int ptbin = reinterpret_cast<TH2D*>(fArrResoPt->At(0))->GetXaxis()->FindBin(ptgen);
-    if (ptbin < 1) {
-      ptbin = 1;
-    }
-    if (ptbin > fArrResoPt->GetLast()) {
-      ptbin = fArrResoPt->GetLast();
-    }
     float smearing = 0.;
-    TH1D* thisHist = reinterpret_cast<TH1D*>(fArrResoPt->At(ptbin));
-    if (thisHist->GetEntries() > 0) {
-      smearing = thisHist->GetRandom() * ptgen;
+    const HistogramSampler& samplerPt = fSamplersResoPt[findPtBin(fPtAxisResoPt, fSamplersResoPt, ptgen)];
+    if (samplerPt.hasEntries()) {
+      smearing = samplerPt.sample() * ptgen;
     }
     ptsmeared = ptgen - smearing;
 
     // smear eta
-    ptbin = reinterpret_cast<TH2D*>(fArrResoEta->At(0))->GetXaxis()->FindBin(ptgen);
-    if (ptbin < 1) {
-      ptbin = 1;
-    }
-    if (ptbin > fArrResoEta->GetLast()) {
-      ptbin = fArrResoEta->GetLast();
-    }
     smearing = 0.;
-    thisHist = reinterpret_cast<TH1D*>(fArrResoEta->At(ptbin));
-    if (thisHist->GetEntries() > 0) {
-      smearing = thisHist->GetRandom();
+    const HistogramSampler& samplerEta = fSamplersResoEta[findPtBin(fPtAxisResoEta, fSamplersResoEta, ptgen)];
+    if (samplerEta.hasEntries()) {
+      smearing = samplerEta.sample();
     }
     etasmeared = etagen - smearing;
 
-    // smear phi
-    ptbin = reinterpret_cast<TH2D*>(fArrResoPhi_Pos->At(0))->GetXaxis()->FindBin(ptgen);
-    if (ptbin < 1) {
-      ptbin = 1;
-    }
-    if (ptbin > fArrResoPhi_Pos->GetLast()) {
-      ptbin = fArrResoPhi_Pos->GetLast();
-    }
+    // smear phi, the pT binning of the positive charges is used for both
     smearing = 0.;
-    if (ch < 0) {
-      thisHist = reinterpret_cast<TH1D*>(fArrResoPhi_Neg->At(ptbin));
-    } else {
-      thisHist = reinterpret_cast<TH1D*>(fArrResoPhi_Pos->At(ptbin));
-    }
-    if (thisHist->GetEntries() > 0) {
-      smearing = thisHist->GetRandom();
+    const int ptbin = findPtBin(fPtAxisResoPhi, fSamplersResoPhi_Pos, ptgen);
+    const HistogramSampler& samplerPhi = ch < 0 ? fSamplersResoPhi_Neg[ptbin] : fSamplersResoPhi_Pos[ptbin];
+    if (samplerPhi.hasEntries()) {
+      smearing = samplerPhi.sample();
     }
     phismeared = phigen - smearing;
   }
@@ -177,6 +163,41 @@ class MomentumSmearer
   TObjArray* fArrResoEta;
   TObjArray* fArrResoPhi_Pos;
   TObjArray* fArrResoPhi_Neg;
+
+  // pT axis and sampler of each pT bin of the resolution arrays, the first entry of an array holds the pT axis
+  TAxis* fPtAxisResoPt = nullptr;
+  TAxis* fPtAxisResoEta = nullptr;
+  TAxis* fPtAxisResoPhi = nullptr;
+  std::vector<HistogramSampler> fSamplersResoPt;
+  std::vector<HistogramSampler> fSamplersResoEta;
+  std::vector<HistogramSampler> fSamplersResoPhi_Pos;
+  std::vector<HistogramSampler> fSamplersResoPhi_Neg;
+
+  void buildSamplers(TObjArray* arrReso, TAxis*& ptAxis, std::vector<HistogramSampler>& samplers)
+  {
+    samplers.clear();
+    if (!arrReso) {
+      return;
+    }
+    ptAxis = reinterpret_cast<TH2D*>(arrReso->At(0))->GetXaxis();
+    samplers.resize(arrReso->GetLast() + 1);
+    for (int ptbin = 1; ptbin <= arrReso->GetLast(); ptbin++) {
+      samplers[ptbin].init(reinterpret_cast<TH1D*>(arrReso->At(ptbin)));
+    }
+  }
+
+  // pT bin of the resolution array, limited to the filled range
+  static int findPtBin(TAxis* ptAxis, std::vector<HistogramSampler> const& samplers, const float ptgen)
+  {
+    int ptbin = ptAxis->FindBin(ptgen);
+    if (ptbin < 1) {
+      ptbin = 1;
+    }
+    if (ptbin > static_cast<int>(samplers.size()) - 1) {
+      ptbin = samplers.size() - 1;
+    }
+    return ptbin;
+  }
 };
 
 #endif // PWGEM_DILEPTON_UTILS_MOMENTUMSMEARER_H_
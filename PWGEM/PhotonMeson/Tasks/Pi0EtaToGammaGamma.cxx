@@ -14,8 +14,10 @@
 // This code loops over photons and makes pairs for neutral mesons analyses.
 //    Please write to: daiki.sekihata@cern.ch
 
+#include <cstdint>
 #include <cstring>
 #include <iterator>
+#include <vector>
 
 #include "TString.h"
 #include "Math/Vector4D.h"
@@ -119,6 +121,9 @@ struct Pi0EtaToGammaGamma {
     DefinePHOSCuts();
     DefineEMCCuts();
     DefinePairCuts();
+    if (fPCMCuts.size() > 32 || fDalitzEECuts.size() > 32 || fPHOSCuts.size() > 32 || fEMCCuts.size() > 32 || fPairCuts.size() > 32) {
+      LOGF(fatal, "At most 32 cuts per photon type and 32 pair cuts are supported, because cut decisions are stored as bits");
+    }
     addhistograms();
 
     fOutputEvent.setObject(reinterpret_cast<THashList*>(fMainList->FindObject("Event")));
@@ -301,28 +306,80 @@ struct Pi0EtaToGammaGamma {
   Preslice<aod::PHOSClusters> perCollision_phos = aod::skimmedcluster::collisionId;
   Preslice<aod::SkimEMCClusters> perCollision_emc = aod::skimmedcluster::collisionId;
 
-  template <PairType pairtype, typename TG1, typename TG2, typename TCut1, typename TCut2>
-  bool IsSelectedPair(TG1 const& g1, TG2 const& g2, TCut1 const& cut1, TCut2 const& cut2)
+  // bit icut is set if the photon passes cut icut of the cut list, indexed by the global index of the photon
+  std::vector<uint32_t> fPhotonCutMasks1;
+  std::vector<uint32_t> fPhotonCutMasks2;
+
+  template <typename TLeg, typename TPhotons, typename TCuts>
+  void EvaluatePhotonCuts(TPhotons const& photons, TCuts const& cuts, std::vector<uint32_t>& masks)
+  {
+    masks.clear();
+    masks.reserve(photons.size());
+    for (auto& photon : photons) {
+      uint32_t mask = 0;
+      for (size_t icut = 0; icut < cuts.size(); icut++) {
+        if (cuts[icut].template IsSelected<TLeg>(photon)) {
+          mask |= (1u << icut);
+        }
+      }
+      size_t index = photon.globalIndex();
+      if (index >= masks.size()) {
+        masks.resize(index + 1, 0);
+      }
+      masks[index] = mask;
+    }
+  }
+
+  template <typename G1, typename G2, typename TPairCuts>
+  uint32_t EvaluatePairCuts(G1 const& g1, G2 const& g2, TPairCuts const& paircuts)
   {
-    bool is_selected_pair = false;
-    if constexpr (pairtype == PairType::kPCMPCM) {
-      is_selected_pair = o2::aod::photonpair::IsSelectedPair<aod::V0Legs, aod::V0Legs>(g1, g2, cut1, cut2);
-    } else if constexpr (pairtype == PairType::kPHOSPHOS) {
-      is_selected_pair = o2::aod::photonpair::IsSelectedPair<int, int>(g1, g2, cut1, cut2); // dummy, because track matching is not ready.
-    } else if constexpr (pairtype == PairType::kEMCEMC) {
-      is_selected_pair = o2::aod::photonpair::IsSelectedPair<aod::SkimEMCMTs, aod::SkimEMCMTs>(g1, g2, cut1, cut2);
-    } else if constexpr (pairtype == PairType::kPCMPHOS) {
-      is_selected_pair = o2::aod::photonpair::IsSelectedPair<aod::V0Legs, int>(g1, g2, cut1, cut2);
-    } else if constexpr (pairtype == PairType::kPCMEMC) {
-      is_selected_pair = o2::aod::photonpair::IsSelectedPair<aod::V0Legs, aod::SkimEMCMTs>(g1, g2, cut1, cut2);
-    } else if constexpr (pairtype == PairType::kPCMDalitz) {
-      is_selected_pair = o2::aod::photonpair::IsSelectedPair<aod::V0Legs, aod::EMPrimaryTracks>(g1, g2, cut1, cut2);
-    } else if constexpr (pairtype == PairType::kPHOSEMC) {
-      is_selected_pair = o2::aod::photonpair::IsSelectedPair<int, aod::SkimEMCMTs>(g1, g2, cut1, cut2);
-    } else {
-      is_selected_pair = true;
+    uint32_t mask = 0;
+    for (size_t ipaircut = 0; ipaircut < paircuts.size(); ipaircut++) {
+      if (paircuts[ipaircut].IsSelected(g1, g2)) {
+        mask |= (1u << ipaircut);
+      }
+    }
+    return mask;
+  }
+
+  // histogram pointers for all (cut1, cut2, paircut) combinations, index (icut1 * ncut2 + icut2) * npaircut + ipaircut
+  template <typename TCuts1, typename TCuts2, typename TPairCuts>
+  std::vector<TH2F*> GetPairHistograms(THashList* list_pair_ss, TCuts1 const& cuts1, TCuts2 const& cuts2, TPairCuts const& paircuts, const char* histname, bool same_cut)
+  {
+    std::vector<TH2F*> hists(cuts1.size() * cuts2.size() * paircuts.size(), nullptr);
+    for (size_t icut1 = 0; icut1 < cuts1.size(); icut1++) {
+      for (size_t icut2 = 0; icut2 < cuts2.size(); icut2++) {
+        if (same_cut && icut1 != icut2) {
+          continue;
+        }
+        auto list_pair_subsys_photoncut = list_pair_ss->FindObject(Form("%s_%s", cuts1[icut1].GetName(), cuts2[icut2].GetName()));
+        for (size_t ipaircut = 0; ipaircut < paircuts.size(); ipaircut++) {
+          hists[(icut1 * cuts2.size() + icut2) * paircuts.size() + ipaircut] = reinterpret_cast<TH2F*>(list_pair_subsys_photoncut->FindObject(paircuts[ipaircut].GetName())->FindObject(histname));
+        }
+      }
+    }
+    return hists;
+  }
+
+  // calls fill(index) for all (cut1, cut2, paircut) combinations selected by the masks, index as in GetPairHistograms
+  template <typename TFunc>
+  void ForEachSelectedCombination(uint32_t cutmask1, size_t ncut1, uint32_t cutmask2, size_t ncut2, uint32_t paircutmask, size_t npaircut, bool same_cut, TFunc&& fill)
+  {
+    for (size_t icut1 = 0; icut1 < ncut1; icut1++) {
+      if (!(cutmask1 & (1u << icut1))) {
+        continue;
+      }
+      for (size_t icut2 = 0; icut2 < ncut2; icut2++) {
+        if (!(cutmask2 & (1u << icut2)) || (same_cut && icut1 != icut2)) {
+          continue;
+        }
+        for (size_t ipaircut = 0; ipaircut < npaircut; ipaircut++) {
+          if (paircutmask & (1u << ipaircut)) {
+            fill((icut1 * ncut2 + icut2) * npaircut + ipaircut);
+          }
+        }
+      }
     }
-    return is_selected_pair;
   }
 
   template <PairType pairtype, typename TEvents, typename TPhotons1, typename TPhotons2, typename TPreslice1, typename TPreslice2, typename TCuts1, typename TCuts2, typename TPairCuts, typename TLegs, typename TPrimaryTracks, typename TEMCMTs>
@@ -331,6 +388,22 @@ struct Pi0EtaToGammaGamma {
     THashList* list_ev_pair = static_cast<THashList*>(fMainList->FindObject("Event")->FindObject(pairnames[pairtype].data()));
     THashList* list_pair_ss = static_cast<THashList*>(fMainList->FindObject("Pair")->FindObject(pairnames[pairtype].data()));
 
+    constexpr bool same_subsystem = pairtype == PairType::kPCMPCM || pairtype == PairType::kPHOSPHOS || pairtype == PairType::kEMCEMC;
+    const size_t ncut1 = cuts1.size();
+    const size_t ncut2 = cuts2.size();
+    const size_t npaircut = paircuts.size();
+    auto hMggPt_Same = GetPairHistograms(list_pair_ss, cuts1, cuts2, paircuts, "hMggPt_Same", same_subsystem);
+    std::vector<TH2F*> hMggPt_Same_RotatedBkg, hdEtadPhi, hdEtaPt, hdPhiPt, hEp_E;
+    if constexpr (pairtype == PairType::kEMCEMC) {
+      hMggPt_Same_RotatedBkg = GetPairHistograms(list_pair_ss, cuts1, cuts2, paircuts, "hMggPt_Same_RotatedBkg", same_subsystem);
+    }
+    if constexpr (pairtype == PairType::kPCMPHOS || pairtype == PairType::kPCMEMC) {
+      hdEtadPhi = GetPairHistograms(list_pair_ss, cuts1, cuts2, paircuts, "hdEtadPhi", same_subsystem);
+      hdEtaPt = GetPairHistograms(list_pair_ss, cuts1, cuts2, paircuts, "hdEtaPt", same_subsystem);
+      hdPhiPt = GetPairHistograms(list_pair_ss, cuts1, cuts2, paircuts, "hdPhiPt", same_subsystem);
+      hEp_E = GetPairHistograms(list_pair_ss, cuts1, cuts2, paircuts, "hEp_E", same_subsystem);
+    }
+
     for (auto& collision : collisions) {
       if ((pairtype == PairType::kPHOSPHOS || pairtype == PairType::kPCMPHOS) && !collision.isPHOSCPVreadout()) {
         continue;
@@ -362,93 +435,94 @@ struct Pi0EtaToGammaGamma {
       auto photons1_coll = photons1.sliceBy(perCollision1, collision.globalIndex());
       auto photons2_coll = photons2.sliceBy(perCollision2, collision.globalIndex());
 
-      if constexpr (pairtype == PairType::kPCMPCM || pairtype == PairType::kPHOSPHOS || pairtype == PairType::kEMCEMC) {
-        for (auto& cut : cuts1) {
-          for (auto& paircut : paircuts) {
-
-            for (auto& [g1, g2] : combinations(CombinationsStrictlyUpperIndexPolicy(photons1_coll, photons2_coll))) {
-              if (!IsSelectedPair<pairtype>(g1, g2, cut, cut)) {
-                continue;
-              }
-              if (!paircut.IsSelected(g1, g2)) {
-                continue;
-              }
-
-              ROOT::Math::PtEtaPhiMVector v1(g1.pt(), g1.eta(), g1.phi(), 0.);
-              ROOT::Math::PtEtaPhiMVector v2(g2.pt(), g2.eta(), g2.phi(), 0.);
-              ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
-              if (abs(v12.Rapidity()) > maxY) {
-                continue;
-              }
-              reinterpret_cast<TH2F*>(list_pair_ss->FindObject(Form("%s_%s", cut.GetName(), cut.GetName()))->FindObject(paircut.GetName())->FindObject("hMggPt_Same"))->Fill(v12.M(), v12.Pt());
+      if constexpr (same_subsystem) {
+        for (auto& [g1, g2] : combinations(CombinationsStrictlyUpperIndexPolicy(photons1_coll, photons2_coll))) {
+          uint32_t cutmask = fPhotonCutMasks1[g1.globalIndex()] & fPhotonCutMasks2[g2.globalIndex()];
+          if (cutmask == 0) {
+            continue;
+          }
+          uint32_t paircutmask = EvaluatePairCuts(g1, g2, paircuts);
+          if (paircutmask == 0) {
+            continue;
+          }
+
+          ROOT::Math::PtEtaPhiMVector v1(g1.pt(), g1.eta(), g1.phi(), 0.);
+          ROOT::Math::PtEtaPhiMVector v2(g2.pt(), g2.eta(), g2.phi(), 0.);
+          ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
+          if (abs(v12.Rapidity()) > maxY) {
+            continue;
+          }
+          ForEachSelectedCombination(cutmask, ncut1, cutmask, ncut2, paircutmask, npaircut, true, [&](size_t index) {
+            hMggPt_Same[index]->Fill(v12.M(), v12.Pt());
+          });
 
-              if constexpr (pairtype == PairType::kEMCEMC) {
-                RotationBackground<aod::SkimEMCClusters>(v12, v1, v2, photons2_coll, g1.globalIndex(), g2.globalIndex(), cut, paircut, emcmatchedtracks);
-              }
-            } // end of combination
-          }   // end of pair cut loop
-        }     // end of cut loop
+          if constexpr (pairtype == PairType::kEMCEMC) {
+            RotationBackground(v12, v1, v2, photons2_coll, g1.globalIndex(), g2.globalIndex(), cutmask, paircutmask, hMggPt_Same_RotatedBkg, ncut1, npaircut);
+          }
+        } // end of combination
 
       } else { // different subsystem pairs
-        for (auto& cut1 : cuts1) {
-          for (auto& cut2 : cuts2) {
-            for (auto& paircut : paircuts) {
-              for (auto& [g1, g2] : combinations(CombinationsFullIndexPolicy(photons1_coll, photons2_coll))) {
-                if (!IsSelectedPair<pairtype>(g1, g2, cut1, cut2)) {
-                  continue;
-                }
-                if (!paircut.IsSelected(g1, g2)) {
-                  continue;
+        for (auto& [g1, g2] : combinations(CombinationsFullIndexPolicy(photons1_coll, photons2_coll))) {
+          uint32_t cutmask1 = fPhotonCutMasks1[g1.globalIndex()];
+          uint32_t cutmask2 = fPhotonCutMasks2[g2.globalIndex()];
+          if (cutmask1 == 0 || cutmask2 == 0) {
+            continue;
+          }
+          uint32_t paircutmask = EvaluatePairCuts(g1, g2, paircuts);
+          if (paircutmask == 0) {
+            continue;
+          }
+
+          if constexpr (pairtype == PairType::kPCMPHOS || pairtype == PairType::kPCMEMC) {
+            auto pos = g1.template posTrack_as<aod::V0Legs>();
+            auto ele = g1.template negTrack_as<aod::V0Legs>();
+
+            for (auto& v0leg : {pos, ele}) {
+              float deta = v0leg.eta() - g2.eta();
+              float dphi = TVector2::Phi_mpi_pi(TVector2::Phi_0_2pi(v0leg.phi()) - TVector2::Phi_0_2pi(g2.phi()));
+              float Ep = g2.e() / v0leg.p();
+              bool is_close = pow(deta / 0.02, 2) + pow(dphi / 0.4, 2) < 1;
+              ForEachSelectedCombination(cutmask1, ncut1, cutmask2, ncut2, paircutmask, npaircut, false, [&](size_t index) {
+                hdEtadPhi[index]->Fill(dphi, deta);
+                hdEtaPt[index]->Fill(v0leg.pt(), deta);
+                hdPhiPt[index]->Fill(v0leg.pt(), dphi);
+                if (is_close) {
+                  hEp_E[index]->Fill(g2.e(), Ep);
                 }
+              });
+            }
 
-                if constexpr (pairtype == PairType::kPCMPHOS || pairtype == PairType::kPCMEMC) {
-                  auto pos = g1.template posTrack_as<aod::V0Legs>();
-                  auto ele = g1.template negTrack_as<aod::V0Legs>();
-
-                  for (auto& v0leg : {pos, ele}) {
-                    float deta = v0leg.eta() - g2.eta();
-                    float dphi = TVector2::Phi_mpi_pi(TVector2::Phi_0_2pi(v0leg.phi()) - TVector2::Phi_0_2pi(g2.phi()));
-                    float Ep = g2.e() / v0leg.p();
-                    reinterpret_cast<TH2F*>(list_pair_ss->FindObject(Form("%s_%s", cut1.GetName(), cut2.GetName()))->FindObject(paircut.GetName())->FindObject("hdEtadPhi"))->Fill(dphi, deta);
-                    reinterpret_cast<TH2F*>(list_pair_ss->FindObject(Form("%s_%s", cut1.GetName(), cut2.GetName()))->FindObject(paircut.GetName())->FindObject("hdEtaPt"))->Fill(v0leg.pt(), deta);
-                    reinterpret_cast<TH2F*>(list_pair_ss->FindObject(Form("%s_%s", cut1.GetName(), cut2.GetName()))->FindObject(paircut.GetName())->FindObject("hdPhiPt"))->Fill(v0leg.pt(), dphi);
-                    if (pow(deta / 0.02, 2) + pow(dphi / 0.4, 2) < 1) {
-                      reinterpret_cast<TH2F*>(list_pair_ss->FindObject(Form("%s_%s", cut1.GetName(), cut2.GetName()))->FindObject(paircut.GetName())->FindObject("hEp_E"))->Fill(g2.e(), Ep);
-                    }
-                  }
-
-                  if constexpr (pairtype == PairType::kPCMPHOS) {
-                    if (o2::aod::photonpair::DoesV0LegMatchWithCluster(pos, g2, 0.02, 0.4, 0.2) || o2::aod::photonpair::DoesV0LegMatchWithCluster(ele, g2, 0.02, 0.4, 0.2)) {
-                      continue;
-                    }
-                  } else if constexpr (pairtype == PairType::kPCMEMC) {
-                    if (o2::aod::photonpair::DoesV0LegMatchWithCluster(pos, g2, 0.02, 0.4, 0.5) || o2::aod::photonpair::DoesV0LegMatchWithCluster(ele, g2, 0.02, 0.4, 0.5)) {
-                      continue;
-                    }
-                  }
-                }
-
-                ROOT::Math::PtEtaPhiMVector v1(g1.pt(), g1.eta(), g1.phi(), 0.);
-                ROOT::Math::PtEtaPhiMVector v2(g2.pt(), g2.eta(), g2.phi(), 0.);
-                if constexpr (pairtype == PairType::kPCMDalitz) {
-                  v2.SetM(g2.mee());
-                  auto pos_sv = g1.template posTrack_as<aod::V0Legs>();
-                  auto ele_sv = g1.template negTrack_as<aod::V0Legs>();
-                  auto pos_pv = g2.template posTrack_as<aod::EMPrimaryTracks>();
-                  auto ele_pv = g2.template negTrack_as<aod::EMPrimaryTracks>();
-                  if (pos_sv.trackId() == pos_pv.trackId() || ele_sv.trackId() == ele_pv.trackId()) {
-                    continue;
-                  }
-                }
-                ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
-                if (abs(v12.Rapidity()) > maxY) {
-                  continue;
-                }
-                reinterpret_cast<TH2F*>(list_pair_ss->FindObject(Form("%s_%s", cut1.GetName(), cut2.GetName()))->FindObject(paircut.GetName())->FindObject("hMggPt_Same"))->Fill(v12.M(), v12.Pt());
-              } // end of combination
-            }   // end of pair cut loop
-          }     // end of cut2 loop
-        }       // end of cut1 loop
+            if constexpr (pairtype == PairType::kPCMPHOS) {
+              if (o2::aod::photonpair::DoesV0LegMatchWithCluster(pos, g2, 0.02, 0.4, 0.2) || o2::aod::photonpair::DoesV0LegMatchWithCluster(ele, g2, 0.02, 0.4, 0.2)) {
+                continue;
+              }
+            } else if constexpr (pairtype == PairType::kPCMEMC) {
+              if (o2::aod::photonpair::DoesV0LegMatchWithCluster(pos, g2, 0.02, 0.4, 0.5) || o2::aod::photonpair::DoesV0LegMatchWithCluster(ele, g2, 0.02, 0.4, 0.5)) {
+                continue;
+              }
+            }
+          }
+
+          ROOT::Math::PtEtaPhiMVector v1(g1.pt(), g1.eta(), g1.phi(), 0.);
+          ROOT::Math::PtEtaPhiMVector v2(g2.pt(), g2.eta(), g2.phi(), 0.);
+          if constexpr (pairtype == PairType::kPCMDalitz) {
+            v2.SetM(g2.mee());
+            auto pos_sv = g1.template posTrack_as<aod::V0Legs>();
+            auto ele_sv = g1.template negTrack_as<aod::V0Legs>();
+            auto pos_pv = g2.template posTrack_as<aod::EMPrimaryTracks>();
+            auto ele_pv = g2.template negTrack_as<aod::EMPrimaryTracks>();
+            if (pos_sv.trackId() == pos_pv.trackId() || ele_sv.trackId() == ele_pv.trackId()) {
+              continue;
+            }
+          }
+          ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
+          if (abs(v12.Rapidity()) > maxY) {
+            continue;
+          }
+          ForEachSelectedCombination(cutmask1, ncut1, cutmask2, ncut2, paircutmask, npaircut, false, [&](size_t index) {
+            hMggPt_Same[index]->Fill(v12.M(), v12.Pt());
+          });
+        } // end of combination
       }
     } // end of collision loop
   }
@@ -463,6 +537,13 @@ struct Pi0EtaToGammaGamma {
   void MixedEventPairing(TEvents const& collisions, TPhotons1 const& photons1, TPhotons2 const& photons2, TPreslice1 const& perCollision1, TPreslice2 const& perCollision2, TCuts1 const& cuts1, TCuts2 const& cuts2, TPairCuts const& paircuts, TLegs const& legs, TPrimaryTracks const& primarytracks, TEMCMTs const& emcmatchedtracks)
   {
     THashList* list_pair_ss = static_cast<THashList*>(fMainList->FindObject("Pair")->FindObject(pairnames[pairtype].data()));
+
+    constexpr bool same_subsystem = pairtype == PairType::kPCMPCM || pairtype == PairType::kPHOSPHOS || pairtype == PairType::kEMCEMC;
+    const size_t ncut1 = cuts1.size();
+    const size_t ncut2 = cuts2.size();
+    const size_t npaircut = paircuts.size();
+    auto hMggPt_Mixed = GetPairHistograms(list_pair_ss, cuts1, cuts2, paircuts, "hMggPt_Mixed", same_subsystem);
+
     // LOGF(info, "Number of collisions after filtering: %d", collisions.size());
     for (auto& [collision1, collision2] : soa::selfCombinations(colBinning, ndepth, -1, collisions, collisions)) { // internally, CombinationsStrictlyUpperIndexPolicy(collisions, collisions) is called.
 
@@ -474,43 +555,39 @@ struct Pi0EtaToGammaGamma {
       // LOGF(info, "collision1: posZ = %f, numContrib = %d , sel8 = %d | collision2: posZ = %f, numContrib = %d , sel8 = %d",
       //     collision1.posZ(), collision1.numContrib(), collision1.sel8(), collision2.posZ(), collision2.numContrib(), collision2.sel8());
 
-      for (auto& cut1 : cuts1) {
-        for (auto& cut2 : cuts2) {
-          for (auto& paircut : paircuts) {
-            for (auto& [g1, g2] : combinations(soa::CombinationsFullIndexPolicy(photons_coll1, photons_coll2))) {
-              // LOGF(info, "Mixed event photon pair: (%d, %d) from events (%d, %d), photon event: (%d, %d)", g1.index(), g2.index(), collision1.index(), collision2.index(), g1.collisionId(), g2.collisionId());
+      for (auto& [g1, g2] : combinations(soa::CombinationsFullIndexPolicy(photons_coll1, photons_coll2))) {
+        // LOGF(info, "Mixed event photon pair: (%d, %d) from events (%d, %d), photon event: (%d, %d)", g1.index(), g2.index(), collision1.index(), collision2.index(), g1.collisionId(), g2.collisionId());
 
-              if ((pairtype == PairType::kPCMPCM || pairtype == PairType::kPHOSPHOS || pairtype == PairType::kEMCEMC) && (TString(cut1.GetName()) != TString(cut2.GetName()))) {
-                continue;
-              }
-              if (!IsSelectedPair<pairtype>(g1, g2, cut1, cut2)) {
-                continue;
-              }
-              if (!paircut.IsSelected(g1, g2)) {
-                continue;
-              }
+        uint32_t cutmask1 = fPhotonCutMasks1[g1.globalIndex()];
+        uint32_t cutmask2 = fPhotonCutMasks2[g2.globalIndex()];
+        if (cutmask1 == 0 || cutmask2 == 0) {
+          continue;
+        }
+        uint32_t paircutmask = EvaluatePairCuts(g1, g2, paircuts);
+        if (paircutmask == 0) {
+          continue;
+        }
 
-              ROOT::Math::PtEtaPhiMVector v1(g1.pt(), g1.eta(), g1.phi(), 0.);
-              ROOT::Math::PtEtaPhiMVector v2(g2.pt(), g2.eta(), g2.phi(), 0.);
-              if constexpr (pairtype == PairType::kPCMDalitz) {
-                v2.SetM(g2.mee());
-              }
-              ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
-              if (abs(v12.Rapidity()) > maxY) {
-                continue;
-              }
-              reinterpret_cast<TH2F*>(list_pair_ss->FindObject(Form("%s_%s", cut1.GetName(), cut2.GetName()))->FindObject(paircut.GetName())->FindObject("hMggPt_Mixed"))->Fill(v12.M(), v12.Pt());
+        ROOT::Math::PtEtaPhiMVector v1(g1.pt(), g1.eta(), g1.phi(), 0.);
+        ROOT::Math::PtEtaPhiMVector v2(g2.pt(), g2.eta(), g2.phi(), 0.);
+        if constexpr (pairtype == PairType::kPCMDalitz) {
+          v2.SetM(g2.mee());
+        }
+        ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
+        if (abs(v12.Rapidity()) > maxY) {
+          continue;
+        }
+        ForEachSelectedCombination(cutmask1, ncut1, cutmask2, ncut2, paircutmask, npaircut, same_subsystem, [&](size_t index) {
+          hMggPt_Mixed[index]->Fill(v12.M(), v12.Pt());
+        });
 
-            } // end of different photon combinations
-          }   // end of pair cut loop
-        }     // end of cut2 loop
-      }       // end of cut1 loop
-    }         // end of different collision combinations
+      } // end of different photon combinations
+    }   // end of different collision combinations
   }
 
   /// \brief Calculate background (using rotation background method only for EMCal!)
   template <typename TPhotons>
-  void RotationBackground(const ROOT::Math::PtEtaPhiMVector& meson, ROOT::Math::PtEtaPhiMVector photon1, ROOT::Math::PtEtaPhiMVector photon2, TPhotons const& photons_coll, unsigned int ig1, unsigned int ig2, EMCPhotonCut const& cut, PairCut const& paircut, SkimEMCMTs const& emcmatchedtracks)
+  void RotationBackground(const ROOT::Math::PtEtaPhiMVector& meson, ROOT::Math::PtEtaPhiMVector photon1, ROOT::Math::PtEtaPhiMVector photon2, TPhotons const& photons_coll, unsigned int ig1, unsigned int ig2, uint32_t cutmask, uint32_t paircutmask, std::vector<TH2F*> const& hists, size_t ncut, size_t npaircut)
   {
     // if less than 3 clusters are present skip event since we need at least 3 clusters
     if (photons_coll.size() < 3) {
@@ -538,7 +615,9 @@ struct Pi0EtaToGammaGamma {
         // only combine rotated photons with other photons
         continue;
       }
-      if (!cut.template IsSelected<aod::SkimEMCMTs>(photon)) {
+      // cuts for which both the pair and the third photon are selected
+      uint32_t photoncutmask = cutmask & fPhotonCutMasks2[photon.globalIndex()];
+      if (photoncutmask == 0) {
         continue;
       }
 
@@ -561,12 +640,14 @@ struct Pi0EtaToGammaGamma {
       // LOG(info) << "openingAngle2_2 = " << openingAngle2_2;
 
       // Fill histograms
-      if (openingAngle1 > minOpenAngle) {
-        reinterpret_cast<TH2F*>(fMainList->FindObject("Pair")->FindObject("EMCEMC")->FindObject(Form("%s_%s", cut.GetName(), cut.GetName()))->FindObject(paircut.GetName())->FindObject("hMggPt_Same_RotatedBkg"))->Fill(mother1.M(), mother1.Pt());
-      }
-      if (openingAngle2 > minOpenAngle) {
-        reinterpret_cast<TH2F*>(fMainList->FindObject("Pair")->FindObject("EMCEMC")->FindObject(Form("%s_%s", cut.GetName(), cut.GetName()))->FindObject(paircut.GetName())->FindObject("hMggPt_Same_RotatedBkg"))->Fill(mother2.M(), mother2.Pt());
-      }
+      ForEachSelectedCombination(photoncutmask, ncut, photoncutmask, ncut, paircutmask, npaircut, true, [&](size_t index) {
+        if (openingAngle1 > minOpenAngle) {
+          hists[index]->Fill(mother1.M(), mother1.Pt());
+        }
+        if (openingAngle2 > minOpenAngle) {
+          hists[index]->Fill(mother2.M(), mother2.Pt());
+        }
+      });
     }
   }
 
@@ -580,42 +661,56 @@ struct Pi0EtaToGammaGamma {
 
   void processPCMPCM(aod::EMReducedEvents const& collisions, MyFilteredCollisions const& filtered_collisions, MyV0Photons const& v0photons, aod::V0Legs const& legs)
   {
+    EvaluatePhotonCuts<aod::V0Legs>(v0photons, fPCMCuts, fPhotonCutMasks1);
+    fPhotonCutMasks2 = fPhotonCutMasks1;
     SameEventPairing<PairType::kPCMPCM>(grouped_collisions, v0photons, v0photons, perCollision, perCollision, fPCMCuts, fPCMCuts, fPairCuts, legs, nullptr, nullptr);
     MixedEventPairing<PairType::kPCMPCM>(filtered_collisions, v0photons, v0photons, perCollision, perCollision, fPCMCuts, fPCMCuts, fPairCuts, legs, nullptr, nullptr);
   }
 
   void processPHOSPHOS(aod::EMReducedEvents const& collisions, MyFilteredCollisions const& filtered_collisions, aod::PHOSClusters const& phosclusters)
   {
+    EvaluatePhotonCuts<int>(phosclusters, fPHOSCuts, fPhotonCutMasks1);
+    fPhotonCutMasks2 = fPhotonCutMasks1;
     SameEventPairing<PairType::kPHOSPHOS>(grouped_collisions, phosclusters, phosclusters, perCollision_phos, perCollision_phos, fPHOSCuts, fPHOSCuts, fPairCuts, nullptr, nullptr, nullptr);
     MixedEventPairing<PairType::kPHOSPHOS>(filtered_collisions, phosclusters, phosclusters, perCollision_phos, perCollision_phos, fPHOSCuts, fPHOSCuts, fPairCuts, nullptr, nullptr, nullptr);
   }
 
   void processEMCEMC(aod::EMReducedEvents const& collisions, MyFilteredCollisions const& filtered_collisions, aod::SkimEMCClusters const& emcclusters, aod::SkimEMCMTs const& emcmatchedtracks)
   {
+    EvaluatePhotonCuts<aod::SkimEMCMTs>(emcclusters, fEMCCuts, fPhotonCutMasks1);
+    fPhotonCutMasks2 = fPhotonCutMasks1;
     SameEventPairing<PairType::kEMCEMC>(grouped_collisions, emcclusters, emcclusters, perCollision_emc, perCollision_emc, fEMCCuts, fEMCCuts, fPairCuts, nullptr, nullptr, emcmatchedtracks);
     MixedEventPairing<PairType::kEMCEMC>(filtered_collisions, emcclusters, emcclusters, perCollision_emc, perCollision_emc, fEMCCuts, fEMCCuts, fPairCuts, nullptr, nullptr, emcmatchedtracks);
   }
 
   void processPCMDalitz(aod::EMReducedEvents const& collisions, MyFilteredCollisions const& filtered_collisions, MyV0Photons const& v0photons, aod::V0Legs const& legs, MyFilteredDalitzEEs const& dileptons, aod::EMPrimaryTracks const& emprimarytracks)
   {
+    EvaluatePhotonCuts<aod::V0Legs>(v0photons, fPCMCuts, fPhotonCutMasks1);
+    EvaluatePhotonCuts<aod::EMPrimaryTracks>(dileptons, fDalitzEECuts, fPhotonCutMasks2);
     SameEventPairing<PairType::kPCMDalitz>(grouped_collisions, v0photons, dileptons, perCollision, perCollision_dalitz, fPCMCuts, fDalitzEECuts, fPairCuts, legs, emprimarytracks, nullptr);
     MixedEventPairing<PairType::kPCMDalitz>(filtered_collisions, v0photons, dileptons, perCollision, perCollision_dalitz, fPCMCuts, fDalitzEECuts, fPairCuts, legs, emprimarytracks, nullptr);
   }
 
   void processPCMPHOS(aod::EMReducedEvents const& collisions, MyFilteredCollisions const& filtered_collisions, MyV0Photons const& v0photons, aod::PHOSClusters const& phosclusters, aod::V0Legs const& legs)
   {
+    EvaluatePhotonCuts<aod::V0Legs>(v0photons, fPCMCuts, fPhotonCutMasks1);
+    EvaluatePhotonCuts<int>(phosclusters, fPHOSCuts, fPhotonCutMasks2);
     SameEventPairing<PairType::kPCMPHOS>(grouped_collisions, v0photons, phosclusters, perCollision, perCollision_phos, fPCMCuts, fPHOSCuts, fPairCuts, legs, nullptr, nullptr);
     MixedEventPairing<PairType::kPCMPHOS>(filtered_collisions, v0photons, phosclusters, perCollision, perCollision_phos, fPCMCuts, fPHOSCuts, fPairCuts, legs, nullptr, nullptr);
   }
 
   void processPCMEMC(aod::EMReducedEvents const& collisions, MyFilteredCollisions const& filtered_collisions, MyV0Photons const& v0photons, aod::SkimEMCClusters const& emcclusters, aod::V0Legs const& legs, aod::SkimEMCMTs const& emcmatchedtracks)
   {
+    EvaluatePhotonCuts<aod::V0Legs>(v0photons, fPCMCuts, fPhotonCutMasks1);
+    EvaluatePhotonCuts<aod::SkimEMCMTs>(emcclusters, fEMCCuts, fPhotonCutMasks2);
     SameEventPairing<PairType::kPCMEMC>(grouped_collisions, v0photons, emcclusters, perCollision, perCollision_emc, fPCMCuts, fEMCCuts, fPairCuts, legs, nullptr, emcmatchedtracks);
     MixedEventPairing<PairType::kPCMEMC>(filtered_collisions, v0photons, emcclusters, perCollision, perCollision_emc, fPCMCuts, fEMCCuts, fPairCuts, legs, nullptr, emcmatchedtracks);
   }
 
   void processPHOSEMC(aod::EMReducedEvents const& collisions, MyFilteredCollisions const& filtered_collisions, aod::PHOSClusters const& phosclusters, aod::SkimEMCClusters const& emcclusters, aod::SkimEMCMTs const& emcmatchedtracks)
   {
+    EvaluatePhotonCuts<int>(phosclusters, fPHOSCuts, fPhotonCutMasks1);
+    EvaluatePhotonCuts<aod::SkimEMCMTs>(emcclusters, fEMCCuts, fPhotonCutMasks2);
     SameEventPairing<PairType::kPHOSEMC>(grouped_collisions, phosclusters, emcclusters, perCollision_phos, perCollision_emc, fPHOSCuts, fEMCCuts, fPairCuts, nullptr, nullptr, emcmatchedtracks);
     MixedEventPairing<PairType::kPHOSEMC>(filtered_collisions, phosclusters, emcclusters, perCollision_phos, perCollision_emc, fPHOSCuts, fEMCCuts, fPairCuts, nullptr, nullptr, emcmatchedtracks);
   }
@@ -15,7 +15,8 @@
 /// \author Antonio Palasciano <antonio.palasciano@cern.ch>, Università degli Studi di Bari
 /// \author Fabrizio Grosa <fabrizio.grosa@cern.ch>, CERN
 
-#include <map>
+#include <algorithm>
+#include <vector>
 
 #include "DCAFitter/DCAFitterN.h"
 #include "Framework/AnalysisTask.h"
@@ -110,6 +111,19 @@ struct HfDataCreatorD0PiReduced {
   // Fitter to redo D0-vertex to get extrapolated daughter tracks (2-prong vertex filter)
   o2::vertexing::DCAFitterN<2> df2;
 
+  // pion candidates of the collision, passing the selections that do not depend on the D0 candidate
+  struct StagedPion {
+    float p;                   // momentum, the pions are sorted by it
+    std::array<float, 3> pVec; // momentum vector
+    int64_t globalIndex;       // global index of the track
+    int8_t sign;               // charge sign
+    int indexAssoc;            // position in the track associations of the collision
+    int64_t indexHfTrackPion;  // row in the pion table, -1 if not filled yet
+    int indexMother;           // index of the B+ mother for the MC matching, -2 if not searched yet
+  };
+  std::vector<StagedPion> stagedPions;
+  std::vector<int> pionsInMassWindow; // positions in stagedPions of the pions paired with a D0 candidate
+
   using TracksPidAll = soa::Join<aod::pidTPCFullEl, aod::pidTPCFullMu, aod::pidTPCFullPi, aod::pidTPCFullKa, aod::pidTPCFullPr,
                                  aod::pidTOFFullEl, aod::pidTOFFullMu, aod::pidTOFFullPi, aod::pidTOFFullKa, aod::pidTOFFullPr>;
   using TracksPIDWithSel = soa::Join<aod::TracksWCovDcaExtra, TracksPidAll, aod::TrackSelection>;
@@ -168,14 +182,11 @@ struct HfDataCreatorD0PiReduced {
     invMass2D0PiMax = (massBplus + invMassWindowD0Pi) * (massBplus + invMassWindowD0Pi);
   }
 
-  /// Pion selection (D0 Pi <-- B+)
+  /// Pion selection (D0 Pi <-- B+), part independent of the D0 candidate
   /// \param trackPion is a track with the pion hypothesis
-  /// \param track0 is prong0 of selected D0 candidate
-  /// \param track1 is prong1 of selected D0 candidate
-  /// \param candD0 is the D0 candidate
   /// \return true if trackPion passes all cuts
-  template <typename T1, typename T2, typename T3>
-  bool isPionSelected(const T1& trackPion, const T2& track0, const T2& track1, const T3& candD0)
+  template <typename T1>
+  bool isPionSelected(const T1& trackPion)
   {
     // check isGlobalTrackWoDCA status for pions if wanted
     if (usePionIsGlobalTrackWoDCA && !trackPion.isGlobalTrackWoDCA()) {
@@ -185,19 +196,60 @@ struct HfDataCreatorD0PiReduced {
     if (trackPion.pt() < ptPionMin || !isSelectedTrackDCA(trackPion)) {
       return false;
     }
+    return true;
+  }
+
+  /// Pion selection (D0 Pi <-- B+), part depending on the D0 candidate
+  /// \param pion is a staged pion
+  /// \param track0 is prong0 of selected D0 candidate
+  /// \param track1 is prong1 of selected D0 candidate
+  /// \param candD0 is the D0 candidate
+  /// \return true if the pion can be paired with the D0 candidate
+  template <typename T2, typename T3>
+  bool isPionSelected(const StagedPion& pion, const T2& track0, const T2& track1, const T3& candD0)
+  {
     // reject pion not compatible with D0/D0bar hypothesis
-    if (!((candD0.isSelD0() >= selectionFlagD0 && trackPion.sign() < 0) || (candD0.isSelD0bar() >= selectionFlagD0bar && trackPion.sign() > 0))) {
-      // LOGF(debug, "D0: %d, D0bar%d, sign: %d", candD0.isSelD0(), candD0.isSelD0bar(), track.sign());
+    if (!((candD0.isSelD0() >= selectionFlagD0 && pion.sign < 0) || (candD0.isSelD0bar() >= selectionFlagD0bar && pion.sign > 0))) {
       return false;
     }
     // reject pions that are D daughters
-    if (trackPion.globalIndex() == track0.globalIndex() || trackPion.globalIndex() == track1.globalIndex()) {
+    if (pion.globalIndex == track0.globalIndex() || pion.globalIndex == track1.globalIndex()) {
       return false;
     }
-
     return true;
   }
 
+  /// Range of pion momentum for which the D0 Pi invariant mass can be in the B+ mass window.
+  /// At fixed pion momentum the invariant mass is extreme when the pion is parallel or antiparallel to the D0.
+  /// \param pVecD0 is the D0 momentum
+  /// \param pMin, pMax are the limits of the range, pMin > pMax if no pion is compatible
+  void getPionMomentumRange(const std::array<float, 3>& pVecD0, double& pMin, double& pMax)
+  {
+    const double pD = RecoDecay::p(pVecD0);
+    const double eD = RecoDecay::e(pD, massD0);
+    const double massProd = massD0 * massPi;
+    const double massD02 = massD0 * massD0;
+    // (m^2 - mD^2 - mPi^2) / 2 = eD * ePi - pD * pPi * cos(theta)
+    const double halfDiffMin = 0.5 * (invMass2D0PiMin - massD02 - massPi * massPi);
+    const double halfDiffMax = 0.5 * (invMass2D0PiMax - massD02 - massPi * massPi);
+    if (halfDiffMax < massProd) {
+      pMin = 1.;
+      pMax = 0.;
+      return;
+    }
+    // parallel pion: mass below the maximum
+    const double sqrtMax = std::sqrt(halfDiffMax * halfDiffMax - massProd * massProd);
+    pMin = (halfDiffMax * pD - eD * sqrtMax) / massD02;
+    pMax = (halfDiffMax * pD + eD * sqrtMax) / massD02;
+    // antiparallel pion: mass above the minimum
+    if (halfDiffMin > massProd) {
+      pMin = std::max(pMin, (eD * std::sqrt(halfDiffMin * halfDiffMin - massProd * massProd) - halfDiffMin * pD) / massD02);
+    }
+    // margin for the float precision of the momenta, the exact selection is applied on the pairs
+    pMin *= 0.999;
+    pMax *= 1.001;
+  }
+
   /// Single-track cuts for pions on dcaXY
   /// \param track is a track
   /// \return true if track passes all cuts
@@ -228,11 +280,21 @@ struct HfDataCreatorD0PiReduced {
   {
     // helpers for ReducedTables filling
     int indexHfReducedCollision = hfReducedCollision.lastIndex() + 1;
-    // std::map where the key is the track.globalIndex() and
-    // the value is the track index in the table of the selected pions
-    std::map<int64_t, int64_t> selectedTracksPion;
     bool fillHfReducedCollision = false;
 
+    // select the pion candidates of the collision once, sorted by momentum
+    stagedPions.clear();
+    int indexAssoc = 0;
+    for (const auto& trackId : trackIndices) {
+      auto trackPion = trackId.template track_as<T>();
+      if (isPionSelected(trackPion)) {
+        registry.fill(HIST("hPtPion"), trackPion.pt());
+        stagedPions.push_back({trackPion.p(), {trackPion.px(), trackPion.py(), trackPion.pz()}, trackPion.globalIndex(), static_cast<int8_t>(trackPion.sign()), indexAssoc, -1, -2});
+      }
+      indexAssoc++;
+    }
+    std::sort(stagedPions.begin(), stagedPions.end(), [](const StagedPion& pion1, const StagedPion& pion2) { return pion1.p < pion2.p; });
+
     auto primaryVertex = getPrimaryVertex(collision);
 
     // Set the magnetic field from ccdb.
@@ -303,24 +365,33 @@ struct HfDataCreatorD0PiReduced {
       std::array<float, 3> pVecD0 = RecoDecay::pVec(pVec0, pVec1);
       auto trackParCovD0 = o2::dataformats::V0(df2.getPCACandidatePos(), pVecD0, df2.calcPCACovMatrixFlat(), trackParCov0, trackParCov1);
 
-      for (const auto& trackId : trackIndices) {
-        auto trackPion = trackId.template track_as<T>();
-
-        // apply selections on pion tracks
-        if (!isPionSelected(trackPion, track0, track1, candD0) || !isSelectedTrackDCA(trackPion)) {
+      // pions compatible with the D0 candidate and in the invariant-mass window,
+      // among the ones with a momentum compatible with the window
+      double pPionMin, pPionMax;
+      getPionMomentumRange(pVecD0, pPionMin, pPionMax);
+      pionsInMassWindow.clear();
+      auto itPion = std::lower_bound(stagedPions.begin(), stagedPions.end(), pPionMin, [](const StagedPion& pion, double p) { return pion.p < p; });
+      for (; itPion != stagedPions.end() && itPion->p <= pPionMax; ++itPion) {
+        if (!isPionSelected(*itPion, track0, track1, candD0)) {
           continue;
         }
-        registry.fill(HIST("hPtPion"), trackPion.pt());
-        std::array<float, 3> pVecPion = {trackPion.px(), trackPion.py(), trackPion.pz()};
         // compute invariant mass square and apply selection
-        auto invMass2D0Pi = RecoDecay::m2(std::array{pVecD0, pVecPion}, std::array{massD0, massPi});
+        auto invMass2D0Pi = RecoDecay::m2(std::array{pVecD0, itPion->pVec}, std::array{massD0, massPi});
         if ((invMass2D0Pi < invMass2D0PiMin) || (invMass2D0Pi > invMass2D0PiMax)) {
           continue;
         }
+        pionsInMassWindow.push_back(itPion - stagedPions.begin());
+      }
+      // keep the order of the track associations in the output tables
+      std::sort(pionsInMassWindow.begin(), pionsInMassWindow.end(), [this](int i1, int i2) { return stagedPions[i1].indexAssoc < stagedPions[i2].indexAssoc; });
+
+      for (const auto iPion : pionsInMassWindow) {
+        auto& pion = stagedPions[iPion];
+        auto trackPion = tracks.rawIteratorAt(pion.globalIndex);
 
         // fill Pion tracks table
         // if information on track already stored, go to next track
-        if (!selectedTracksPion.count(trackPion.globalIndex())) {
+        if (pion.indexHfTrackPion < 0) {
           hfTrackPion(trackPion.globalIndex(), indexHfReducedCollision,
                       trackPion.x(), trackPion.alpha(),
                       trackPion.y(), trackPion.z(), trackPion.snp(),
@@ -333,10 +404,9 @@ struct HfDataCreatorD0PiReduced {
                          trackPion.c1PtTgl(), trackPion.c1Pt21Pt2());
           hfTrackPidPion(trackPion.hasTPC(), trackPion.hasTOF(),
                          trackPion.tpcNSigmaPi(), trackPion.tofNSigmaPi());
-          // add trackPion.globalIndex() to a list
-          // to keep memory of the pions filled in the table and avoid refilling them if they are paired to another D candidate
+          // keep memory of the pions filled in the table to avoid refilling them if they are paired to another D candidate
           // and keep track of their index in hfTrackPion for McRec purposes
-          selectedTracksPion[trackPion.globalIndex()] = hfTrackPion.lastIndex();
+          pion.indexHfTrackPion = hfTrackPion.lastIndex();
         }
 
         if constexpr (doMc) {
@@ -358,10 +428,12 @@ struct HfDataCreatorD0PiReduced {
               LOGF(info, "WARNING: B+ decays in the expected final state but the condition on the intermediate state is not fulfilled");
             }
           }
-          auto indexMother = RecoDecay::getMother(particlesMc, trackPion.template mcParticle_as<P>(), pdg::Code::kBPlus, true);
-          auto particleMother = particlesMc.rawIteratorAt(indexMother);
+          if (pion.indexMother == -2) {
+            pion.indexMother = RecoDecay::getMother(particlesMc, trackPion.template mcParticle_as<P>(), pdg::Code::kBPlus, true);
+          }
+          auto particleMother = particlesMc.rawIteratorAt(pion.indexMother);
 
-          rowHfD0PiMcRecReduced(indexHfCand2Prong, selectedTracksPion[trackPion.globalIndex()], flag, particleMother.pt());
+          rowHfD0PiMcRecReduced(indexHfCand2Prong, pion.indexHfTrackPion, flag, particleMother.pt());
         }
         fillHfCand2Prong = true;
       }                       // pion loop
@@ -15,7 +15,8 @@
 /// \author Alexandre Bigot <alexandre.bigot@cern.ch>, IPHC Strasbourg
 /// \author Fabrizio Grosa <fabrizio.grosa@cern.ch>, CERN
 
-#include <map>
+#include <algorithm>
+#include <vector>
 
 #include "DCAFitter/DCAFitterN.h"
 #include "Framework/AnalysisTask.h"
@@ -109,6 +110,19 @@ struct HfDataCreatorDplusPiReduced {
   // Fitter to redo D-vertex to get extrapolated daughter tracks (3-prong vertex filter)
   o2::vertexing::DCAFitterN<3> df3;
 
+  // pion candidates of the collision, passing the selections that do not depend on the D candidate
+  struct StagedPion {
+    float p;                   // momentum, the pions are sorted by it
+    std::array<float, 3> pVec; // momentum vector
+    int64_t globalIndex;       // global index of the track
+    int8_t sign;               // charge sign
+    int indexAssoc;            // position in the track associations of the collision
+    int64_t indexHfTrackPion;  // row in the pion table, -1 if not filled yet
+    int indexMother;           // index of the B0 mother for the MC matching, -2 if not searched yet
+  };
+  std::vector<StagedPion> stagedPions;
+  std::vector<int> pionsInMassWindow; // positions in stagedPions of the pions paired with a D candidate
+
   using TracksPidAll = soa::Join<aod::pidTPCFullEl, aod::pidTPCFullMu, aod::pidTPCFullPi, aod::pidTPCFullKa, aod::pidTPCFullPr,
                                  aod::pidTOFFullEl, aod::pidTOFFullMu, aod::pidTOFFullPi, aod::pidTOFFullKa, aod::pidTOFFullPr>;
   using TracksPIDWithSel = soa::Join<aod::TracksWCovDcaExtra, TracksPidAll, aod::TrackSelection>;
@@ -167,14 +181,11 @@ struct HfDataCreatorDplusPiReduced {
     invMass2DPiMax = (massB0 + invMassWindowDPi) * (massB0 + invMassWindowDPi);
   }
 
-  /// Pion selection (D Pi <-- B0)
+  /// Pion selection (D Pi <-- B0), part independent of the D candidate
   /// \param trackPion is a track with the pion hypothesis
-  /// \param track0 is prong0 of selected D candidate
-  /// \param track1 is prong1 of selected D candidate
-  /// \param track2 is prong2 of selected D candidate
   /// \return true if trackPion passes all cuts
-  template <typename T1, typename T2>
-  bool isPionSelected(const T1& trackPion, const T2& track0, const T2& track1, const T2& track2)
+  template <typename T1>
+  bool isPionSelected(const T1& trackPion)
   {
     // check isGlobalTrackWoDCA status for pions if wanted
     if (usePionIsGlobalTrackWoDCA && !trackPion.isGlobalTrackWoDCA()) {
@@ -184,17 +195,60 @@ struct HfDataCreatorDplusPiReduced {
     if (trackPion.pt() < ptPionMin || !isSelectedTrackDCA(trackPion)) {
       return false;
     }
+    return true;
+  }
+
+  /// Pion selection (D Pi <-- B0), part depending on the D candidate
+  /// \param pion is a staged pion
+  /// \param track0 is prong0 of selected D candidate
+  /// \param track1 is prong1 of selected D candidate
+  /// \param track2 is prong2 of selected D candidate
+  /// \return true if the pion can be paired with the D candidate
+  template <typename T2>
+  bool isPionSelected(const StagedPion& pion, const T2& track0, const T2& track1, const T2& track2)
+  {
     // reject pions that are D daughters
-    if (trackPion.globalIndex() == track0.globalIndex() || trackPion.globalIndex() == track1.globalIndex() || trackPion.globalIndex() == track2.globalIndex()) {
+    if (pion.globalIndex == track0.globalIndex() || pion.globalIndex == track1.globalIndex() || pion.globalIndex == track2.globalIndex()) {
       return false;
     }
     // reject pi D with same sign as D
-    if (trackPion.sign() * track0.sign() > 0) {
+    if (pion.sign * track0.sign() > 0) {
       return false;
     }
     return true;
   }
 
+  /// Range of pion momentum for which the D Pi invariant mass can be in the B0 mass window.
+  /// At fixed pion momentum the invariant mass is extreme when the pion is parallel or antiparallel to the D.
+  /// \param pVecD is the D momentum
+  /// \param pMin, pMax are the limits of the range, pMin > pMax if no pion is compatible
+  void getPionMomentumRange(const std::array<float, 3>& pVecD, double& pMin, double& pMax)
+  {
+    const double pD = RecoDecay::p(pVecD);
+    const double eD = RecoDecay::e(pD, massD);
+    const double massProd = massD * massPi;
+    const double massD2 = massD * massD;
+    // (m^2 - mD^2 - mPi^2) / 2 = eD * ePi - pD * pPi * cos(theta)
+    const double halfDiffMin = 0.5 * (invMass2DPiMin - massD2 - massPi * massPi);
+    const double halfDiffMax = 0.5 * (invMass2DPiMax - massD2 - massPi * massPi);
+    if (halfDiffMax < massProd) {
+      pMin = 1.;
+      pMax = 0.;
+      return;
+    }
+    // parallel pion: mass below the maximum
+    const double sqrtMax = std::sqrt(halfDiffMax * halfDiffMax - massProd * massProd);
+    pMin = (halfDiffMax * pD - eD * sqrtMax) / massD2;
+    pMax = (halfDiffMax * pD + eD * sqrtMax) / massD2;
+    // antiparallel pion: mass above the minimum
+    if (halfDiffMin > massProd) {
+      pMin = std::max(pMin, (eD * std::sqrt(halfDiffMin * halfDiffMin - massProd * massProd) - halfDiffMin * pD) / massD2);
+    }
+    // margin for the float precision of the momenta, the exact selection is applied on the pairs
+    pMin *= 0.999;
+    pMax *= 1.001;
+  }
+
   /// Single-track cuts for pions on dcaXY
   /// \param track is a track
   /// \return true if track passes all cuts
@@ -225,11 +279,21 @@ struct HfDataCreatorDplusPiReduced {
   {
     // helpers for ReducedTables filling
     int indexHfReducedCollision = hfReducedCollision.lastIndex() + 1;
-    // std::map where the key is the track.globalIndex() and
-    // the value is the track index in the table of the selected pions
-    std::map<int64_t, int64_t> selectedTracksPion;
     bool fillHfReducedCollision = false;
 
+    // select the pion candidates of the collision once, sorted by momentum
+    stagedPions.clear();
+    int indexAssoc = 0;
+    for (const auto& trackId : trackIndices) {
+      auto trackPion = trackId.template track_as<T>();
+      if (isPionSelected(trackPion)) {
+        registry.fill(HIST("hPtPion"), trackPion.pt());
+        stagedPions.push_back({trackPion.p(), {trackPion.px(), trackPion.py(), trackPion.pz()}, trackPion.globalIndex(), static_cast<int8_t>(trackPion.sign()), indexAssoc, -1, -2});
+      }
+      indexAssoc++;
+    }
+    std::sort(stagedPions.begin(), stagedPions.end(), [](const StagedPion& pion1, const StagedPion& pion2) { return pion1.p < pion2.p; });
+
     auto primaryVertex = getPrimaryVertex(collision);
 
     // Set the magnetic field from ccdb.
@@ -306,24 +370,33 @@ struct HfDataCreatorDplusPiReduced {
       auto trackParCovPiK = o2::dataformats::V0(df3.getPCACandidatePos(), pVecPiK, df3.calcPCACovMatrixFlat(), trackParCov0, trackParCov1);
       auto trackParCovD = o2::dataformats::V0(df3.getPCACandidatePos(), pVecD, df3.calcPCACovMatrixFlat(), trackParCovPiK, trackParCov2);
 
-      for (const auto& trackId : trackIndices) {
-        auto trackPion = trackId.template track_as<T>();
-
-        // apply selections on pion tracks
-        if (!isPionSelected(trackPion, track0, track1, track2) || !isSelectedTrackDCA(trackPion)) {
+      // pions compatible with the D candidate and in the invariant-mass window,
+      // among the ones with a momentum compatible with the window
+      double pPionMin, pPionMax;
+      getPionMomentumRange(pVecD, pPionMin, pPionMax);
+      pionsInMassWindow.clear();
+      auto itPion = std::lower_bound(stagedPions.begin(), stagedPions.end(), pPionMin, [](const StagedPion& pion, double p) { return pion.p < p; });
+      for (; itPion != stagedPions.end() && itPion->p <= pPionMax; ++itPion) {
+        if (!isPionSelected(*itPion, track0, track1, track2)) {
           continue;
         }
-        registry.fill(HIST("hPtPion"), trackPion.pt());
-        std::array<float, 3> pVecPion = {trackPion.px(), trackPion.py(), trackPion.pz()};
         // compute invariant mass square and apply selection
-        auto invMass2DPi = RecoDecay::m2(std::array{pVecD, pVecPion}, std::array{massD, massPi});
+        auto invMass2DPi = RecoDecay::m2(std::array{pVecD, itPion->pVec}, std::array{massD, massPi});
         if ((invMass2DPi < invMass2DPiMin) || (invMass2DPi > invMass2DPiMax)) {
           continue;
         }
+        pionsInMassWindow.push_back(itPion - stagedPions.begin());
+      }
+      // keep the order of the track associations in the output tables
+      std::sort(pionsInMassWindow.begin(), pionsInMassWindow.end(), [this](int i1, int i2) { return stagedPions[i1].indexAssoc < stagedPions[i2].indexAssoc; });
+
+      for (const auto iPion : pionsInMassWindow) {
+        auto& pion = stagedPions[iPion];
+        auto trackPion = tracks.rawIteratorAt(pion.globalIndex);
 
         // fill Pion tracks table
         // if information on track already stored, go to next track
-        if (!selectedTracksPion.count(trackPion.globalIndex())) {
+        if (pion.indexHfTrackPion < 0) {
           hfTrackPion(trackPion.globalIndex(), indexHfReducedCollision,
                       trackPion.x(), trackPion.alpha(),
                       trackPion.y(), trackPion.z(), trackPion.snp(),
@@ -336,10 +409,9 @@ struct HfDataCreatorDplusPiReduced {
                          trackPion.c1PtTgl(), trackPion.c1Pt21Pt2());
           hfTrackPidPion(trackPion.hasTPC(), trackPion.hasTOF(),
                          trackPion.tpcNSigmaPi(), trackPion.tofNSigmaPi());
-          // add trackPion.globalIndex() to a list
-          // to keep memory of the pions filled in the table and avoid refilling them if they are paired to another D candidate
+          // keep memory of the pions filled in the table to avoid refilling them if they are paired to another D candidate
           // and keep track of their index in hfTrackPion for McRec purposes
-          selectedTracksPion[trackPion.globalIndex()] = hfTrackPion.lastIndex();
+          pion.indexHfTrackPion = hfTrackPion.lastIndex();
         }
 
         if constexpr (doMc) {
@@ -362,9 +434,11 @@ struct HfDataCreatorDplusPiReduced {
               LOGF(debug, "B0 decays in the expected final state but the condition on the intermediate state is not fulfilled");
             }
           }
-          auto indexMother = RecoDecay::getMother(particlesMc, trackPion.template mcParticle_as<P>(), pdg::Code::kB0, true);
-          auto particleMother = particlesMc.rawIteratorAt(indexMother);
-          rowHfDPiMcRecReduced(indexHfCand3Prong, selectedTracksPion[trackPion.globalIndex()], flag, debug, particleMother.pt());
+          if (pion.indexMother == -2) {
+            pion.indexMother = RecoDecay::getMother(particlesMc, trackPion.template mcParticle_as<P>(), pdg::Code::kB0, true);
+          }
+          auto particleMother = particlesMc.rawIteratorAt(pion.indexMother);
+          rowHfDPiMcRecReduced(indexHfCand3Prong, pion.indexHfTrackPion, flag, debug, particleMother.pt());
         }
         fillHfCand3Prong = true;
       }                       // pion loop
@@ -350,6 +350,64 @@ DECLARE_SOA_TABLE(HfPvRefitDstar, "AOD", "HFPVREFITDSTAR", //!
                   hf_pv_refit::PvRefitSigmaZ2,
                   o2::soa::Marker<2>);
 
+// secondary-vertex fits of the skim, to be reused by the candidate creators
+// (impact parameters w.r.t. the primary vertex used in the skim, refitted or not)
+namespace hf_sv_fit
+{
+DECLARE_SOA_COLUMN(XSecondaryVertex, xSecondaryVertex, float);               //!
+DECLARE_SOA_COLUMN(YSecondaryVertex, ySecondaryVertex, float);               //!
+DECLARE_SOA_COLUMN(ZSecondaryVertex, zSecondaryVertex, float);               //!
+DECLARE_SOA_COLUMN(CovSvXX, covSvXX, float);                                 //!
+DECLARE_SOA_COLUMN(CovSvXY, covSvXY, float);                                 //!
+DECLARE_SOA_COLUMN(CovSvYY, covSvYY, float);                                 //!
+DECLARE_SOA_COLUMN(CovSvXZ, covSvXZ, float);                                 //!
+DECLARE_SOA_COLUMN(CovSvYZ, covSvYZ, float);                                 //!
+DECLARE_SOA_COLUMN(CovSvZZ, covSvZZ, float);                                 //!
+DECLARE_SOA_COLUMN(Chi2PCA, chi2PCA, float);                                 //! sum of (non-weighted) distances of the secondary vertex to its prongs
+DECLARE_SOA_COLUMN(PxProng0, pxProng0, float);                               //! prong momenta at the secondary vertex
+DECLARE_SOA_COLUMN(PyProng0, pyProng0, float);                               //!
+DECLARE_SOA_COLUMN(PzProng0, pzProng0, float);                               //!
+DECLARE_SOA_COLUMN(PxProng1, pxProng1, float);                               //!
+DECLARE_SOA_COLUMN(PyProng1, pyProng1, float);                               //!
+DECLARE_SOA_COLUMN(PzProng1, pzProng1, float);                               //!
+DECLARE_SOA_COLUMN(PxProng2, pxProng2, float);                               //!
+DECLARE_SOA_COLUMN(PyProng2, pyProng2, float);                               //!
+DECLARE_SOA_COLUMN(PzProng2, pzProng2, float);                               //!
+DECLARE_SOA_COLUMN(ImpactParameter0, impactParameter0, float);               //!
+DECLARE_SOA_COLUMN(ImpactParameter1, impactParameter1, float);               //!
+DECLARE_SOA_COLUMN(ImpactParameter2, impactParameter2, float);               //!
+DECLARE_SOA_COLUMN(ImpactParameterSigmaY20, impactParameterSigmaY20, float); //!
+DECLARE_SOA_COLUMN(ImpactParameterSigmaY21, impactParameterSigmaY21, float); //!
+DECLARE_SOA_COLUMN(ImpactParameterSigmaY22, impactParameterSigmaY22, float); //!
+DECLARE_SOA_COLUMN(ImpactParameterZ0, impactParameterZ0, float);             //!
+DECLARE_SOA_COLUMN(ImpactParameterZ1, impactParameterZ1, float);             //!
+DECLARE_SOA_COLUMN(ImpactParameterZ2, impactParameterZ2, float);             //!
+DECLARE_SOA_COLUMN(FitConfigHash, fitConfigHash, uint32_t);                  //! hash of the vertexing configuration, 0 if the fit cannot be reused
+} // namespace hf_sv_fit
+
+DECLARE_SOA_TABLE(HfSvFit2Prong, "AOD", "HFSVFIT2PRONG", //!
+                  hf_sv_fit::XSecondaryVertex, hf_sv_fit::YSecondaryVertex, hf_sv_fit::ZSecondaryVertex,
+                  hf_sv_fit::CovSvXX, hf_sv_fit::CovSvXY, hf_sv_fit::CovSvYY, hf_sv_fit::CovSvXZ, hf_sv_fit::CovSvYZ, hf_sv_fit::CovSvZZ,
+                  hf_sv_fit::Chi2PCA,
+                  hf_sv_fit::PxProng0, hf_sv_fit::PyProng0, hf_sv_fit::PzProng0,
+                  hf_sv_fit::PxProng1, hf_sv_fit::PyProng1, hf_sv_fit::PzProng1,
+                  hf_sv_fit::ImpactParameter0, hf_sv_fit::ImpactParameter1,
+                  hf_sv_fit::ImpactParameterSigmaY20, hf_sv_fit::ImpactParameterSigmaY21,
+                  hf_sv_fit::ImpactParameterZ0, hf_sv_fit::ImpactParameterZ1,
+                  hf_sv_fit::FitConfigHash);
+
+DECLARE_SOA_TABLE(HfSvFit3Prong, "AOD", "HFSVFIT3PRONG", //!
+                  hf_sv_fit::XSecondaryVertex, hf_sv_fit::YSecondaryVertex, hf_sv_fit::ZSecondaryVertex,
+                  hf_sv_fit::CovSvXX, hf_sv_fit::CovSvXY, hf_sv_fit::CovSvYY, hf_sv_fit::CovSvXZ, hf_sv_fit::CovSvYZ, hf_sv_fit::CovSvZZ,
+                  hf_sv_fit::Chi2PCA,
+                  hf_sv_fit::PxProng0, hf_sv_fit::PyProng0, hf_sv_fit::PzProng0,
+                  hf_sv_fit::PxProng1, hf_sv_fit::PyProng1, hf_sv_fit::PzProng1,
+                  hf_sv_fit::PxProng2, hf_sv_fit::PyProng2, hf_sv_fit::PzProng2,
+                  hf_sv_fit::ImpactParameter0, hf_sv_fit::ImpactParameter1, hf_sv_fit::ImpactParameter2,
+                  hf_sv_fit::ImpactParameterSigmaY20, hf_sv_fit::ImpactParameterSigmaY21, hf_sv_fit::ImpactParameterSigmaY22,
+                  hf_sv_fit::ImpactParameterZ0, hf_sv_fit::ImpactParameterZ1, hf_sv_fit::ImpactParameterZ2,
+                  hf_sv_fit::FitConfigHash);
+
 // general decay properties
 namespace hf_cand
 {
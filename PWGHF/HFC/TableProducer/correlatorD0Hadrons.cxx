@@ -28,6 +28,7 @@
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "PWGHF/DataModel/CandidateSelectionTables.h"
 #include "PWGHF/HFC/DataModel/CorrelationTables.h"
+#include "PWGHF/HFC/Utils/utilsCorrelations.h"
 
 using namespace o2;
 using namespace o2::analysis;
@@ -189,6 +190,7 @@ struct HfCorrelatorD0Hadrons {
   double massPi{0.};
   double massK{0.};
   double softPiMass = 0.14543; // pion mass + Q-value of the D*->D0pi decay
+  hf_correlations::AssociatedTracks associatedTracks; // associated tracks of the collision, reused by all D0 candidates
 
   Preslice<aod::HfCand2Prong> perCol = aod::hf_cand::collisionId;
 
@@ -262,6 +264,30 @@ struct HfCorrelatorD0Hadrons {
     registry.add("hCountD0TriggersGen", "D0 trigger particles - MC gen;;N of trigger D0", {HistType::kTH2F, {{1, -0.5, 0.5}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
   }
 
+  /// Fills the buffer of associated tracks of the collision and counts the tracks for the multiplicity selection
+  /// \param applyKinematicCuts  whether the eta and pT cuts are applied to the associated tracks
+  /// \return number of tracks for the multiplicity selection
+  template <typename TCollision, typename TTracks>
+  int stageAssociatedTracks(TCollision const& collision, TTracks const& tracks, bool applyKinematicCuts)
+  {
+    associatedTracks.clear();
+    int nTracks = 0;
+    const bool countTracks = collision.numContrib() > 1;
+    for (const auto& track : tracks) {
+      if (countTracks && std::abs(track.eta()) <= etaTrackMax && std::abs(track.dcaXY()) <= dcaXYTrackMax && std::abs(track.dcaZ()) <= dcaZTrackMax) {
+        nTracks++;
+      }
+      if (applyKinematicCuts && (std::abs(track.eta()) > etaTrackMax || track.pt() < ptTrackMin)) {
+        continue;
+      }
+      if (std::abs(track.dcaXY()) >= 1. || std::abs(track.dcaZ()) >= 1.) {
+        continue; // Remove secondary tracks
+      }
+      associatedTracks.add(track, massPi);
+    }
+    return nTracks;
+  }
+
   // =======  Process starts for Data, Same event ============
 
   /// D0-h correlation pair builder - for real data and data-like analysis (i.e. reco-level w/o matching request via MC truth)
@@ -274,18 +300,7 @@ struct HfCorrelatorD0Hadrons {
       return;
     }
     int poolBin = corrBinning.getBin(std::make_tuple(collision.posZ(), collision.multFV0M()));
-    int nTracks = 0;
-    if (collision.numContrib() > 1) {
-      for (const auto& track : tracks) {
-        if (std::abs(track.eta()) > etaTrackMax) {
-          continue;
-        }
-        if (std::abs(track.dcaXY()) > dcaXYTrackMax || std::abs(track.dcaZ()) > dcaZTrackMax) {
-          continue;
-        }
-        nTracks++;
-      }
-    }
+    int nTracks = stageAssociatedTracks(collision, tracks, false);
     registry.fill(HIST("hMultiplicityPreSelection"), nTracks);
     if (nTracks < multMin || nTracks > multMax) {
       return;
@@ -337,36 +352,42 @@ struct HfCorrelatorD0Hadrons {
       registry.fill(HIST("hD0Bin"), poolBin);
 
       // ============ D-h correlation dedicated section ==================================
+      const bool isSelD0 = candidate1.isSelD0() >= selectionFlagD0;
+      const bool isSelD0bar = candidate1.isSelD0bar() >= selectionFlagD0bar;
+      const auto invMassD0 = hfHelper.invMassD0ToPiK(candidate1);
+      const auto invMassD0bar = hfHelper.invMassD0barToKPi(candidate1);
+      const auto prong0Id = candidate1.prong0Id(), prong1Id = candidate1.prong1Id();
+      const auto pxCand = candidate1.px(), pyCand = candidate1.py(), pzCand = candidate1.pz();
+      const auto ptCand = candidate1.pt(), etaCand = candidate1.eta(), phiCand = candidate1.phi();
 
       // ========================== track loop starts here ================================
-      for (const auto& track : tracks) {
-        registry.fill(HIST("hTrackCounter"), 1); // fill total no. of tracks
+      for (int64_t iTrack = 0; iTrack < tracks.size(); ++iTrack) {
+        registry.fill(HIST("hTrackCounter"), 1); // fill total no. of tracks, once per track as the entries and errors depend on it
+      }
+      for (std::size_t iTrack = 0; iTrack < associatedTracks.size(); ++iTrack) {
         // Remove D0 daughters by checking track indices
-        if ((candidate1.prong0Id() == track.globalIndex()) || (candidate1.prong1Id() == track.globalIndex())) {
+        if ((prong0Id == associatedTracks.globalIndex[iTrack]) || (prong1Id == associatedTracks.globalIndex[iTrack])) {
           continue;
         }
-        if (std::abs(track.dcaXY()) >= 1. || std::abs(track.dcaZ()) >= 1.)
-          continue; // Remove secondary tracks
-
         registry.fill(HIST("hTrackCounter"), 2); // fill no. of tracks before soft pion removal
 
         // ========== soft pion removal ===================================================
         double invMassDstar1 = 0., invMassDstar2 = 0.;
         bool isSoftPiD0 = false, isSoftPiD0bar = false;
-        auto pSum2 = RecoDecay::p2(candidate1.px() + track.px(), candidate1.py() + track.py(), candidate1.pz() + track.pz());
-        auto ePion = track.energy(massPi);
+        auto pSum2 = RecoDecay::p2(pxCand + associatedTracks.px[iTrack], pyCand + associatedTracks.py[iTrack], pzCand + associatedTracks.pz[iTrack]);
+        auto ePion = associatedTracks.energy[iTrack];
         invMassDstar1 = std::sqrt((ePiK + ePion) * (ePiK + ePion) - pSum2);
         invMassDstar2 = std::sqrt((eKPi + ePion) * (eKPi + ePion) - pSum2);
 
-        if (candidate1.isSelD0() >= selectionFlagD0) {
-          if ((std::abs(invMassDstar1 - hfHelper.invMassD0ToPiK(candidate1)) - softPiMass) < ptSoftPionMax) {
+        if (isSelD0) {
+          if ((std::abs(invMassDstar1 - invMassD0) - softPiMass) < ptSoftPionMax) {
             isSoftPiD0 = true;
             continue;
           }
         }
 
-        if (candidate1.isSelD0bar() >= selectionFlagD0bar) {
-          if ((std::abs(invMassDstar2 - hfHelper.invMassD0barToKPi(candidate1)) - softPiMass) < ptSoftPionMax) {
+        if (isSelD0bar) {
+          if ((std::abs(invMassDstar2 - invMassD0bar) - softPiMass) < ptSoftPionMax) {
             isSoftPiD0bar = true;
             continue;
           }
@@ -374,19 +395,19 @@ struct HfCorrelatorD0Hadrons {
         registry.fill(HIST("hTrackCounter"), 3); // fill no. of tracks after soft pion removal
 
         int signalStatus = 0;
-        if ((candidate1.isSelD0() >= selectionFlagD0) && !isSoftPiD0) {
+        if (isSelD0 && !isSoftPiD0) {
           signalStatus += aod::hf_correlation_d0_hadron::ParticleTypeData::D0Only;
         }
-        if ((candidate1.isSelD0bar() >= selectionFlagD0bar) && !isSoftPiD0bar) {
+        if (isSelD0bar && !isSoftPiD0bar) {
           signalStatus += aod::hf_correlation_d0_hadron::ParticleTypeData::D0barOnly;
         }
 
-        entryD0HadronPair(getDeltaPhi(track.phi(), candidate1.phi()),
-                          track.eta() - candidate1.eta(),
-                          candidate1.pt(),
-                          track.pt(),
+        entryD0HadronPair(getDeltaPhi(associatedTracks.phi[iTrack], phiCand),
+                          associatedTracks.eta[iTrack] - etaCand,
+                          ptCand,
+                          associatedTracks.pt[iTrack],
                           poolBin);
-        entryD0HadronRecoInfo(hfHelper.invMassD0ToPiK(candidate1), hfHelper.invMassD0barToKPi(candidate1), signalStatus);
+        entryD0HadronRecoInfo(invMassD0, invMassD0bar, signalStatus);
 
       } // end inner loop (tracks)
 
@@ -405,18 +426,7 @@ struct HfCorrelatorD0Hadrons {
       return;
     }
     int poolBin = corrBinning.getBin(std::make_tuple(collision.posZ(), collision.multFV0M()));
-    int nTracks = 0;
-    if (collision.numContrib() > 1) {
-      for (const auto& track : tracks) {
-        if (std::abs(track.eta()) > etaTrackMax) {
-          continue;
-        }
-        if (std::abs(track.dcaXY()) > dcaXYTrackMax || std::abs(track.dcaZ()) > dcaZTrackMax) {
-          continue;
-        }
-        nTracks++;
-      }
-    }
+    int nTracks = stageAssociatedTracks(collision, tracks, true);
     registry.fill(HIST("hMultiplicityPreSelection"), nTracks);
     if (nTracks < multMin || nTracks > multMax) {
       return;
@@ -484,42 +494,43 @@ struct HfCorrelatorD0Hadrons {
       flagD0 = candidate1.flagMcMatchRec() == (1 << aod::hf_cand_2prong::DecayType::D0ToPiK);     // flagD0Signal 'true' if candidate1 matched to D0 (particle)
       flagD0bar = candidate1.flagMcMatchRec() == -(1 << aod::hf_cand_2prong::DecayType::D0ToPiK); // flagD0Reflection 'true' if candidate1, selected as D0 (particle), is matched to D0bar (antiparticle)
 
+      const bool isSelD0 = candidate1.isSelD0() >= selectionFlagD0;
+      const bool isSelD0bar = candidate1.isSelD0bar() >= selectionFlagD0bar;
+      const auto invMassD0 = hfHelper.invMassD0ToPiK(candidate1);
+      const auto invMassD0bar = hfHelper.invMassD0barToKPi(candidate1);
+      const auto prong0Id = candidate1.prong0Id(), prong1Id = candidate1.prong1Id();
+      const auto pxCand = candidate1.px(), pyCand = candidate1.py(), pzCand = candidate1.pz();
+      const auto ptCand = candidate1.pt(), etaCand = candidate1.eta(), phiCand = candidate1.phi();
+
       // ========== track loop starts here ========================
 
-      for (const auto& track : tracks) {
-        registry.fill(HIST("hTrackCounterRec"), 1); // fill total no. of tracks
-        if (std::abs(track.eta()) > etaTrackMax) {
-          continue;
-        }
-        if (track.pt() < ptTrackMin) {
-          continue;
-        }
+      for (int64_t iTrack = 0; iTrack < tracks.size(); ++iTrack) {
+        registry.fill(HIST("hTrackCounterRec"), 1); // fill total no. of tracks, once per track as the entries and errors depend on it
+      }
+      for (std::size_t iTrack = 0; iTrack < associatedTracks.size(); ++iTrack) {
         // Removing D0 daughters by checking track indices
-        if ((candidate1.prong0Id() == track.globalIndex()) || (candidate1.prong1Id() == track.globalIndex())) {
+        if ((prong0Id == associatedTracks.globalIndex[iTrack]) || (prong1Id == associatedTracks.globalIndex[iTrack])) {
           continue;
         }
-        if (std::abs(track.dcaXY()) >= 1. || std::abs(track.dcaZ()) >= 1.) {
-          continue; // Remove secondary tracks
-        }
         registry.fill(HIST("hTrackCounterRec"), 2); // fill no. of tracks before soft pion removal
 
         // ===== soft pion removal ===================================================
         double invMassDstar1 = 0, invMassDstar2 = 0;
         bool isSoftPiD0 = false, isSoftPiD0bar = false;
-        auto pSum2 = RecoDecay::p2(candidate1.px() + track.px(), candidate1.py() + track.py(), candidate1.pz() + track.pz());
-        auto ePion = track.energy(massPi);
+        auto pSum2 = RecoDecay::p2(pxCand + associatedTracks.px[iTrack], pyCand + associatedTracks.py[iTrack], pzCand + associatedTracks.pz[iTrack]);
+        auto ePion = associatedTracks.energy[iTrack];
         invMassDstar1 = std::sqrt((ePiK + ePion) * (ePiK + ePion) - pSum2);
         invMassDstar2 = std::sqrt((eKPi + ePion) * (eKPi + ePion) - pSum2);
 
-        if (candidate1.isSelD0() >= selectionFlagD0) {
-          if ((std::abs(invMassDstar1 - hfHelper.invMassD0ToPiK(candidate1)) - softPiMass) < ptSoftPionMax) {
+        if (isSelD0) {
+          if ((std::abs(invMassDstar1 - invMassD0) - softPiMass) < ptSoftPionMax) {
             isSoftPiD0 = true;
             continue;
           }
         }
 
-        if (candidate1.isSelD0bar() >= selectionFlagD0bar) {
-          if ((std::abs(invMassDstar2 - hfHelper.invMassD0barToKPi(candidate1)) - softPiMass) < ptSoftPionMax) {
+        if (isSelD0bar) {
+          if ((std::abs(invMassDstar2 - invMassD0bar) - softPiMass) < ptSoftPionMax) {
             isSoftPiD0bar = true;
             continue;
           }
@@ -528,32 +539,32 @@ struct HfCorrelatorD0Hadrons {
         registry.fill(HIST("hTrackCounterRec"), 3); // fill no. of tracks after soft pion removal
 
         int signalStatus = 0;
-        if (flagD0 && (candidate1.isSelD0() >= selectionFlagD0) && !isSoftPiD0) {
+        if (flagD0 && isSelD0 && !isSoftPiD0) {
           SETBIT(signalStatus, aod::hf_correlation_d0_hadron::ParticleTypeMcRec::D0Sig);
         } // signal case D0
-        if (flagD0bar && (candidate1.isSelD0() >= selectionFlagD0) && !isSoftPiD0) {
+        if (flagD0bar && isSelD0 && !isSoftPiD0) {
           SETBIT(signalStatus, aod::hf_correlation_d0_hadron::ParticleTypeMcRec::D0Ref);
         } // reflection case D0
-        if (!flagD0 && !flagD0bar && (candidate1.isSelD0() >= selectionFlagD0) && !isSoftPiD0) {
+        if (!flagD0 && !flagD0bar && isSelD0 && !isSoftPiD0) {
           SETBIT(signalStatus, aod::hf_correlation_d0_hadron::ParticleTypeMcRec::D0Bg);
         } // background case D0
 
-        if (flagD0bar && (candidate1.isSelD0bar() >= selectionFlagD0bar) && !isSoftPiD0bar) {
+        if (flagD0bar && isSelD0bar && !isSoftPiD0bar) {
           SETBIT(signalStatus, aod::hf_correlation_d0_hadron::ParticleTypeMcRec::D0barSig);
         } // signal case D0bar
-        if (flagD0 && (candidate1.isSelD0bar() >= selectionFlagD0bar) && !isSoftPiD0bar) {
+        if (flagD0 && isSelD0bar && !isSoftPiD0bar) {
           SETBIT(signalStatus, aod::hf_correlation_d0_hadron::ParticleTypeMcRec::D0barRef);
         } // reflection case D0bar
-        if (!flagD0 && !flagD0bar && (candidate1.isSelD0bar() >= selectionFlagD0bar) && !isSoftPiD0bar) {
+        if (!flagD0 && !flagD0bar && isSelD0bar && !isSoftPiD0bar) {
           SETBIT(signalStatus, aod::hf_correlation_d0_hadron::ParticleTypeMcRec::D0barBg);
         } // background case D0bar
 
-        entryD0HadronPair(getDeltaPhi(track.phi(), candidate1.phi()),
-                          track.eta() - candidate1.eta(),
-                          candidate1.pt(),
-                          track.pt(),
+        entryD0HadronPair(getDeltaPhi(associatedTracks.phi[iTrack], phiCand),
+                          associatedTracks.eta[iTrack] - etaCand,
+                          ptCand,
+                          associatedTracks.pt[iTrack],
                           poolBin);
-        entryD0HadronRecoInfo(hfHelper.invMassD0ToPiK(candidate1), hfHelper.invMassD0barToKPi(candidate1), signalStatus);
+        entryD0HadronRecoInfo(invMassD0, invMassD0bar, signalStatus);
       } // end inner loop (Tracks)
     }   // end of outer loop (D0)
     registry.fill(HIST("hZvtx"), collision.posZ());
@@ -650,10 +661,12 @@ struct HfCorrelatorD0Hadrons {
     auto tracksTuple = std::make_tuple(candidates, tracks);
     Pair<SelectedCollisions, SelectedCandidatesData, SelectedTracks, BinningType> pairData{corrBinning, 5, -1, collisions, tracksTuple, &cache};
 
+    associatedTracks.clear();
     for (const auto& [c1, tracks1, c2, tracks2] : pairData) {
       // LOGF(info, "Mixed event collisions: Index = (%d, %d), tracks Size: (%d, %d), Z Vertex: (%f, %f), Pool Bin: (%d, %d)", c1.globalIndex(), c2.globalIndex(), tracks1.size(), tracks2.size(), c1.posZ(), c2.posZ(), corrBinning.getBin(std::make_tuple(c1.posZ(), c1.multFV0M())),corrBinning.getBin(std::make_tuple(c2.posZ(), c2.multFV0M()))); // For debug
       int poolBin = corrBinning.getBin(std::make_tuple(c2.posZ(), c2.multFV0M()));
-      for (const auto& [t1, t2] : o2::soa::combinations(o2::soa::CombinationsFullIndexPolicy(tracks1, tracks2))) {
+      associatedTracks.stageMixedEventTracks(c2.globalIndex(), tracks2, massPi);
+      for (const auto& t1 : tracks1) {
 
         if (yCandMax >= 0. && std::abs(hfHelper.yD0(t1)) > yCandMax) {
           continue;
@@ -662,43 +675,52 @@ struct HfCorrelatorD0Hadrons {
         // soft pion removal, signal status 1,3 for D0 and 2,3 for D0bar (SoftPi removed), signal status 11,13 for D0  and 12.13 for D0bar (only SoftPi)
         auto ePiK = RecoDecay::e(t1.pVectorProng0(), massPi) + RecoDecay::e(t1.pVectorProng1(), massK);
         auto eKPi = RecoDecay::e(t1.pVectorProng0(), massK) + RecoDecay::e(t1.pVectorProng1(), massPi);
-        double invMassDstar1 = 0., invMassDstar2 = 0.;
-        bool isSoftPiD0 = false, isSoftPiD0bar = false;
-        auto pSum2 = RecoDecay::p2(t1.px() + t2.px(), t1.py() + t2.py(), t1.pz() + t2.pz());
-        auto ePion = t2.energy(massPi);
-        invMassDstar1 = std::sqrt((ePiK + ePion) * (ePiK + ePion) - pSum2);
-        invMassDstar2 = std::sqrt((eKPi + ePion) * (eKPi + ePion) - pSum2);
-
-        if (t1.isSelD0() >= selectionFlagD0) {
-          if ((std::abs(invMassDstar1 - hfHelper.invMassD0ToPiK(t1)) - softPiMass) < ptSoftPionMax) {
-            isSoftPiD0 = true;
+        const bool isSelD0 = t1.isSelD0() >= selectionFlagD0;
+        const bool isSelD0bar = t1.isSelD0bar() >= selectionFlagD0bar;
+        const auto invMassD0 = hfHelper.invMassD0ToPiK(t1);
+        const auto invMassD0bar = hfHelper.invMassD0barToKPi(t1);
+        const auto pxCand = t1.px(), pyCand = t1.py(), pzCand = t1.pz();
+        const auto ptCand = t1.pt(), etaCand = t1.eta(), phiCand = t1.phi();
+
+        for (std::size_t iTrack = 0; iTrack < associatedTracks.size(); ++iTrack) {
+          double invMassDstar1 = 0., invMassDstar2 = 0.;
+          bool isSoftPiD0 = false, isSoftPiD0bar = false;
+          auto pSum2 = RecoDecay::p2(pxCand + associatedTracks.px[iTrack], pyCand + associatedTracks.py[iTrack], pzCand + associatedTracks.pz[iTrack]);
+          auto ePion = associatedTracks.energy[iTrack];
+          invMassDstar1 = std::sqrt((ePiK + ePion) * (ePiK + ePion) - pSum2);
+          invMassDstar2 = std::sqrt((eKPi + ePion) * (eKPi + ePion) - pSum2);
+
+          if (isSelD0) {
+            if ((std::abs(invMassDstar1 - invMassD0) - softPiMass) < ptSoftPionMax) {
+              isSoftPiD0 = true;
+            }
           }
-        }
 
-        if (t1.isSelD0bar() >= selectionFlagD0bar) {
-          if ((std::abs(invMassDstar2 - hfHelper.invMassD0barToKPi(t1)) - softPiMass) < ptSoftPionMax) {
-            isSoftPiD0bar = true;
+          if (isSelD0bar) {
+            if ((std::abs(invMassDstar2 - invMassD0bar) - softPiMass) < ptSoftPionMax) {
+              isSoftPiD0bar = true;
+            }
           }
-        }
 
-        int signalStatus = 0;
-        if (t1.isSelD0() >= selectionFlagD0) {
-          if (!isSoftPiD0) {
-            signalStatus += aod::hf_correlation_d0_hadron::ParticleTypeData::D0Only;
-          } else {
-            signalStatus += aod::hf_correlation_d0_hadron::ParticleTypeData::D0OnlySoftPi;
+          int signalStatus = 0;
+          if (isSelD0) {
+            if (!isSoftPiD0) {
+              signalStatus += aod::hf_correlation_d0_hadron::ParticleTypeData::D0Only;
+            } else {
+              signalStatus += aod::hf_correlation_d0_hadron::ParticleTypeData::D0OnlySoftPi;
+            }
           }
-        }
-        if (t1.isSelD0bar() >= selectionFlagD0bar) {
-          if (!isSoftPiD0bar) {
-            signalStatus += aod::hf_correlation_d0_hadron::ParticleTypeData::D0barOnly;
-          } else {
-            signalStatus += aod::hf_correlation_d0_hadron::ParticleTypeData::D0barOnlySoftPi;
+          if (isSelD0bar) {
+            if (!isSoftPiD0bar) {
+              signalStatus += aod::hf_correlation_d0_hadron::ParticleTypeData::D0barOnly;
+            } else {
+              signalStatus += aod::hf_correlation_d0_hadron::ParticleTypeData::D0barOnlySoftPi;
+            }
           }
-        }
 
-        entryD0HadronPair(getDeltaPhi(t1.phi(), t2.phi()), t1.eta() - t2.eta(), t1.pt(), t2.pt(), poolBin);
-        entryD0HadronRecoInfo(hfHelper.invMassD0ToPiK(t1), hfHelper.invMassD0barToKPi(t1), signalStatus);
+          entryD0HadronPair(getDeltaPhi(phiCand, associatedTracks.phi[iTrack]), etaCand - associatedTracks.eta[iTrack], ptCand, associatedTracks.pt[iTrack], poolBin);
+          entryD0HadronRecoInfo(invMassD0, invMassD0bar, signalStatus);
+        }
       }
     }
   }
@@ -714,10 +736,12 @@ struct HfCorrelatorD0Hadrons {
     Pair<SelectedCollisions, SelectedCandidatesMcRec, SelectedTracks, BinningType> pairMcRec{corrBinning, 5, -1, collisions, tracksTuple, &cache};
     bool flagD0 = false;
     bool flagD0bar = false;
+    associatedTracks.clear();
     for (const auto& [c1, tracks1, c2, tracks2] : pairMcRec) {
       int poolBin = corrBinning.getBin(std::make_tuple(c2.posZ(), c2.multFV0M()));
+      associatedTracks.stageMixedEventTracks(c2.globalIndex(), tracks2, massPi);
 
-      for (const auto& [t1, t2] : o2::soa::combinations(o2::soa::CombinationsFullIndexPolicy(tracks1, tracks2))) {
+      for (const auto& t1 : tracks1) {
 
         if (yCandMax >= 0. && std::abs(hfHelper.yD0(t1)) > yCandMax) {
           continue;
@@ -726,80 +750,90 @@ struct HfCorrelatorD0Hadrons {
         // soft pion removal
         auto ePiK = RecoDecay::e(t1.pVectorProng0(), massPi) + RecoDecay::e(t1.pVectorProng1(), massK);
         auto eKPi = RecoDecay::e(t1.pVectorProng0(), massK) + RecoDecay::e(t1.pVectorProng1(), massPi);
-        double invMassDstar1 = 0., invMassDstar2 = 0.;
-        bool isSoftPiD0 = false, isSoftPiD0bar = false;
-        auto pSum2 = RecoDecay::p2(t1.px() + t2.px(), t1.py() + t2.py(), t1.pz() + t2.pz());
-        auto ePion = t2.energy(massPi);
-        invMassDstar1 = std::sqrt((ePiK + ePion) * (ePiK + ePion) - pSum2);
-        invMassDstar2 = std::sqrt((eKPi + ePion) * (eKPi + ePion) - pSum2);
-
-        if (t1.isSelD0() >= selectionFlagD0) {
-          if ((std::abs(invMassDstar1 - hfHelper.invMassD0ToPiK(t1)) - softPiMass) < ptSoftPionMax) {
-            isSoftPiD0 = true;
-          }
-        }
-
-        if (t1.isSelD0bar() >= selectionFlagD0bar) {
-          if ((std::abs(invMassDstar2 - hfHelper.invMassD0barToKPi(t1)) - softPiMass) < ptSoftPionMax) {
-            isSoftPiD0bar = true;
-          }
-        }
+        const bool isSelD0 = t1.isSelD0() >= selectionFlagD0;
+        const bool isSelD0bar = t1.isSelD0bar() >= selectionFlagD0bar;
+        const auto invMassD0 = hfHelper.invMassD0ToPiK(t1);
+        const auto invMassD0bar = hfHelper.invMassD0barToKPi(t1);
+        const auto pxCand = t1.px(), pyCand = t1.py(), pzCand = t1.pz();
+        const auto ptCand = t1.pt(), etaCand = t1.eta(), phiCand = t1.phi();
 
         flagD0 = t1.flagMcMatchRec() == (1 << aod::hf_cand_2prong::DecayType::D0ToPiK);     // flagD0Signal 'true' if candidate1 matched to D0 (particle)
         flagD0bar = t1.flagMcMatchRec() == -(1 << aod::hf_cand_2prong::DecayType::D0ToPiK); // flagD0Reflection 'true' if candidate1, selected as D0 (particle), is matched to D0bar (antiparticle)
-        int signalStatus = 0;
 
-        if (flagD0 && (t1.isSelD0() >= selectionFlagD0)) {
-          if (!isSoftPiD0) {
-            SETBIT(signalStatus, aod::hf_correlation_d0_hadron::ParticleTypeMcRec::D0Sig); //  signalStatus += 1;
-          } else {
-            SETBIT(signalStatus, aod::hf_correlation_d0_hadron::ParticleTypeMcRec::SoftPi); // signalStatus += 64;
+        for (std::size_t iTrack = 0; iTrack < associatedTracks.size(); ++iTrack) {
+          double invMassDstar1 = 0., invMassDstar2 = 0.;
+          bool isSoftPiD0 = false, isSoftPiD0bar = false;
+          auto pSum2 = RecoDecay::p2(pxCand + associatedTracks.px[iTrack], pyCand + associatedTracks.py[iTrack], pzCand + associatedTracks.pz[iTrack]);
+          auto ePion = associatedTracks.energy[iTrack];
+          invMassDstar1 = std::sqrt((ePiK + ePion) * (ePiK + ePion) - pSum2);
+          invMassDstar2 = std::sqrt((eKPi + ePion) * (eKPi + ePion) - pSum2);
+
+          if (isSelD0) {
+            if ((std::abs(invMassDstar1 - invMassD0) - softPiMass) < ptSoftPionMax) {
+              isSoftPiD0 = true;
+            }
           }
-        } // signal case D0
 
-        if (flagD0bar && (t1.isSelD0() >= selectionFlagD0)) {
-          if (!isSoftPiD0) {
-            SETBIT(signalStatus, aod::hf_correlation_d0_hadron::ParticleTypeMcRec::D0Ref); //   signalStatus += 2;
-          } else {
-            SETBIT(signalStatus, aod::hf_correlation_d0_hadron::ParticleTypeMcRec::SoftPi); // signalStatus += 64;
+          if (isSelD0bar) {
+            if ((std::abs(invMassDstar2 - invMassD0bar) - softPiMass) < ptSoftPionMax) {
+              isSoftPiD0bar = true;
+            }
           }
-        } // reflection case D0
 
-        if (!flagD0 && !flagD0bar && (t1.isSelD0() >= selectionFlagD0)) {
-          if (!isSoftPiD0) {
-            SETBIT(signalStatus, aod::hf_correlation_d0_hadron::ParticleTypeMcRec::D0Bg); //  signalStatus += 4;
-          } else {
-            SETBIT(signalStatus, aod::hf_correlation_d0_hadron::ParticleTypeMcRec::SoftPi);
-          }
-        } // background case D0
+          int signalStatus = 0;
 
-        if (flagD0bar && (t1.isSelD0bar() >= selectionFlagD0bar)) {
-          if (!isSoftPiD0bar) {
-            SETBIT(signalStatus, aod::hf_correlation_d0_hadron::ParticleTypeMcRec::D0barSig); //  signalStatus += 8;
-          } else {
-            SETBIT(signalStatus, aod::hf_correlation_d0_hadron::ParticleTypeMcRec::SoftPi);
-          }
-        } // signal case D0bar
+          if (flagD0 && isSelD0) {
+            if (!isSoftPiD0) {
+              SETBIT(signalStatus, aod::hf_correlation_d0_hadron::ParticleTypeMcRec::D0Sig); //  signalStatus += 1;
+            } else {
+              SETBIT(signalStatus, aod::hf_correlation_d0_hadron::ParticleTypeMcRec::SoftPi); // signalStatus += 64;
+            }
+          } // signal case D0
 
-        if (flagD0 && (t1.isSelD0bar() >= selectionFlagD0bar)) {
-          if (!isSoftPiD0bar) {
-            SETBIT(signalStatus, aod::hf_correlation_d0_hadron::ParticleTypeMcRec::D0barRef); // signalStatus += 16;
-          } else {
-            SETBIT(signalStatus, aod::hf_correlation_d0_hadron::ParticleTypeMcRec::SoftPi);
-          }
-        } // reflection case D0bar
+          if (flagD0bar && isSelD0) {
+            if (!isSoftPiD0) {
+              SETBIT(signalStatus, aod::hf_correlation_d0_hadron::ParticleTypeMcRec::D0Ref); //   signalStatus += 2;
+            } else {
+              SETBIT(signalStatus, aod::hf_correlation_d0_hadron::ParticleTypeMcRec::SoftPi); // signalStatus += 64;
+            }
+          } // reflection case D0
 
-        if (!flagD0 && !flagD0bar && (t1.isSelD0bar() >= selectionFlagD0bar)) {
-          if (!isSoftPiD0bar) {
-            SETBIT(signalStatus, aod::hf_correlation_d0_hadron::ParticleTypeMcRec::D0barBg); //   signalStatus += 32;
-          } else {
-            SETBIT(signalStatus, aod::hf_correlation_d0_hadron::ParticleTypeMcRec::SoftPi);
-          }
-        } // background case D0bar
+          if (!flagD0 && !flagD0bar && isSelD0) {
+            if (!isSoftPiD0) {
+              SETBIT(signalStatus, aod::hf_correlation_d0_hadron::ParticleTypeMcRec::D0Bg); //  signalStatus += 4;
+            } else {
+              SETBIT(signalStatus, aod::hf_correlation_d0_hadron::ParticleTypeMcRec::SoftPi);
+            }
+          } // background case D0
+
+          if (flagD0bar && isSelD0bar) {
+            if (!isSoftPiD0bar) {
+              SETBIT(signalStatus, aod::hf_correlation_d0_hadron::ParticleTypeMcRec::D0barSig); //  signalStatus += 8;
+            } else {
+              SETBIT(signalStatus, aod::hf_correlation_d0_hadron::ParticleTypeMcRec::SoftPi);
+            }
+          } // signal case D0bar
 
-        registry.fill(HIST("hSignalStatusMERec"), signalStatus);
-        entryD0HadronPair(getDeltaPhi(t1.phi(), t2.phi()), t1.eta() - t2.eta(), t1.pt(), t2.pt(), poolBin);
-        entryD0HadronRecoInfo(hfHelper.invMassD0ToPiK(t1), hfHelper.invMassD0barToKPi(t1), signalStatus);
+          if (flagD0 && isSelD0bar) {
+            if (!isSoftPiD0bar) {
+              SETBIT(signalStatus, aod::hf_correlation_d0_hadron::ParticleTypeMcRec::D0barRef); // signalStatus += 16;
+            } else {
+              SETBIT(signalStatus, aod::hf_correlation_d0_hadron::ParticleTypeMcRec::SoftPi);
+            }
+          } // reflection case D0bar
+
+          if (!flagD0 && !flagD0bar && isSelD0bar) {
+            if (!isSoftPiD0bar) {
+              SETBIT(signalStatus, aod::hf_correlation_d0_hadron::ParticleTypeMcRec::D0barBg); //   signalStatus += 32;
+            } else {
+              SETBIT(signalStatus, aod::hf_correlation_d0_hadron::ParticleTypeMcRec::SoftPi);
+            }
+          } // background case D0bar
+
+          registry.fill(HIST("hSignalStatusMERec"), signalStatus);
+          entryD0HadronPair(getDeltaPhi(phiCand, associatedTracks.phi[iTrack]), etaCand - associatedTracks.eta[iTrack], ptCand, associatedTracks.pt[iTrack], poolBin);
+          entryD0HadronRecoInfo(invMassD0, invMassD0bar, signalStatus);
+        }
       }
     }
   }
@@ -26,6 +26,7 @@
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "PWGHF/DataModel/CandidateSelectionTables.h"
 #include "PWGHF/HFC/DataModel/CorrelationTables.h"
+#include "PWGHF/HFC/Utils/utilsCorrelations.h"
 
 using namespace o2;
 using namespace o2::analysis;
@@ -169,6 +170,7 @@ struct HfCorrelatorDplusHadrons {
 
   HfHelper hfHelper;
   SliceCache cache;
+  hf_correlations::AssociatedTracks associatedTracks; // associated tracks of the collision, reused by all Dplus candidates
 
   // Event Mixing for the Data Mode
   using MySelCollisions = soa::Filtered<soa::Join<aod::Collisions, aod::Mults, aod::DmesonSelection>>;
@@ -233,6 +235,33 @@ struct HfCorrelatorDplusHadrons {
     registry.add("hcountDplustriggersMCGen", "Dplus trigger particles - MC gen;;N of trigger Dplus", {HistType::kTH2F, {{1, -0.5, 0.5}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
   }
 
+  /// Fills the buffer of associated tracks of the collision and counts the tracks for the multiplicity selection
+  /// \return number of tracks for the multiplicity selection
+  template <typename TCollision, typename TTracks>
+  int stageAssociatedTracks(TCollision const& collision, TTracks const& tracks, int poolBin)
+  {
+    associatedTracks.clear();
+    int nTracks = 0;
+    const bool countTracks = collision.numContrib() > 1;
+    for (const auto& track : tracks) {
+      if (std::abs(track.eta()) > etaTrackMax) {
+        continue;
+      }
+      if (countTracks && std::abs(track.dcaXY()) <= dcaXYTrackMax && std::abs(track.dcaZ()) <= dcaZTrackMax) {
+        nTracks++;
+        registry.fill(HIST("hTracksBin"), poolBin);
+      }
+      if (track.pt() < ptTrackMin) {
+        continue;
+      }
+      if (std::abs(track.dcaXY()) >= dcaXYTrackMax || std::abs(track.dcaZ()) >= dcaZTrackMax) {
+        continue; // Remove secondary tracks
+      }
+      associatedTracks.add(track);
+    }
+    return nTracks;
+  }
+
   /// Dplus-hadron correlation pair builder - for real data and data-like analysis (i.e. reco-level w/o matching request via MC truth)
   void processData(soa::Join<aod::Collisions, aod::Mults>::iterator const& collision,
                    aod::TracksWDca const& tracks,
@@ -240,20 +269,7 @@ struct HfCorrelatorDplusHadrons {
   {
     if (selectedDplusCandidates.size() > 0) {
       int poolBin = corrBinning.getBin(std::make_tuple(collision.posZ(), collision.multFV0M()));
-      int nTracks = 0;
-      if (collision.numContrib() > 1) {
-        for (const auto& track : tracks) {
-          if (std::abs(track.eta()) > etaTrackMax) {
-            continue;
-          }
-          if (std::abs(track.dcaXY()) > dcaXYTrackMax || std::abs(track.dcaZ()) > dcaZTrackMax) {
-            continue;
-          }
-          nTracks++;
-          registry.fill(HIST("hTracksBin"), poolBin);
-        }
-      }
-
+      int nTracks = stageAssociatedTracks(collision, tracks, poolBin);
       registry.fill(HIST("hMultiplicityPreSelection"), nTracks);
       if (nTracks < multMin || nTracks > multMax) {
         return;
@@ -294,25 +310,20 @@ struct HfCorrelatorDplusHadrons {
         registry.fill(HIST("hDplusBin"), poolBin);
         // Dplus-Hadron correlation dedicated section
         // if the candidate is a Dplus, search for Hadrons and evaluate correlations
-        for (const auto& track : tracks) {
-          if (std::abs(track.eta()) > etaTrackMax) {
-            continue;
-          }
-          if (track.pt() < ptTrackMin) {
-            continue;
-          }
-          if (std::abs(track.dcaXY()) >= dcaXYTrackMax || std::abs(track.dcaZ()) >= dcaZTrackMax) {
-            continue; // Remove secondary tracks
-          }
+        const auto invMassDplus = hfHelper.invMassDplusToPiKPi(candidate1);
+        const auto prong0Id = candidate1.prong0Id(), prong1Id = candidate1.prong1Id(), prong2Id = candidate1.prong2Id();
+        const auto ptCand = candidate1.pt(), etaCand = candidate1.eta(), phiCand = candidate1.phi();
+        for (std::size_t iTrack = 0; iTrack < associatedTracks.size(); ++iTrack) {
           // Removing Dplus daughters by checking track indices
-          if ((candidate1.prong0Id() == track.globalIndex()) || (candidate1.prong1Id() == track.globalIndex()) || (candidate1.prong2Id() == track.globalIndex())) {
+          const auto trackIndex = associatedTracks.globalIndex[iTrack];
+          if ((prong0Id == trackIndex) || (prong1Id == trackIndex) || (prong2Id == trackIndex)) {
             continue;
           }
-          entryDplusHadronPair(getDeltaPhi(track.phi(), candidate1.phi()),
-                               track.eta() - candidate1.eta(),
-                               candidate1.pt(),
-                               track.pt(), poolBin);
-          entryDplusHadronRecoInfo(hfHelper.invMassDplusToPiKPi(candidate1), 0);
+          entryDplusHadronPair(getDeltaPhi(associatedTracks.phi[iTrack], phiCand),
+                               associatedTracks.eta[iTrack] - etaCand,
+                               ptCand,
+                               associatedTracks.pt[iTrack], poolBin);
+          entryDplusHadronRecoInfo(invMassDplus, 0);
         } // Hadron Tracks loop
       }   // end outer Dplus loop
       registry.fill(HIST("hZvtx"), collision.posZ());
@@ -328,19 +339,7 @@ struct HfCorrelatorDplusHadrons {
   {
     if (selectedDplusCandidatesMc.size() > 0) {
       int poolBin = corrBinning.getBin(std::make_tuple(collision.posZ(), collision.multFV0M()));
-      int nTracks = 0;
-      if (collision.numContrib() > 1) {
-        for (const auto& track : tracks) {
-          if (std::abs(track.eta()) > etaTrackMax) {
-            continue;
-          }
-          if (std::abs(track.dcaXY()) > dcaXYTrackMax || std::abs(track.dcaZ()) > dcaZTrackMax) {
-            continue;
-          }
-          nTracks++;
-          registry.fill(HIST("hTracksBin"), poolBin);
-        }
-      }
+      int nTracks = stageAssociatedTracks(collision, tracks, poolBin);
       registry.fill(HIST("hMultiplicityPreSelection"), nTracks);
       if (nTracks < multMin || nTracks > multMax) {
         return;
@@ -391,25 +390,20 @@ struct HfCorrelatorDplusHadrons {
         // Dplus-Hadron correlation dedicated section
         // if the candidate is selected as Dplus, search for Hadron and evaluate correlations
         flagDplusSignal = candidate1.flagMcMatchRec() == 1 << aod::hf_cand_3prong::DecayType::DplusToPiKPi;
-        for (const auto& track : tracks) {
-          if (std::abs(track.eta()) > etaTrackMax) {
-            continue;
-          }
-          if (track.pt() < ptTrackMin) {
-            continue;
-          }
+        const auto invMassDplus = hfHelper.invMassDplusToPiKPi(candidate1);
+        const auto prong0Id = candidate1.prong0Id(), prong1Id = candidate1.prong1Id(), prong2Id = candidate1.prong2Id();
+        const auto ptCand = candidate1.pt(), etaCand = candidate1.eta(), phiCand = candidate1.phi();
+        for (std::size_t iTrack = 0; iTrack < associatedTracks.size(); ++iTrack) {
           // Removing Dplus daughters by checking track indices
-          if ((candidate1.prong0Id() == track.globalIndex()) || (candidate1.prong1Id() == track.globalIndex()) || (candidate1.prong2Id() == track.globalIndex())) {
+          const auto trackIndex = associatedTracks.globalIndex[iTrack];
+          if ((prong0Id == trackIndex) || (prong1Id == trackIndex) || (prong2Id == trackIndex)) {
             continue;
           }
-          if (std::abs(track.dcaXY()) >= dcaXYTrackMax || std::abs(track.dcaZ()) >= dcaZTrackMax) {
-            continue; // Remove secondary tracks
-          }
-          entryDplusHadronPair(getDeltaPhi(track.phi(), candidate1.phi()),
-                               track.eta() - candidate1.eta(),
-                               candidate1.pt(),
-                               track.pt(), poolBin);
-          entryDplusHadronRecoInfo(hfHelper.invMassDplusToPiKPi(candidate1), flagDplusSignal);
+          entryDplusHadronPair(getDeltaPhi(associatedTracks.phi[iTrack], phiCand),
+                               associatedTracks.eta[iTrack] - etaCand,
+                               ptCand,
+                               associatedTracks.pt[iTrack], poolBin);
+          entryDplusHadronRecoInfo(invMassDplus, flagDplusSignal);
         } // end inner loop (Tracks)
 
       } // end outer Dplus loop
@@ -506,16 +500,22 @@ struct HfCorrelatorDplusHadrons {
     auto tracksTuple = std::make_tuple(candidates, tracks);
     Pair<MySelCollisions, MyCandidatesData, MyTracks, BinningType> pairData{corrBinning, 5, -1, collisions, tracksTuple, &cache};
 
+    associatedTracks.clear();
     for (const auto& [c1, tracks1, c2, tracks2] : pairData) {
       // LOGF(info, "Mixed event collisions: Index = (%d, %d), tracks Size: (%d, %d), Z Vertex: (%f, %f), Pool Bin: (%d, %d)", c1.globalIndex(), c2.globalIndex(), tracks1.size(), tracks2.size(), c1.posZ(), c2.posZ(), corrBinning.getBin(std::make_tuple(c1.posZ(), c1.multFV0M())),corrBinning.getBin(std::make_tuple(c2.posZ(), c2.multFV0M()))); // For debug
       int poolBin = corrBinning.getBin(std::make_tuple(c2.posZ(), c2.multFV0M()));
-      for (const auto& [t1, t2] : o2::soa::combinations(o2::soa::CombinationsFullIndexPolicy(tracks1, tracks2))) {
+      associatedTracks.stageMixedEventTracks(c2.globalIndex(), tracks2);
+      for (const auto& t1 : tracks1) {
 
         if (yCandMax >= 0. && std::abs(hfHelper.yDplus(t1)) > yCandMax) {
           continue;
         }
-        entryDplusHadronPair(getDeltaPhi(t1.phi(), t2.phi()), t1.eta() - t2.eta(), t1.pt(), t2.pt(), poolBin);
-        entryDplusHadronRecoInfo(hfHelper.invMassDplusToPiKPi(t1), 0);
+        const auto invMassDplus = hfHelper.invMassDplusToPiKPi(t1);
+        const auto ptCand = t1.pt(), etaCand = t1.eta(), phiCand = t1.phi();
+        for (std::size_t iTrack = 0; iTrack < associatedTracks.size(); ++iTrack) {
+          entryDplusHadronPair(getDeltaPhi(phiCand, associatedTracks.phi[iTrack]), etaCand - associatedTracks.eta[iTrack], ptCand, associatedTracks.pt[iTrack], poolBin);
+          entryDplusHadronRecoInfo(invMassDplus, 0);
+        }
       }
     }
   }
@@ -528,15 +528,21 @@ struct HfCorrelatorDplusHadrons {
     auto tracksTuple = std::make_tuple(candidates, tracks);
     Pair<MySelCollisions, MyCandidatesMcRec, MyTracks, BinningType> pairMcRec{corrBinning, 5, -1, collisions, tracksTuple, &cache};
 
+    associatedTracks.clear();
     for (const auto& [c1, tracks1, c2, tracks2] : pairMcRec) {
       int poolBin = corrBinning.getBin(std::make_tuple(c2.posZ(), c2.multFV0M()));
-      for (const auto& [t1, t2] : o2::soa::combinations(o2::soa::CombinationsFullIndexPolicy(tracks1, tracks2))) {
+      associatedTracks.stageMixedEventTracks(c2.globalIndex(), tracks2);
+      for (const auto& t1 : tracks1) {
 
         if (yCandMax >= 0. && std::abs(hfHelper.yDplus(t1)) > yCandMax) {
           continue;
         }
-        entryDplusHadronPair(getDeltaPhi(t1.phi(), t2.phi()), t1.eta() - t2.eta(), t1.pt(), t2.pt(), poolBin);
-        entryDplusHadronRecoInfo(hfHelper.invMassDplusToPiKPi(t1), 0);
+        const auto invMassDplus = hfHelper.invMassDplusToPiKPi(t1);
+        const auto ptCand = t1.pt(), etaCand = t1.eta(), phiCand = t1.phi();
+        for (std::size_t iTrack = 0; iTrack < associatedTracks.size(); ++iTrack) {
+          entryDplusHadronPair(getDeltaPhi(phiCand, associatedTracks.phi[iTrack]), etaCand - associatedTracks.eta[iTrack], ptCand, associatedTracks.pt[iTrack], poolBin);
+          entryDplusHadronRecoInfo(invMassDplus, 0);
+        }
       }
     }
   }
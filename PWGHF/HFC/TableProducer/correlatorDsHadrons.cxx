@@ -28,6 +28,7 @@
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "PWGHF/DataModel/CandidateSelectionTables.h"
 #include "PWGHF/HFC/DataModel/CorrelationTables.h"
+#include "PWGHF/HFC/Utils/utilsCorrelations.h"
 
 using namespace o2;
 using namespace o2::analysis;
@@ -179,6 +180,7 @@ struct HfCorrelatorDsHadrons {
 
   HfHelper hfHelper;
   SliceCache cache;
+  hf_correlations::AssociatedTracks associatedTracks; // associated tracks of the collision, reused by all Ds candidates
 
   using SelCollisionsWithDs = soa::Filtered<soa::Join<aod::Collisions, aod::Mults, aod::DmesonSelection>>;      // collisionFilter applied
   using SelCollisionsWithDsMc = soa::Filtered<soa::Join<aod::McCollisions, aod::DmesonSelection>>;              // collisionFilter applied
@@ -355,6 +357,24 @@ struct HfCorrelatorDsHadrons {
     }
   }
 
+  /// Fills the buffer of associated tracks of the collision and counts the tracks for the multiplicity selection
+  /// \return number of tracks for the multiplicity selection
+  template <typename TCollision, typename TTracks>
+  int stageAssociatedTracks(TCollision const& collision, TTracks const& tracks, int poolBin)
+  {
+    associatedTracks.clear();
+    int nTracks = 0;
+    const bool countTracks = collision.numContrib() > 1;
+    for (const auto& track : tracks) {
+      if (countTracks && std::abs(track.eta()) <= etaTrackMax) {
+        nTracks++;
+        registry.fill(HIST("hTracksPoolBin"), poolBin);
+      }
+      associatedTracks.add(track);
+    }
+    return nTracks;
+  }
+
   /// Ds-hadron correlation pair builder - for real data and data-like analysis (i.e. reco-level w/o matching request via MC truth)
   void processData(SelCollisionsWithDs::iterator const& collision,
                    CandDsData const& candidates,
@@ -366,16 +386,7 @@ struct HfCorrelatorDsHadrons {
       registry.fill(HIST("hMultV0M"), collision.multFV0M());
       int poolBin = corrBinning.getBin(std::make_tuple(collision.posZ(), collision.multFV0M()));
       registry.fill(HIST("hCollisionPoolBin"), poolBin);
-      int nTracks = 0;
-      if (collision.numContrib() > 1) {
-        for (const auto& track : tracks) {
-          if (std::abs(track.eta()) > etaTrackMax) {
-            continue;
-          }
-          nTracks++;
-          registry.fill(HIST("hTracksPoolBin"), poolBin);
-        }
-      }
+      int nTracks = stageAssociatedTracks(collision, tracks, poolBin);
       if (nTracks < multMin || nTracks > multMax) {
         return;
       }
@@ -404,28 +415,33 @@ struct HfCorrelatorDsHadrons {
         }
 
         // Ds-Hadron correlation dedicated section
-        for (const auto& track : tracks) {
+        // DsToKKPi and DsToPiKK division
+        bool isSelDs = true;
+        double invMassDs = 0.;
+        if (candidate.isSelDsToKKPi() >= selectionFlagDs) {
+          invMassDs = hfHelper.invMassDsToKKPi(candidate);
+        } else if (candidate.isSelDsToPiKK() >= selectionFlagDs) {
+          invMassDs = hfHelper.invMassDsToPiKK(candidate);
+        } else {
+          isSelDs = false;
+        }
+        const auto prong0Id = candidate.prong0Id(), prong1Id = candidate.prong1Id(), prong2Id = candidate.prong2Id();
+        const auto ptCand = candidate.pt(), etaCand = candidate.eta(), phiCand = candidate.phi();
+        for (std::size_t iTrack = 0; iTrack < associatedTracks.size(); ++iTrack) {
           // Removing Ds daughters by checking track indices
-          if ((candidate.prong0Id() == track.globalIndex()) || (candidate.prong1Id() == track.globalIndex()) || (candidate.prong2Id() == track.globalIndex())) {
+          const auto trackIndex = associatedTracks.globalIndex[iTrack];
+          if ((prong0Id == trackIndex) || (prong1Id == trackIndex) || (prong2Id == trackIndex)) {
             continue;
           }
-          registry.fill(HIST("hEtaVsPtPartAssoc"), track.eta(), candidate.pt());
-          registry.fill(HIST("hPhiVsPtPartAssoc"), RecoDecay::constrainAngle(track.phi(), -o2::constants::math::PIHalf), candidate.pt());
-          if (candidate.isSelDsToKKPi() >= selectionFlagDs) {
-            entryDsHadronPair(getDeltaPhi(track.phi(), candidate.phi()),
-                              track.eta() - candidate.eta(),
-                              candidate.pt(),
-                              track.pt(),
+          registry.fill(HIST("hEtaVsPtPartAssoc"), associatedTracks.eta[iTrack], ptCand);
+          registry.fill(HIST("hPhiVsPtPartAssoc"), RecoDecay::constrainAngle(associatedTracks.phi[iTrack], -o2::constants::math::PIHalf), ptCand);
+          if (isSelDs) {
+            entryDsHadronPair(getDeltaPhi(associatedTracks.phi[iTrack], phiCand),
+                              associatedTracks.eta[iTrack] - etaCand,
+                              ptCand,
+                              associatedTracks.pt[iTrack],
                               poolBin);
-            entryDsHadronRecoInfo(hfHelper.invMassDsToKKPi(candidate), false);
-            entryDsHadronGenInfo(false);
-          } else if (candidate.isSelDsToPiKK() >= selectionFlagDs) {
-            entryDsHadronPair(getDeltaPhi(track.phi(), candidate.phi()),
-                              track.eta() - candidate.eta(),
-                              candidate.pt(),
-                              track.pt(),
-                              poolBin);
-            entryDsHadronRecoInfo(hfHelper.invMassDsToPiKK(candidate), false);
+            entryDsHadronRecoInfo(invMassDs, false);
             entryDsHadronGenInfo(false);
           }
         }
@@ -444,16 +460,7 @@ struct HfCorrelatorDsHadrons {
       registry.fill(HIST("hMultV0M"), collision.multFV0M());
       int poolBin = corrBinning.getBin(std::make_tuple(collision.posZ(), collision.multFV0M()));
       registry.fill(HIST("hCollisionPoolBin"), poolBin);
-      int nTracks = 0;
-      if (collision.numContrib() > 1) {
-        for (const auto& track : tracks) {
-          if (std::abs(track.eta()) > etaTrackMax) {
-            continue;
-          }
-          registry.fill(HIST("hTracksPoolBin"), poolBin);
-          nTracks++;
-        }
-      }
+      int nTracks = stageAssociatedTracks(collision, tracks, poolBin);
       registry.fill(HIST("hMultiplicityPreSelection"), nTracks);
       if (nTracks < multMin || nTracks > multMax) {
         return;
@@ -517,28 +524,32 @@ struct HfCorrelatorDsHadrons {
 
         // Ds-Hadron correlation dedicated section
         // if the candidate is selected as Ds, search for Hadron and evaluate correlations
-        for (const auto& track : tracks) {
+        // DsToKKPi and DsToPiKK division
+        bool isSelDs = true;
+        double invMassDs = 0.;
+        if (candidate.isSelDsToKKPi() >= selectionFlagDs) {
+          invMassDs = hfHelper.invMassDsToKKPi(candidate);
+        } else if (candidate.isSelDsToPiKK() >= selectionFlagDs) {
+          invMassDs = hfHelper.invMassDsToPiKK(candidate);
+        } else {
+          isSelDs = false;
+        }
+        const auto prong0Id = candidate.prong0Id(), prong1Id = candidate.prong1Id(), prong2Id = candidate.prong2Id();
+        const auto ptCand = candidate.pt(), etaCand = candidate.eta(), phiCand = candidate.phi();
+        for (std::size_t iTrack = 0; iTrack < associatedTracks.size(); ++iTrack) {
           // Removing Ds daughters by checking track indices
-          if ((candidate.prong0Id() == track.globalIndex()) || (candidate.prong1Id() == track.globalIndex()) || (candidate.prong2Id() == track.globalIndex())) {
+          const auto trackIndex = associatedTracks.globalIndex[iTrack];
+          if ((prong0Id == trackIndex) || (prong1Id == trackIndex) || (prong2Id == trackIndex)) {
             continue;
           }
-          registry.fill(HIST("hPtParticleAssocMcRec"), track.pt()); // va tolto
-          // DsToKKPi and DsToPiKK division
-          if (candidate.isSelDsToKKPi() >= selectionFlagDs) {
-            entryDsHadronPair(getDeltaPhi(track.phi(), candidate.phi()),
-                              track.eta() - candidate.eta(),
-                              candidate.pt(),
-                              track.pt(),
-                              poolBin);
-            entryDsHadronRecoInfo(hfHelper.invMassDsToKKPi(candidate), isDsSignal);
-            entryDsHadronGenInfo(isDsPrompt);
-          } else if (candidate.isSelDsToPiKK() >= selectionFlagDs) {
-            entryDsHadronPair(getDeltaPhi(track.phi(), candidate.phi()),
-                              track.eta() - candidate.eta(),
-                              candidate.pt(),
-                              track.pt(),
+          registry.fill(HIST("hPtParticleAssocMcRec"), associatedTracks.pt[iTrack]); // va tolto
+          if (isSelDs) {
+            entryDsHadronPair(getDeltaPhi(associatedTracks.phi[iTrack], phiCand),
+                              associatedTracks.eta[iTrack] - etaCand,
+                              ptCand,
+                              associatedTracks.pt[iTrack],
                               poolBin);
-            entryDsHadronRecoInfo(hfHelper.invMassDsToPiKK(candidate), isDsSignal);
+            entryDsHadronRecoInfo(invMassDs, isDsSignal);
             entryDsHadronGenInfo(isDsPrompt);
           }
         }
@@ -711,6 +722,7 @@ struct HfCorrelatorDsHadrons {
     auto tracksTuple = std::make_tuple(candidates, tracks);
     Pair<soa::Join<aod::Collisions, aod::Mults>, CandDsData, MyTracksData, BinningType> pairData{corrBinning, numberEventsMixed, -1, collisions, tracksTuple, &cache};
 
+    associatedTracks.clear();
     for (const auto& [c1, tracks1, c2, tracks2] : pairData) {
       if (tracks1.size() == 0) {
         continue;
@@ -720,7 +732,8 @@ struct HfCorrelatorDsHadrons {
       int poolBinDs = corrBinning.getBin(std::make_tuple(c1.posZ(), c1.multFV0M()));
       registry.fill(HIST("hTracksPoolBin"), poolBin);
       registry.fill(HIST("hDsPoolBin"), poolBinDs);
-      for (const auto& [cand, pAssoc] : o2::soa::combinations(o2::soa::CombinationsFullIndexPolicy(tracks1, tracks2))) {
+      associatedTracks.stageMixedEventTracks(c2.globalIndex(), tracks2);
+      for (const auto& cand : tracks1) {
         if (!(cand.hfflag() & 1 << aod::hf_cand_3prong::DecayType::DsToKKPi)) {
           continue;
         }
@@ -729,23 +742,22 @@ struct HfCorrelatorDsHadrons {
         }
 
         // DsToKKPi and DsToPiKK division
+        double invMassDs = 0.;
         if (cand.isSelDsToKKPi() >= selectionFlagDs) {
-          // LOGF(info, "Mixed event tracks pair: (%d, %d) from events (%d, %d), track event: (%d, %d), KKPi", cand.index(), pAssoc.index(), c1.index(), c2.index(), cand.collision().index(), pAssoc.collision().index());
-          entryDsHadronPair(getDeltaPhi(pAssoc.phi(), cand.phi()),
-                            pAssoc.eta() - cand.eta(),
-                            cand.pt(),
-                            pAssoc.pt(),
-                            poolBin);
-          entryDsHadronRecoInfo(hfHelper.invMassDsToKKPi(cand), false);
-          entryDsHadronGenInfo(false);
+          invMassDs = hfHelper.invMassDsToKKPi(cand);
         } else if (cand.isSelDsToPiKK() >= selectionFlagDs) {
-          // LOGF(info, "Mixed event tracks pair: (%d, %d) from events (%d, %d), track event: (%d, %d), PiKK", cand.index(), pAssoc.index(), c1.index(), c2.index(), cand.collision().index(), pAssoc.collision().index());
-          entryDsHadronPair(getDeltaPhi(pAssoc.phi(), cand.phi()),
-                            pAssoc.eta() - cand.eta(),
-                            cand.pt(),
-                            pAssoc.pt(),
+          invMassDs = hfHelper.invMassDsToPiKK(cand);
+        } else {
+          continue;
+        }
+        const auto ptCand = cand.pt(), etaCand = cand.eta(), phiCand = cand.phi();
+        for (std::size_t iTrack = 0; iTrack < associatedTracks.size(); ++iTrack) {
+          entryDsHadronPair(getDeltaPhi(associatedTracks.phi[iTrack], phiCand),
+                            associatedTracks.eta[iTrack] - etaCand,
+                            ptCand,
+                            associatedTracks.pt[iTrack],
                             poolBin);
-          entryDsHadronRecoInfo(hfHelper.invMassDsToPiKK(cand), false);
+          entryDsHadronRecoInfo(invMassDs, false);
           entryDsHadronGenInfo(false);
         }
       }
@@ -785,12 +797,14 @@ struct HfCorrelatorDsHadrons {
 
     bool isDsPrompt = false;
     bool isDsSignal = false;
+    associatedTracks.clear();
     for (const auto& [c1, tracks1, c2, tracks2] : pairMcRec) {
       int poolBin = corrBinning.getBin(std::make_tuple(c2.posZ(), c2.multFV0M()));
       int poolBinDs = corrBinning.getBin(std::make_tuple(c1.posZ(), c1.multFV0M()));
       registry.fill(HIST("hTracksPoolBin"), poolBin);
       registry.fill(HIST("hDsPoolBin"), poolBinDs);
-      for (const auto& [candidate, pAssoc] : o2::soa::combinations(o2::soa::CombinationsFullIndexPolicy(tracks1, tracks2))) {
+      associatedTracks.stageMixedEventTracks(c2.globalIndex(), tracks2);
+      for (const auto& candidate : tracks1) {
 
         if (yCandMax >= 0. && std::abs(hfHelper.yDs(candidate)) > yCandMax) {
           continue;
@@ -800,21 +814,22 @@ struct HfCorrelatorDsHadrons {
         // Ds Signal
         isDsSignal = std::abs(candidate.flagMcMatchRec()) == 1 << aod::hf_cand_3prong::DecayType::DsToKKPi;
         // DsToKKPi and DsToPiKK division
+        double invMassDs = 0.;
         if (candidate.isSelDsToKKPi() >= selectionFlagDs) {
-          entryDsHadronPair(getDeltaPhi(pAssoc.phi(), candidate.phi()),
-                            pAssoc.eta() - candidate.eta(),
-                            candidate.pt(),
-                            pAssoc.pt(),
-                            poolBin);
-          entryDsHadronRecoInfo(hfHelper.invMassDsToKKPi(candidate), isDsSignal);
-          entryDsHadronGenInfo(isDsPrompt);
+          invMassDs = hfHelper.invMassDsToKKPi(candidate);
         } else if (candidate.isSelDsToPiKK() >= selectionFlagDs) {
-          entryDsHadronPair(getDeltaPhi(pAssoc.phi(), candidate.phi()),
-                            pAssoc.eta() - candidate.eta(),
-                            candidate.pt(),
-                            pAssoc.pt(),
+          invMassDs = hfHelper.invMassDsToPiKK(candidate);
+        } else {
+          continue;
+        }
+        const auto ptCand = candidate.pt(), etaCand = candidate.eta(), phiCand = candidate.phi();
+        for (std::size_t iTrack = 0; iTrack < associatedTracks.size(); ++iTrack) {
+          entryDsHadronPair(getDeltaPhi(associatedTracks.phi[iTrack], phiCand),
+                            associatedTracks.eta[iTrack] - etaCand,
+                            ptCand,
+                            associatedTracks.pt[iTrack],
                             poolBin);
-          entryDsHadronRecoInfo(hfHelper.invMassDsToPiKK(candidate), isDsSignal);
+          entryDsHadronRecoInfo(invMassDs, isDsSignal);
           entryDsHadronGenInfo(isDsPrompt);
         }
       }
@@ -0,0 +1,106 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file utilsCorrelations.h
+/// \brief Utilities for the HF correlation analyses
+
+#ifndef PWGHF_HFC_UTILS_UTILSCORRELATIONS_H_
+#define PWGHF_HFC_UTILS_UTILSCORRELATIONS_H_
+
+#include <cstddef> // std::size_t
+#include <cstdint> // int64_t
+#include <vector>
+
+namespace o2::analysis::hf_correlations
+{
+/// Associated tracks of a collision, selected once and then paired with all the trigger candidates.
+/// The columns are stored as in the track table, so that the correlation variables computed from the buffer
+/// are the same as the ones computed from the table.
+struct AssociatedTracks {
+  std::vector<float> eta;
+  std::vector<float> phi;
+  std::vector<float> pt;
+  std::vector<float> px;     // only filled by add(track, mass)
+  std::vector<float> py;     // only filled by add(track, mass)
+  std::vector<float> pz;     // only filled by add(track, mass)
+  std::vector<float> energy; // energy in the given mass hypothesis, only filled by add(track, mass)
+  std::vector<int64_t> globalIndex;
+  int64_t collisionId = -1; // collision of the staged tracks, -1 if unknown
+
+  /// Empties the buffer, keeping the allocated memory.
+  void clear()
+  {
+    eta.clear();
+    phi.clear();
+    pt.clear();
+    px.clear();
+    py.clear();
+    pz.clear();
+    energy.clear();
+    globalIndex.clear();
+    collisionId = -1;
+  }
+
+  std::size_t size() const { return eta.size(); }
+
+  /// Adds the angular variables, pT and index of a track.
+  template <typename TTrack>
+  void add(TTrack const& track)
+  {
+    eta.push_back(track.eta());
+    phi.push_back(track.phi());
+    pt.push_back(track.pt());
+    globalIndex.push_back(track.globalIndex());
+  }
+
+  /// Adds a track together with its momentum and its energy in the given mass hypothesis.
+  template <typename TTrack>
+  void add(TTrack const& track, double mass)
+  {
+    add(track);
+    px.push_back(track.px());
+    py.push_back(track.py());
+    pz.push_back(track.pz());
+    energy.push_back(track.energy(mass));
+  }
+
+  /// Fills the buffer with the tracks of a mixed-event partner collision,
+  /// unless it already holds them from the previous pair.
+  template <typename TTracks>
+  void stageMixedEventTracks(int64_t partnerCollisionId, TTracks const& tracks)
+  {
+    if (collisionId == partnerCollisionId) {
+      return;
+    }
+    clear();
+    for (const auto& track : tracks) {
+      add(track);
+    }
+    collisionId = partnerCollisionId;
+  }
+
+  /// Same as stageMixedEventTracks(partnerCollisionId, tracks), with the momentum and energy of the tracks.
+  template <typename TTracks>
+  void stageMixedEventTracks(int64_t partnerCollisionId, TTracks const& tracks, double mass)
+  {
+    if (collisionId == partnerCollisionId) {
+      return;
+    }
+    clear();
+    for (const auto& track : tracks) {
+      add(track, mass);
+    }
+    collisionId = partnerCollisionId;
+  }
+};
+} // namespace o2::analysis::hf_correlations
+
+#endif // PWGHF_HFC_UTILS_UTILSCORRELATIONS_H_
@@ -35,7 +35,9 @@
 #include "Tools/KFparticle/KFUtilities.h"
 
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
+#include "PWGHF/Utils/utilsAnalysis.h"
 #include "PWGHF/Utils/utilsBfieldCCDB.h"
+#include "PWGHF/Utils/utilsMcMatching.h"
 
 using namespace o2;
 using namespace o2::analysis;
@@ -75,6 +77,7 @@ struct HfCandidateCreator2Prong {
   double massPiK{0.};
   double massKPi{0.};
   double bz{0.};
+  uint32_t svFitConfigHash{0}; // vertexing configuration required to reuse the secondary-vertex fits of the skim
 
   OutputObj<TH1F> hMass2{TH1F("hMass2", "2-prong candidates;inv. mass (#pi K) (GeV/#it{c}^{2});entries", 500, 0., 5.)};
   OutputObj<TH1F> hCovPVXX{TH1F("hCovPVXX", "2-prong candidates;XX element of cov. matrix of prim. vtx. position (cm^{2});entries", 100, 0., 1.e-4)};
@@ -91,7 +94,7 @@ struct HfCandidateCreator2Prong {
 
   void init(InitContext const&)
   {
-    std::array<bool, 2> doprocessDF{doprocessPvRefitWithDCAFitterN, doprocessNoPvRefitWithDCAFitterN};
+    std::array<bool, 4> doprocessDF{doprocessPvRefitWithDCAFitterN, doprocessNoPvRefitWithDCAFitterN, doprocessPvRefitWithDCAFitterNFromSkim, doprocessNoPvRefitWithDCAFitterNFromSkim};
     std::array<bool, 2> doprocessKF{doprocessPvRefitWithKFParticle, doprocessNoPvRefitWithKFParticle};
     if ((std::accumulate(doprocessDF.begin(), doprocessDF.end(), 0) + std::accumulate(doprocessKF.begin(), doprocessKF.end(), 0)) != 1) {
       LOGP(fatal, "Only one process function can be enabled at a time.");
@@ -112,7 +115,7 @@ struct HfCandidateCreator2Prong {
     runNumber = 0;
   }
 
-  template <bool doPvRefit, typename CandType, typename TTracks>
+  template <bool doPvRefit, bool useSvFitFromSkim = false, typename CandType, typename TTracks>
   void runCreator2ProngWithDCAFitterN(aod::Collisions const& collisions,
                                       CandType const& rowsTrackIndexProng2,
                                       TTracks const& tracks,
@@ -148,28 +151,55 @@ struct HfCandidateCreator2Prong {
         LOG(info) << ">>>>>>>>>>>> Magnetic field: " << bz;
         // df.setBz(bz); /// put it outside the 'if'! Otherwise we have a difference wrt bz Configurable (< 1 permille) in Run2 conv. data
         // df.print();
+        svFitConfigHash = getSvFitConfigHash(propagateToPCA, maxR, maxDZIni, minParamChange, minRelChi2Change, useAbsDCA, useWeightedFinalPCA, doprocessPvRefitWithDCAFitterNFromSkim, bz, static_cast<int>(df.getMatCorrType()));
       }
       df.setBz(bz);
 
-      // reconstruct the 2-prong secondary vertex
-      if (df.process(trackParVarPos1, trackParVarNeg1) == 0) {
-        continue;
+      std::array<double, 3> secondaryVertex;
+      float chi2PCA;
+      std::array<float, 6> covMatrixPCA;
+      std::array<float, 3> pvec0;
+      std::array<float, 3> pvec1;
+      o2::dataformats::DCA impactParameter0;
+      o2::dataformats::DCA impactParameter1;
+      o2::track::TrackParCov trackParVar0;
+      o2::track::TrackParCov trackParVar1;
+
+      // take the secondary vertex fitted in the skim, if it was fitted with the same configuration
+      bool isSvFitFromSkim = false;
+      if constexpr (useSvFitFromSkim) {
+        if (rowTrackIndexProng2.fitConfigHash() == svFitConfigHash) {
+          isSvFitFromSkim = true;
+          secondaryVertex = {rowTrackIndexProng2.xSecondaryVertex(), rowTrackIndexProng2.ySecondaryVertex(), rowTrackIndexProng2.zSecondaryVertex()};
+          chi2PCA = rowTrackIndexProng2.chi2PCA();
+          covMatrixPCA = {rowTrackIndexProng2.covSvXX(), rowTrackIndexProng2.covSvXY(), rowTrackIndexProng2.covSvYY(), rowTrackIndexProng2.covSvXZ(), rowTrackIndexProng2.covSvYZ(), rowTrackIndexProng2.covSvZZ()};
+          pvec0 = {rowTrackIndexProng2.pxProng0(), rowTrackIndexProng2.pyProng0(), rowTrackIndexProng2.pzProng0()};
+          pvec1 = {rowTrackIndexProng2.pxProng1(), rowTrackIndexProng2.pyProng1(), rowTrackIndexProng2.pzProng1()};
+          impactParameter0.set(rowTrackIndexProng2.impactParameter0(), rowTrackIndexProng2.impactParameterZ0(), rowTrackIndexProng2.impactParameterSigmaY20(), 0.f, 0.f);
+          impactParameter1.set(rowTrackIndexProng2.impactParameter1(), rowTrackIndexProng2.impactParameterZ1(), rowTrackIndexProng2.impactParameterSigmaY21(), 0.f, 0.f);
+        }
+      }
+
+      if (!isSvFitFromSkim) {
+        // reconstruct the 2-prong secondary vertex
+        if (df.process(trackParVarPos1, trackParVarNeg1) == 0) {
+          continue;
+        }
+        const auto& vertexPCA = df.getPCACandidate();
+        secondaryVertex = {vertexPCA[0], vertexPCA[1], vertexPCA[2]};
+        chi2PCA = df.getChi2AtPCACandidate();
+        covMatrixPCA = df.calcPCACovMatrixFlat();
+        trackParVar0 = df.getTrack(0);
+        trackParVar1 = df.getTrack(1);
+
+        // get track momenta
+        trackParVar0.getPxPyPzGlo(pvec0);
+        trackParVar1.getPxPyPzGlo(pvec1);
       }
-      const auto& secondaryVertex = df.getPCACandidate();
-      auto chi2PCA = df.getChi2AtPCACandidate();
-      auto covMatrixPCA = df.calcPCACovMatrixFlat();
       hCovSVXX->Fill(covMatrixPCA[0]); // FIXME: Calculation of errorDecayLength(XY) gives wrong values without this line.
       hCovSVYY->Fill(covMatrixPCA[2]);
       hCovSVXZ->Fill(covMatrixPCA[3]);
       hCovSVZZ->Fill(covMatrixPCA[5]);
-      auto trackParVar0 = df.getTrack(0);
-      auto trackParVar1 = df.getTrack(1);
-
-      // get track momenta
-      std::array<float, 3> pvec0;
-      std::array<float, 3> pvec1;
-      trackParVar0.getPxPyPzGlo(pvec0);
-      trackParVar1.getPxPyPzGlo(pvec1);
 
       // get track impact parameters
       // This modifies track momenta!
@@ -195,10 +225,10 @@ struct HfCandidateCreator2Prong {
       hCovPVYY->Fill(covMatrixPV[2]);
       hCovPVXZ->Fill(covMatrixPV[3]);
       hCovPVZZ->Fill(covMatrixPV[5]);
-      o2::dataformats::DCA impactParameter0;
-      o2::dataformats::DCA impactParameter1;
-      trackParVar0.propagateToDCA(primaryVertex, bz, &impactParameter0);
-      trackParVar1.propagateToDCA(primaryVertex, bz, &impactParameter1);
+      if (!isSvFitFromSkim) {
+        trackParVar0.propagateToDCA(primaryVertex, bz, &impactParameter0);
+        trackParVar1.propagateToDCA(primaryVertex, bz, &impactParameter1);
+      }
       hDcaXYProngs->Fill(track0.pt(), impactParameter0.getY() * toMicrometers);
       hDcaXYProngs->Fill(track1.pt(), impactParameter1.getY() * toMicrometers);
       hDcaZProngs->Fill(track0.pt(), impactParameter0.getZ() * toMicrometers);
@@ -377,6 +407,26 @@ struct HfCandidateCreator2Prong {
 
   PROCESS_SWITCH(HfCandidateCreator2Prong, processNoPvRefitWithDCAFitterN, "Run candidate creator without PV refit", true);
 
+  void processPvRefitWithDCAFitterNFromSkim(aod::Collisions const& collisions,
+                                            soa::Join<aod::Hf2Prongs, aod::HfPvRefit2Prong, aod::HfSvFit2Prong> const& rowsTrackIndexProng2,
+                                            aod::TracksWCov const& tracks,
+                                            aod::BCsWithTimestamps const& bcWithTimeStamps)
+  {
+    runCreator2ProngWithDCAFitterN<true, true>(collisions, rowsTrackIndexProng2, tracks, bcWithTimeStamps);
+  }
+
+  PROCESS_SWITCH(HfCandidateCreator2Prong, processPvRefitWithDCAFitterNFromSkim, "Run candidate creator with PV refit, reusing the secondary-vertex fits of the skim", false);
+
+  void processNoPvRefitWithDCAFitterNFromSkim(aod::Collisions const& collisions,
+                                              soa::Join<aod::Hf2Prongs, aod::HfSvFit2Prong> const& rowsTrackIndexProng2,
+                                              aod::TracksWCov const& tracks,
+                                              aod::BCsWithTimestamps const& bcWithTimeStamps)
+  {
+    runCreator2ProngWithDCAFitterN<false, true>(collisions, rowsTrackIndexProng2, tracks, bcWithTimeStamps);
+  }
+
+  PROCESS_SWITCH(HfCandidateCreator2Prong, processNoPvRefitWithDCAFitterNFromSkim, "Run candidate creator without PV refit, reusing the secondary-vertex fits of the skim", false);
+
   void processPvRefitWithKFParticle(aod::Collisions const& collisions,
                                     soa::Join<aod::Hf2Prongs, aod::HfPvRefit2Prong> const& rowsTrackIndexProng2,
                                     soa::Join<aod::TracksWCov, aod::TracksExtra> const& tracks,
@@ -402,7 +452,15 @@ struct HfCandidateCreator2ProngExpressions {
   Produces<aod::HfCand2ProngMcRec> rowMcMatchRec;
   Produces<aod::HfCand2ProngMcGen> rowMcMatchGen;
 
-  void init(InitContext const&) {}
+  HfDecayChannelMatcher<2> mcMatcher;
+
+  void init(InitContext const&)
+  {
+    // channels in order of priority
+    mcMatcher.addChannel(DecayType::D0ToPiK, pdg::Code::kD0, std::array{+kPiPlus, -kKPlus});           // D0(bar) → π± K∓
+    mcMatcher.addChannel(DecayType::JpsiToEE, pdg::Code::kJPsi, std::array{+kElectron, -kElectron});   // J/ψ → e+ e−
+    mcMatcher.addChannel(DecayType::JpsiToMuMu, pdg::Code::kJPsi, std::array{+kMuonPlus, -kMuonPlus}); // J/ψ → μ+ μ−
+  }
 
   /// Performs MC matching.
   void processMc(aod::TracksWMc const& tracks,
@@ -410,43 +468,22 @@ struct HfCandidateCreator2ProngExpressions {
   {
     rowCandidateProng2->bindExternalIndices(&tracks);
 
-    int indexRec = -1;
-    int8_t sign = 0;
     int8_t flag = 0;
     int8_t origin = 0;
 
     // Match reconstructed candidates.
     // Spawned table can be used directly
     for (const auto& candidate : *rowCandidateProng2) {
-      flag = 0;
       origin = 0;
       auto arrayDaughters = std::array{candidate.prong0_as<aod::TracksWMc>(), candidate.prong1_as<aod::TracksWMc>()};
 
-      // D0(bar) → π± K∓
-      indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, pdg::Code::kD0, std::array{+kPiPlus, -kKPlus}, true, &sign);
-      if (indexRec > -1) {
-        flag = sign * (1 << DecayType::D0ToPiK);
-      }
-
-      // J/ψ → e+ e−
-      if (flag == 0) {
-        indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, pdg::Code::kJPsi, std::array{+kElectron, -kElectron}, true);
-        if (indexRec > -1) {
-          flag = 1 << DecayType::JpsiToEE;
-        }
-      }
-
-      // J/ψ → μ+ μ−
-      if (flag == 0) {
-        indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, pdg::Code::kJPsi, std::array{+kMuonPlus, -kMuonPlus}, true);
-        if (indexRec > -1) {
-          flag = 1 << DecayType::JpsiToMuMu;
-        }
-      }
+      // all the channels are checked in one pass
+      auto match = mcMatcher.matchRec(mcParticles, arrayDaughters);
+      flag = match.flag;
 
       // Check whether the particle is non-prompt (from a b quark).
       if (flag != 0) {
-        auto particle = mcParticles.rawIteratorAt(indexRec);
+        auto particle = mcParticles.rawIteratorAt(match.indexMother);
         origin = RecoDecay::getCharmHadronOrigin(mcParticles, particle);
       }
 
@@ -455,27 +492,9 @@ struct HfCandidateCreator2ProngExpressions {
 
     // Match generated particles.
     for (const auto& particle : mcParticles) {
-      flag = 0;
       origin = 0;
 
-      // D0(bar) → π± K∓
-      if (RecoDecay::isMatchedMCGen(mcParticles, particle, pdg::Code::kD0, std::array{+kPiPlus, -kKPlus}, true, &sign)) {
-        flag = sign * (1 << DecayType::D0ToPiK);
-      }
-
-      // J/ψ → e+ e−
-      if (flag == 0) {
-        if (RecoDecay::isMatchedMCGen(mcParticles, particle, pdg::Code::kJPsi, std::array{+kElectron, -kElectron}, true)) {
-          flag = 1 << DecayType::JpsiToEE;
-        }
-      }
-
-      // J/ψ → μ+ μ−
-      if (flag == 0) {
-        if (RecoDecay::isMatchedMCGen(mcParticles, particle, pdg::Code::kJPsi, std::array{+kMuonPlus, -kMuonPlus}, true)) {
-          flag = 1 << DecayType::JpsiToMuMu;
-        }
-      }
+      flag = mcMatcher.matchGen(mcParticles, particle).flag;
 
       // Check whether the particle is non-prompt (from a b quark).
       if (flag != 0) {
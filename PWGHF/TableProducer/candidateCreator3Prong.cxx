@@ -15,6 +15,8 @@
 ///
 /// \author Vít Kučera <vit.kucera@cern.ch>, CERN
 
+#include <numeric> // std::accumulate
+
 #include "DCAFitter/DCAFitterN.h"
 #include "Framework/AnalysisTask.h"
 #include "Framework/runDataProcessing.h"
@@ -23,7 +25,9 @@
 #include "Common/Core/trackUtilities.h"
 
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
+#include "PWGHF/Utils/utilsAnalysis.h"
 #include "PWGHF/Utils/utilsBfieldCCDB.h"
+#include "PWGHF/Utils/utilsMcMatching.h"
 
 using namespace o2;
 using namespace o2::analysis;
@@ -60,6 +64,7 @@ struct HfCandidateCreator3Prong {
   double massK{0.};
   double massPiKPi{0.};
   double bz{0.};
+  uint32_t svFitConfigHash{0}; // vertexing configuration required to reuse the secondary-vertex fits of the skim
 
   OutputObj<TH1F> hMass3{TH1F("hMass3", "3-prong candidates;inv. mass (#pi K #pi) (GeV/#it{c}^{2});entries", 500, 1.6, 2.1)};
   OutputObj<TH1F> hCovPVXX{TH1F("hCovPVXX", "3-prong candidates;XX element of cov. matrix of prim. vtx. position (cm^{2});entries", 100, 0., 1.e-4)};
@@ -75,10 +80,10 @@ struct HfCandidateCreator3Prong {
 
   void init(InitContext const&)
   {
-    if (doprocessPvRefit && doprocessNoPvRefit) {
-      LOGP(fatal, "Only one process function between processPvRefit and processNoPvRefit can be enabled at a time.");
+    std::array<bool, 4> doprocess{doprocessPvRefit, doprocessNoPvRefit, doprocessPvRefitFromSkim, doprocessNoPvRefitFromSkim};
+    if (std::accumulate(doprocess.begin(), doprocess.end(), 0) > 1) {
+      LOGP(fatal, "Only one process function can be enabled at a time.");
     }
-
     massPi = o2::analysis::pdg::MassPiPlus;
     massK = o2::analysis::pdg::MassKPlus;
     ccdb->setURL(ccdbUrl);
@@ -88,7 +93,7 @@ struct HfCandidateCreator3Prong {
     runNumber = 0;
   }
 
-  template <bool doPvRefit = false, typename Cand>
+  template <bool doPvRefit = false, bool useSvFitFromSkim = false, typename Cand>
   void runCreator3Prong(aod::Collisions const& collisions,
                         Cand const& rowsTrackIndexProng3,
                         aod::TracksWCov const& tracks,
@@ -126,31 +131,59 @@ struct HfCandidateCreator3Prong {
         LOG(info) << ">>>>>>>>>>>> Magnetic field: " << bz;
         // df.setBz(bz); /// put it outside the 'if'! Otherwise we have a difference wrt bz Configurable (< 1 permille) in Run2 conv. data
         // df.print();
+        svFitConfigHash = getSvFitConfigHash(propagateToPCA, maxR, maxDZIni, minParamChange, minRelChi2Change, useAbsDCA, useWeightedFinalPCA, doprocessPvRefitFromSkim, bz, static_cast<int>(df.getMatCorrType()));
       }
       df.setBz(bz);
 
-      // reconstruct the 3-prong secondary vertex
-      if (df.process(trackParVar0, trackParVar1, trackParVar2) == 0) {
-        continue;
+      std::array<double, 3> secondaryVertex;
+      float chi2PCA;
+      std::array<float, 6> covMatrixPCA;
+      std::array<float, 3> pvec0;
+      std::array<float, 3> pvec1;
+      std::array<float, 3> pvec2;
+      o2::dataformats::DCA impactParameter0;
+      o2::dataformats::DCA impactParameter1;
+      o2::dataformats::DCA impactParameter2;
+
+      // take the secondary vertex fitted in the skim, if it was fitted with the same configuration
+      bool isSvFitFromSkim = false;
+      if constexpr (useSvFitFromSkim) {
+        if (rowTrackIndexProng3.fitConfigHash() == svFitConfigHash) {
+          isSvFitFromSkim = true;
+          secondaryVertex = {rowTrackIndexProng3.xSecondaryVertex(), rowTrackIndexProng3.ySecondaryVertex(), rowTrackIndexProng3.zSecondaryVertex()};
+          chi2PCA = rowTrackIndexProng3.chi2PCA();
+          covMatrixPCA = {rowTrackIndexProng3.covSvXX(), rowTrackIndexProng3.covSvXY(), rowTrackIndexProng3.covSvYY(), rowTrackIndexProng3.covSvXZ(), rowTrackIndexProng3.covSvYZ(), rowTrackIndexProng3.covSvZZ()};
+          pvec0 = {rowTrackIndexProng3.pxProng0(), rowTrackIndexProng3.pyProng0(), rowTrackIndexProng3.pzProng0()};
+          pvec1 = {rowTrackIndexProng3.pxProng1(), rowTrackIndexProng3.pyProng1(), rowTrackIndexProng3.pzProng1()};
+          pvec2 = {rowTrackIndexProng3.pxProng2(), rowTrackIndexProng3.pyProng2(), rowTrackIndexProng3.pzProng2()};
+          impactParameter0.set(rowTrackIndexProng3.impactParameter0(), rowTrackIndexProng3.impactParameterZ0(), rowTrackIndexProng3.impactParameterSigmaY20(), 0.f, 0.f);
+          impactParameter1.set(rowTrackIndexProng3.impactParameter1(), rowTrackIndexProng3.impactParameterZ1(), rowTrackIndexProng3.impactParameterSigmaY21(), 0.f, 0.f);
+          impactParameter2.set(rowTrackIndexProng3.impactParameter2(), rowTrackIndexProng3.impactParameterZ2(), rowTrackIndexProng3.impactParameterSigmaY22(), 0.f, 0.f);
+        }
+      }
+
+      if (!isSvFitFromSkim) {
+        // reconstruct the 3-prong secondary vertex
+        if (df.process(trackParVar0, trackParVar1, trackParVar2) == 0) {
+          continue;
+        }
+        const auto& vertexPCA = df.getPCACandidate();
+        secondaryVertex = {vertexPCA[0], vertexPCA[1], vertexPCA[2]};
+        chi2PCA = df.getChi2AtPCACandidate();
+        covMatrixPCA = df.calcPCACovMatrixFlat();
+        trackParVar0 = df.getTrack(0);
+        trackParVar1 = df.getTrack(1);
+        trackParVar2 = df.getTrack(2);
+
+        // get track momenta
+        trackParVar0.getPxPyPzGlo(pvec0);
+        trackParVar1.getPxPyPzGlo(pvec1);
+        trackParVar2.getPxPyPzGlo(pvec2);
       }
-      const auto& secondaryVertex = df.getPCACandidate();
-      auto chi2PCA = df.getChi2AtPCACandidate();
-      auto covMatrixPCA = df.calcPCACovMatrixFlat();
       hCovSVXX->Fill(covMatrixPCA[0]); // FIXME: Calculation of errorDecayLength(XY) gives wrong values without this line.
       hCovSVYY->Fill(covMatrixPCA[2]);
       hCovSVXZ->Fill(covMatrixPCA[3]);
       hCovSVZZ->Fill(covMatrixPCA[5]);
-      trackParVar0 = df.getTrack(0);
-      trackParVar1 = df.getTrack(1);
-      trackParVar2 = df.getTrack(2);
-
-      // get track momenta
-      std::array<float, 3> pvec0;
-      std::array<float, 3> pvec1;
-      std::array<float, 3> pvec2;
-      trackParVar0.getPxPyPzGlo(pvec0);
-      trackParVar1.getPxPyPzGlo(pvec1);
-      trackParVar2.getPxPyPzGlo(pvec2);
 
       // get track impact parameters
       // This modifies track momenta!
@@ -176,12 +209,11 @@ struct HfCandidateCreator3Prong {
       hCovPVYY->Fill(covMatrixPV[2]);
       hCovPVXZ->Fill(covMatrixPV[3]);
       hCovPVZZ->Fill(covMatrixPV[5]);
-      o2::dataformats::DCA impactParameter0;
-      o2::dataformats::DCA impactParameter1;
-      o2::dataformats::DCA impactParameter2;
-      trackParVar0.propagateToDCA(primaryVertex, bz, &impactParameter0);
-      trackParVar1.propagateToDCA(primaryVertex, bz, &impactParameter1);
-      trackParVar2.propagateToDCA(primaryVertex, bz, &impactParameter2);
+      if (!isSvFitFromSkim) {
+        trackParVar0.propagateToDCA(primaryVertex, bz, &impactParameter0);
+        trackParVar1.propagateToDCA(primaryVertex, bz, &impactParameter1);
+        trackParVar2.propagateToDCA(primaryVertex, bz, &impactParameter2);
+      }
       hDcaXYProngs->Fill(track0.pt(), impactParameter0.getY() * toMicrometers);
       hDcaXYProngs->Fill(track1.pt(), impactParameter1.getY() * toMicrometers);
       hDcaXYProngs->Fill(track2.pt(), impactParameter2.getY() * toMicrometers);
@@ -238,6 +270,26 @@ struct HfCandidateCreator3Prong {
   }
 
   PROCESS_SWITCH(HfCandidateCreator3Prong, processNoPvRefit, "Run candidate creator without PV refit", true);
+
+  void processPvRefitFromSkim(aod::Collisions const& collisions,
+                              soa::Join<aod::Hf3Prongs, aod::HfPvRefit3Prong, aod::HfSvFit3Prong> const& rowsTrackIndexProng3,
+                              aod::TracksWCov const& tracks,
+                              aod::BCsWithTimestamps const& bcWithTimeStamps)
+  {
+    runCreator3Prong<true, true>(collisions, rowsTrackIndexProng3, tracks, bcWithTimeStamps);
+  }
+
+  PROCESS_SWITCH(HfCandidateCreator3Prong, processPvRefitFromSkim, "Run candidate creator with PV refit, reusing the secondary-vertex fits of the skim", false);
+
+  void processNoPvRefitFromSkim(aod::Collisions const& collisions,
+                                soa::Join<aod::Hf3Prongs, aod::HfSvFit3Prong> const& rowsTrackIndexProng3,
+                                aod::TracksWCov const& tracks,
+                                aod::BCsWithTimestamps const& bcWithTimeStamps)
+  {
+    runCreator3Prong<false, true>(collisions, rowsTrackIndexProng3, tracks, bcWithTimeStamps);
+  }
+
+  PROCESS_SWITCH(HfCandidateCreator3Prong, processNoPvRefitFromSkim, "Run candidate creator without PV refit, reusing the secondary-vertex fits of the skim", false);
 };
 
 /// Extends the base table with expression columns.
@@ -246,7 +298,21 @@ struct HfCandidateCreator3ProngExpressions {
   Produces<aod::HfCand3ProngMcRec> rowMcMatchRec;
   Produces<aod::HfCand3ProngMcGen> rowMcMatchGen;
 
-  void init(InitContext const&) {}
+  HfDecayChannelMatcher<3> mcMatcher;
+
+  void init(InitContext const&)
+  {
+    // channels in order of priority
+    mcMatcher.addChannel(DecayType::DplusToPiKPi, pdg::Code::kDPlus, std::array{+kPiPlus, -kKPlus, +kPiPlus}, 2);   // D± → π± K∓ π±
+    mcMatcher.addChannel(DecayType::DsToKKPi, pdg::Code::kDS, std::array{+kKPlus, -kKPlus, +kPiPlus}, 2);           // Ds± → K± K∓ π±
+    mcMatcher.addResonantChannel(DecayChannelDs::PhiPi, std::array{333, +kPiPlus});                                 // Ds± → Phi π±
+    mcMatcher.addResonantChannel(DecayChannelDs::K0starK, std::array{313, +kKPlus});                                // Ds± → K*(892)0bar K±
+    mcMatcher.addChannel(DecayType::LcToPKPi, pdg::Code::kLambdaCPlus, std::array{+kProton, -kKPlus, +kPiPlus}, 2); // Λc± → p± K∓ π±
+    mcMatcher.addResonantChannel(1, std::array{+kProton, 313});                                                     // Λc± → p± K*
+    mcMatcher.addResonantChannel(2, std::array{2224, +kKPlus});                                                     // Λc± → Δ(1232)±± K∓
+    mcMatcher.addResonantChannel(3, std::array{3124, +kPiPlus});                                                    // Λc± → Λ(1520) π±
+    mcMatcher.addChannel(DecayType::XicToPKPi, pdg::Code::kXiCPlus, std::array{+kProton, -kKPlus, +kPiPlus}, 2);    // Ξc± → p± K∓ π±
+  }
 
   /// Performs MC matching.
   void processMc(aod::TracksWMc const& tracks,
@@ -254,170 +320,47 @@ struct HfCandidateCreator3ProngExpressions {
   {
     rowCandidateProng3->bindExternalIndices(&tracks);
 
-    int indexRec = -1;
-    int8_t sign = 0;
     int8_t flag = 0;
     int8_t origin = 0;
     int8_t swapping = 0;
-    int8_t channel = 0;
-    std::vector<int> arrDaughIndex;
-    std::array<int, 2> arrPDGDaugh;
-    std::array<int, 2> arrPDGResonant1 = {kProton, 313};       // Λc± → p± K*
-    std::array<int, 2> arrPDGResonant2 = {2224, kKPlus};       // Λc± → Δ(1232)±± K∓
-    std::array<int, 2> arrPDGResonant3 = {3124, kPiPlus};      // Λc± → Λ(1520) π±
-    std::array<int, 2> arrPDGResonantDsPhiPi = {333, kPiPlus}; // Ds± → Phi π±
-    std::array<int, 2> arrPDGResonantDsKstarK = {313, kKPlus}; // Ds± → K*(892)0bar K±
 
     // Match reconstructed candidates.
     // Spawned table can be used directly
     for (const auto& candidate : *rowCandidateProng3) {
-      flag = 0;
       origin = 0;
       swapping = 0;
-      channel = 0;
-      arrDaughIndex.clear();
       auto arrayDaughters = std::array{candidate.prong0_as<aod::TracksWMc>(), candidate.prong1_as<aod::TracksWMc>(), candidate.prong2_as<aod::TracksWMc>()};
 
-      // D± → π± K∓ π±
-      indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, pdg::Code::kDPlus, std::array{+kPiPlus, -kKPlus, +kPiPlus}, true, &sign, 2);
-      if (indexRec > -1) {
-        flag = sign * (1 << DecayType::DplusToPiKPi);
-      }
-
-      // Ds± → K± K∓ π±
-      if (flag == 0) {
-        indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, pdg::Code::kDS, std::array{+kKPlus, -kKPlus, +kPiPlus}, true, &sign, 2);
-        if (indexRec > -1) {
-          flag = sign * (1 << DecayType::DsToKKPi);
-          if (arrayDaughters[0].has_mcParticle()) {
-            swapping = int8_t(std::abs(arrayDaughters[0].mcParticle().pdgCode()) == kPiPlus);
-          }
-          RecoDecay::getDaughters(mcParticles.rawIteratorAt(indexRec), &arrDaughIndex, std::array{0}, 1);
-          if (arrDaughIndex.size() == 2) {
-            for (auto iProng = 0u; iProng < arrDaughIndex.size(); ++iProng) {
-              auto daughI = mcParticles.rawIteratorAt(arrDaughIndex[iProng]);
-              arrPDGDaugh[iProng] = std::abs(daughI.pdgCode());
-            }
-            if ((arrPDGDaugh[0] == arrPDGResonantDsPhiPi[0] && arrPDGDaugh[1] == arrPDGResonantDsPhiPi[1]) || (arrPDGDaugh[0] == arrPDGResonantDsPhiPi[1] && arrPDGDaugh[1] == arrPDGResonantDsPhiPi[0])) {
-              channel = DecayChannelDs::PhiPi;
-            } else if ((arrPDGDaugh[0] == arrPDGResonantDsKstarK[0] && arrPDGDaugh[1] == arrPDGResonantDsKstarK[1]) || (arrPDGDaugh[0] == arrPDGResonantDsKstarK[1] && arrPDGDaugh[1] == arrPDGResonantDsKstarK[0])) {
-              channel = DecayChannelDs::K0starK;
-            }
-          }
-        }
-      }
+      // all the channels are checked in one pass
+      auto match = mcMatcher.matchRec(mcParticles, arrayDaughters);
+      flag = match.flag;
 
-      // Λc± → p± K∓ π±
-      if (flag == 0) {
-        indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, pdg::Code::kLambdaCPlus, std::array{+kProton, -kKPlus, +kPiPlus}, true, &sign, 2);
-        if (indexRec > -1) {
-          flag = sign * (1 << DecayType::LcToPKPi);
-
-          // Flagging the different Λc± → p± K∓ π± decay channels
-          if (arrayDaughters[0].has_mcParticle()) {
-            swapping = int8_t(std::abs(arrayDaughters[0].mcParticle().pdgCode()) == kPiPlus);
-          }
-          RecoDecay::getDaughters(mcParticles.rawIteratorAt(indexRec), &arrDaughIndex, std::array{0}, 1);
-          if (arrDaughIndex.size() == 2) {
-            for (auto iProng = 0u; iProng < arrDaughIndex.size(); ++iProng) {
-              auto daughI = mcParticles.rawIteratorAt(arrDaughIndex[iProng]);
-              arrPDGDaugh[iProng] = std::abs(daughI.pdgCode());
-            }
-            if ((arrPDGDaugh[0] == arrPDGResonant1[0] && arrPDGDaugh[1] == arrPDGResonant1[1]) || (arrPDGDaugh[0] == arrPDGResonant1[1] && arrPDGDaugh[1] == arrPDGResonant1[0])) {
-              channel = 1;
-            } else if ((arrPDGDaugh[0] == arrPDGResonant2[0] && arrPDGDaugh[1] == arrPDGResonant2[1]) || (arrPDGDaugh[0] == arrPDGResonant2[1] && arrPDGDaugh[1] == arrPDGResonant2[0])) {
-              channel = 2;
-            } else if ((arrPDGDaugh[0] == arrPDGResonant3[0] && arrPDGDaugh[1] == arrPDGResonant3[1]) || (arrPDGDaugh[0] == arrPDGResonant3[1] && arrPDGDaugh[1] == arrPDGResonant3[0])) {
-              channel = 3;
-            }
-          }
-        }
-      }
-
-      // Ξc± → p± K∓ π±
-      if (flag == 0) {
-        indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, pdg::Code::kXiCPlus, std::array{+kProton, -kKPlus, +kPiPlus}, true, &sign, 2);
-        if (indexRec > -1) {
-          flag = sign * (1 << DecayType::XicToPKPi);
-        }
-      }
-
-      // Check whether the particle is non-prompt (from a b quark).
       if (flag != 0) {
-        auto particle = mcParticles.rawIteratorAt(indexRec);
+        // Ds± and Λc± with the pion as first prong
+        if (std::abs(flag) == (1 << DecayType::DsToKKPi) || std::abs(flag) == (1 << DecayType::LcToPKPi)) {
+          swapping = int8_t(std::abs(arrayDaughters[0].mcParticle().pdgCode()) == kPiPlus);
+        }
+        // Check whether the particle is non-prompt (from a b quark).
+        auto particle = mcParticles.rawIteratorAt(match.indexMother);
         origin = RecoDecay::getCharmHadronOrigin(mcParticles, particle);
       }
 
-      rowMcMatchRec(flag, origin, swapping, channel);
+      rowMcMatchRec(flag, origin, swapping, match.resonantChannel);
     }
 
     // Match generated particles.
     for (const auto& particle : mcParticles) {
-      flag = 0;
       origin = 0;
-      channel = 0;
-      arrDaughIndex.clear();
 
-      // D± → π± K∓ π±
-      if (RecoDecay::isMatchedMCGen(mcParticles, particle, pdg::Code::kDPlus, std::array{+kPiPlus, -kKPlus, +kPiPlus}, true, &sign, 2)) {
-        flag = sign * (1 << DecayType::DplusToPiKPi);
-      }
-
-      // Ds± → K± K∓ π±
-      if (flag == 0) {
-        if (RecoDecay::isMatchedMCGen(mcParticles, particle, pdg::Code::kDS, std::array{+kKPlus, -kKPlus, +kPiPlus}, true, &sign, 2)) {
-          flag = sign * (1 << DecayType::DsToKKPi);
-          RecoDecay::getDaughters(particle, &arrDaughIndex, std::array{0}, 1);
-          if (arrDaughIndex.size() == 2) {
-            for (auto jProng = 0u; jProng < arrDaughIndex.size(); ++jProng) {
-              auto daughJ = mcParticles.rawIteratorAt(arrDaughIndex[jProng]);
-              arrPDGDaugh[jProng] = std::abs(daughJ.pdgCode());
-            }
-            if ((arrPDGDaugh[0] == arrPDGResonantDsPhiPi[0] && arrPDGDaugh[1] == arrPDGResonantDsPhiPi[1]) || (arrPDGDaugh[0] == arrPDGResonantDsPhiPi[1] && arrPDGDaugh[1] == arrPDGResonantDsPhiPi[0])) {
-              channel = DecayChannelDs::PhiPi;
-            } else if ((arrPDGDaugh[0] == arrPDGResonantDsKstarK[0] && arrPDGDaugh[1] == arrPDGResonantDsKstarK[1]) || (arrPDGDaugh[0] == arrPDGResonantDsKstarK[1] && arrPDGDaugh[1] == arrPDGResonantDsKstarK[0])) {
-              channel = DecayChannelDs::K0starK;
-            }
-          }
-        }
-      }
-
-      // Λc± → p± K∓ π±
-      if (flag == 0) {
-        if (RecoDecay::isMatchedMCGen(mcParticles, particle, pdg::Code::kLambdaCPlus, std::array{+kProton, -kKPlus, +kPiPlus}, true, &sign, 2)) {
-          flag = sign * (1 << DecayType::LcToPKPi);
-
-          // Flagging the different Λc± → p± K∓ π± decay channels
-          RecoDecay::getDaughters(particle, &arrDaughIndex, std::array{0}, 1);
-          if (arrDaughIndex.size() == 2) {
-            for (auto jProng = 0u; jProng < arrDaughIndex.size(); ++jProng) {
-              auto daughJ = mcParticles.rawIteratorAt(arrDaughIndex[jProng]);
-              arrPDGDaugh[jProng] = std::abs(daughJ.pdgCode());
-            }
-            if ((arrPDGDaugh[0] == arrPDGResonant1[0] && arrPDGDaugh[1] == arrPDGResonant1[1]) || (arrPDGDaugh[0] == arrPDGResonant1[1] && arrPDGDaugh[1] == arrPDGResonant1[0])) {
-              channel = 1;
-            } else if ((arrPDGDaugh[0] == arrPDGResonant2[0] && arrPDGDaugh[1] == arrPDGResonant2[1]) || (arrPDGDaugh[0] == arrPDGResonant2[1] && arrPDGDaugh[1] == arrPDGResonant2[0])) {
-              channel = 2;
-            } else if ((arrPDGDaugh[0] == arrPDGResonant3[0] && arrPDGDaugh[1] == arrPDGResonant3[1]) || (arrPDGDaugh[0] == arrPDGResonant3[1] && arrPDGDaugh[1] == arrPDGResonant3[0])) {
-              channel = 3;
-            }
-          }
-        }
-      }
-
-      // Ξc± → p± K∓ π±
-      if (flag == 0) {
-        if (RecoDecay::isMatchedMCGen(mcParticles, particle, pdg::Code::kXiCPlus, std::array{+kProton, -kKPlus, +kPiPlus}, true, &sign, 2)) {
-          flag = sign * (1 << DecayType::XicToPKPi);
-        }
-      }
+      auto match = mcMatcher.matchGen(mcParticles, particle);
+      flag = match.flag;
 
       // Check whether the particle is non-prompt (from a b quark).
       if (flag != 0) {
         origin = RecoDecay::getCharmHadronOrigin(mcParticles, particle);
       }
 
-      rowMcMatchGen(flag, origin, channel);
+      rowMcMatchGen(flag, origin, match.resonantChannel);
     }
   }
 
@@ -33,9 +33,11 @@
 #include "Framework/AnalysisTask.h"
 #include "Framework/HistogramRegistry.h"
 #include "Framework/runDataProcessing.h"
+#include "ReconstructionDataFormats/DCA.h"
 #include "ReconstructionDataFormats/V0.h"
 #include "ReconstructionDataFormats/Vertex.h" // for PV refit
 
+#include "Common/Core/PrimaryVertexRefitter.h"
 #include "Common/Core/trackUtilities.h"
 #include "Common/DataModel/CollisionAssociationTables.h"
 #include "Common/DataModel/EventSelection.h"
@@ -259,6 +261,7 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
   Configurable<bool> doPvRefit{"doPvRefit", false, "do PV refit excluding the considered track"};
   Configurable<bool> fillHistograms{"fillHistograms", true, "fill histograms"};
   Configurable<bool> debugPvRefit{"debugPvRefit", false, "debug lines for primary vertex refit"};
+  Configurable<bool> useFastPvRefit{"useFastPvRefit", false, "PV refit: remove the considered track with a Kalman downdate of the PV fit instead of a full refit (approximate: weights and linearisation of the other tracks not updated)"};
   // Configurable<double> bz{"bz", 5., "bz field"};
   // quality cut
   Configurable<bool> doCutQuality{"doCutQuality", true, "apply quality cuts"};
@@ -308,6 +311,7 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
   o2::base::MatLayerCylSet* lut;
   o2::base::Propagator::MatCorrType noMatCorr = o2::base::Propagator::MatCorrType::USEMatCorrNONE;
   int runNumber;
+  PrimaryVertexRefitter pvRefitter; // vertexer configured once, prepared once per collision
 
   // single-track cuts
   static const int nCuts = 4;
@@ -404,6 +408,8 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
 
       lut = o2::base::MatLayerCylSet::rectifyPtrFromFile(ccdb->get<o2::base::MatLayerCylSet>(ccdbPathLut));
       runNumber = 0;
+
+      pvRefitter.init(); /// no diamond constraint
     }
   }
 
@@ -610,54 +616,16 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
     }
   }
 
-  /// Method for the PV refit and DCA recalculation for tracks with a collision assigned
+  /// Method to prepare the PV refit for the current collision, to be called once per collision
   /// \param collision is a collision
-  /// \param bcWithTimeStamps is a table of bunch crossing joined with timestamps used to query the CCDB for B and material budget
-  /// \param vecPvContributorGlobId is a vector containing the global ID of PV contributors for the current collision
   /// \param vecPvContributorTrackParCov is a vector containing the TrackParCov of PV contributors for the current collision
-  /// \param myTrack is the track to be removed, if contributor, from the PV refit
-  /// \param pvCoord is an array containing the coordinates of the refitted PV
-  /// \param pvCovMatrix is an array containing the covariance matrix values of the refitted PV
-  /// \param dcaXYdcaZ is an array containing the dcaXY and dcaZ of myTrack with respect to the refitted PV
-  void performPvRefitTrack(aod::Collision const& collision,
-                           aod::BCsWithTimestamps const& bcWithTimeStamps,
-                           std::vector<int64_t> vecPvContributorGlobId,
-                           std::vector<o2::track::TrackParCov> vecPvContributorTrackParCov,
-                           TracksWithSelAndDCA::iterator const& myTrack,
-                           std::array<float, 3>& pvCoord,
-                           std::array<float, 6>& pvCovMatrix,
-                           std::array<float, 2>& dcaXYdcaZ)
+  /// \return true if the PV refit is doable
+  bool preparePvRefit(aod::Collision const& collision,
+                      std::vector<o2::track::TrackParCov> const& vecPvContributorTrackParCov)
   {
-    std::vector<bool> vecPvRefitContributorUsed(vecPvContributorGlobId.size(), true);
-
-    /// Prepare the vertex refitting
     // set the magnetic field from CCDB
     auto bc = collision.bc_as<o2::aod::BCsWithTimestamps>();
     initCCDB(bc, runNumber, ccdb, isRun2 ? ccdbPathGrp : ccdbPathGrpMag, lut, isRun2);
-    /*if (runNumber != bc.runNumber()) {
-
-      if (isRun2) { // Run 2 GRP object
-        o2::parameters::GRPObject* grpo = ccdb->getForTimeStamp<o2::parameters::GRPObject>(ccdbPathGrp, bc.timestamp());
-        if (grpo != nullptr) {
-          o2::base::Propagator::initFieldFromGRP(grpo);
-          o2::base::Propagator::Instance()->setMatLUT(lut);
-          LOGF(info, "Setting magnetic field to %d kG for run %d from its GRP CCDB object (type o2::parameters::GRPObject)", grpo->getNominalL3Field(), bc.runNumber());
-        } else {
-          LOGF(fatal, "Run 2 GRP object (type o2::parameters::GRPObject) is not available in CCDB for run=%d at timestamp=%llu", bc.runNumber(), bc.timestamp());
-        }
-      } else { // Run 3 GRP object
-        o2::parameters::GRPMagField* grpo = ccdb->getForTimeStamp<o2::parameters::GRPMagField>(ccdbPathGrpMag, bc.timestamp());
-        if (grpo != nullptr) {
-          o2::base::Propagator::initFieldFromGRP(grpo);
-          o2::base::Propagator::Instance()->setMatLUT(lut);
-          LOG(info) << "Setting magnetic field to current" << grpo->getL3Current() << " A for run" << bc.runNumber() << " from its GRP CCDB object (type o2::parameters::GRPMagField)";
-        } else {
-          LOGF(fatal, "Run 3 GRP object (type o2::parameters::GRPMagField) is not available in CCDB for run=%d at timestamp=%llu", bc.runNumber(), bc.timestamp());
-        }
-      }
-
-      runNumber = bc.runNumber();
-    }*/
 
     // build the VertexBase to initialize the vertexer
     o2::dataformats::VertexBase primVtx;
@@ -665,20 +633,36 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
     primVtx.setY(collision.posY());
     primVtx.setZ(collision.posZ());
     primVtx.setCov(collision.covXX(), collision.covXY(), collision.covYY(), collision.covXZ(), collision.covYZ(), collision.covZZ());
-    // configure PVertexer
-    o2::vertexing::PVertexer vertexer;
-    o2::conf::ConfigurableParam::updateFromString("pvertexer.useMeanVertexConstraint=false"); /// remove diamond constraint (let's keep it at the moment...)
-    vertexer.init();
-    bool pvRefitDoable = vertexer.prepareVertexRefit(vecPvContributorTrackParCov, primVtx);
+    bool pvRefitDoable = pvRefitter.prepare(vecPvContributorTrackParCov, primVtx, collision.chi2(), o2::base::Propagator::Instance()->getNominalBz(), !useFastPvRefit, useFastPvRefit);
+    if (debugPvRefit) {
+      LOG(info) << "prepareVertexRefit = " << pvRefitDoable << " Ncontrib= " << vecPvContributorTrackParCov.size() << " Ntracks= " << collision.numContrib() << " Vtx= " << primVtx.asString();
+    }
+    return pvRefitDoable;
+  }
+
+  /// Method for the PV refit and DCA recalculation for tracks with a collision assigned
+  /// \param collision is a collision
+  /// \param vecPvContributorGlobId is a vector containing the global ID of PV contributors for the current collision
+  /// \param pvRefitDoable is the result of preparePvRefit for the current collision
+  /// \param myTrack is the track to be removed, if contributor, from the PV refit
+  /// \param pvCoord is an array containing the coordinates of the refitted PV
+  /// \param pvCovMatrix is an array containing the covariance matrix values of the refitted PV
+  /// \param dcaXYdcaZ is an array containing the dcaXY and dcaZ of myTrack with respect to the refitted PV
+  void performPvRefitTrack(aod::Collision const& collision,
+                           std::vector<int64_t> const& vecPvContributorGlobId,
+                           bool pvRefitDoable,
+                           TracksWithSelAndDCA::iterator const& myTrack,
+                           std::array<float, 3>& pvCoord,
+                           std::array<float, 6>& pvCovMatrix,
+                           std::array<float, 2>& dcaXYdcaZ)
+  {
+    const auto& primVtx = pvRefitter.getVertex();
     if (!pvRefitDoable) {
       LOG(info) << "Not enough tracks accepted for the refit";
       if (doPvRefit && fillHistograms) {
         registry.fill(HIST("PvRefit/hNContribPvRefitNotDoable"), collision.numContrib());
       }
     }
-    if (debugPvRefit) {
-      LOG(info) << "prepareVertexRefit = " << pvRefitDoable << " Ncontrib= " << vecPvContributorTrackParCov.size() << " Ntracks= " << collision.numContrib() << " Vtx= " << primVtx.asString();
-    }
 
     if (fillHistograms) {
       registry.fill(HIST("PvRefit/hVerticesPerTrack"), 1);
@@ -697,9 +681,14 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
         /// this track contributed to the PV fit: let's do the refit without it
         const int entry = std::distance(vecPvContributorGlobId.begin(), trackIterator);
 
-        vecPvRefitContributorUsed[entry] = false; /// remove the track from the PV refitting
-
-        auto primVtxRefitted = vertexer.refitVertex(vecPvRefitContributorUsed, primVtx); // vertex refit
+        o2::dataformats::PrimaryVertex primVtxRefitted;
+        if (useFastPvRefit) {
+          primVtxRefitted = pvRefitter.removeContributors({entry}); // vertex downdate
+        } else {
+          std::vector<bool> vecPvRefitContributorUsed(vecPvContributorGlobId.size(), true);
+          vecPvRefitContributorUsed[entry] = false;                             /// remove the track from the PV refitting
+          primVtxRefitted = pvRefitter.refitWithout(vecPvRefitContributorUsed); // vertex refit
+        }
         // LOG(info) << "refit " << cnt << "/" << ntr << " result = " << primVtxRefitted.asString();
         if (debugPvRefit) {
           LOG(info) << "refit for track with global index " << static_cast<int>(myTrack.globalIndex()) << " " << primVtxRefitted.asString();
@@ -722,8 +711,6 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
           registry.fill(HIST("PvRefit/hChi2vsNContrib"), primVtxRefitted.getNContributors(), primVtxRefitted.getChi2());
         }
 
-        vecPvRefitContributorUsed[entry] = true; /// restore the track for the next PV refitting (probably not necessary here)
-
         if (recalcImpPar) {
           // fill the histograms for refitted PV with good Chi2
           const double deltaX = primVtx.getX() - primVtxRefitted.getX();
@@ -829,6 +816,11 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
       auto thisCollId = collision.globalIndex();
       auto groupedTrackIndices = trackIndices.sliceBy(trackIndicesPerCollision, thisCollId);
 
+      /// PV contributors for the current collision, retrieved and prepared for the refit at the first track that needs them
+      std::vector<int64_t> vecPvContributorGlobId = {};
+      bool isPvRefitPrepared = false;
+      bool pvRefitDoable = false;
+
       for (const auto& trackId : groupedTrackIndices) {
         int statusProng = BIT(CandidateType::NCandidateTypes) - 1; // all bits on
         auto track = trackId.track_as<TracksWithSelAndDCA>();
@@ -850,25 +842,28 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
           pvRefitPvCoord = {collision.posX(), collision.posY(), collision.posZ()};
           pvRefitPvCovMatrix = {collision.covXX(), collision.covXY(), collision.covYY(), collision.covXZ(), collision.covYZ(), collision.covZZ()};
 
-          /// retrieve PV contributors for the current collision
-          std::vector<int64_t> vecPvContributorGlobId = {};
-          std::vector<o2::track::TrackParCov> vecPvContributorTrackParCov = {};
+          if (!isPvRefitPrepared) {
+            /// retrieve PV contributors for the current collision
+            std::vector<o2::track::TrackParCov> vecPvContributorTrackParCov = {};
 
-          /// contributors for the current collision
-          auto pvContrCollision = pvContributors->sliceByCached(aod::track::collisionId, thisCollId, cache);
-          for (const auto& contributor : pvContrCollision) {
-            vecPvContributorGlobId.push_back(contributor.globalIndex());
-            vecPvContributorTrackParCov.push_back(getTrackParCov(contributor));
-          }
-          if (debugPvRefit) {
-            LOG(info) << "### vecPvContributorGlobId.size()=" << vecPvContributorGlobId.size() << ", vecPvContributorTrackParCov.size()=" << vecPvContributorTrackParCov.size() << ", N. original contributors=" << collision.numContrib();
+            /// contributors for the current collision
+            auto pvContrCollision = pvContributors->sliceByCached(aod::track::collisionId, thisCollId, cache);
+            for (const auto& contributor : pvContrCollision) {
+              vecPvContributorGlobId.push_back(contributor.globalIndex());
+              vecPvContributorTrackParCov.push_back(getTrackParCov(contributor));
+            }
+            if (debugPvRefit) {
+              LOG(info) << "### vecPvContributorGlobId.size()=" << vecPvContributorGlobId.size() << ", vecPvContributorTrackParCov.size()=" << vecPvContributorTrackParCov.size() << ", N. original contributors=" << collision.numContrib();
+            }
+            pvRefitDoable = preparePvRefit(collision, vecPvContributorTrackParCov);
+            isPvRefitPrepared = true;
           }
 
           /// Perform the PV refit only for tracks with an assigned collision
           if (debugPvRefit) {
             LOG(info) << "[BEFORE performPvRefitTrack] track.collision().globalIndex(): " << collision.globalIndex();
           }
-          performPvRefitTrack(collision, bcWithTimeStamps, vecPvContributorGlobId, vecPvContributorTrackParCov, track, pvRefitPvCoord, pvRefitPvCovMatrix, pvRefitDcaXYDcaZ);
+          performPvRefitTrack(collision, vecPvContributorGlobId, pvRefitDoable, track, pvRefitPvCoord, pvRefitPvCovMatrix, pvRefitDcaXYDcaZ);
           pvRefitDcaPerTrack[trackIdx] = pvRefitDcaXYDcaZ;
           pvRefitPvCoordPerTrack[trackIdx] = pvRefitPvCoord;
           pvRefitPvCovMatrixPerTrack[trackIdx] = pvRefitPvCovMatrix;
@@ -920,6 +915,8 @@ struct HfTrackIndexSkimCreator {
   Produces<aod::Hf3Prongs> rowTrackIndexProng3;
   Produces<aod::HfCutStatus3Prong> rowProng3CutStatus;
   Produces<aod::HfPvRefit3Prong> rowProng3PVrefit;
+  Produces<aod::HfSvFit2Prong> rowProng2SvFit;
+  Produces<aod::HfSvFit3Prong> rowProng3SvFit;
   Produces<aod::HfDstars> rowTrackIndexDstar;
   Produces<aod::HfCutStatusDstar> rowDstarCutStatus;
   Produces<aod::HfPvRefitDstar> rowDstarPVrefit;
@@ -929,6 +926,8 @@ struct HfTrackIndexSkimCreator {
   Configurable<bool> doDstar{"doDstar", false, "do D* candidates"};
   Configurable<bool> debug{"debug", false, "debug mode"};
   Configurable<bool> debugPvRefit{"debugPvRefit", false, "debug lines for primary vertex refit"};
+  Configurable<bool> useFastPvRefit{"useFastPvRefit", false, "PV refit: remove the candidate daughters with a Kalman downdate of the PV fit instead of a full refit (approximate: weights and linearisation of the other tracks not updated)"};
+  Configurable<bool> fillSvFitTables{"fillSvFitTables", false, "store the 2- and 3-prong secondary-vertex fits, needed by the candidate creators using them"};
   Configurable<bool> fillHistograms{"fillHistograms", true, "fill histograms"};
   ConfigurableAxis axisNumTracks{"axisNumTracks", {250, -0.5f, 249.5f}, "Number of tracks"};
   ConfigurableAxis axisNumCands{"axisNumCands", {200, -0.5f, 199.f}, "Number of candidates"};
@@ -980,6 +979,8 @@ struct HfTrackIndexSkimCreator {
   o2::base::MatLayerCylSet* lut;
   o2::base::Propagator::MatCorrType noMatCorr = o2::base::Propagator::MatCorrType::USEMatCorrNONE;
   int runNumber;
+  PrimaryVertexRefitter pvRefitter; // vertexer configured once, prepared once per collision
+  uint32_t svFitConfigHash{0};      // vertexing configuration of the stored secondary-vertex fits
 
   double massPi{0.};
   double massK{0.};
@@ -1128,6 +1129,10 @@ struct HfTrackIndexSkimCreator {
     ccdb->setLocalObjectValidityChecking();
     lut = o2::base::MatLayerCylSet::rectifyPtrFromFile(ccdb->get<o2::base::MatLayerCylSet>(ccdbPathLut));
     runNumber = 0;
+
+    if (doprocess2And3ProngsWithPvRefit) {
+      pvRefitter.init(); /// no diamond constraint
+    }
   }
 
   /// Method to perform selections for 2-prong candidates before vertex reconstruction
@@ -1449,49 +1454,47 @@ struct HfTrackIndexSkimCreator {
     return isSelected;
   }
 
+  /// Method to prepare the PV refit for the current collision, to be called once per collision
+  /// \param collision is a collision
+  /// \param vecPvContributorTrackParCov is a vector containing the TrackParCov of PV contributors for the current collision
+  /// \return true if the PV refit is doable
+  bool preparePvRefit(SelectedCollisions::iterator const& collision,
+                      std::vector<o2::track::TrackParCov> const& vecPvContributorTrackParCov)
+  {
+    // build the VertexBase to initialize the vertexer
+    o2::dataformats::VertexBase primVtx;
+    primVtx.setX(collision.posX());
+    primVtx.setY(collision.posY());
+    primVtx.setZ(collision.posZ());
+    primVtx.setCov(collision.covXX(), collision.covXY(), collision.covYY(), collision.covXZ(), collision.covYZ(), collision.covZZ());
+    bool pvRefitDoable = pvRefitter.prepare(vecPvContributorTrackParCov, primVtx, collision.chi2(), o2::base::Propagator::Instance()->getNominalBz(), !useFastPvRefit, useFastPvRefit);
+    if (debugPvRefit) {
+      LOG(info) << "prepareVertexRefit = " << pvRefitDoable << " Ncontrib= " << vecPvContributorTrackParCov.size() << " Ntracks= " << collision.numContrib() << " Vtx= " << primVtx.asString();
+    }
+    return pvRefitDoable;
+  }
+
   /// Method for the PV refit excluding the candidate daughters
   /// \param collision is a collision
-  /// \param bcWithTimeStamps is a table of bunch crossing joined with timestamps used to query the CCDB for B and material budget
   /// \param vecPvContributorGlobId is a vector containing the global ID of PV contributors for the current collision
-  /// \param vecPvContributorTrackParCov is a vector containing the TrackParCov of PV contributors for the current collision
+  /// \param pvRefitDoable is the result of preparePvRefit for the current collision
   /// \param vecCandPvContributorGlobId is a vector containing the global indices of daughter tracks that contributed to the original PV refit
   /// \param pvCoord is a vector where to store X, Y and Z values of refitted PV
   /// \param pvCovMatrix is a vector where to store the covariance matrix values of refitted PV
   void performPvRefitCandProngs(SelectedCollisions::iterator const& collision,
-                                aod::BCsWithTimestamps const& bcWithTimeStamps,
-                                std::vector<int64_t> vecPvContributorGlobId,
-                                std::vector<o2::track::TrackParCov> vecPvContributorTrackParCov,
+                                std::vector<int64_t> const& vecPvContributorGlobId,
+                                bool pvRefitDoable,
                                 std::vector<int64_t> vecCandPvContributorGlobId,
                                 std::array<float, 3>& pvCoord,
                                 std::array<float, 6>& pvCovMatrix)
   {
-    std::vector<bool> vecPvRefitContributorUsed(vecPvContributorGlobId.size(), true);
-
-    /// Prepare the vertex refitting
-    // set the magnetic field from CCDB
-    auto bc = collision.bc_as<o2::aod::BCsWithTimestamps>();
-    initCCDB(bc, runNumber, ccdb, isRun2 ? ccdbPathGrp : ccdbPathGrpMag, lut, isRun2);
-
-    // build the VertexBase to initialize the vertexer
-    o2::dataformats::VertexBase primVtx;
-    primVtx.setX(collision.posX());
-    primVtx.setY(collision.posY());
-    primVtx.setZ(collision.posZ());
-    primVtx.setCov(collision.covXX(), collision.covXY(), collision.covYY(), collision.covXZ(), collision.covYZ(), collision.covZZ());
-    // configure PVertexer
-    o2::vertexing::PVertexer vertexer;
-    o2::conf::ConfigurableParam::updateFromString("pvertexer.useMeanVertexConstraint=false"); /// remove diamond constraint (let's keep it at the moment...)
-    vertexer.init();
-    bool pvRefitDoable = vertexer.prepareVertexRefit(vecPvContributorTrackParCov, primVtx);
+    const auto& primVtx = pvRefitter.getVertex();
     if (!pvRefitDoable) {
       LOG(info) << "Not enough tracks accepted for the refit";
       if (doprocess2And3ProngsWithPvRefit && fillHistograms) {
         registry.fill(HIST("PvRefit/hNContribPvRefitNotDoable"), collision.numContrib());
       }
     }
-    if (debugPvRefit) {
-      LOG(info) << "prepareVertexRefit = " << pvRefitDoable << " Ncontrib= " << vecPvContributorTrackParCov.size() << " Ntracks= " << collision.numContrib() << " Vtx= " << primVtx.asString();
-    }
 
     /// PV refitting, if the tracks contributed to this at the beginning
     o2::dataformats::VertexBase primVtxBaseRecalc;
@@ -1502,12 +1505,12 @@ struct HfTrackIndexSkimCreator {
       }
       recalcPvRefit = true;
       int nCandContr = 0;
+      std::vector<int> vecCandPvContributorEntries{};
       for (uint64_t myGlobalID : vecCandPvContributorGlobId) {
         auto trackIterator = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), myGlobalID); /// track global index
         if (trackIterator != vecPvContributorGlobId.end()) {
           /// this is a contributor, let's remove it for the PV refit
-          const int entry = std::distance(vecPvContributorGlobId.begin(), trackIterator);
-          vecPvRefitContributorUsed[entry] = false; /// remove the track from the PV refitting
+          vecCandPvContributorEntries.push_back(std::distance(vecPvContributorGlobId.begin(), trackIterator));
           nCandContr++;
         }
       }
@@ -1516,7 +1519,16 @@ struct HfTrackIndexSkimCreator {
       if (debugPvRefit) {
         LOG(info) << "### PV refit after removing " << nCandContr << " tracks";
       }
-      auto primVtxRefitted = vertexer.refitVertex(vecPvRefitContributorUsed, primVtx); // vertex refit
+      o2::dataformats::PrimaryVertex primVtxRefitted;
+      if (useFastPvRefit) {
+        primVtxRefitted = pvRefitter.removeContributors(vecCandPvContributorEntries); // vertex downdate
+      } else {
+        std::vector<bool> vecPvRefitContributorUsed(vecPvContributorGlobId.size(), true);
+        for (const auto entry : vecCandPvContributorEntries) {
+          vecPvRefitContributorUsed[entry] = false; /// remove the track from the PV refitting
+        }
+        primVtxRefitted = pvRefitter.refitWithout(vecPvRefitContributorUsed); // vertex refit
+      }
       // LOG(info) << "refit " << cnt << "/" << ntr << " result = " << primVtxRefitted.asString();
       // LOG(info) << "refit for track with global index " << static_cast<int>(myTrack.globalIndex()) << " " << primVtxRefitted.asString();
       if (primVtxRefitted.getChi2() < 0) {
@@ -1538,10 +1550,6 @@ struct HfTrackIndexSkimCreator {
         registry.fill(HIST("PvRefit/hChi2vsNContrib"), primVtxRefitted.getNContributors(), primVtxRefitted.getChi2());
       }
 
-      for (size_t i = 0; i < vecPvContributorGlobId.size(); i++) {
-        vecPvRefitContributorUsed[i] = true; /// restore the tracks for the next PV refitting (probably not necessary here)
-      }
-
       if (recalcPvRefit) {
         // fill the histograms for refitted PV with good Chi2
         const double deltaX = primVtx.getX() - primVtxRefitted.getX();
@@ -1585,6 +1593,53 @@ struct HfTrackIndexSkimCreator {
     return;
   } /// end of performPvRefitCandProngs function
 
+  /// Fills the table with the secondary-vertex fit of the last processed candidate, in the format used by the candidate creators
+  /// \param fitter is the DCAFitterN used for the candidate
+  /// \param rowSvFit is the table cursor
+  /// \param pvCoord is the position of the primary vertex used for the candidate (refitted or not)
+  /// \param pvCovMatrix is the covariance matrix of the primary vertex
+  /// \param isReusable is false if the tracks were propagated before the fit, i.e. the creators would not find the same fit
+  template <int nProngs, typename TFitter, typename TCursor>
+  void fillSvFitTable(TFitter& fitter, TCursor& rowSvFit, std::array<float, 3> const& pvCoord, std::array<float, 6> const& pvCovMatrix, bool isReusable)
+  {
+    o2::dataformats::VertexBase primaryVertex;
+    primaryVertex.setXYZ(pvCoord[0], pvCoord[1], pvCoord[2]);
+    primaryVertex.setCov(pvCovMatrix[0], pvCovMatrix[1], pvCovMatrix[2], pvCovMatrix[3], pvCovMatrix[4], pvCovMatrix[5]);
+
+    const auto& secondaryVertex = fitter.getPCACandidate();
+    const auto covMatrixPCA = fitter.calcPCACovMatrixFlat();
+    std::array<std::array<float, 3>, nProngs> pvec;
+    std::array<o2::dataformats::DCA, nProngs> impactParameter;
+    for (int iProng = 0; iProng < nProngs; iProng++) {
+      auto trackParVar = fitter.getTrack(iProng);
+      trackParVar.getPxPyPzGlo(pvec[iProng]);
+      trackParVar.propagateToDCA(primaryVertex, fitter.getBz(), &impactParameter[iProng]);
+    }
+    const uint32_t configHash = isReusable ? svFitConfigHash : 0;
+    if constexpr (nProngs == 2) {
+      rowSvFit(secondaryVertex[0], secondaryVertex[1], secondaryVertex[2],
+               covMatrixPCA[0], covMatrixPCA[1], covMatrixPCA[2], covMatrixPCA[3], covMatrixPCA[4], covMatrixPCA[5],
+               fitter.getChi2AtPCACandidate(),
+               pvec[0][0], pvec[0][1], pvec[0][2],
+               pvec[1][0], pvec[1][1], pvec[1][2],
+               impactParameter[0].getY(), impactParameter[1].getY(),
+               impactParameter[0].getSigmaY2(), impactParameter[1].getSigmaY2(),
+               impactParameter[0].getZ(), impactParameter[1].getZ(),
+               configHash);
+    } else {
+      rowSvFit(secondaryVertex[0], secondaryVertex[1], secondaryVertex[2],
+               covMatrixPCA[0], covMatrixPCA[1], covMatrixPCA[2], covMatrixPCA[3], covMatrixPCA[4], covMatrixPCA[5],
+               fitter.getChi2AtPCACandidate(),
+               pvec[0][0], pvec[0][1], pvec[0][2],
+               pvec[1][0], pvec[1][1], pvec[1][2],
+               pvec[2][0], pvec[2][1], pvec[2][2],
+               impactParameter[0].getY(), impactParameter[1].getY(), impactParameter[2].getY(),
+               impactParameter[0].getSigmaY2(), impactParameter[1].getSigmaY2(), impactParameter[2].getSigmaY2(),
+               impactParameter[0].getZ(), impactParameter[1].getZ(), impactParameter[2].getZ(),
+               configHash);
+    }
+  }
+
   template <bool doPvRefit = false, typename TTracks>
   void run2And3Prongs(SelectedCollisions const& collisions,
                       aod::BCsWithTimestamps const& bcWithTimeStamps,
@@ -1608,7 +1663,6 @@ struct HfTrackIndexSkimCreator {
       /// retrieve PV contributors for the current collision
       std::vector<int64_t> vecPvContributorGlobId{};
       std::vector<o2::track::TrackParCov> vecPvContributorTrackParCov{};
-      std::vector<bool> vecPvRefitContributorUsed{};
       if constexpr (doPvRefit) {
         auto groupedTracksUnfiltered = tracks.sliceBy(tracksPerCollision, collision.globalIndex());
         const int nTrk = groupedTracksUnfiltered.size();
@@ -1635,7 +1689,6 @@ struct HfTrackIndexSkimCreator {
             LOG(info) << "!!! Some problem here !!! vecPvContributorTrackParCov.size()= " << vecPvContributorTrackParCov.size() << ", nContrib=" << nContrib << ", collision.numContrib()" << collision.numContrib();
           }
         }
-        vecPvRefitContributorUsed = std::vector<bool>(vecPvContributorGlobId.size(), true);
       }
 
       // auto centrality = collision.centV0M(); //FIXME add centrality when option for variations to the process function appears
@@ -1655,6 +1708,12 @@ struct HfTrackIndexSkimCreator {
       auto bc = collision.bc_as<o2::aod::BCsWithTimestamps>();
       initCCDB(bc, runNumber, ccdb, isRun2 ? ccdbPathGrp : ccdbPathGrpMag, lut, isRun2);
 
+      // prepare the PV refit once for all candidates of this collision
+      bool pvRefitDoable = false;
+      if constexpr (doPvRefit) {
+        pvRefitDoable = preparePvRefit(collision, vecPvContributorTrackParCov);
+      }
+
       // 2-prong vertex fitter
       o2::vertexing::DCAFitterN<2> df2;
       df2.setBz(o2::base::Propagator::Instance()->getNominalBz());
@@ -1677,6 +1736,11 @@ struct HfTrackIndexSkimCreator {
       df3.setUseAbsDCA(useAbsDCA);
       df3.setWeightedFinalPCA(useWeightedFinalPCA);
 
+      // the field changes with the run, the 2- and 3-prong fitters have the same configuration
+      if (fillSvFitTables) {
+        svFitConfigHash = getSvFitConfigHash(propagateToPCA, maxR, maxDZIni, minParamChange, minRelChi2Change, useAbsDCA, useWeightedFinalPCA, doprocess2And3ProngsWithPvRefit, df2.getBz(), static_cast<int>(df2.getMatCorrType()));
+      }
+
       // used to calculate number of candidiates per event
       auto nCand2 = rowTrackIndexProng2.lastIndex();
       auto nCand3 = rowTrackIndexProng3.lastIndex();
@@ -1799,7 +1863,7 @@ struct HfTrackIndexSkimCreator {
                   if (debugPvRefit) {
                     LOG(info) << "### [2 Prong] Calling performPvRefitCandProngs for HF 2 prong candidate";
                   }
-                  performPvRefitCandProngs(collision, bcWithTimeStamps, vecPvContributorGlobId, vecPvContributorTrackParCov, {trackPos1.globalIndex(), trackNeg1.globalIndex()}, pvRefitCoord2Prong, pvRefitCovMatrix2Prong);
+                  performPvRefitCandProngs(collision, vecPvContributorGlobId, pvRefitDoable, {trackPos1.globalIndex(), trackNeg1.globalIndex()}, pvRefitCoord2Prong, pvRefitCovMatrix2Prong);
                 } else if (nCandContr == 1) {
                   /// Only one daughter was a contributor, let's use then the PV recalculated by excluding only it
                   if (debugPvRefit) {
@@ -1847,6 +1911,11 @@ struct HfTrackIndexSkimCreator {
                   rowProng2PVrefit(pvRefitCoord2Prong[0], pvRefitCoord2Prong[1], pvRefitCoord2Prong[2],
                                    pvRefitCovMatrix2Prong[0], pvRefitCovMatrix2Prong[1], pvRefitCovMatrix2Prong[2], pvRefitCovMatrix2Prong[3], pvRefitCovMatrix2Prong[4], pvRefitCovMatrix2Prong[5]);
                 }
+                if (fillSvFitTables) {
+                  // tracks re-propagated to this collision are not fitted in the same way by the candidate creators
+                  bool isReusable = thisCollId == trackPos1.collisionId() && thisCollId == trackNeg1.collisionId();
+                  fillSvFitTable<2>(df2, rowProng2SvFit, pvRefitCoord2Prong, pvRefitCovMatrix2Prong, isReusable);
+                }
 
                 if (debug) {
                   int Prong2CutStatus[kN2ProngDecays];
@@ -2026,7 +2095,7 @@ struct HfTrackIndexSkimCreator {
                   if (debugPvRefit) {
                     LOG(info) << "### [3 prong] Calling performPvRefitCandProngs for HF 3 prong candidate, removing " << nCandContr << " daughters";
                   }
-                  performPvRefitCandProngs(collision, bcWithTimeStamps, vecPvContributorGlobId, vecPvContributorTrackParCov, vecCandPvContributorGlobId, pvRefitCoord3Prong2Pos1Neg, pvRefitCovMatrix3Prong2Pos1Neg);
+                  performPvRefitCandProngs(collision, vecPvContributorGlobId, pvRefitDoable, vecCandPvContributorGlobId, pvRefitCoord3Prong2Pos1Neg, pvRefitCovMatrix3Prong2Pos1Neg);
                 } else if (nCandContr == 1) {
                   /// Only one daughter was a contributor, let's use then the PV recalculated by excluding only it
                   if (debugPvRefit) {
@@ -2095,6 +2164,10 @@ struct HfTrackIndexSkimCreator {
                 rowProng3PVrefit(pvRefitCoord3Prong2Pos1Neg[0], pvRefitCoord3Prong2Pos1Neg[1], pvRefitCoord3Prong2Pos1Neg[2],
                                  pvRefitCovMatrix3Prong2Pos1Neg[0], pvRefitCovMatrix3Prong2Pos1Neg[1], pvRefitCovMatrix3Prong2Pos1Neg[2], pvRefitCovMatrix3Prong2Pos1Neg[3], pvRefitCovMatrix3Prong2Pos1Neg[4], pvRefitCovMatrix3Prong2Pos1Neg[5]);
               }
+              if (fillSvFitTables) {
+                bool isReusable = thisCollId == trackPos1.collisionId() && thisCollId == trackNeg1.collisionId() && thisCollId == trackPos2.collisionId();
+                fillSvFitTable<3>(df3, rowProng3SvFit, pvRefitCoord3Prong2Pos1Neg, pvRefitCovMatrix3Prong2Pos1Neg, isReusable);
+              }
 
               if (debug) {
                 int Prong3CutStatus[kN3ProngDecays];
@@ -2277,7 +2350,7 @@ struct HfTrackIndexSkimCreator {
                   if (debugPvRefit) {
                     LOG(info) << "### [3 prong] Calling performPvRefitCandProngs for HF 3 prong candidate, removing " << nCandContr << " daughters";
                   }
-                  performPvRefitCandProngs(collision, bcWithTimeStamps, vecPvContributorGlobId, vecPvContributorTrackParCov, vecCandPvContributorGlobId, pvRefitCoord3Prong1Pos2Neg, pvRefitCovMatrix3Prong1Pos2Neg);
+                  performPvRefitCandProngs(collision, vecPvContributorGlobId, pvRefitDoable, vecCandPvContributorGlobId, pvRefitCoord3Prong1Pos2Neg, pvRefitCovMatrix3Prong1Pos2Neg);
                 } else if (nCandContr == 1) {
                   /// Only one daughter was a contributor, let's use then the PV recalculated by excluding only it
                   if (debugPvRefit) {
@@ -2346,6 +2419,10 @@ struct HfTrackIndexSkimCreator {
                 rowProng3PVrefit(pvRefitCoord3Prong1Pos2Neg[0], pvRefitCoord3Prong1Pos2Neg[1], pvRefitCoord3Prong1Pos2Neg[2],
                                  pvRefitCovMatrix3Prong1Pos2Neg[0], pvRefitCovMatrix3Prong1Pos2Neg[1], pvRefitCovMatrix3Prong1Pos2Neg[2], pvRefitCovMatrix3Prong1Pos2Neg[3], pvRefitCovMatrix3Prong1Pos2Neg[4], pvRefitCovMatrix3Prong1Pos2Neg[5]);
               }
+              if (fillSvFitTables) {
+                bool isReusable = thisCollId == trackNeg1.collisionId() && thisCollId == trackPos1.collisionId() && thisCollId == trackNeg2.collisionId();
+                fillSvFitTable<3>(df3, rowProng3SvFit, pvRefitCoord3Prong1Pos2Neg, pvRefitCovMatrix3Prong1Pos2Neg, isReusable);
+              }
 
               if (debug) {
                 int Prong3CutStatus[kN3ProngDecays];
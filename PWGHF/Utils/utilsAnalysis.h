@@ -16,6 +16,8 @@
 #define PWGHF_UTILS_UTILSANALYSIS_H_
 
 #include <algorithm> // std::upper_bound
+#include <cstdint>   // uint32_t
+#include <cstring>   // std::memcpy
 #include <iterator>  // std::distance
 
 namespace o2::analysis
@@ -36,6 +38,35 @@ int findBin(T1 const& binsPt, T2 value)
   }
   return std::distance(binsPt->begin(), std::upper_bound(binsPt->begin(), binsPt->end(), value)) - 1;
 }
+
+/// Hash of the DCAFitterN configuration, stored with the secondary-vertex fits of the skim
+/// and compared by the candidate creators to decide whether the stored fit can be reused.
+/// \param bz  magnetic field set in the fitter, which changes with the run
+/// \param matCorrType  material correction type of the fitter (o2::base::Propagator::MatCorrType)
+/// \note 0 is reserved for fits which cannot be reused.
+inline uint32_t getSvFitConfigHash(bool propagateToPCA, double maxR, double maxDZIni, double minParamChange, double minRelChi2Change,
+                                   bool useAbsDCA, bool useWeightedFinalPCA, bool usePvRefit, float bz, int matCorrType)
+{
+  uint32_t hash = 2166136261u; // FNV-1a
+  auto add = [&hash](auto value) {
+    unsigned char bytes[sizeof(value)];
+    std::memcpy(bytes, &value, sizeof(value));
+    for (const auto byte : bytes) {
+      hash = (hash ^ byte) * 16777619u;
+    }
+  };
+  add(propagateToPCA);
+  add(maxR);
+  add(maxDZIni);
+  add(minParamChange);
+  add(minRelChi2Change);
+  add(useAbsDCA);
+  add(useWeightedFinalPCA);
+  add(usePvRefit);
+  add(bz);
+  add(matCorrType);
+  return hash == 0 ? 1 : hash;
+}
 } // namespace o2::analysis
 
 #endif // PWGHF_UTILS_UTILSANALYSIS_H_
@@ -0,0 +1,258 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file utilsMcMatching.h
+/// \brief Matching of HF candidates and generated particles against a set of decay channels
+///
+/// The decay channels of a candidate creator are registered once. A reconstructed candidate is then classified
+/// against all of them with a single walk up the mother chain of its first prong, and only the channels whose
+/// daughter PDG codes match the ones of the prongs are tested. The result is the same as calling
+/// RecoDecay::getMatchedMCRec and RecoDecay::isMatchedMCGen channel after channel in the order of registration.
+
+#ifndef PWGHF_UTILS_UTILSMCMATCHING_H_
+#define PWGHF_UTILS_UTILSMCMATCHING_H_
+
+#include <algorithm> // std::sort, std::find
+#include <array>
+#include <cstdint> // int8_t
+#include <cstdlib> // std::abs
+#include <vector>
+
+#include "Common/Core/RecoDecay.h"
+
+namespace o2::analysis
+{
+
+/// Decay channels with N final-state prongs, antiparticles are always accepted
+template <std::size_t N>
+class HfDecayChannelMatcher
+{
+ public:
+  struct Result {
+    int indexMother = -1;       // index of the matched mother, -1 if not matched
+    int8_t sign = 0;            // 1 if particle, -1 if antiparticle w.r.t. the PDG code of the channel
+    int8_t flag = 0;            // sign * (1 << decay type), as in the HF MC tables
+    int8_t resonantChannel = 0; // resonant channel of the matched decay, 0 if none
+  };
+
+  /// Adds a decay channel, channels are tested in the order they are added
+  /// \param decayType  decay type, bit of the MC flag
+  /// \param pdgMother  PDG code of the mother
+  /// \param pdgDaughters  PDG codes of the final-state daughters
+  /// \param depthMax  maximum decay tree level (at least 1), as in RecoDecay::getMatchedMCRec
+  void addChannel(int decayType, int pdgMother, std::array<int, N> const& pdgDaughters, int depthMax = 1)
+  {
+    Channel channel;
+    channel.decayType = decayType;
+    channel.pdgMother = pdgMother;
+    channel.pdgDaughters = pdgDaughters;
+    for (std::size_t i = 0; i < N; ++i) {
+      channel.absPdgDaughters[i] = std::abs(pdgDaughters[i]);
+    }
+    std::sort(channel.absPdgDaughters.begin(), channel.absPdgDaughters.end());
+    channel.depthMax = depthMax;
+    mChannels.push_back(channel);
+    mDepthMax = std::max(mDepthMax, depthMax);
+  }
+
+  /// Adds a resonant decay of the last added channel, identified by the two direct daughters of the mother
+  void addResonantChannel(int8_t resonantChannel, std::array<int, 2> const& pdgResonantDaughters)
+  {
+    auto absPdgs = std::array{std::abs(pdgResonantDaughters[0]), std::abs(pdgResonantDaughters[1])};
+    std::sort(absPdgs.begin(), absPdgs.end());
+    mChannels.back().resonances.push_back({resonantChannel, absPdgs});
+  }
+
+  /// Matches a reconstructed candidate, equivalent to RecoDecay::getMatchedMCRec for each channel
+  /// \param particlesMC  table with MC particles
+  /// \param arrDaughters  array of candidate prongs
+  template <typename T, typename U>
+  Result matchRec(const T& particlesMC, const std::array<U, N>& arrDaughters)
+  {
+    Result result;
+    std::array<int64_t, N> arrDaughtersIndex;
+    std::array<int, N> arrDaughtersPdg;
+    std::array<int, N> absPdgs;
+    for (std::size_t iProng = 0; iProng < N; ++iProng) {
+      if (!arrDaughters[iProng].has_mcParticle()) {
+        return result;
+      }
+      auto particleI = arrDaughters[iProng].mcParticle();
+      arrDaughtersIndex[iProng] = particleI.globalIndex();
+      arrDaughtersPdg[iProng] = particleI.pdgCode();
+      absPdgs[iProng] = std::abs(arrDaughtersPdg[iProng]);
+    }
+    std::sort(absPdgs.begin(), absPdgs.end());
+
+    // only the channels with the PDG codes of the prongs can match
+    bool isAnyCompatible = false;
+    for (const auto& channel : mChannels) {
+      isAnyCompatible |= channel.absPdgDaughters == absPdgs;
+    }
+    if (!isAnyCompatible) {
+      return result;
+    }
+
+    // mother chain of the first prong, in the order in which RecoDecay::getMother visits it
+    mAncestors.clear();
+    mStageIds.assign(1, arrDaughtersIndex[0]);
+    for (int stage = 1; stage <= mDepthMax && !mStageIds.empty(); ++stage) {
+      mNextStageIds.clear();
+      for (const auto iPart : mStageIds) {
+        auto particle = particlesMC.rawIteratorAt(iPart - particlesMC.offset());
+        if (!particle.has_mothers()) {
+          continue;
+        }
+        for (auto iMother = particle.mothersIds().front(); iMother <= particle.mothersIds().back(); ++iMother) {
+          mAncestors.push_back({iMother, particlesMC.rawIteratorAt(iMother - particlesMC.offset()).pdgCode(), stage, iPart});
+          if (std::find(mNextStageIds.begin(), mNextStageIds.end(), iMother) == mNextStageIds.end()) {
+            mNextStageIds.push_back(iMother);
+          }
+        }
+      }
+      std::swap(mStageIds, mNextStageIds);
+    }
+
+    for (const auto& channel : mChannels) {
+      if (channel.absPdgDaughters != absPdgs) {
+        continue;
+      }
+      // as in RecoDecay::getMother: first stage with a match, last particle of the stage with a match, its first matching mother
+      const Ancestor* mother = nullptr;
+      for (const auto& ancestor : mAncestors) {
+        if (ancestor.stage > channel.depthMax || (mother && ancestor.stage > mother->stage)) {
+          break;
+        }
+        if (std::abs(ancestor.pdg) == std::abs(channel.pdgMother) && (!mother || mother->child != ancestor.child)) {
+          mother = &ancestor;
+        }
+      }
+      if (!mother) {
+        continue;
+      }
+      const int8_t sgn = mother->pdg == channel.pdgMother ? 1 : -1;
+      auto particleMother = particlesMC.rawIteratorAt(mother->index - particlesMC.offset());
+      if (!particleMother.has_daughters() || particleMother.daughtersIds().back() - particleMother.daughtersIds().front() + 1 > static_cast<int>(N)) {
+        continue;
+      }
+      mFinalDaughters.clear();
+      RecoDecay::getDaughters(particleMother, &mFinalDaughters, channel.pdgDaughters, channel.depthMax);
+      if (mFinalDaughters.size() != N || !areDaughtersMatched(arrDaughtersIndex, arrDaughtersPdg, channel.pdgDaughters, sgn)) {
+        continue;
+      }
+      result.indexMother = mother->index;
+      setResult(particlesMC, result, channel, sgn, particleMother);
+      return result;
+    }
+    return result;
+  }
+
+  /// Matches a generated particle, equivalent to RecoDecay::isMatchedMCGen for each channel
+  /// \param particlesMC  table with MC particles
+  /// \param particle  MC particle
+  template <typename T, typename U>
+  Result matchGen(const T& particlesMC, const U& particle)
+  {
+    Result result;
+    const int absPdg = std::abs(particle.pdgCode());
+    for (const auto& channel : mChannels) {
+      if (std::abs(channel.pdgMother) != absPdg) {
+        continue;
+      }
+      int8_t sgn = 0;
+      if (RecoDecay::isMatchedMCGen(particlesMC, particle, channel.pdgMother, channel.pdgDaughters, true, &sgn, channel.depthMax)) {
+        result.indexMother = particle.globalIndex();
+        setResult(particlesMC, result, channel, sgn, particle);
+        return result;
+      }
+    }
+    return result;
+  }
+
+ private:
+  struct Resonance {
+    int8_t resonantChannel;
+    std::array<int, 2> absPdgDaughters; // sorted
+  };
+
+  struct Channel {
+    int decayType;
+    int pdgMother;
+    std::array<int, N> pdgDaughters;
+    std::array<int, N> absPdgDaughters; // sorted, to compare with the prongs
+    int depthMax;
+    std::vector<Resonance> resonances;
+  };
+
+  struct Ancestor {
+    int64_t index;
+    int pdg;
+    int stage;
+    int64_t child; // particle of the previous stage
+  };
+
+  /// each prong is a different final daughter of the mother, with one of the expected PDG codes
+  bool areDaughtersMatched(std::array<int64_t, N> const& arrDaughtersIndex, std::array<int, N> const& arrDaughtersPdg, std::array<int, N> pdgDaughters, int8_t sgn)
+  {
+    for (std::size_t iProng = 0; iProng < N; ++iProng) {
+      auto itDaughter = std::find(mFinalDaughters.begin(), mFinalDaughters.end(), arrDaughtersIndex[iProng]);
+      if (itDaughter == mFinalDaughters.end()) {
+        return false;
+      }
+      *itDaughter = -1;
+      auto itPdg = std::find(pdgDaughters.begin(), pdgDaughters.end(), sgn * arrDaughtersPdg[iProng]);
+      if (itPdg == pdgDaughters.end()) {
+        return false;
+      }
+      *itPdg = 0;
+    }
+    return true;
+  }
+
+  template <typename T, typename U>
+  void setResult(const T& particlesMC, Result& result, Channel const& channel, int8_t sgn, const U& mother)
+  {
+    result.sign = sgn;
+    result.flag = sgn * (1 << channel.decayType);
+    if (channel.resonances.empty()) {
+      return;
+    }
+    mFinalDaughters.clear();
+    RecoDecay::getDaughters(mother, &mFinalDaughters, std::array{0}, 1);
+    if (mFinalDaughters.size() != 2) {
+      return;
+    }
+    std::array<int, 2> absPdgs;
+    for (std::size_t i = 0; i < 2; ++i) {
+      absPdgs[i] = std::abs(particlesMC.rawIteratorAt(mFinalDaughters[i] - particlesMC.offset()).pdgCode());
+    }
+    std::sort(absPdgs.begin(), absPdgs.end());
+    for (const auto& resonance : channel.resonances) {
+      if (resonance.absPdgDaughters == absPdgs) {
+        result.resonantChannel = resonance.resonantChannel;
+        return;
+      }
+    }
+  }
+
+  std::vector<Channel> mChannels;
+  int mDepthMax = 0;
+
+  // buffers reused between calls
+  std::vector<Ancestor> mAncestors;
+  std::vector<int64_t> mStageIds;
+  std::vector<int64_t> mNextStageIds;
+  std::vector<int> mFinalDaughters;
+};
+
+} // namespace o2::analysis
+
+#endif // PWGHF_UTILS_UTILSMCMATCHING_H_
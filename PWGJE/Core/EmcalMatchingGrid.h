@@ -0,0 +1,159 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file EmcalMatchingGrid.h
+/// \brief Uniform (eta, phi) grid of track impact points for the EMCal cluster-track matching
+///
+/// The tracks are sorted once into the cells of the grid. The cells are aligned to the EMCal
+/// supermodule boundaries in phi and to eta = 0, and are not smaller than the matching distance
+/// unless a supermodule fits several of them. A cluster only tests the tracks of the cells overlapping
+/// the square of half side maxMatchingDistance around it. The matches are the same as the ones of
+/// JetUtilities::MatchClustersAndTracks: up to maxNumberMatches closest tracks, in order of increasing
+/// distance, with distance = sqrt(deta^2 + dphi^2) < maxMatchingDistance and phi not periodic.
+
+#ifndef PWGJE_CORE_EMCALMATCHINGGRID_H_
+#define PWGJE_CORE_EMCALMATCHINGGRID_H_
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "Framework/Logger.h"
+
+namespace JetUtilities
+{
+
+class EmcalMatchingGrid
+{
+ public:
+  /**
+   * Sets up the grid cells.
+   *
+   * @param maxMatchingDistance Maximum matching distance, must be positive.
+   * @param etaMax Eta range of the grid, tracks beyond it are kept in the edge cells.
+   */
+  void init(double maxMatchingDistance, double etaMax = 1.0)
+  {
+    if (!(maxMatchingDistance > 0.)) {
+      LOGP(fatal, "EmcalMatchingGrid: the maximum matching distance must be positive, got {}", maxMatchingDistance);
+    }
+    mMaxMatchingDistance = maxMatchingDistance;
+    const int nCellsPerSMPhi = std::max(1, static_cast<int>(SMPhiWidth / maxMatchingDistance));
+    const int nCellsPerSMEta = std::max(1, static_cast<int>(SMEtaMax / maxMatchingDistance));
+    mCellPhi = SMPhiWidth / nCellsPerSMPhi;
+    mCellEta = SMEtaMax / nCellsPerSMEta;
+    // first cell edges below phi = 0 and eta = -etaMax, on the supermodule grid
+    mPhiMin = EMCalPhiMin - std::ceil(EMCalPhiMin / mCellPhi) * mCellPhi;
+    mNPhi = static_cast<int>(std::ceil((TwoPI - mPhiMin) / mCellPhi));
+    mEtaMin = -SMEtaMax - std::ceil(std::max(etaMax - SMEtaMax, 0.) / mCellEta) * mCellEta;
+    mNEta = static_cast<int>(std::ceil(-2. * mEtaMin / mCellEta - 1.e-9));
+    mCellStart.assign(mNEta * mNPhi + 1, 0);
+  }
+
+  /**
+   * Sorts the track impact points into the grid, to be called once per collision.
+   *
+   * @param trackEta Track eta.
+   * @param trackPhi Track phi, in [0, 2pi).
+   */
+  void setTracks(std::vector<double> const& trackEta, std::vector<double> const& trackPhi)
+  {
+    const int nTracks = trackEta.size();
+    mTrackCell.resize(nTracks);
+    std::fill(mCellStart.begin(), mCellStart.end(), 0);
+    for (int iTrack = 0; iTrack < nTracks; iTrack++) {
+      mTrackCell[iTrack] = cellIndex(etaCell(trackEta[iTrack]), phiCell(trackPhi[iTrack]));
+      mCellStart[mTrackCell[iTrack] + 1]++;
+    }
+    for (std::size_t iCell = 1; iCell < mCellStart.size(); iCell++) {
+      mCellStart[iCell] += mCellStart[iCell - 1];
+    }
+    // counting sort, tracks of a cell keep their order
+    mSortedIndex.resize(nTracks);
+    mSortedEta.resize(nTracks);
+    mSortedPhi.resize(nTracks);
+    mCellFill.assign(mCellStart.begin(), mCellStart.end() - 1);
+    for (int iTrack = 0; iTrack < nTracks; iTrack++) {
+      const int iSorted = mCellFill[mTrackCell[iTrack]]++;
+      mSortedIndex[iSorted] = iTrack;
+      mSortedEta[iSorted] = trackEta[iTrack];
+      mSortedPhi[iSorted] = trackPhi[iTrack];
+    }
+  }
+
+  /**
+   * Matches clusters with the tracks of the grid.
+   *
+   * @param clusterEta Cluster eta.
+   * @param clusterPhi Cluster phi, in [0, 2pi).
+   * @param maxNumberMatches Maximum number of matches per cluster.
+   * @param matchIndex Track indices matched to each cluster, maxNumberMatches entries per cluster, -1 if none.
+   */
+  void matchClusters(std::vector<double> const& clusterEta, std::vector<double> const& clusterPhi, int maxNumberMatches, std::vector<int>& matchIndex)
+  {
+    const std::size_t nClusters = clusterEta.size();
+    matchIndex.assign(nClusters * maxNumberMatches, -1);
+    if (mSortedIndex.empty()) {
+      return;
+    }
+    for (std::size_t iCluster = 0; iCluster < nClusters; iCluster++) {
+      const double eta = clusterEta[iCluster], phi = clusterPhi[iCluster];
+      const int etaFirst = etaCell(eta - mMaxMatchingDistance), etaLast = etaCell(eta + mMaxMatchingDistance);
+      const int phiFirst = phiCell(phi - mMaxMatchingDistance), phiLast = phiCell(phi + mMaxMatchingDistance);
+      mCandidates.clear();
+      for (int iEta = etaFirst; iEta <= etaLast; iEta++) {
+        for (int iPhi = phiFirst; iPhi <= phiLast; iPhi++) {
+          const int iCell = cellIndex(iEta, iPhi);
+          for (int iSorted = mCellStart[iCell]; iSorted < mCellStart[iCell + 1]; iSorted++) {
+            const double dEta = mSortedEta[iSorted] - eta, dPhi = mSortedPhi[iSorted] - phi;
+            const double distance = std::sqrt(dEta * dEta + dPhi * dPhi);
+            if (distance < mMaxMatchingDistance) {
+              mCandidates.emplace_back(distance, mSortedIndex[iSorted]);
+            }
+          }
+        }
+      }
+      const std::size_t nMatches = std::min<std::size_t>(mCandidates.size(), maxNumberMatches);
+      std::partial_sort(mCandidates.begin(), mCandidates.begin() + nMatches, mCandidates.end());
+      for (std::size_t iMatch = 0; iMatch < nMatches; iMatch++) {
+        matchIndex[iCluster * maxNumberMatches + iMatch] = mCandidates[iMatch].second;
+      }
+    }
+  }
+
+ private:
+  static constexpr double TwoPI = 2. * M_PI;
+  static constexpr double EMCalPhiMin = 80. * M_PI / 180.; // lower phi edge of the first EMCal supermodule
+  static constexpr double SMPhiWidth = 20. * M_PI / 180.;  // phi size of a supermodule
+  static constexpr double SMEtaMax = 0.7;                  // eta size of a supermodule, from eta = 0
+
+  int etaCell(double eta) const { return std::clamp(static_cast<int>(std::floor((eta - mEtaMin) / mCellEta)), 0, mNEta - 1); }
+  int phiCell(double phi) const { return std::clamp(static_cast<int>(std::floor((phi - mPhiMin) / mCellPhi)), 0, mNPhi - 1); }
+  int cellIndex(int iEta, int iPhi) const { return iEta * mNPhi + iPhi; }
+
+  double mMaxMatchingDistance = 0.;
+  double mCellEta = 1., mCellPhi = 1.;
+  double mEtaMin = 0., mPhiMin = 0.;
+  int mNEta = 1, mNPhi = 1;
+
+  std::vector<int> mCellStart;   // first sorted track of each cell, size nCells + 1
+  std::vector<int> mCellFill;    // buffer for the counting sort
+  std::vector<int> mTrackCell;   // cell of each track
+  std::vector<int> mSortedIndex; // track index, sorted by cell
+  std::vector<double> mSortedEta;
+  std::vector<double> mSortedPhi;
+  std::vector<std::pair<double, int>> mCandidates; // (distance, track index) of the tracks within the matching distance of a cluster
+};
+
+} // namespace JetUtilities
+
+#endif // PWGJE_CORE_EMCALMATCHINGGRID_H_
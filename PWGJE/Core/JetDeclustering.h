@@ -0,0 +1,218 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file JetDeclustering.h
+/// \brief Cambridge/Aachen reclustering of the constituents of a jet and its Lund declustering chains
+///
+/// The constituents are reclustered into a single jet with the C/A algorithm and the E recombination
+/// scheme, with the rapidity-azimuth distance of fastjet. As the merging sequence only depends on the
+/// constituent directions, the splittings are the same as the ones of the fastjet C/A reclustering of
+/// the jet, ghosts excluded, without the cost of the cluster sequence and of the area computation.
+/// The nearest neighbours are cached, which makes the reclustering O(N^2) for the small N of a jet.
+
+#ifndef PWGJE_CORE_JETDECLUSTERING_H_
+#define PWGJE_CORE_JETDECLUSTERING_H_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace JetUtilities
+{
+
+class JetDeclustering
+{
+ public:
+  /// Splitting of a subjet into a harder and a softer branch
+  struct Splitting {
+    int level;            // 0 for the primary declustering chain, 1 for a secondary one
+    int primarySplitting; // index of the primary splitting whose softer branch is declustered, -1 for primary splittings
+    float z;              // pT,soft / (pT,hard + pT,soft)
+    float deltaR;         // rapidity-azimuth distance between the two branches
+    float kt;             // pT,soft * deltaR
+    float pt;             // pT of the declustered subjet
+  };
+
+  void clear() { mNodes.clear(); }
+
+  /// Adds a constituent from its four-momentum.
+  void addConstituent(double px, double py, double pz, double e) { addNode(px, py, pz, e, -1, -1); }
+
+  /// Adds a track-like constituent with the given mass hypothesis, as in FastJetUtilities::fillTracks.
+  template <typename T>
+  void addTrack(T const& constituent, double mass)
+  {
+    const double px = constituent.px(), py = constituent.py(), pz = constituent.pz();
+    addConstituent(px, py, pz, std::sqrt(px * px + py * py + pz * pz + mass * mass));
+  }
+
+  /**
+   * Reclusters the constituents into a single jet and declusters it, once per jet after adding its constituents.
+   *
+   * @param doSecondary Decluster also the softer branch of each primary splitting.
+   * @return Primary splittings, from the largest to the smallest angle, followed by the secondary ones.
+   */
+  std::vector<Splitting> const& decluster(bool doSecondary = false)
+  {
+    mSplittings.clear();
+    const int root = recluster();
+    if (root < 0) {
+      return mSplittings;
+    }
+    followHarderBranch(root, 0, -1);
+    if (doSecondary) {
+      const int nPrimary = mSplittings.size();
+      for (int iPrimary = 0; iPrimary < nPrimary; iPrimary++) {
+        followHarderBranch(mSofterBranch[iPrimary], 1, iPrimary);
+      }
+    }
+    return mSplittings;
+  }
+
+ private:
+  struct Node {
+    double px, py, pz, e;
+    double pt2, rap, phi;
+    int parent1, parent2; // -1 for a constituent
+  };
+
+  static constexpr double TwoPI = 2. * M_PI;
+  static constexpr double MaxRap = 1.e5; // rapidity of a particle along the beam, as in fastjet
+
+  void addNode(double px, double py, double pz, double e, int parent1, int parent2)
+  {
+    Node node{px, py, pz, e, px * px + py * py, 0., 0., parent1, parent2};
+    // rapidity and azimuth as in fastjet::PseudoJet
+    node.phi = node.pt2 == 0. ? 0. : std::atan2(py, px);
+    if (node.phi < 0.) {
+      node.phi += TwoPI;
+    }
+    if (e == std::abs(pz) && node.pt2 == 0.) {
+      node.rap = pz >= 0. ? MaxRap + pz : -(MaxRap - pz);
+    } else {
+      const double m2 = std::max(0., e * e - node.pt2 - pz * pz);
+      const double ePlusPz = e + std::abs(pz);
+      node.rap = 0.5 * std::log((node.pt2 + m2) / (ePlusPz * ePlusPz));
+      if (pz > 0.) {
+        node.rap = -node.rap;
+      }
+    }
+    mNodes.push_back(node);
+  }
+
+  double deltaR2(int i, int j) const
+  {
+    const double dRap = mNodes[i].rap - mNodes[j].rap;
+    double dPhi = std::abs(mNodes[i].phi - mNodes[j].phi);
+    if (dPhi > M_PI) {
+      dPhi = TwoPI - dPhi;
+    }
+    return dRap * dRap + dPhi * dPhi;
+  }
+
+  void updateNearestNeighbour(int iActive)
+  {
+    mNearestDistance[iActive] = std::numeric_limits<double>::max();
+    mNearest[iActive] = -1;
+    for (std::size_t jActive = 0; jActive < mActive.size(); jActive++) {
+      if (static_cast<int>(jActive) == iActive) {
+        continue;
+      }
+      const double distance = deltaR2(mActive[iActive], mActive[jActive]);
+      if (distance < mNearestDistance[iActive]) {
+        mNearestDistance[iActive] = distance;
+        mNearest[iActive] = jActive;
+      }
+    }
+  }
+
+  /// Merges the closest pair of subjets until one is left, returns the index of the final jet or -1 without constituents
+  int recluster()
+  {
+    const int nConstituents = mNodes.size();
+    if (nConstituents == 0) {
+      return -1;
+    }
+    mActive.resize(nConstituents);
+    mNearest.resize(nConstituents);
+    mNearestDistance.resize(nConstituents);
+    for (int i = 0; i < nConstituents; i++) {
+      mActive[i] = i;
+    }
+    for (int i = 0; i < nConstituents; i++) {
+      updateNearestNeighbour(i);
+    }
+    while (mActive.size() > 1) {
+      const int iActive = std::min_element(mNearestDistance.begin(), mNearestDistance.end()) - mNearestDistance.begin();
+      const int jActive = mNearest[iActive];
+      const Node& a = mNodes[mActive[iActive]];
+      const Node& b = mNodes[mActive[jActive]];
+      addNode(a.px + b.px, a.py + b.py, a.pz + b.pz, a.e + b.e, mActive[iActive], mActive[jActive]);
+      // the merged subjet takes the place of the first one, the last subjet takes the place of the second one
+      const int iLow = std::min(iActive, jActive), iHigh = std::max(iActive, jActive);
+      const int iLast = mActive.size() - 1;
+      mActive[iLow] = mNodes.size() - 1;
+      mActive[iHigh] = mActive[iLast];
+      mNearest[iHigh] = mNearest[iLast];
+      mNearestDistance[iHigh] = mNearestDistance[iLast];
+      mActive.pop_back();
+      mNearest.pop_back();
+      mNearestDistance.pop_back();
+      for (std::size_t kActive = 0; kActive < mActive.size(); kActive++) {
+        if (mNearest[kActive] == iLast) {
+          mNearest[kActive] = iHigh; // the last subjet moved
+        }
+        if (static_cast<int>(kActive) == iLow || mNearest[kActive] == iLow || mNearest[kActive] == iHigh) {
+          updateNearestNeighbour(kActive);
+        } else {
+          const double distance = deltaR2(mActive[kActive], mActive[iLow]);
+          if (distance < mNearestDistance[kActive]) {
+            mNearestDistance[kActive] = distance;
+            mNearest[kActive] = iLow;
+          }
+        }
+      }
+    }
+    return mActive[0];
+  }
+
+  /// Declusters a subjet following its harder branch and stores the splittings
+  void followHarderBranch(int iNode, int level, int primarySplitting)
+  {
+    while (mNodes[iNode].parent1 >= 0) {
+      int iHard = mNodes[iNode].parent1, iSoft = mNodes[iNode].parent2;
+      if (mNodes[iHard].pt2 < mNodes[iSoft].pt2) {
+        std::swap(iHard, iSoft);
+      }
+      const double ptHard = std::sqrt(mNodes[iHard].pt2), ptSoft = std::sqrt(mNodes[iSoft].pt2);
+      const double deltaR = std::sqrt(deltaR2(iHard, iSoft));
+      mSplittings.push_back({level, primarySplitting, static_cast<float>(ptSoft / (ptHard + ptSoft)), static_cast<float>(deltaR),
+                             static_cast<float>(ptSoft * deltaR), static_cast<float>(std::sqrt(mNodes[iNode].pt2))});
+      if (level == 0) {
+        mSofterBranch.resize(mSplittings.size());
+        mSofterBranch.back() = iSoft;
+      }
+      iNode = iHard;
+    }
+  }
+
+  std::vector<Node> mNodes;              // constituents followed by the merged subjets
+  std::vector<int> mActive;              // subjets not merged yet
+  std::vector<int> mNearest;             // position in mActive of the nearest neighbour of each active subjet
+  std::vector<double> mNearestDistance;  // squared distance to the nearest neighbour of each active subjet
+  std::vector<int> mSofterBranch;        // softer branch of each primary splitting
+  std::vector<Splitting> mSplittings;
+};
+
+} // namespace JetUtilities
+
+#endif // PWGJE_CORE_JETDECLUSTERING_H_
@@ -35,6 +35,16 @@ DECLARE_SOA_COLUMN(Rg, rg, float);   //!
 DECLARE_SOA_COLUMN(Nsd, nsd, float); //!
 } // namespace jetsubstructure
 
+namespace jetsplitting
+{
+DECLARE_SOA_COLUMN(Level, level, int8_t);                        //! 0 for the primary Lund declustering chain, 1 for a secondary one
+DECLARE_SOA_COLUMN(PrimarySplitting, primarySplitting, int16_t); //! index of the primary splitting whose softer branch is declustered, -1 for primary splittings
+DECLARE_SOA_COLUMN(Z, z, float);                                 //! pT,soft / (pT,hard + pT,soft)
+DECLARE_SOA_COLUMN(DeltaR, deltaR, float);                       //! distance between the two branches
+DECLARE_SOA_COLUMN(Kt, kt, float);                               //! pT,soft * deltaR
+DECLARE_SOA_COLUMN(Pt, pt, float);                               //! pT of the declustered subjet
+} // namespace jetsplitting
+
 namespace jetoutput
 {
 DECLARE_SOA_INDEX_COLUMN(Collision, collision);                //!
@@ -73,7 +83,8 @@ DECLARE_SOA_COLUMN(JetNConstituents, jetNConstituents, int);   //!
                                                                                                                                                                                                                                                                                                                                                                                                                             \
   DECLARE_SOA_TABLE(_jet_type_##Substructures, "AOD", _description_ "SS", jetsubstructure::Zg, jetsubstructure::Rg, jetsubstructure::Nsd, _name_##substructure::Dummy##_jet_type_<>);                                                                                                                                                                                                                                       \
   DECLARE_SOA_TABLE(_jet_type_##Output, "AOD", _description_ "O", jetoutput::_collision_type_##Id, _name_##substructure::_jet_type_##Id, _name_##substructure::Candidate##Id, _name_##geomatched::_matched_jet_type_##Ids, _name_##ptmatched::_matched_jet_type_##Ids, _name_##candmatched::_matched_jet_type_##Ids, jetoutput::JetPt, jetoutput::JetPhi, jetoutput::JetEta, jetoutput::JetR, jetoutput::JetNConstituents); \
-  DECLARE_SOA_TABLE(_jet_type_##SubstructureOutput, "AOD", _description_ "SSO", _name_##substructure::_jet_type_##Id, jetsubstructure::Zg, jetsubstructure::Rg, jetsubstructure::Nsd);
+  DECLARE_SOA_TABLE(_jet_type_##SubstructureOutput, "AOD", _description_ "SSO", _name_##substructure::_jet_type_##Id, jetsubstructure::Zg, jetsubstructure::Rg, jetsubstructure::Nsd);                                                                                                                                                                                                                                      \
+  DECLARE_SOA_TABLE(_jet_type_##Splittings, "AOD", _description_ "SPL", _name_##substructure::_jet_type_##Id, jetsplitting::Level, jetsplitting::PrimarySplitting, jetsplitting::Z, jetsplitting::DeltaR, jetsplitting::Kt, jetsplitting::Pt);
 
 #define JETSUBSTRUCTURE_TABLES_DEF(_jet_type_, _cand_type_, _description_)                                                                                               \
   JETSUBSTRUCTURE_TABLE_DEF(Collision, _jet_type_##Jet, _jet_type_##Jet, _cand_type_, _jet_type_##jet, _description_)                                                    \
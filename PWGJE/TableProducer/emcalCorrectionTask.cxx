@@ -39,6 +39,7 @@
 #include "EMCALBase/NonlinearityHandler.h"
 #include "EMCALReconstruction/Clusterizer.h"
 #include "PWGJE/Core/JetUtilities.h"
+#include "PWGJE/Core/EmcalMatchingGrid.h"
 #include "TVector2.h"
 
 using namespace o2;
@@ -70,6 +71,7 @@ struct EmcalCorrectionTask {
   Configurable<int> selectedCellType{"selectedCellType", 1, "EMCAL Cell type"};
   Configurable<std::string> clusterDefinitions{"clusterDefinition", "kV3Default", "cluster definition to be selected, e.g. V3Default. Multiple definitions can be specified separated by comma"};
   Configurable<float> maxMatchingDistance{"maxMatchingDistance", 0.4f, "Max matching distance track-cluster"};
+  Configurable<bool> useMatchingGrid{"useMatchingGrid", true, "Match clusters and tracks with a grid of the tracks built once per BC instead of a KD-tree per clusterizer"};
   Configurable<bool> hasPropagatedTracks{"hasPropagatedTracks", false, "temporary flag, only set to true when running over data which has the tracks propagated to EMCal/PHOS!"};
   Configurable<std::string> nonlinearityFunction{"nonlinearityFunction", "DATA_TestbeamFinal", "Nonlinearity correction at cluster level"};
   Configurable<bool> disableNonLin{"disableNonLin", false, "Disable NonLin correction if set to true"};
@@ -98,6 +100,17 @@ struct EmcalCorrectionTask {
   std::vector<o2::emcal::AnalysisCluster> mAnalysisClusters;
 
   std::vector<o2::aod::EMCALClusterDefinition> mClusterDefinitions;
+  // Track matching
+  // The tracks of the collision are read by the first clusterizer of the BC and reused by the others
+  static constexpr int MaxNumberMatches = 20;
+  JetUtilities::EmcalMatchingGrid mMatchingGrid;
+  bool mHasTrackInfo = false;
+  std::vector<double> mTrackPhi;
+  std::vector<double> mTrackEta;
+  std::vector<int64_t> mTrackGlobalIndex;
+  std::vector<double> mClusterPhi;
+  std::vector<double> mClusterEta;
+  std::vector<int> mClusterToTrackIndex; // MaxNumberMatches track indices per cluster, -1 if none
   // QA
   o2::framework::HistogramRegistry mHistManager{"EMCALCorrectionTaskQAHistograms"};
 
@@ -157,6 +170,10 @@ struct EmcalCorrectionTask {
       LOG(error) << "No cluster definitions specified!";
     }
 
+    if (useMatchingGrid) {
+      mMatchingGrid.init(maxMatchingDistance);
+    }
+
     mNonlinearityHandler = o2::emcal::NonlinearityFactory::getInstance().getNonlinearity(static_cast<std::string>(nonlinearityFunction));
     LOG(info) << "Using nonlinearity parameterisation: " << nonlinearityFunction.value;
     LOG(info) << "Apply shaper saturation correction:  " << (hasShaperCorrection.value ? "yes" : "no");
@@ -261,6 +278,7 @@ struct EmcalCorrectionTask {
       //  this is a test
       //  Run the clusterizers
       LOG(debug) << "Running clusterizers";
+      mHasTrackInfo = false;
       for (size_t iClusterizer = 0; iClusterizer < mClusterizers.size(); iClusterizer++) {
         cellsToCluster(iClusterizer, cellsBC);
 
@@ -272,15 +290,11 @@ struct EmcalCorrectionTask {
               mHistManager.fill(HIST("hCollisionType"), 1);
               math_utils::Point3D<float> vertex_pos = {col.posX(), col.posY(), col.posZ()};
 
-              std::vector<std::vector<int>> clusterToTrackIndexMap;
-              std::vector<std::vector<int>> trackToClusterIndexMap;
-              std::tuple<std::vector<std::vector<int>>, std::vector<std::vector<int>>> IndexMapPair{clusterToTrackIndexMap, trackToClusterIndexMap};
-              std::vector<int64_t> trackGlobalIndex;
-              doTrackMatching<collEventSels::filtered_iterator>(col, tracks, IndexMapPair, vertex_pos, trackGlobalIndex);
+              doTrackMatching<collEventSels::filtered_iterator>(col, tracks, vertex_pos);
 
               // Store the clusters in the table where a matching collision could
               // be identified.
-              FillClusterTable<collEventSels::filtered_iterator>(col, vertex_pos, iClusterizer, cellIndicesBC, IndexMapPair, trackGlobalIndex);
+              FillClusterTable<collEventSels::filtered_iterator>(col, vertex_pos, iClusterizer, cellIndicesBC, true);
             }
           }
         } else { // ambiguous
@@ -360,6 +374,7 @@ struct EmcalCorrectionTask {
       //  this is a test
       //  Run the clusterizers
       LOG(debug) << "Running clusterizers";
+      mHasTrackInfo = false;
       for (size_t iClusterizer = 0; iClusterizer < mClusterizers.size(); iClusterizer++) {
         cellsToCluster(iClusterizer, cellsBC);
 
@@ -371,15 +386,11 @@ struct EmcalCorrectionTask {
               mHistManager.fill(HIST("hCollisionType"), 1);
               math_utils::Point3D<float> vertex_pos = {col.posX(), col.posY(), col.posZ()};
 
-              std::vector<std::vector<int>> clusterToTrackIndexMap;
-              std::vector<std::vector<int>> trackToClusterIndexMap;
-              std::tuple<std::vector<std::vector<int>>, std::vector<std::vector<int>>> IndexMapPair{clusterToTrackIndexMap, trackToClusterIndexMap};
-              std::vector<int64_t> trackGlobalIndex;
-              doTrackMatching<collEventSels::filtered_iterator>(col, tracks, IndexMapPair, vertex_pos, trackGlobalIndex);
+              doTrackMatching<collEventSels::filtered_iterator>(col, tracks, vertex_pos);
 
               // Store the clusters in the table where a matching collision could
               // be identified.
-              FillClusterTable<collEventSels::filtered_iterator>(col, vertex_pos, iClusterizer, cellIndicesBC, IndexMapPair, trackGlobalIndex);
+              FillClusterTable<collEventSels::filtered_iterator>(col, vertex_pos, iClusterizer, cellIndicesBC, true);
             }
           }
         } else { // ambiguous
@@ -514,7 +525,7 @@ struct EmcalCorrectionTask {
   }
 
   template <typename Collision>
-  void FillClusterTable(Collision const& col, math_utils::Point3D<float> const& vertex_pos, size_t iClusterizer, const gsl::span<int64_t> cellIndicesBC, std::optional<std::tuple<std::vector<std::vector<int>>, std::vector<std::vector<int>>>> const& IndexMapPair = std::nullopt, std::optional<std::vector<int64_t>> const& trackGlobalIndex = std::nullopt)
+  void FillClusterTable(Collision const& col, math_utils::Point3D<float> const& vertex_pos, size_t iClusterizer, const gsl::span<int64_t> cellIndicesBC, bool hasTrackMatching = false)
   {
     // we found a collision, put the clusters into the none ambiguous table
     clusters.reserve(mAnalysisClusters.size());
@@ -559,12 +570,12 @@ struct EmcalCorrectionTask {
       // fill histograms
       mHistManager.fill(HIST("hClusterE"), cluster.E());
       mHistManager.fill(HIST("hClusterEtaPhi"), pos.Eta(), TVector2::Phi_0_2pi(pos.Phi()));
-      if (IndexMapPair && trackGlobalIndex) {
-        for (unsigned int iTrack = 0;
-             iTrack < std::get<0>(*IndexMapPair)[iCluster].size(); iTrack++) {
-          if (std::get<0>(*IndexMapPair)[iCluster][iTrack] >= 0) {
-            LOG(debug) << "Found track " << (*trackGlobalIndex)[std::get<0>(*IndexMapPair)[iCluster][iTrack]] << " in cluster " << cluster.getID();
-            matchedTracks(clusters.lastIndex(), (*trackGlobalIndex)[std::get<0>(*IndexMapPair)[iCluster][iTrack]]);
+      if (hasTrackMatching) {
+        for (int iMatch = 0; iMatch < MaxNumberMatches; iMatch++) {
+          const int iTrack = mClusterToTrackIndex[iCluster * MaxNumberMatches + iMatch];
+          if (iTrack >= 0) {
+            LOG(debug) << "Found track " << mTrackGlobalIndex[iTrack] << " in cluster " << cluster.getID();
+            matchedTracks(clusters.lastIndex(), mTrackGlobalIndex[iTrack]);
           }
         }
       }
@@ -615,26 +626,27 @@ struct EmcalCorrectionTask {
   }
 
   template <typename Collision>
-  void doTrackMatching(Collision const& col, myGlobTracks const& tracks, std::tuple<std::vector<std::vector<int>>, std::vector<std::vector<int>>>& IndexMapPair, math_utils::Point3D<float>& vertex_pos, std::vector<int64_t>& trackGlobalIndex)
+  void doTrackMatching(Collision const& col, myGlobTracks const& tracks, math_utils::Point3D<float>& vertex_pos)
   {
-    auto groupedTracks = tracks.sliceBy(perCollision, col.globalIndex());
-    int NTracksInCol = groupedTracks.size();
-    std::vector<double> trackPhi;
-    std::vector<double> trackEta;
-    // reserve memory to reduce on the fly memory allocation
-    trackPhi.reserve(NTracksInCol);
-    trackEta.reserve(NTracksInCol);
-    trackGlobalIndex.reserve(NTracksInCol);
-    FillTrackInfo<decltype(groupedTracks)>(groupedTracks, trackPhi, trackEta, trackGlobalIndex);
-
-    int NClusterInCol = mAnalysisClusters.size();
-    std::vector<double> clusterPhi;
-    std::vector<double> clusterEta;
-    clusterPhi.reserve(NClusterInCol);
-    clusterEta.reserve(NClusterInCol);
-
-    // TODO one loop that could in principle be combined with the other
-    // loop to improve performance
+    if (!mHasTrackInfo) {
+      auto groupedTracks = tracks.sliceBy(perCollision, col.globalIndex());
+      int NTracksInCol = groupedTracks.size();
+      mTrackPhi.clear();
+      mTrackEta.clear();
+      mTrackGlobalIndex.clear();
+      // reserve memory to reduce on the fly memory allocation
+      mTrackPhi.reserve(NTracksInCol);
+      mTrackEta.reserve(NTracksInCol);
+      mTrackGlobalIndex.reserve(NTracksInCol);
+      FillTrackInfo<decltype(groupedTracks)>(groupedTracks, mTrackPhi, mTrackEta, mTrackGlobalIndex);
+      if (useMatchingGrid) {
+        mMatchingGrid.setTracks(mTrackEta, mTrackPhi);
+      }
+      mHasTrackInfo = true;
+    }
+
+    mClusterPhi.clear();
+    mClusterEta.clear();
     for (const auto& cluster : mAnalysisClusters) {
       // Determine the cluster eta, phi, correcting for the vertex
       // position.
@@ -642,13 +654,21 @@ struct EmcalCorrectionTask {
       pos = pos - vertex_pos;
       // Normalize the vector and rescale by energy.
       pos *= (cluster.E() / std::sqrt(pos.Mag2()));
-      clusterPhi.emplace_back(TVector2::Phi_0_2pi(pos.Phi()));
-      clusterEta.emplace_back(pos.Eta());
+      mClusterPhi.emplace_back(TVector2::Phi_0_2pi(pos.Phi()));
+      mClusterEta.emplace_back(pos.Eta());
+    }
+    if (useMatchingGrid) {
+      mMatchingGrid.matchClusters(mClusterEta, mClusterPhi, MaxNumberMatches, mClusterToTrackIndex);
+      return;
+    }
+    auto IndexMapPair =
+      JetUtilities::MatchClustersAndTracks(mClusterPhi, mClusterEta,
+                                           mTrackPhi, mTrackEta,
+                                           maxMatchingDistance, MaxNumberMatches);
+    mClusterToTrackIndex.clear();
+    for (const auto& clusterMatches : std::get<0>(IndexMapPair)) {
+      mClusterToTrackIndex.insert(mClusterToTrackIndex.end(), clusterMatches.begin(), clusterMatches.end());
     }
-    IndexMapPair =
-      JetUtilities::MatchClustersAndTracks(clusterPhi, clusterEta,
-                                           trackPhi, trackEta,
-                                           maxMatchingDistance, 20);
   }
 
   template <typename Tracks>
@@ -14,9 +14,6 @@
 // Author: Nima Zardoshti
 //
 
-#include "fastjet/PseudoJet.hh"
-#include "fastjet/ClusterSequenceArea.hh"
-
 #include "Framework/AnalysisTask.h"
 #include "Framework/AnalysisDataModel.h"
 #include "Framework/ASoA.h"
@@ -33,6 +30,7 @@
 #include "PWGJE/DataModel/JetSubstructure.h"
 #include "PWGJE/Core/JetFinder.h"
 #include "PWGJE/Core/FastJetUtilities.h"
+#include "PWGJE/Core/JetDeclustering.h"
 
 using namespace o2;
 using namespace o2::framework;
@@ -40,19 +38,19 @@ using namespace o2::framework::expressions;
 
 #include "Framework/runDataProcessing.h"
 
-template <typename JetTable, typename JetTableMCP, typename SubstructureTable>
+template <typename JetTable, typename JetTableMCP, typename SubstructureTable, typename SplittingTable>
 struct JetSubstructureTask {
   Produces<SubstructureTable> jetSubstructureTable;
+  Produces<SplittingTable> jetSplittingTable;
   OutputObj<TH2F> hZg{"h_jet_zg_jet_pt"};
   OutputObj<TH2F> hRg{"h_jet_rg_jet_pt"};
   OutputObj<TH2F> hNsd{"h_jet_nsd_jet_pt"};
 
   Configurable<float> zCut{"zCut", 0.1, "soft drop z cut"};
   Configurable<float> beta{"beta", 0.0, "soft drop beta"};
+  Configurable<bool> doSecondaryDeclustering{"doSecondaryDeclustering", false, "store also the secondary Lund declustering chains"};
 
-  std::vector<fastjet::PseudoJet> jetConstituents;
-  std::vector<fastjet::PseudoJet> jetReclustered;
-  JetFinder jetReclusterer;
+  JetUtilities::JetDeclustering jetDeclustering;
 
   void init(InitContext const&)
   {
@@ -62,30 +60,24 @@ struct JetSubstructureTask {
                            10, 0.0, 0.5, 200, 0.0, 200.0));
     hNsd.setObject(new TH2F("h_jet_nsd_jet_pt", ";n_{SD}; #it{p}_{T,jet} (GeV/#it{c})",
                             7, -0.5, 6.5, 200, 0.0, 200.0));
-
-    jetReclusterer.isReclustering = true;
-    jetReclusterer.algorithm = fastjet::JetAlgorithm::cambridge_algorithm;
   }
 
+  // the constituents are reclustered with C/A, the primary declustering chain gives the soft drop observables
+  // and all the splittings are stored for the consumers of the Lund declustering
   template <typename T>
   void jetReclustering(T const& jet)
   {
-    jetReclustered.clear();
-    fastjet::ClusterSequenceArea clusterSeq(jetReclusterer.findJets(jetConstituents, jetReclustered));
-    jetReclustered = sorted_by_pt(jetReclustered);
-    fastjet::PseudoJet daughterSubJet = jetReclustered[0];
-    fastjet::PseudoJet parentSubJet1;
-    fastjet::PseudoJet parentSubJet2;
     bool softDropped = false;
     auto nsd = 0.0;
     auto zg = -1.0;
     auto rg = -1.0;
-    while (daughterSubJet.has_parents(parentSubJet1, parentSubJet2)) {
-      if (parentSubJet1.perp() < parentSubJet2.perp()) {
-        std::swap(parentSubJet1, parentSubJet2);
+    for (auto const& splitting : jetDeclustering.decluster(doSecondaryDeclustering)) {
+      jetSplittingTable(jet.globalIndex(), splitting.level, splitting.primarySplitting, splitting.z, splitting.deltaR, splitting.kt, splitting.pt);
+      if (splitting.level != 0) {
+        continue;
       }
-      auto z = parentSubJet2.perp() / (parentSubJet1.perp() + parentSubJet2.perp());
-      auto theta = parentSubJet1.delta_R(parentSubJet2);
+      auto z = splitting.z;
+      auto theta = splitting.deltaR;
       if (z >= zCut * TMath::Power(theta / (jet.r() / 100.f), beta)) {
         if (!softDropped) {
           zg = z;
@@ -96,7 +88,6 @@ struct JetSubstructureTask {
         }
         nsd++;
       }
-      daughterSubJet = parentSubJet1;
     }
     hNsd->Fill(nsd, jet.pt());
     jetSubstructureTable(zg, rg, nsd);
@@ -110,9 +101,9 @@ struct JetSubstructureTask {
   void processChargedJets(typename JetTable::iterator const& jet,
                           aod::Tracks const& tracks)
   {
-    jetConstituents.clear();
+    jetDeclustering.clear();
     for (auto& jetConstituent : jet.template tracks_as<aod::Tracks>()) {
-      FastJetUtilities::fillTracks(jetConstituent, jetConstituents, jetConstituent.globalIndex());
+      jetDeclustering.addTrack(jetConstituent, JetFinder::mPion);
     }
     jetReclustering(jet);
   }
@@ -121,17 +112,17 @@ struct JetSubstructureTask {
   void processChargedJetsMCP(typename JetTableMCP::iterator const& jet,
                              aod::McParticles const& particles)
   {
-    jetConstituents.clear();
+    jetDeclustering.clear();
     for (auto& jetConstituent : jet.template tracks_as<aod::McParticles>()) {
-      FastJetUtilities::fillTracks(jetConstituent, jetConstituents, jetConstituent.globalIndex(), static_cast<int>(JetConstituentStatus::track), RecoDecay::getMassPDG(jetConstituent.pdgCode()));
+      jetDeclustering.addTrack(jetConstituent, RecoDecay::getMassPDG(jetConstituent.pdgCode()));
     }
     jetReclustering(jet);
   }
   PROCESS_SWITCH(JetSubstructureTask, processChargedJetsMCP, "charged jet substructure on MC particle level", false);
 };
-using JetSubstructureDataLevel = JetSubstructureTask<soa::Join<aod::ChargedJets, aod::ChargedJetConstituents>, soa::Join<aod::ChargedMCParticleLevelJets, aod::ChargedMCParticleLevelJetConstituents>, o2::aod::ChargedJetSubstructures>;
-using JetSubstructureMCDetectorLevel = JetSubstructureTask<soa::Join<aod::ChargedMCDetectorLevelJets, aod::ChargedMCDetectorLevelJetConstituents>, soa::Join<aod::ChargedMCParticleLevelJets, aod::ChargedMCParticleLevelJetConstituents>, o2::aod::ChargedMCDetectorLevelJetSubstructures>;
-using JetSubstructureMCParticleLevel = JetSubstructureTask<soa::Join<aod::ChargedMCDetectorLevelJets, aod::ChargedMCDetectorLevelJetConstituents>, soa::Join<aod::ChargedMCParticleLevelJets, aod::ChargedMCParticleLevelJetConstituents>, o2::aod::ChargedMCParticleLevelJetSubstructures>;
+using JetSubstructureDataLevel = JetSubstructureTask<soa::Join<aod::ChargedJets, aod::ChargedJetConstituents>, soa::Join<aod::ChargedMCParticleLevelJets, aod::ChargedMCParticleLevelJetConstituents>, o2::aod::ChargedJetSubstructures, o2::aod::ChargedJetSplittings>;
+using JetSubstructureMCDetectorLevel = JetSubstructureTask<soa::Join<aod::ChargedMCDetectorLevelJets, aod::ChargedMCDetectorLevelJetConstituents>, soa::Join<aod::ChargedMCParticleLevelJets, aod::ChargedMCParticleLevelJetConstituents>, o2::aod::ChargedMCDetectorLevelJetSubstructures, o2::aod::ChargedMCDetectorLevelJetSplittings>;
+using JetSubstructureMCParticleLevel = JetSubstructureTask<soa::Join<aod::ChargedMCDetectorLevelJets, aod::ChargedMCDetectorLevelJetConstituents>, soa::Join<aod::ChargedMCParticleLevelJets, aod::ChargedMCParticleLevelJetConstituents>, o2::aod::ChargedMCParticleLevelJetSubstructures, o2::aod::ChargedMCParticleLevelJetSplittings>;
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
 {
@@ -100,9 +100,11 @@ struct nSubJettiness {
   }
 
   // function that converts a jet from the O2Physics jet table into a pseudojet; the fastjet cluster sequence of the jet needs to be given as input and will be modified by the function to save the clustering information
+  // the constituent vector is filled in place, so that its memory is reused from jet to jet
   template <typename JetTableElement>
-  void jetToPseudoJet(JetTableElement const& jet, fastjet::PseudoJet& pseudoJet, std::vector<fastjet::PseudoJet> jetConstituents, fastjet::ClusterSequence& clusterSeqInput)
+  void jetToPseudoJet(JetTableElement const& jet, fastjet::PseudoJet& pseudoJet, std::vector<fastjet::PseudoJet>& jetConstituents, fastjet::ClusterSequence& clusterSeqInput)
   {
+    jetConstituents.clear();
     for (auto& jetConstituent : jet.template tracks_as<TrackTable>()) {
       FastJetUtilities::fillTracks(jetConstituent, jetConstituents, jetConstituent.globalIndex());
     }
@@ -151,7 +153,6 @@ struct nSubJettiness {
       registry.fill(HIST("hErrorControl"), -999);
     } else {
       fastjet::PseudoJet pseudoJet;
-      jetConstituents.clear();
       jetToPseudoJet(jet, pseudoJet, jetConstituents, clusterSeq_pseudoJet);
       std::vector<float> nSub_Kt_results = getNsubRatio21(pseudoJet, jet.r() / 100., fastjet::contrib::KT_Axes(), "Kt");
       std::vector<float> nSub_CA_results = getNsubRatio21(pseudoJet, jet.r() / 100., fastjet::contrib::CA_Axes(), "CA");
@@ -54,6 +54,7 @@
 #include "Common/Core/trackUtilities.h"
 #include "PWGLF/DataModel/LFStrangenessTables.h"
 #include "PWGLF/DataModel/LFParticleIdentification.h"
+#include "PWGLF/Utils/trackDCACache.h"
 #include "Common/Core/TrackSelection.h"
 #include "Common/DataModel/TrackSelectionTables.h"
 #include "DetectorsBase/Propagator.h"
@@ -242,6 +243,9 @@ struct cascadeBuilder {
   o2::track::TrackParCov lV0Track;
   o2::track::TrackParCov lCascadeTrack;
 
+  // DCA to PV of the daughters, computed once per track and collision in each dataframe
+  o2::analysis::TrackDCACache trackDCACache;
+
   // Helper struct to do bookkeeping of building parameters
   struct {
     std::array<long, kNCascSteps> cascstats;
@@ -800,11 +804,9 @@ struct cascadeBuilder {
 
     // bachelor DCA track to PV
     // Calculate DCA with respect to the collision associated to the V0, not individual tracks
-    gpu::gpustd::array<float, 2> dcaInfo;
-
-    auto bachTrackPar = getTrackPar(bachTrack);
-    o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, bachTrackPar, 2.f, fitter.getMatCorrType(), &dcaInfo);
-    cascadecandidate.bachDCAxy = dcaInfo[0];
+    // (cached: a bachelor is shared by several cascades of the same collision)
+    const std::array<float, 3> primaryVertexPos = {collision.posX(), collision.posY(), collision.posZ()};
+    cascadecandidate.bachDCAxy = trackDCACache.get(bachTrack, cascade.collisionId(), primaryVertexPos).dca[0];
 
     if (TMath::Abs(cascadecandidate.bachDCAxy) < dcabachtopv)
       return false;
@@ -902,6 +904,7 @@ struct cascadeBuilder {
     lCascadeTrack = fitter.createParentTrackParCov();
     lCascadeTrack.setAbsCharge(cascadecandidate.charge); // to be sure
     lCascadeTrack.setPID(o2::track::PID::XiMinus);       // FIXME: not OK for omegas
+    gpu::gpustd::array<float, 2> dcaInfo;
     dcaInfo[0] = 999;
     dcaInfo[1] = 999;
 
@@ -1022,18 +1025,11 @@ struct cascadeBuilder {
 
     // bachelor DCA track to PV
     // Calculate DCA with respect to the collision associated to the V0, not individual tracks
-    gpu::gpustd::array<float, 2> dcaInfo;
-
-    auto bachTrackPar = getTrackPar(bachTrack);
-    o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, bachTrackPar, 2.f, fitter.getMatCorrType(), &dcaInfo);
-    cascadecandidate.bachDCAxy = dcaInfo[0];
-
-    o2::track::TrackParCov posTrackParCovForDCA = getTrackParCov(posTrack);
-    o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, posTrackParCovForDCA, 2.f, fitter.getMatCorrType(), &dcaInfo);
-    cascadecandidate.v0dcapostopv = dcaInfo[0];
-    o2::track::TrackParCov negTrackParCovForDCA = getTrackParCov(negTrack);
-    o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, negTrackParCovForDCA, 2.f, fitter.getMatCorrType(), &dcaInfo);
-    cascadecandidate.v0dcanegtopv = dcaInfo[0];
+    // (cached: the daughters are shared by several cascades of the same collision)
+    const std::array<float, 3> primaryVertexPos = {collision.posX(), collision.posY(), collision.posZ()};
+    cascadecandidate.bachDCAxy = trackDCACache.get(bachTrack, cascade.collisionId(), primaryVertexPos).dca[0];
+    cascadecandidate.v0dcapostopv = trackDCACache.get(posTrack, cascade.collisionId(), primaryVertexPos).dca[0];
+    cascadecandidate.v0dcanegtopv = trackDCACache.get(negTrack, cascade.collisionId(), primaryVertexPos).dca[0];
 
     if (TMath::Abs(cascadecandidate.bachDCAxy) < dcabachtopv)
       return false;
@@ -1161,6 +1157,7 @@ struct cascadeBuilder {
     } else {
       lCascadeTrack = getTrackParCovFromKFP(KFOmega, o2::track::PID::OmegaMinus, cascadecandidate.charge);
     }
+    gpu::gpustd::array<float, 2> dcaInfo;
     dcaInfo[0] = 999;
     dcaInfo[1] = 999;
     o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, lCascadeTrack, 2.f, matCorrCascade, &dcaInfo);
@@ -1523,8 +1520,9 @@ struct cascadeBuilder {
     resetHistos();
   }
 
-  void processRun2(aod::Collisions const& collisions, aod::V0sLinked const&, V0full const&, soa::Filtered<TaggedCascades> const& cascades, FullTracksExt const&, aod::BCsWithTimestamps const&)
+  void processRun2(aod::Collisions const& collisions, aod::V0sLinked const&, V0full const&, soa::Filtered<TaggedCascades> const& cascades, FullTracksExt const& tracks, aod::BCsWithTimestamps const&)
   {
+    trackDCACache.reset(tracks.size(), fitter.getMatCorrType());
     for (const auto& collision : collisions) {
       // Fire up CCDB
       auto bc = collision.bc_as<aod::BCsWithTimestamps>();
@@ -1537,8 +1535,9 @@ struct cascadeBuilder {
   }
   PROCESS_SWITCH(cascadeBuilder, processRun2, "Produce Run 2 cascade tables", true);
 
-  void processRun3(aod::Collisions const& collisions, aod::V0sLinked const&, V0full const&, soa::Filtered<TaggedCascades> const& cascades, FullTracksExtIU const&, aod::BCsWithTimestamps const&)
+  void processRun3(aod::Collisions const& collisions, aod::V0sLinked const&, V0full const&, soa::Filtered<TaggedCascades> const& cascades, FullTracksExtIU const& tracks, aod::BCsWithTimestamps const&)
   {
+    trackDCACache.reset(tracks.size(), fitter.getMatCorrType());
     for (const auto& collision : collisions) {
       // Fire up CCDB
       auto bc = collision.bc_as<aod::BCsWithTimestamps>();
@@ -1551,8 +1550,9 @@ struct cascadeBuilder {
   }
   PROCESS_SWITCH(cascadeBuilder, processRun3, "Produce Run 3 cascade tables", false);
 
-  void processRun3withKFParticle(aod::Collisions const& collisions, soa::Filtered<TaggedCascades> const& cascades, FullTracksExtIU const&, aod::BCsWithTimestamps const&, aod::V0s const&)
+  void processRun3withKFParticle(aod::Collisions const& collisions, soa::Filtered<TaggedCascades> const& cascades, FullTracksExtIU const& tracks, aod::BCsWithTimestamps const&, aod::V0s const&)
   {
+    trackDCACache.reset(tracks.size(), fitter.getMatCorrType());
     for (const auto& collision : collisions) {
       // Fire up CCDB
       auto bc = collision.bc_as<aod::BCsWithTimestamps>();
@@ -1565,8 +1565,9 @@ struct cascadeBuilder {
   }
   PROCESS_SWITCH(cascadeBuilder, processRun3withKFParticle, "Produce Run 3 KF cascade tables", false);
 
-  void processRun3withStrangenessTracking(aod::Collisions const& collisions, aod::V0sLinked const&, V0full const&, soa::Filtered<TaggedCascades> const& cascades, FullTracksExtIU const&, aod::BCsWithTimestamps const&, aod::TrackedCascades const& trackedCascades)
+  void processRun3withStrangenessTracking(aod::Collisions const& collisions, aod::V0sLinked const&, V0full const&, soa::Filtered<TaggedCascades> const& cascades, FullTracksExtIU const& tracks, aod::BCsWithTimestamps const&, aod::TrackedCascades const& trackedCascades)
   {
+    trackDCACache.reset(tracks.size(), fitter.getMatCorrType());
     for (const auto& collision : collisions) {
       // Fire up CCDB
       auto bc = collision.bc_as<aod::BCsWithTimestamps>();
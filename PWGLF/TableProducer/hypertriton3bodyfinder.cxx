@@ -16,6 +16,7 @@
 #include <array>
 #include <cstdlib>
 #include <iterator>
+#include <vector>
 
 #include "Framework/runDataProcessing.h"
 #include "Framework/AnalysisTask.h"
@@ -27,6 +28,7 @@
 #include "Common/Core/trackUtilities.h"
 #include "PWGLF/DataModel/LFStrangenessTables.h"
 #include "PWGLF/DataModel/Vtx3BodyTables.h"
+#include "PWGLF/Utils/helixPrefilter.h"
 #include "Common/Core/TrackSelection.h"
 #include "Common/DataModel/TrackSelectionTables.h"
 #include "Common/DataModel/EventSelection.h"
@@ -156,6 +158,16 @@ struct hypertriton3bodyFinder {
   // for DCA
   // Configurable<float> dcav0dau{"dcav0dau", 1.0, "DCA V0 Daughters"};
 
+  // Analytic prefilter of the track combinations before the DCAFitters
+  // The finder has no DCA or z-gap selection on the daughters, so the prefilter cuts are additional selections
+  // and not bounds of the existing ones: enabling it changes the candidate output.
+  Configurable<bool> usePrefilter{"usePrefilter", false, "reject combinations whose transverse circles are incompatible with the prefilter cuts before fitting (additional selections, changes the output)"};
+  Configurable<float> prefilterMaxDXY{"prefilterMaxDXY", 4.f, "max transverse distance of the circles of the V0 daughters (cm)"};
+  Configurable<float> prefilterMaxDZ{"prefilterMaxDZ", 5.f, "max z distance of the V0 daughters at the circle crossing (cm)"};
+  Configurable<float> prefilterRTolerance{"prefilterRTolerance", 2.f, "tolerance on the minimum V0 radius at the circle crossing (cm)"};
+  Configurable<float> prefilterCosPAXYTolerance{"prefilterCosPAXYTolerance", 0.1f, "tolerance on the minimum V0 cosPAXY at the circle crossing"};
+  Configurable<float> prefilterMaxDXYBachelor{"prefilterMaxDXYBachelor", 5.f, "max transverse distance of the circle of the bachelor to the V0 vertex (cm)"};
+
   // for track cut in SVertexer, Can we use it in the production of goodtrack table?
   // float maxDCAXY3Body = 0.3; // max DCA of 3 body decay to PV in XY?
   // float maxDCAZ3Body = 0.3;  // max DCA of 3 body decay to PV in Z
@@ -191,6 +203,9 @@ struct hypertriton3bodyFinder {
   o2::base::MatLayerCylSet* lut = nullptr;
   o2::vertexing::DCAFitterN<2> fitter;
   o2::vertexing::DCAFitterN<3> fitter3body;
+  o2::analysis::HelixPrefilter prefilter;
+  std::vector<o2::analysis::TrackCircle> negativeCircles;
+  std::vector<o2::analysis::TrackCircle> goodCircles;
 
   void init(InitContext& context)
   {
@@ -263,6 +278,11 @@ struct hypertriton3bodyFinder {
     fitter3body.setMaxChi2(1e9);
     fitter3body.setUseAbsDCA(d_UseAbsDCA);
 
+    prefilter.setMaxDXY(prefilterMaxDXY);
+    prefilter.setMaxDZ(prefilterMaxDZ);
+    prefilter.setRadiusRange(std::sqrt(minR2ToMeanVertex) - prefilterRTolerance, 200.f);
+    prefilter.setMinCosPAXY(minCosPAXYMeanVertex3bodyV0 - prefilterCosPAXYTolerance, mMeanVertex.getX(), mMeanVertex.getY());
+
     // Material correction in the DCA fitter
     o2::base::Propagator::MatCorrType matCorr = o2::base::Propagator::MatCorrType::USEMatCorrNONE;
     if (useMatCorrType == 1) {
@@ -395,12 +415,33 @@ struct hypertriton3bodyFinder {
   template <class TTrackTo, typename TCollisionTable, typename TPosTrackTable, typename TNegTrackTable, typename TGoodTrackTable>
   void DecayFinder(TCollisionTable const& dCollision, TPosTrackTable const& dPtracks, TNegTrackTable const& dNtracks, TGoodTrackTable const& dGoodtracks)
   {
+    // transverse circles of the negative and bachelor tracks, computed once
+    if (usePrefilter) {
+      negativeCircles.clear();
+      for (auto& t1id : dNtracks) {
+        negativeCircles.push_back(o2::analysis::getTrackCircle(getTrackPar(t1id.template goodTrack_as<TTrackTo>()), d_bz));
+      }
+      goodCircles.clear();
+      for (auto& t2id : dGoodtracks) {
+        goodCircles.push_back(o2::analysis::getTrackCircle(getTrackPar(t2id.template goodTrack_as<TTrackTo>()), d_bz));
+      }
+    }
+
     for (auto& t0id : dPtracks) { // FIXME: turn into combination(...)
       registry.fill(HIST("hV0Counter"), 0.5);
       auto t0 = t0id.template goodTrack_as<TTrackTo>();
       auto Track0 = getTrackParCov(t0);
+      o2::analysis::TrackCircle positiveCircle;
+      if (usePrefilter) {
+        positiveCircle = o2::analysis::getTrackCircle(Track0, d_bz);
+      }
 
+      int iNegative = -1;
       for (auto& t1id : dNtracks) {
+        iNegative++;
+        if (usePrefilter && !prefilter.isCompatible(positiveCircle, negativeCircles[iNegative])) {
+          continue;
+        }
         auto t1 = t1id.template goodTrack_as<TTrackTo>();
         auto Track1 = getTrackParCov(t1);
         int nCand = fitter.process(Track0, Track1);
@@ -478,7 +519,9 @@ struct hypertriton3bodyFinder {
         }
         registry.fill(HIST("hV0Counter"), 9.5);
 
+        int iGood = -1;
         for (auto& t2id : dGoodtracks) {
+          iGood++;
           if (t2id.globalIndex() == t0id.globalIndex()) {
             continue; // skip the track used by V0
           }
@@ -494,6 +537,10 @@ struct hypertriton3bodyFinder {
           }
           registry.fill(HIST("hVtx3BodyCounter"), 1.5);
 
+          if (usePrefilter && o2::analysis::HelixPrefilter::getDistanceXY(goodCircles[iGood], v0XYZ[0], v0XYZ[1]) > prefilterMaxDXYBachelor) {
+            continue;
+          }
+
           int n3bodyVtx = fitter3body.process(track0, track1, bach);
           if (n3bodyVtx == 0) { // discard this pair
             continue;
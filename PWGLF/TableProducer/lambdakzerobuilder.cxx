@@ -54,6 +54,7 @@
 #include "Common/Core/trackUtilities.h"
 #include "PWGLF/DataModel/LFStrangenessTables.h"
 #include "PWGLF/DataModel/LFParticleIdentification.h"
+#include "PWGLF/Utils/trackDCACache.h"
 #include "Common/Core/TrackSelection.h"
 #include "Common/DataModel/TrackSelectionTables.h"
 #include "DetectorsBase/Propagator.h"
@@ -239,6 +240,9 @@ struct lambdakzeroBuilder {
   o2::track::TrackParCov lPositiveTrack;
   o2::track::TrackParCov lNegativeTrack;
 
+  // DCA to PV of the daughters, computed once per track and collision in each dataframe
+  o2::analysis::TrackDCACache trackDCACache;
+
   void init(InitContext& context)
   {
     resetHistos();
@@ -510,15 +514,10 @@ struct lambdakzeroBuilder {
     statisticsRegistry.v0stats[kV0TPCrefit]++;
 
     // Calculate DCA with respect to the collision associated to the V0, not individual tracks
-    gpu::gpustd::array<float, 2> dcaInfo;
-
-    auto posTrackPar = getTrackPar(posTrack);
-    o2::base::Propagator::Instance()->propagateToDCABxByBz({primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ()}, posTrackPar, 2.f, fitter.getMatCorrType(), &dcaInfo);
-    auto posTrackdcaXY = dcaInfo[0];
-
-    auto negTrackPar = getTrackPar(negTrack);
-    o2::base::Propagator::Instance()->propagateToDCABxByBz({primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ()}, negTrackPar, 2.f, fitter.getMatCorrType(), &dcaInfo);
-    auto negTrackdcaXY = dcaInfo[0];
+    // (cached: a track is a daughter of several V0s of the same collision)
+    const std::array<float, 3> primaryVertexPos = {primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ()};
+    auto posTrackdcaXY = trackDCACache.get(posTrack, V0.collisionId(), primaryVertexPos).dca[0];
+    auto negTrackdcaXY = trackDCACache.get(negTrack, V0.collisionId(), primaryVertexPos).dca[0];
 
     if (fabs(posTrackdcaXY) < dcapostopv || fabs(negTrackdcaXY) < dcanegtopv) {
       return false;
@@ -725,17 +724,18 @@ struct lambdakzeroBuilder {
     resetHistos();
   }
 
-  void processRun2(aod::Collisions const& collisions, soa::Filtered<TaggedV0s> const& V0s, FullTracksExt const&, aod::BCsWithTimestamps const&)
+  void processRun2(aod::Collisions const& collisions, soa::Filtered<TaggedV0s> const& V0s, FullTracksExt const& tracks, aod::BCsWithTimestamps const&)
   {
     // Fire up CCDB
     auto collision = collisions.begin();
     auto bc = collision.bc_as<aod::BCsWithTimestamps>();
     initCCDB(bc);
+    trackDCACache.reset(tracks.size(), fitter.getMatCorrType());
     buildStrangenessTables<FullTracksExt>(V0s);
   }
   PROCESS_SWITCH(lambdakzeroBuilder, processRun2, "Produce Run 2 V0 tables", false);
 
-  void processRun3(aod::Collisions const& collisions, soa::Filtered<TaggedV0s> const& V0s, FullTracksExtIU const&, aod::BCsWithTimestamps const& bcs)
+  void processRun3(aod::Collisions const& collisions, soa::Filtered<TaggedV0s> const& V0s, FullTracksExtIU const& tracks, aod::BCsWithTimestamps const& bcs)
   {
     // Fire up CCDB
     auto bc = collisions.size() ? collisions.begin().bc_as<aod::BCsWithTimestamps>() : bcs.begin();
@@ -744,6 +744,7 @@ struct lambdakzeroBuilder {
       return;
     }
     initCCDB(bc);
+    trackDCACache.reset(tracks.size(), fitter.getMatCorrType());
     buildStrangenessTables<FullTracksExtIU>(V0s);
   }
   PROCESS_SWITCH(lambdakzeroBuilder, processRun3, "Produce Run 3 V0 tables", true);
@@ -39,6 +39,7 @@
 #include "Common/DataModel/PIDResponse.h"
 #include "PWGLF/DataModel/LFStrangenessTables.h"
 #include "PWGLF/DataModel/LFStrangenessFinderTables.h"
+#include "PWGLF/Utils/helixPrefilter.h"
 #include "Common/Core/TrackSelection.h"
 #include "Common/DataModel/TrackSelectionTables.h"
 #include "Common/DataModel/EventSelection.h"
@@ -59,6 +60,7 @@
 #include <cmath>
 #include <array>
 #include <cstdlib>
+#include <vector>
 
 using namespace o2;
 using namespace o2::framework;
@@ -144,6 +146,12 @@ struct lambdakzerofinder {
   Configurable<float> v0radius{"v0radius", 5.0, "v0radius"};
   Configurable<float> maxV0DCAtoPV{"maxV0DCAtoPV", 0.5, "maximum V0 DCA to PV"};
 
+  // Analytic prefilter of the track pairs before the DCAFitter
+  Configurable<bool> usePrefilter{"usePrefilter", true, "reject pairs whose transverse circles are incompatible with the selections before fitting"};
+  Configurable<float> prefilterMaxDXY{"prefilterMaxDXY", 4.f, "max transverse distance of the circles of the daughters (cm)"};
+  Configurable<float> prefilterMaxDZ{"prefilterMaxDZ", 5.f, "max z distance of the daughters at the circle crossing (cm)"};
+  Configurable<float> prefilterRTolerance{"prefilterRTolerance", 2.f, "tolerance on the minimum V0 radius at the circle crossing (cm)"};
+
   // Configurables for selecting which particles to generate
   Configurable<bool> findK0Short{"findK0Short", true, "findK0Short"};
   Configurable<bool> findLambda{"findLambda", true, "findLambda"};
@@ -164,6 +172,9 @@ struct lambdakzerofinder {
   int mRunNumber;
   float d_bz;
 
+  o2::analysis::HelixPrefilter prefilter;
+  std::vector<o2::analysis::TrackCircle> negativeCircles;
+
   void init(InitContext& context)
   {
     mRunNumber = 0;
@@ -178,6 +189,15 @@ struct lambdakzerofinder {
     fitter.setMaxDZIni(1e9);
     fitter.setMaxChi2(1e9);
     fitter.setUseAbsDCA(d_UseAbsDCA);
+
+    // with absolute DCAs the chi2 of two prongs is half the square of their distance, bounded from below by the transverse one
+    float maxDXY = prefilterMaxDXY;
+    if (d_UseAbsDCA) {
+      maxDXY = std::min(maxDXY, std::sqrt(2.f * dcav0dau));
+    }
+    prefilter.setMaxDXY(maxDXY);
+    prefilter.setMaxDZ(prefilterMaxDZ);
+    prefilter.setRadiusRange(v0radius - prefilterRTolerance, 200.f);
   }
 
   void initCCDB(aod::BCsWithTimestamps::iterator const& bc)
@@ -296,8 +316,22 @@ struct lambdakzerofinder {
 
     Long_t lNCand = 0;
 
+    // transverse circles of the negative tracks, computed once
+    if (usePrefilter) {
+      negativeCircles.clear();
+      for (auto& nTrack : nTracks) {
+        negativeCircles.push_back(o2::analysis::getTrackCircle(getTrackPar(nTrack.track_as<FullTracksExtIU>()), d_bz));
+      }
+    }
+
     for (auto& pTrack : pTracks) { // FIXME: turn into combination(...)
+      o2::analysis::TrackCircle positiveCircle;
+      if (usePrefilter) {
+        positiveCircle = o2::analysis::getTrackCircle(getTrackPar(pTrack.track_as<FullTracksExtIU>()), d_bz);
+      }
+      int iNegative = -1;
       for (auto& nTrack : nTracks) {
+        iNegative++;
         // Check compatibility with certain hypotheses and desired building
         bool keepCandidate = false;
         if (pTrack.compatiblePi() && nTrack.compatiblePi() && findK0Short)
@@ -308,6 +342,8 @@ struct lambdakzerofinder {
           keepCandidate = true;
         if (!keepCandidate)
           continue;
+        if (usePrefilter && !prefilter.isCompatible(positiveCircle, negativeCircles[iNegative]))
+          continue;
 
         auto t1 = pTrack.track_as<FullTracksExtIU>();
         auto t2 = nTrack.track_as<FullTracksExtIU>();
@@ -16,6 +16,10 @@
 /// \brief  Task to produce the PID information for the TPC for the purpose of the Light flavor PWG
 ///
 
+#include <algorithm>
+#include <array>
+#include <vector>
+
 // ROOT includes
 #include "TFile.h"
 #include "TSystem.h"
@@ -75,6 +79,71 @@ const std::string defaultOptions[nSpecies][nOptions]{{"", "", "false", "false"},
                                                      {"", "", "false", "false"},
                                                      {"", "", "false", "false"}};
 
+// Post calibration (TF1 or TGraph) tabulated at load time on a grid in momentum, linearly interpolated
+struct postCalibTable {
+  TF1* fun = nullptr;
+  TGraph* graph = nullptr;
+  bool isLog = false;       // grid uniform in log(p) if the range is positive, uniform in p otherwise
+  float xMin = 0.f;         // tabulated range
+  float xMax = 0.f;         // tabulated range
+  float uMin = 0.f;         // first grid point in p or log(p)
+  float invStep = 0.f;      // inverse of the grid step in p or log(p)
+  std::vector<float> values; // tabulated values, empty if the object is evaluated directly
+
+  void set(TF1* f, TGraph* g, int nPoints)
+  {
+    fun = f;
+    graph = g;
+    values.clear();
+    if ((!fun && !graph) || nPoints < 2) {
+      return;
+    }
+    double lo = 0., hi = 0.;
+    if (fun) {
+      fun->GetRange(lo, hi);
+    } else {
+      if (graph->GetN() < 2) {
+        return;
+      }
+      lo = *std::min_element(graph->GetX(), graph->GetX() + graph->GetN());
+      hi = *std::max_element(graph->GetX(), graph->GetX() + graph->GetN());
+    }
+    if (!(hi > lo)) {
+      return;
+    }
+    isLog = lo > 0.;
+    xMin = lo;
+    xMax = hi;
+    const double uLo = isLog ? std::log(lo) : lo;
+    const double uHi = isLog ? std::log(hi) : hi;
+    uMin = uLo;
+    invStep = (nPoints - 1) / (uHi - uLo);
+    values.resize(nPoints);
+    for (int i = 0; i < nPoints; i++) {
+      const double u = uLo + i * (uHi - uLo) / (nPoints - 1);
+      values[i] = evalObject(isLog ? std::exp(u) : u);
+    }
+  }
+
+  bool isSet() const { return fun || graph; }
+
+  float evalObject(float x) const { return fun ? fun->Eval(x) : graph->Eval(x); }
+
+  /// Value of the post calibration at x, defaultValue if not set. Outside the tabulated range the object is evaluated
+  float eval(float x, float defaultValue) const
+  {
+    if (!isSet()) {
+      return defaultValue;
+    }
+    if (values.empty() || !(x >= xMin && x <= xMax)) {
+      return evalObject(x);
+    }
+    const float u = ((isLog ? std::log(x) : x) - uMin) * invStep;
+    const int i = std::min(static_cast<int>(u), static_cast<int>(values.size()) - 2);
+    return values[i] + (u - i) * (values[i + 1] - values[i]);
+  }
+};
+
 // Structure to hold the parameters
 struct bbParams {
   const std::string name;
@@ -95,6 +164,10 @@ struct bbParams {
   TF1* postCorrectionFun = nullptr;
   TF1* postCorrectionFunSigma = nullptr;
 
+  postCalibTable postCorrectionTable;      // Tabulated postCorrectionFun or postCorrection
+  postCalibTable postCorrectionSigmaTable; // Tabulated postCorrectionFunSigma or postCorrectionSigma
+  int postCalibTableSize = 1000;           // Number of grid points of the tabulated post calibrations, not tabulated if < 2
+
   // Utility parameters for the usage
   bool betheBlochSet = true;     // Flag to check if the Bethe-Bloch parameters have been set. By default is true as the default values are set. Used to check if the parameters have been set after a CCDB update
   bool requirePostCalib = true;  // Flag to force the post calib. to be required, if not found, it will trigger a fatal error
@@ -268,6 +341,8 @@ struct bbParams {
     } else {
       LOG(info) << "          postCorrectionSigma: Not assigned";
     }
+    postCorrectionTable.set(postCorrectionFun, postCorrection, postCalibTableSize);
+    postCorrectionSigmaTable.set(postCorrectionFunSigma, postCorrectionSigma, postCalibTableSize);
   }
 
   ///
@@ -466,6 +541,7 @@ struct lfTpcPid {
   Service<o2::ccdb::BasicCCDBManager> ccdb;
   Configurable<bool> skipTPCOnly{"skipTPCOnly", true, "Flag to skip TPC only tracks (faster but affects the analyses that use TPC only tracks)"};
   Configurable<bool> fatalOnNonExisting{"fatalOnNonExisting", true, "Fatal message if calibrations not found on the CCDB"};
+  Configurable<int> postCalibTableSize{"postCalibTableSize", 1000, "Number of points of the lookup tables of the post calibrations, if < 2 the TF1/TGraph are evaluated for each track"};
 
   // Parameters setting from json
   Configurable<LabeledArray<float>> bbParameters{"bbParameters",
@@ -560,218 +636,60 @@ struct lfTpcPid {
 
   HistogramRegistry histos{"histos", {}, OutputObjHandlingPolicy::AnalysisObject};
 
-  template <o2::track::PID::ID id, typename T>
-  float BetheBlochLf(const T& track, const bbParams& params) const
-  {
-    static constexpr float invmass = 1.f / o2::track::pid_constants::sMasses2Z[id];
-    static constexpr float charge = o2::track::pid_constants::sCharges[id];
-    float corr = 0.f;
-    if (params.postCorrection != nullptr) {
-      corr = params.postCorrection->Eval(track.tpcInnerParam());
-    }
-    if (params.postCorrectionFun != nullptr) {
-      corr = params.postCorrectionFun->Eval(track.tpcInnerParam());
-    }
-    if (params.isSimple) {
-      return o2::tpc::BetheBlochAleph(track.tpcInnerParam() * invmass, params.bb1, params.bb2, params.bb3, params.bb4, params.bb5) + corr;
+  // Track columns used by the response, read once per process call
+  struct {
+    std::vector<float> innerParam;
+    std::vector<float> signal;
+    std::vector<uint8_t> isNegative;
+    std::vector<uint8_t> isSelected; // has TPC and is not a skipped TPC only track
+  } columns;
+  std::array<std::vector<float>, 3> expSigmas; // expected sigma per computed species
+  std::array<std::vector<float>, 3> nSigmas;   // nsigma per computed species
+
+  template <typename T>
+  void fillColumns(const T& tracks)
+  {
+    const auto n = tracks.size();
+    columns.innerParam.resize(n);
+    columns.signal.resize(n);
+    columns.isNegative.resize(n);
+    columns.isSelected.resize(n);
+    size_t i = 0;
+    for (auto const& trk : tracks) {
+      columns.innerParam[i] = trk.tpcInnerParam();
+      columns.signal[i] = trk.tpcSignal();
+      columns.isNegative[i] = trk.sign() <= 0;
+      columns.isSelected[i] = trk.hasTPC() && (!skipTPCOnly || trk.hasITS() || trk.hasTRD() || trk.hasTOF());
+      i++;
     }
-    return params.mip * o2::tpc::BetheBlochAleph(track.tpcInnerParam() * invmass, params.bb1, params.bb2, params.bb3, params.bb4, params.bb5) * std::pow(charge, params.exp) + corr;
-  }
-
-  template <typename T>
-  float BetheBlochEl(const T& track) const
-  {
-    return BetheBlochLf<o2::track::PID::Electron>(track, bbEl);
-  }
-  template <typename T>
-  float BetheBlochMu(const T& track) const
-  {
-    return BetheBlochLf<o2::track::PID::Muon>(track, bbMu);
-  }
-  template <typename T>
-  float BetheBlochPi(const T& track) const
-  {
-    return BetheBlochLf<o2::track::PID::Pion>(track, bbPi);
-  }
-  template <typename T>
-  float BetheBlochKa(const T& track) const
-  {
-    return BetheBlochLf<o2::track::PID::Kaon>(track, bbKa);
-  }
-  template <typename T>
-  float BetheBlochPr(const T& track) const
-  {
-    return BetheBlochLf<o2::track::PID::Proton>(track, bbPr);
-  }
-  template <typename T>
-  float BetheBlochDe(const T& track) const
-  {
-    return BetheBlochLf<o2::track::PID::Deuteron>(track, bbDe);
-  }
-  template <typename T>
-  float BetheBlochTr(const T& track) const
-  {
-    return BetheBlochLf<o2::track::PID::Triton>(track, bbTr);
-  }
-  template <typename T>
-  float BetheBlochHe(const T& track) const
-  {
-    return BetheBlochLf<o2::track::PID::Helium3>(track, bbHe);
-  }
-  template <typename T>
-  float BetheBlochAl(const T& track) const
-  {
-    return BetheBlochLf<o2::track::PID::Alpha>(track, bbAl);
-  }
-
-  template <typename T>
-  float BetheBlochNegEl(const T& track) const
-  {
-    return BetheBlochLf<o2::track::PID::Electron>(track, bbNegEl);
-  }
-  template <typename T>
-  float BetheBlochNegMu(const T& track) const
-  {
-    return BetheBlochLf<o2::track::PID::Muon>(track, bbNegMu);
-  }
-  template <typename T>
-  float BetheBlochNegPi(const T& track) const
-  {
-    return BetheBlochLf<o2::track::PID::Pion>(track, bbNegPi);
-  }
-  template <typename T>
-  float BetheBlochNegKa(const T& track) const
-  {
-    return BetheBlochLf<o2::track::PID::Kaon>(track, bbNegKa);
-  }
-  template <typename T>
-  float BetheBlochNegPr(const T& track) const
-  {
-    return BetheBlochLf<o2::track::PID::Proton>(track, bbNegPr);
-  }
-  template <typename T>
-  float BetheBlochNegDe(const T& track) const
-  {
-    return BetheBlochLf<o2::track::PID::Deuteron>(track, bbNegDe);
-  }
-  template <typename T>
-  float BetheBlochNegTr(const T& track) const
-  {
-    return BetheBlochLf<o2::track::PID::Triton>(track, bbNegTr);
-  }
-  template <typename T>
-  float BetheBlochNegHe(const T& track) const
-  {
-    return BetheBlochLf<o2::track::PID::Helium3>(track, bbNegHe);
-  }
-  template <typename T>
-  float BetheBlochNegAl(const T& track) const
-  {
-    return BetheBlochLf<o2::track::PID::Alpha>(track, bbNegAl);
   }
 
-  template <o2::track::PID::ID id, typename T>
-  float BetheBlochResolutionLf(const T& track, const bbParams& params, const float bb) const
+  /// Computes the expected sigma and the nsigma of the selected tracks of the columns in one pass
+  /// The resolution of negative tracks is taken from the parameters of the positive ones
+  template <o2::track::PID::ID id>
+  void computeResponse(const bbParams& params, const bbParams& paramsNeg, std::vector<float>& expSigma, std::vector<float>& nSigma) const
   {
-    float corr = 1.f;
-    if (params.postCorrectionSigma != nullptr) {
-      corr = params.postCorrectionSigma->Eval(track.tpcInnerParam());
-    }
-    if (params.postCorrectionFunSigma != nullptr) {
-      corr = params.postCorrectionFunSigma->Eval(track.tpcInnerParam());
+    static constexpr float invmass = 1.f / o2::track::pid_constants::sMasses2Z[id];
+    static constexpr float charge = o2::track::pid_constants::sCharges[id];
+    // Constants per charge sign (0 positive, 1 negative), hoisted out of the track loop
+    const std::array<const bbParams*, 2> par{&params, &paramsNeg};
+    std::array<float, 2> scale;
+    for (int k = 0; k < 2; k++) {
+      scale[k] = par[k]->isSimple ? 1.f : par[k]->mip * std::pow(charge, par[k]->exp);
+    }
+    const size_t n = columns.innerParam.size();
+    expSigma.resize(n);
+    nSigma.resize(n);
+    for (size_t i = 0; i < n; i++) {
+      if (!columns.isSelected[i]) {
+        continue;
+      }
+      const bbParams& p = *par[columns.isNegative[i]];
+      const float x = columns.innerParam[i];
+      const float bb = scale[columns.isNegative[i]] * o2::tpc::BetheBlochAleph(x * invmass, p.bb1, p.bb2, p.bb3, p.bb4, p.bb5) + p.postCorrectionTable.eval(x, 0.f);
+      expSigma[i] = params.res * bb * params.postCorrectionSigmaTable.eval(x, 1.f);
+      nSigma[i] = (columns.signal[i] - bb) / expSigma[i];
     }
-    return params.res * bb * corr;
-  }
-
-  template <typename T>
-  float BetheBlochResEl(const T& track, const float bb) const
-  {
-    return BetheBlochResolutionLf<o2::track::PID::Electron>(track, bbEl, bb);
-  }
-  template <typename T>
-  float BetheBlochResMu(const T& track, const float bb) const
-  {
-    return BetheBlochResolutionLf<o2::track::PID::Muon>(track, bbMu, bb);
-  }
-  template <typename T>
-  float BetheBlochResPi(const T& track, const float bb) const
-  {
-    return BetheBlochResolutionLf<o2::track::PID::Pion>(track, bbPi, bb);
-  }
-  template <typename T>
-  float BetheBlochResKa(const T& track, const float bb) const
-  {
-    return BetheBlochResolutionLf<o2::track::PID::Kaon>(track, bbKa, bb);
-  }
-  template <typename T>
-  float BetheBlochResPr(const T& track, const float bb) const
-  {
-    return BetheBlochResolutionLf<o2::track::PID::Proton>(track, bbPr, bb);
-  }
-  template <typename T>
-  float BetheBlochResDe(const T& track, const float bb) const
-  {
-    return BetheBlochResolutionLf<o2::track::PID::Deuteron>(track, bbDe, bb);
-  }
-  template <typename T>
-  float BetheBlochResTr(const T& track, const float bb) const
-  {
-    return BetheBlochResolutionLf<o2::track::PID::Triton>(track, bbTr, bb);
-  }
-  template <typename T>
-  float BetheBlochResHe(const T& track, const float bb) const
-  {
-    return BetheBlochResolutionLf<o2::track::PID::Helium3>(track, bbHe, bb);
-  }
-  template <typename T>
-  float BetheBlochResAl(const T& track, const float bb) const
-  {
-    return BetheBlochResolutionLf<o2::track::PID::Alpha>(track, bbAl, bb);
-  }
-  template <typename T>
-  float BetheBlochResNegEl(const T& track, const float bb) const
-  {
-    return BetheBlochResolutionLf<o2::track::PID::Electron>(track, bbEl, bb);
-  }
-  template <typename T>
-  float BetheBlochResNegMu(const T& track, const float bb) const
-  {
-    return BetheBlochResolutionLf<o2::track::PID::Muon>(track, bbMu, bb);
-  }
-  template <typename T>
-  float BetheBlochResNegPi(const T& track, const float bb) const
-  {
-    return BetheBlochResolutionLf<o2::track::PID::Pion>(track, bbPi, bb);
-  }
-  template <typename T>
-  float BetheBlochResNegKa(const T& track, const float bb) const
-  {
-    return BetheBlochResolutionLf<o2::track::PID::Kaon>(track, bbKa, bb);
-  }
-  template <typename T>
-  float BetheBlochResNegPr(const T& track, const float bb) const
-  {
-    return BetheBlochResolutionLf<o2::track::PID::Proton>(track, bbPr, bb);
-  }
-  template <typename T>
-  float BetheBlochResNegDe(const T& track, const float bb) const
-  {
-    return BetheBlochResolutionLf<o2::track::PID::Deuteron>(track, bbDe, bb);
-  }
-  template <typename T>
-  float BetheBlochResNegTr(const T& track, const float bb) const
-  {
-    return BetheBlochResolutionLf<o2::track::PID::Triton>(track, bbTr, bb);
-  }
-  template <typename T>
-  float BetheBlochResNegHe(const T& track, const float bb) const
-  {
-    return BetheBlochResolutionLf<o2::track::PID::Helium3>(track, bbHe, bb);
-  }
-  template <typename T>
-  float BetheBlochResNegAl(const T& track, const float bb) const
-  {
-    return BetheBlochResolutionLf<o2::track::PID::Alpha>(track, bbAl, bb);
   }
 
   void init(o2::framework::InitContext& initContext)
@@ -795,6 +713,8 @@ struct lfTpcPid {
 #define InitPerParticle(Particle)                                                                          \
   if (doprocess##Particle || doprocessFull##Particle) {                                                    \
     LOG(info) << "Enabling " << #Particle;                                                                 \
+    bb##Particle.postCalibTableSize = postCalibTableSize;                                                  \
+    bbNeg##Particle.postCalibTableSize = postCalibTableSize;                                               \
     bb##Particle.init(#Particle, bbParameters, fileParamBb##Particle, ccdb);                               \
     bbNeg##Particle.init(#Particle, bbParameters, fileParamBbNeg##Particle, ccdb);                         \
     auto h = histos.add<TH1>(Form("%s", #Particle), "", kTH1F, {{10, 0, 10}});                             \
@@ -857,7 +777,7 @@ struct lfTpcPid {
 #undef InitPerParticle
   }
 
-#define makeProcess(Particle)                                                                                            \
+#define makeProcess(Particle, Id)                                                                                        \
   void process##Particle(Colls const& collisions,                                                                        \
                          soa::Join<Trks, aod::pidTPC##Particle> const& tracks,                                           \
                          aod::BCsWithTimestamps const&)                                                                  \
@@ -878,52 +798,37 @@ struct lfTpcPid {
       }                                                                                                                  \
       bb##Particle.updateValues(collisions.iteratorAt(0).bc_as<aod::BCsWithTimestamps>(), ccdb);                         \
       bbNeg##Particle.updateValues(collisions.iteratorAt(0).bc_as<aod::BCsWithTimestamps>(), ccdb);                      \
-      float bb = 0.f;                                                                                                    \
+      fillColumns(tracks);                                                                                               \
+      computeResponse<o2::track::PID::Id>(bb##Particle, bbNeg##Particle, expSigmas[0], nSigmas[0]);                      \
+      size_t i = 0;                                                                                                      \
       for (auto const& trk : tracks) {                                                                                   \
-        if (!trk.hasTPC()) {                                                                                             \
+        if (!columns.isSelected[i]) {                                                                                    \
           tablePID##Particle(aod::pidtpc_tiny::binning::underflowBin);                                                   \
-          continue;                                                                                                      \
-        }                                                                                                                \
-        if (skipTPCOnly) {                                                                                               \
-          if (!trk.hasITS() && !trk.hasTRD() && !trk.hasTOF()) {                                                         \
-            tablePID##Particle(aod::pidtpc_tiny::binning::underflowBin);                                                 \
-            continue;                                                                                                    \
-          }                                                                                                              \
-        }                                                                                                                \
-        if (trk.sign() > 0) {                                                                                            \
-          if (!bb##Particle.betheBlochSet) {                                                                             \
-            tablePID##Particle(trk.tpcNSigmaStore##Particle());                                                          \
-            continue;                                                                                                    \
-          }                                                                                                              \
-          bb = BetheBloch##Particle(trk);                                                                                \
+        } else if (!(columns.isNegative[i] ? bbNeg##Particle : bb##Particle).betheBlochSet) {                            \
+          tablePID##Particle(trk.tpcNSigmaStore##Particle());                                                            \
         } else {                                                                                                         \
-          if (!bbNeg##Particle.betheBlochSet) {                                                                          \
-            tablePID##Particle(trk.tpcNSigmaStore##Particle());                                                          \
-            continue;                                                                                                    \
-          }                                                                                                              \
-          bb = BetheBlochNeg##Particle(trk);                                                                             \
+          aod::pidutils::packInTable<aod::pidtpc_tiny::binning>(nSigmas[0][i], tablePID##Particle);                      \
         }                                                                                                                \
-        aod::pidutils::packInTable<aod::pidtpc_tiny::binning>((trk.tpcSignal() - bb) / BetheBlochRes##Particle(trk, bb), \
-                                                              tablePID##Particle);                                       \
+        i++;                                                                                                             \
       }                                                                                                                  \
     }                                                                                                                    \
   }                                                                                                                      \
   PROCESS_SWITCH(lfTpcPid, process##Particle, "Produce a table for the " #Particle " hypothesis", false);
 
-  makeProcess(El);
-  makeProcess(Mu);
-  makeProcess(Pi);
-  makeProcess(Ka);
-  makeProcess(Pr);
-  makeProcess(De);
-  makeProcess(Tr);
-  makeProcess(He);
-  makeProcess(Al);
+  makeProcess(El, Electron);
+  makeProcess(Mu, Muon);
+  makeProcess(Pi, Pion);
+  makeProcess(Ka, Kaon);
+  makeProcess(Pr, Proton);
+  makeProcess(De, Deuteron);
+  makeProcess(Tr, Triton);
+  makeProcess(He, Helium3);
+  makeProcess(Al, Alpha);
 
 #undef makeProcess
 
 // Full tables
-#define makeProcess(Particle)                                                                       \
+#define makeProcess(Particle, Id)                                                                   \
   void processFull##Particle(Colls const& collisions,                                               \
                              soa::Join<Trks, aod::pidTPCFull##Particle> const& tracks,              \
                              aod::BCsWithTimestamps const&)                                         \
@@ -944,49 +849,32 @@ struct lfTpcPid {
       }                                                                                             \
       bb##Particle.updateValues(collisions.iteratorAt(0).bc_as<aod::BCsWithTimestamps>(), ccdb);    \
       bbNeg##Particle.updateValues(collisions.iteratorAt(0).bc_as<aod::BCsWithTimestamps>(), ccdb); \
-      float bb = 0.f;                                                                               \
-      float expSigma = 1.f;                                                                         \
+      fillColumns(tracks);                                                                          \
+      computeResponse<o2::track::PID::Id>(bb##Particle, bbNeg##Particle, expSigmas[0], nSigmas[0]); \
+      size_t i = 0;                                                                                 \
       for (auto const& trk : tracks) {                                                              \
-        if (!trk.hasTPC()) {                                                                        \
+        if (!columns.isSelected[i]) {                                                               \
           tablePIDFull##Particle(-999.f, -999.f);                                                   \
-          continue;                                                                                 \
-        }                                                                                           \
-        if (skipTPCOnly) {                                                                          \
-          if (!trk.hasITS() && !trk.hasTRD() && !trk.hasTOF()) {                                    \
-            tablePIDFull##Particle(-999.f, -999.f);                                                 \
-            continue;                                                                               \
-          }                                                                                         \
-        }                                                                                           \
-        if (trk.sign() > 0) {                                                                       \
-          if (!bb##Particle.betheBlochSet) {                                                        \
-            tablePIDFull##Particle(trk.tpcExpSigma##Particle(), trk.tpcNSigma##Particle());         \
-            continue;                                                                               \
-          }                                                                                         \
-          bb = BetheBloch##Particle(trk);                                                           \
-          expSigma = BetheBlochRes##Particle(trk, bb);                                              \
+        } else if (!(columns.isNegative[i] ? bbNeg##Particle : bb##Particle).betheBlochSet) {       \
+          tablePIDFull##Particle(trk.tpcExpSigma##Particle(), trk.tpcNSigma##Particle());           \
         } else {                                                                                    \
-          if (!bbNeg##Particle.betheBlochSet) {                                                     \
-            tablePIDFull##Particle(trk.tpcExpSigma##Particle(), trk.tpcNSigma##Particle());         \
-            continue;                                                                               \
-          }                                                                                         \
-          bb = BetheBlochNeg##Particle(trk);                                                        \
-          expSigma = BetheBlochResNeg##Particle(trk, bb);                                           \
+          tablePIDFull##Particle(expSigmas[0][i], nSigmas[0][i]);                                   \
         }                                                                                           \
-        tablePIDFull##Particle(expSigma, (trk.tpcSignal() - bb) / expSigma);                        \
+        i++;                                                                                        \
       }                                                                                             \
     }                                                                                               \
   }                                                                                                 \
   PROCESS_SWITCH(lfTpcPid, processFull##Particle, "Produce a full table for the " #Particle " hypothesis", false);
 
-  makeProcess(El);
-  makeProcess(Mu);
-  makeProcess(Pi);
-  makeProcess(Ka);
-  makeProcess(Pr);
-  makeProcess(De);
-  makeProcess(Tr);
-  makeProcess(He);
-  makeProcess(Al);
+  makeProcess(El, Electron);
+  makeProcess(Mu, Muon);
+  makeProcess(Pi, Pion);
+  makeProcess(Ka, Kaon);
+  makeProcess(Pr, Proton);
+  makeProcess(De, Deuteron);
+  makeProcess(Tr, Triton);
+  makeProcess(He, Helium3);
+  makeProcess(Al, Alpha);
 
 #undef makeProcess
 
@@ -1010,49 +898,28 @@ struct lfTpcPid {
       bbPr.updateValues(collisions.iteratorAt(0).bc_as<aod::BCsWithTimestamps>(), ccdb);
       bbNegPr.updateValues(collisions.iteratorAt(0).bc_as<aod::BCsWithTimestamps>(), ccdb);
     }
-    float bb = 0.f;
-    float expSigma = 1.f;
-    for (auto const& trk : tracks) {
-      if (!trk.hasTPC() || dummyPID) {
+    if (dummyPID) {
+      for (unsigned int i{0}; i < tracks.size(); ++i) {
         tablePIDFullPi(-999.f, -999.f);
         tablePIDFullKa(-999.f, -999.f);
         tablePIDFullPr(-999.f, -999.f);
-        continue;
-      }
-      if (skipTPCOnly) {
-        if (!trk.hasITS() && !trk.hasTRD() && !trk.hasTOF()) {
-          tablePIDFullPi(-999.f, -999.f);
-          tablePIDFullKa(-999.f, -999.f);
-          tablePIDFullPr(-999.f, -999.f);
-          continue;
-        }
-      }
-      if (trk.sign() > 0) {
-        bb = BetheBlochPi(trk);
-        expSigma = BetheBlochResPi(trk, bb);
-      } else {
-        bb = BetheBlochNegPi(trk);
-        expSigma = BetheBlochResNegPi(trk, bb);
-      }
-      tablePIDFullPi(expSigma, (trk.tpcSignal() - bb) / expSigma);
-
-      if (trk.sign() > 0) {
-        bb = BetheBlochKa(trk);
-        expSigma = BetheBlochResKa(trk, bb);
-      } else {
-        bb = BetheBlochNegKa(trk);
-        expSigma = BetheBlochResNegKa(trk, bb);
       }
-      tablePIDFullKa(expSigma, (trk.tpcSignal() - bb) / expSigma);
-
-      if (trk.sign() > 0) {
-        bb = BetheBlochPr(trk);
-        expSigma = BetheBlochResPr(trk, bb);
-      } else {
-        bb = BetheBlochNegPr(trk);
-        expSigma = BetheBlochResNegPr(trk, bb);
+      return;
+    }
+    fillColumns(tracks);
+    computeResponse<o2::track::PID::Pion>(bbPi, bbNegPi, expSigmas[0], nSigmas[0]);
+    computeResponse<o2::track::PID::Kaon>(bbKa, bbNegKa, expSigmas[1], nSigmas[1]);
+    computeResponse<o2::track::PID::Proton>(bbPr, bbNegPr, expSigmas[2], nSigmas[2]);
+    for (size_t i = 0; i < columns.isSelected.size(); i++) {
+      if (!columns.isSelected[i]) {
+        tablePIDFullPi(-999.f, -999.f);
+        tablePIDFullKa(-999.f, -999.f);
+        tablePIDFullPr(-999.f, -999.f);
+        continue;
       }
-      tablePIDFullPr(expSigma, (trk.tpcSignal() - bb) / expSigma);
+      tablePIDFullPi(expSigmas[0][i], nSigmas[0][i]);
+      tablePIDFullKa(expSigmas[1][i], nSigmas[1][i]);
+      tablePIDFullPr(expSigmas[2][i], nSigmas[2][i]);
     }
   }
   PROCESS_SWITCH(lfTpcPid, processStandalone, "Produce full tables in a standalone way for Pi-Ka-Pr", false);
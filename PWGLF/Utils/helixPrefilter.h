@@ -0,0 +1,245 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file helixPrefilter.h
+/// \brief Analytic prefilter of track pairs for the secondary-vertex finders
+///
+/// The transverse circle of each track is computed once. For a pair of tracks, the candidate secondary
+/// vertices in the transverse plane are the intersections of the two circles or, if the circles do not
+/// intersect, the points of closest approach along the line of the centres. A pair is rejected before
+/// running the DCAFitter when none of the candidates is compatible with the configured transverse distance,
+/// radius, z-gap and, optionally, transverse pointing angle. The DCAFitter starts from the same points
+/// (o2::track::CrossInfo), so the tolerances only have to cover the displacement of the vertex during the fit.
+
+#ifndef PWGLF_UTILS_HELIXPREFILTER_H_
+#define PWGLF_UTILS_HELIXPREFILTER_H_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace o2::analysis
+{
+
+/// Transverse circle of a track, in global coordinates
+struct TrackCircle {
+  float xC = 0.f, yC = 0.f, rC = 0.f; // centre and radius of the circle, rC = 0 for a straight track
+  float x = 0.f, y = 0.f, z = 0.f;    // reference point of the track
+  float cosPhi = 1.f, sinPhi = 0.f;   // direction of the transverse momentum at the reference point
+  float tgl = 0.f;
+  float pt = 0.f;
+  float rotation = 0.f; // +1 (-1) if the track turns anticlockwise (clockwise) seen from positive z
+};
+
+/// Computes the transverse circle of a track, as TrackPar::getCircleParams
+/// \param track  track parametrisation
+/// \param bz  magnetic field (kG)
+template <typename T>
+TrackCircle getTrackCircle(T const& track, float bz)
+{
+  // straight track if the sagitta between the vertex and the middle of the TPC is below 0.01 cm
+  constexpr float MinSagitta = 0.01f, TPCMidR = 160.f, MinCurv = 8 * MinSagitta / (TPCMidR * TPCMidR);
+  TrackCircle circle;
+  const float sna = std::sin(track.getAlpha()), csa = std::cos(track.getAlpha());
+  const float snp = track.getSnp(), csp = std::sqrt((1.f - snp) * (1.f + snp));
+  circle.x = track.getX() * csa - track.getY() * sna;
+  circle.y = track.getX() * sna + track.getY() * csa;
+  circle.z = track.getZ();
+  circle.cosPhi = csp * csa - snp * sna;
+  circle.sinPhi = snp * csa + csp * sna;
+  circle.tgl = track.getTgl();
+  circle.pt = track.getPt();
+  const float curvature = track.getCurvature(bz);
+  if (std::abs(curvature) > MinCurv) {
+    const float r = 1.f / curvature; // signed
+    const float xCLoc = track.getX() - snp * r, yCLoc = track.getY() + csp * r;
+    circle.xC = xCLoc * csa - yCLoc * sna;
+    circle.yC = xCLoc * sna + yCLoc * csa;
+    circle.rC = std::abs(r);
+    circle.rotation = r > 0.f ? 1.f : -1.f;
+  }
+  return circle;
+}
+
+/// Candidate secondary vertices of a pair of tracks in the transverse plane
+struct CircleCrossing {
+  int n = 0;                                  // number of candidates, 0 if not computable (straight or concentric tracks)
+  float dxy = 0.f;                            // transverse distance of the circles, 0 if they intersect
+  std::array<std::array<float, 2>, 2> pos0{}; // point of the first track at each candidate
+  std::array<std::array<float, 2>, 2> pos1{}; // point of the second track at each candidate
+};
+
+class HelixPrefilter
+{
+ public:
+  /// Maximum transverse distance between the two circles
+  void setMaxDXY(float maxDXY) { mMaxDXY = maxDXY; }
+  /// Maximum distance in z of the two tracks at a candidate
+  void setMaxDZ(float maxDZ) { mMaxDZ = maxDZ; }
+  /// Allowed transverse radius of a candidate, w.r.t. (0, 0)
+  void setRadiusRange(float minR, float maxR)
+  {
+    mMinR2 = minR > 0.f ? minR * minR : 0.f;
+    mMaxR2 = maxR * maxR;
+  }
+  /// Minimum cosine of the transverse pointing angle of the pair momentum at a candidate w.r.t. (x, y), disabled if < -1
+  void setMinCosPAXY(float minCosPAXY, float x = 0.f, float y = 0.f)
+  {
+    mMinCosPAXY = minCosPAXY;
+    mXRef = x;
+    mYRef = y;
+  }
+
+  /// Computes the candidate secondary vertices of two tracks in the transverse plane
+  static void crossCircles(TrackCircle const& t0, TrackCircle const& t1, CircleCrossing& crossing)
+  {
+    crossing.n = 0;
+    crossing.dxy = 0.f;
+    if (t0.rC == 0.f || t1.rC == 0.f) {
+      return;
+    }
+    // double precision: the radii of high-pT tracks are large w.r.t. the distances of interest
+    const double r0 = t0.rC, r1 = t1.rC;
+    const double dx = static_cast<double>(t1.xC) - t0.xC, dy = static_cast<double>(t1.yC) - t0.yC;
+    const double d = std::sqrt(dx * dx + dy * dy);
+    if (d == 0.) {
+      return;
+    }
+    const double ux = dx / d, uy = dy / d;
+    crossing.n = 1;
+    if (d > r0 + r1) {
+      // separate circles: closest points on the line of the centres
+      crossing.dxy = d - r0 - r1;
+      crossing.pos0[0] = {static_cast<float>(t0.xC + r0 * ux), static_cast<float>(t0.yC + r0 * uy)};
+      crossing.pos1[0] = {static_cast<float>(t1.xC - r1 * ux), static_cast<float>(t1.yC - r1 * uy)};
+    } else if (d < std::abs(r0 - r1)) {
+      // one circle inside the other: closest points on the side of the inner centre
+      const double sign = r0 > r1 ? 1. : -1.;
+      crossing.dxy = std::abs(r0 - r1) - d;
+      crossing.pos0[0] = {static_cast<float>(t0.xC + sign * r0 * ux), static_cast<float>(t0.yC + sign * r0 * uy)};
+      crossing.pos1[0] = {static_cast<float>(t1.xC + sign * r1 * ux), static_cast<float>(t1.yC + sign * r1 * uy)};
+    } else {
+      // two intersections, symmetric w.r.t. the line of the centres
+      const double a = (r0 * r0 - r1 * r1 + d * d) / (2. * d);
+      const double h = std::sqrt(std::max(r0 * r0 - a * a, 0.));
+      const double xM = t0.xC + a * ux, yM = t0.yC + a * uy;
+      crossing.n = 2;
+      crossing.pos0[0] = crossing.pos1[0] = {static_cast<float>(xM - h * uy), static_cast<float>(yM + h * ux)};
+      crossing.pos0[1] = crossing.pos1[1] = {static_cast<float>(xM + h * uy), static_cast<float>(yM - h * ux)};
+    }
+  }
+
+  /// Whether the pair of tracks can form a secondary vertex passing the cuts
+  bool isCompatible(TrackCircle const& t0, TrackCircle const& t1)
+  {
+    crossCircles(t0, t1, mCrossing);
+    if (mCrossing.n == 0) {
+      return true; // no analytic estimate, left to the fitter
+    }
+    if (mCrossing.dxy > mMaxDXY) {
+      return false;
+    }
+    for (int i = 0; i < mCrossing.n; i++) {
+      const auto& p0 = mCrossing.pos0[i];
+      const auto& p1 = mCrossing.pos1[i];
+      const float x = 0.5f * (p0[0] + p1[0]), y = 0.5f * (p0[1] + p1[1]);
+      const float r2 = x * x + y * y;
+      if (r2 < mMinR2 || r2 > mMaxR2) {
+        continue;
+      }
+      if (!isZCompatible(t0, p0, t1, p1)) {
+        continue;
+      }
+      if (mMinCosPAXY >= -1.f) {
+        std::array<float, 2> dir0, dir1;
+        getDirectionAt(t0, p0, dir0);
+        getDirectionAt(t1, p1, dir1);
+        const float px = t0.pt * dir0[0] + t1.pt * dir1[0], py = t0.pt * dir0[1] + t1.pt * dir1[1];
+        const float dxRef = x - mXRef, dyRef = y - mYRef;
+        const float norm2 = (px * px + py * py) * (dxRef * dxRef + dyRef * dyRef);
+        if (norm2 > 0.f && (px * dxRef + py * dyRef) < mMinCosPAXY * std::sqrt(norm2)) {
+          continue;
+        }
+      }
+      return true;
+    }
+    return false;
+  }
+
+  /// Transverse distance of the circle of a track to a point
+  static float getDistanceXY(TrackCircle const& t, float x, float y)
+  {
+    if (t.rC == 0.f) {
+      return std::abs((x - t.x) * t.sinPhi - (y - t.y) * t.cosPhi);
+    }
+    return std::abs(std::hypot(x - t.xC, y - t.yC) - t.rC);
+  }
+
+  CircleCrossing const& getCrossing() const { return mCrossing; }
+
+ private:
+  /// Number of additional full turns, in each direction, considered for looping tracks.
+  /// Pairs compatible in z only after more turns are rejected.
+  static constexpr int MaxTurns = 2;
+
+  /// z of the track at a point of its circle, following the shortest arc from the reference point
+  /// (turning angle in [-pi, pi] in the direction of motion), plus nTurns full turns
+  static float getZAt(TrackCircle const& t, std::array<float, 2> const& p, int nTurns = 0)
+  {
+    // turning angle between the radius vectors of the reference point and of the point
+    const float ux0 = t.x - t.xC, uy0 = t.y - t.yC;
+    const float ux1 = p[0] - t.xC, uy1 = p[1] - t.yC;
+    const float angle = t.rotation * std::atan2(ux0 * uy1 - uy0 * ux1, ux0 * ux1 + uy0 * uy1);
+    return t.z + t.tgl * t.rC * (angle + TwoPI * nTurns);
+  }
+
+  /// Whether the two tracks are within mMaxDZ in z at their points of a candidate, for the shortest arcs
+  /// or, for looping tracks, after up to MaxTurns additional turns of either track
+  bool isZCompatible(TrackCircle const& t0, std::array<float, 2> const& p0, TrackCircle const& t1, std::array<float, 2> const& p1) const
+  {
+    const float z0 = getZAt(t0, p0), z1 = getZAt(t1, p1);
+    if (std::abs(z0 - z1) <= mMaxDZ) {
+      return true;
+    }
+    // z advance per turn
+    const float period0 = TwoPI * t0.rC * t0.tgl, period1 = TwoPI * t1.rC * t1.tgl;
+    for (int n0 = -MaxTurns; n0 <= MaxTurns; n0++) {
+      for (int n1 = -MaxTurns; n1 <= MaxTurns; n1++) {
+        if (std::abs(z0 + n0 * period0 - z1 - n1 * period1) <= mMaxDZ) {
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  /// direction of the transverse momentum of the track at a point of its circle
+  static void getDirectionAt(TrackCircle const& t, std::array<float, 2> const& p, std::array<float, 2>& dir)
+  {
+    const float ux = (p[0] - t.xC) / t.rC, uy = (p[1] - t.yC) / t.rC;
+    dir = {-t.rotation * uy, t.rotation * ux};
+  }
+
+  static constexpr float TwoPI = 2.f * static_cast<float>(M_PI);
+
+  float mMaxDXY = 1e9f;
+  float mMaxDZ = 1e9f;
+  float mMinR2 = 0.f;
+  float mMaxR2 = 1e18f;
+  float mMinCosPAXY = -2.f;
+  float mXRef = 0.f;
+  float mYRef = 0.f;
+  CircleCrossing mCrossing;
+};
+
+} // namespace o2::analysis
+
+#endif // PWGLF_UTILS_HELIXPREFILTER_H_
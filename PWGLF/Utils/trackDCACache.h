@@ -0,0 +1,80 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file trackDCACache.h
+/// \brief Per-dataframe cache of the track DCA to the primary vertex for the strangeness builders
+///
+/// The same track is a daughter of many V0 and cascade hypotheses. The propagation to the
+/// primary vertex is done once per (track, collision) and reused by all of them.
+/// The cache has to be reset at the beginning of each dataframe and whenever the magnetic
+/// field or the material correction used for the propagation change.
+
+#ifndef PWGLF_UTILS_TRACKDCACACHE_H_
+#define PWGLF_UTILS_TRACKDCACACHE_H_
+
+#include <array>
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+#include "DetectorsBase/Propagator.h"
+#include "ReconstructionDataFormats/Track.h"
+#include "Common/Core/trackUtilities.h"
+
+namespace o2::analysis
+{
+
+class TrackDCACache
+{
+ public:
+  struct Entry {
+    int collisionId = kNotComputed;   // collision the DCA was computed for (-1: mean vertex)
+    std::array<float, 2> dca{};       // DCAxy and DCAz
+    o2::track::TrackPar trackParAtPV; // track parameters propagated to the DCA to the vertex
+  };
+
+  /// Invalidates all entries, to be called at the beginning of each dataframe
+  /// \param nTracks is the size of the track table of the dataframe
+  /// \param matCorr is the material correction used for the propagation, must be the one of the DCAFitter
+  void reset(size_t nTracks, o2::base::Propagator::MatCorrType matCorr)
+  {
+    mEntries.assign(nTracks, Entry{});
+    mMatCorr = matCorr;
+  }
+
+  /// Returns the DCA of the track to the vertex of collisionId, propagating the track only the first time
+  /// \param track is the track, with its global index in the table used in reset
+  /// \param collisionId is the collision whose vertex is used (-1 for the mean vertex)
+  /// \param vertex is the position of the vertex
+  template <typename TTrack>
+  Entry const& get(TTrack const& track, int collisionId, std::array<float, 3> const& vertex)
+  {
+    auto& entry = mEntries[track.globalIndex()];
+    if (entry.collisionId != collisionId) {
+      gpu::gpustd::array<float, 2> dcaInfo{-999.f, -999.f};
+      entry.trackParAtPV = getTrackPar(track);
+      o2::base::Propagator::Instance()->propagateToDCABxByBz({vertex[0], vertex[1], vertex[2]}, entry.trackParAtPV, 2.f, mMatCorr, &dcaInfo);
+      entry.dca = {dcaInfo[0], dcaInfo[1]};
+      entry.collisionId = collisionId;
+    }
+    return entry;
+  }
+
+ private:
+  static constexpr int kNotComputed = INT_MIN;
+
+  std::vector<Entry> mEntries;
+  o2::base::Propagator::MatCorrType mMatCorr = o2::base::Propagator::MatCorrType::USEMatCorrNONE;
+};
+
+} // namespace o2::analysis
+
+#endif // PWGLF_UTILS_TRACKDCACACHE_H_
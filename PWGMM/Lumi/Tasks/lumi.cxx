@@ -20,6 +20,7 @@
 #include <iostream>
 #include <vector>
 
+#include "Common/Core/PrimaryVertexRefitter.h"
 #include "Common/Core/TrackSelection.h"
 #include "Common/Core/trackUtilities.h"
 #include "Common/DataModel/EventSelection.h"
@@ -129,6 +130,7 @@ struct lumiTask {
        {HistType::kTH2F, {{1000, -1, 1, "y"}, {1000, -1, 1, "ry"}}}} //
     }};
   bool doPVrefit = true;
+  PrimaryVertexRefitter pvRefitter; // vertexer configured once in init
 
   void init(InitContext&)
   {
@@ -138,6 +140,8 @@ struct lumiTask {
     uint64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
     ccdb->setCreatedNotAfter(now);
     mRunNumber = 0;
+
+    pvRefitter.init(); // we want to refit w/o MeanVertex constraint
   }
 
   void process(aod::Collision const& collision, aod::BCsWithTimestamps const&,
@@ -190,16 +194,12 @@ struct lumiTask {
     Pvtx.setZ(collision.posZ());
     Pvtx.setCov(collision.covXX(), collision.covXY(), collision.covYY(),
                 collision.covXZ(), collision.covYZ(), collision.covZZ());
-    // configure PVertexer
 
     o2::dataformats::VertexBase PVbase_recalculated;
 
-    o2::vertexing::PVertexer vertexer;
-    o2::conf::ConfigurableParam::updateFromString(
-      "pvertexer.useMeanVertexConstraint=false"); // we want to refit w/o
-                                                  // MeanVertex constraint
-    vertexer.init();
-    bool PVrefit_doable = vertexer.prepareVertexRefit(vec_TrkContributos, Pvtx);
+    bool PVrefit_doable = pvRefitter.prepare(
+      vec_TrkContributos, Pvtx, collision.chi2(),
+      o2::base::Propagator::Instance()->getNominalBz(), true, false);
     double chi2 = -1.;
     double refitX = -9999.;
     double refitY = -9999.;
@@ -209,7 +209,7 @@ struct lumiTask {
     double refitXY = -9999.;
 
     if (doPVrefit && PVrefit_doable) {
-      auto Pvtx_refitted = vertexer.refitVertex(vec_useTrk_PVrefit, Pvtx);
+      auto Pvtx_refitted = pvRefitter.refitWithout(vec_useTrk_PVrefit);
       chi2 = Pvtx_refitted.getChi2();
       refitX = Pvtx_refitted.getX();
       refitY = Pvtx_refitted.getY();
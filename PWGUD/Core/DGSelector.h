@@ -29,6 +29,10 @@ class DGSelector
   DGSelector() { fPDG = TDatabasePDG::Instance(); }
   ~DGSelector() { delete fPDG; }
 
+  // use the FIT veto of the dataframe instead of testing the BCs of each range
+  // the BC ranges must then be slices of the BCs table used to update the veto
+  void SetFITVeto(udhelpers::FITVeto const* fitVeto) { fFITVeto = fitVeto; }
+
   template <typename CC, typename BCs, typename TCs, typename FWs>
   int Print(DGCutparHolder diffCuts, CC& collision, BCs& bcRange, TCs& tracks, FWs& fwdtracks)
   {
@@ -45,10 +49,8 @@ class DGSelector
 
     // check that there are no FIT signals in any of the compatible BCs
     // Double Gap (DG) condition
-    for (auto const& bc : bcRange) {
-      if (!udhelpers::cleanFIT(bc, diffCuts.maxFITtime(), diffCuts.FITAmpLimits())) {
-        return 1;
-      }
+    if (!IsCleanFIT(diffCuts, bcRange)) {
+      return 1;
     }
 
     // forward tracks
@@ -151,10 +153,8 @@ class DGSelector
   {
     // check that there are no FIT signals in bcRange
     // Double Gap (DG) condition
-    for (auto const& bc : bcRange) {
-      if (!udhelpers::cleanFIT(bc, diffCuts.maxFITtime(), diffCuts.FITAmpLimits())) {
-        return 1;
-      }
+    if (!IsCleanFIT(diffCuts, bcRange)) {
+      return 1;
     }
 
     // no activity in muon arm
@@ -220,7 +220,23 @@ class DGSelector
   };
 
  private:
+  // FIT veto condition for a range of compatible BCs
+  template <typename BCs>
+  bool IsCleanFIT(DGCutparHolder& diffCuts, BCs& bcRange)
+  {
+    if (fFITVeto) {
+      return fFITVeto->isClean(bcRange);
+    }
+    for (auto const& bc : bcRange) {
+      if (!udhelpers::cleanFIT(bc, diffCuts.maxFITtime(), diffCuts.FITAmpLimits())) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   TDatabasePDG* fPDG;
+  udhelpers::FITVeto const* fFITVeto = nullptr; //!
 
   ClassDefNV(DGSelector, 1);
 };
@@ -435,6 +435,127 @@ bool cleanFITCollision(T& col, float maxFITtime, std::vector<float> lims)
   }
   return (isCleanFV0 && isCleanFT0 && isCleanFDD);
 }
+// -----------------------------------------------------------------------------
+// FIT veto for all BCs of a dataframe
+// The FIT times and amplitudes of the BCs are read once, in the order of the BCs table, and the
+// number of BCs failing cleanFIT is accumulated in a prefix sum. Whether all BCs of a range of
+// compatible BCs (a slice of the same table as returned by compatibleBCs) pass cleanFIT is then
+// a difference of two prefix sums, instead of a loop over the BCs of the range for each candidate.
+class FITVeto
+{
+ public:
+  // read the FIT information of the BCs, only if the BCs table or the cuts changed since the last call
+  template <typename T>
+  void update(T const& bcs, float maxFITtime, std::vector<float> const& lims)
+  {
+    const int64_t nBCs = bcs.size();
+    const uint64_t firstBC = nBCs > 0 ? bcs.iteratorAt(0).globalBC() : 0;
+    const uint64_t lastBC = nBCs > 0 ? bcs.iteratorAt(nBCs - 1).globalBC() : 0;
+    if (bcs.asArrowTable().get() != mTable || nBCs != static_cast<int64_t>(mBCs.size()) || firstBC != mFirstBC || lastBC != mLastBC) {
+      mTable = bcs.asArrowTable().get();
+      mFirstBC = firstBC;
+      mLastBC = lastBC;
+      mBCs.resize(nBCs);
+      int64_t ind = 0;
+      for (auto const& bc : bcs) {
+        auto& info = mBCs[ind++];
+        info = BCFITInfo{};
+        if (bc.has_foundFV0()) {
+          info.hasFV0 = true;
+          info.timeFV0A = bc.foundFV0().time();
+          info.ampFV0A = FV0AmplitudeA(bc.foundFV0());
+        }
+        if (bc.has_foundFT0()) {
+          info.hasFT0 = true;
+          info.timeFT0A = bc.foundFT0().timeA();
+          info.timeFT0C = bc.foundFT0().timeC();
+          info.ampFT0A = FT0AmplitudeA(bc.foundFT0());
+          info.ampFT0C = FT0AmplitudeC(bc.foundFT0());
+        }
+        if (bc.has_foundFDD()) {
+          info.hasFDD = true;
+          info.timeFDDA = bc.foundFDD().timeA();
+          info.timeFDDC = bc.foundFDD().timeC();
+          info.ampFDDA = FDDAmplitudeA(bc.foundFDD());
+          info.ampFDDC = FDDAmplitudeC(bc.foundFDD());
+        }
+      }
+      mHasCuts = false;
+    }
+    if (!mHasCuts || maxFITtime != mMaxFITtime || lims != mLims) {
+      mHasCuts = true;
+      mMaxFITtime = maxFITtime;
+      mLims = lims;
+      mNNotClean.resize(mBCs.size() + 1);
+      mNNotClean[0] = 0;
+      for (std::size_t ind = 0; ind < mBCs.size(); ind++) {
+        mNNotClean[ind + 1] = mNNotClean[ind] + (isClean(mBCs[ind]) ? 0 : 1);
+      }
+    }
+  }
+
+  // true if all BCs with row index in [first, first + n) pass cleanFIT
+  bool isClean(int64_t first, int64_t n) const
+  {
+    if (n <= 0) {
+      return true;
+    }
+    return mNNotClean[first + n] == mNNotClean[first];
+  }
+
+  // true if all BCs of a slice of the BCs table pass cleanFIT
+  template <typename T>
+  bool isClean(T const& bcRange) const
+  {
+    return isClean(bcRange.offset(), bcRange.size());
+  }
+
+ private:
+  struct BCFITInfo {
+    bool hasFV0 = false;
+    bool hasFT0 = false;
+    bool hasFDD = false;
+    float timeFV0A = 0.;
+    float ampFV0A = 0.;
+    float timeFT0A = 0.;
+    float timeFT0C = 0.;
+    float ampFT0A = 0.;
+    float ampFT0C = 0.;
+    float timeFDDA = 0.;
+    float timeFDDC = 0.;
+    int16_t ampFDDA = 0;
+    int16_t ampFDDC = 0;
+  };
+
+  // same as cleanFIT
+  bool isClean(BCFITInfo const& info) const
+  {
+    if (info.hasFV0 && !(std::abs(info.timeFV0A) <= mMaxFITtime && info.ampFV0A <= mLims[0])) {
+      return false;
+    }
+    if (info.hasFT0 && !(std::abs(info.timeFT0A) <= mMaxFITtime && info.ampFT0A <= mLims[1] &&
+                         std::abs(info.timeFT0C) <= mMaxFITtime && info.ampFT0C <= mLims[2])) {
+      return false;
+    }
+    if (info.hasFDD && !(std::abs(info.timeFDDA) <= mMaxFITtime && info.ampFDDA <= mLims[3] &&
+                         std::abs(info.timeFDDC) <= mMaxFITtime && info.ampFDDC <= mLims[4])) {
+      return false;
+    }
+    return true;
+  }
+
+  // identification of the BCs table
+  const void* mTable = nullptr;
+  uint64_t mFirstBC = 0;
+  uint64_t mLastBC = 0;
+
+  bool mHasCuts = false;
+  float mMaxFITtime = 0.;
+  std::vector<float> mLims;
+  std::vector<BCFITInfo> mBCs;     // per BC, in the order of the BCs table
+  std::vector<int64_t> mNNotClean; // number of BCs failing cleanFIT before each BC
+};
+
 // -----------------------------------------------------------------------------
 // fill BB and BG information into FITInfo
 template <typename BCR>
@@ -254,8 +254,9 @@ struct DGBCCandProducer {
   DGCutparHolder diffCuts = DGCutparHolder();
   Configurable<DGCutparHolder> DGCuts{"DGCuts", {}, "DG event cuts"};
 
-  // DG selector
+  // DG selector, with the FIT veto of the BCs of the dataframe
   DGSelector dgSelector;
+  udhelpers::FITVeto fitVeto;
 
   HistogramRegistry registry{
     "registry",
@@ -355,6 +356,7 @@ struct DGBCCandProducer {
   void init(InitContext& context)
   {
     diffCuts = (DGCutparHolder)DGCuts;
+    dgSelector.SetFITVeto(&fitVeto);
 
     if (context.mOptions.get<bool>("processTinBCs")) {
       registry.add("table/candCase", "#candCase", {HistType::kTH1F, {{4, -0.5, 3.5}}});
@@ -377,6 +379,9 @@ struct DGBCCandProducer {
                      TCs const& tracks, aod::FwdTracks const& fwdtracks, FTIBCs const& ftibcs,
                      aod::Zdcs const& zdcs, aod::FT0s const& ft0s, aod::FV0As const& fv0as, aod::FDDs const& fdds)
   {
+    // FIT information of the BCs, read once per dataframe
+    fitVeto.update(bcs, diffCuts.maxFITtime(), diffCuts.FITAmpLimits());
+
     // fill FITInfo
     auto bcnum = tibc.bcnum();
     upchelpers::FITInfo fitInfo{};
@@ -534,6 +539,7 @@ struct DGBCCandProducer {
     if (bcs.size() <= 0) {
       return;
     }
+    fitVeto.update(bcs, diffCuts.maxFITtime(), diffCuts.FITAmpLimits());
 
     // run over all BC in bcs and tibcs
     int64_t lastCollision = 0;
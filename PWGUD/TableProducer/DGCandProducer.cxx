@@ -28,8 +28,9 @@ struct DGCandProducer {
   DGCutparHolder diffCuts = DGCutparHolder();
   Configurable<DGCutparHolder> DGCuts{"DGCuts", {}, "DG event cuts"};
 
-  // DG selector
+  // DG selector, with the FIT veto of the BCs of the dataframe
   DGSelector dgSelector;
+  udhelpers::FITVeto fitVeto;
 
   // data tables
   Produces<aod::UDCollisions> outputCollisions;
@@ -132,6 +133,7 @@ struct DGCandProducer {
   void init(InitContext&)
   {
     diffCuts = (DGCutparHolder)DGCuts;
+    dgSelector.SetFITVeto(&fitVeto);
 
     // add histograms for the different process functions
     registry.add("reco/Stat", "Cut statistics; Selection criterion; Collisions", {HistType::kTH1F, {{14, -0.5, 13.5}}});
@@ -153,6 +155,9 @@ struct DGCandProducer {
     auto bc = collision.foundBC_as<BCs>();
     LOGF(debug, "<DGCandProducer>  BC id %d", bc.globalBC());
 
+    // FIT information of the BCs, read once per dataframe
+    fitVeto.update(bcs, diffCuts.maxFITtime(), diffCuts.FITAmpLimits());
+
     // obtain slice of compatible BCs
     auto bcRange = udhelpers::compatibleBCs(collision, diffCuts.NDtcoll(), bcs, diffCuts.minNBCs());
     LOGF(debug, "<DGCandProducer>  Size of bcRange %d", bcRange.size());
@@ -112,7 +112,69 @@ struct PidONNXInterface {
     return false;
   }
 
+  /// Batched version of applyModel: the tracks are routed to the model of their pT range and each model is run once
+  /// \param certainties  filled in the order of the tracks, -1 for tracks without a suitable model
+  template <typename T>
+  void applyModelBatch(const T& tracks, int pid, std::vector<float>& certainties)
+  {
+    certainties.assign(tracks.size(), -1.0f);
+    runBatches(tracks, pid);
+    for (std::size_t iTrack = 0; iTrack < mBatchModels.size(); iTrack++) {
+      if (mBatchModels[iTrack] >= 0) {
+        certainties[iTrack] = (*mBatchOutputs[mBatchModels[iTrack] % kNDetectors])[mBatchRows[iTrack]];
+      }
+    }
+  }
+
+  /// Batched version of applyModelBoolean
+  /// \param accepted  filled in the order of the tracks, false for tracks without a suitable model
+  template <typename T>
+  void applyModelBooleanBatch(const T& tracks, int pid, std::vector<bool>& accepted)
+  {
+    accepted.assign(tracks.size(), false);
+    runBatches(tracks, pid);
+    for (std::size_t iTrack = 0; iTrack < mBatchModels.size(); iTrack++) {
+      if (mBatchModels[iTrack] >= 0) {
+        accepted[iTrack] = (*mBatchOutputs[mBatchModels[iTrack] % kNDetectors])[mBatchRows[iTrack]] >= mModels[mBatchModels[iTrack]].mMinCertainty;
+      }
+    }
+  }
+
  private:
+  // Fills the batches of the models of the pid with the tracks in their pT range and runs them.
+  // For each track, mBatchModels holds the model index (-1 if none) and mBatchRows the row in the model batch.
+  template <typename T>
+  void runBatches(const T& tracks, int pid)
+  {
+    mBatchModels.assign(tracks.size(), -1);
+    mBatchRows.assign(tracks.size(), 0);
+    std::size_t iPid = 0;
+    while (iPid < mNPids && mModels[iPid * kNDetectors].mPid != pid) {
+      iPid++;
+    }
+    std::size_t iTrack = 0;
+    for (const auto& track : tracks) {
+      if (iPid < mNPids) {
+        for (uint32_t j = 0; j < kNDetectors; j++) {
+          if (track.pt() >= mPTLimits[iPid][j] && (j == kNDetectors - 1 || track.pt() < mPTLimits[iPid][j + 1])) {
+            mBatchModels[iTrack] = iPid * kNDetectors + j;
+            mBatchRows[iTrack] = mModels[iPid * kNDetectors + j].addToBatch(track);
+            break;
+          }
+        }
+      }
+      if (mBatchModels[iTrack] < 0) {
+        LOG(error) << "No suitable PID ML model found for track: " << track.globalIndex() << " from collision: " << track.collision().globalIndex() << " and expected pid: " << pid;
+      }
+      iTrack++;
+    }
+    if (iPid < mNPids) {
+      for (uint32_t j = 0; j < kNDetectors; j++) {
+        mBatchOutputs[j] = &mModels[iPid * kNDetectors + j].runBatch();
+      }
+    }
+  }
+
   void fillDefaultConfiguration(std::vector<double>& minCertainties)
   {
     // FIXME: A more sophisticated strategy should be based on pid values as well
@@ -123,5 +185,10 @@ struct PidONNXInterface {
   std::vector<PidONNXModel> mModels;
   std::size_t mNPids;
   o2::framework::LabeledArray<double> mPTLimits;
+
+  // batch bookkeeping, reused between calls
+  std::vector<int> mBatchModels;
+  std::vector<std::size_t> mBatchRows;
+  std::array<std::vector<float> const*, kNDetectors> mBatchOutputs{};
 };
 #endif // TOOLS_PIDML_PIDONNXINTERFACE_H_
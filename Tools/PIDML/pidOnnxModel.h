@@ -19,6 +19,7 @@
 
 #include <string>
 #include <algorithm>
+#include <array>
 #include <map>
 #include <utility>
 #include <memory>
@@ -87,6 +88,11 @@ struct PidONNXModel {
 
     // Assume model has 1 input node and 1 output node.
     assert(mInputNames.size() == 1 && mOutputNames.size() == 1);
+
+    compileScalingParams();
+    if (mInputShapes[0].size() != 2 || (mInputShapes[0][1] > 0 && mInputShapes[0][1] != static_cast<int64_t>(mNInputs))) {
+      LOG(fatal) << "PID ML model input shape " << printShape(mInputShapes[0]) << " does not match the " << mNInputs << " input features of the detector configuration";
+    }
   }
   PidONNXModel() = default;
   PidONNXModel(PidONNXModel&&) = default;
@@ -101,6 +107,28 @@ struct PidONNXModel {
     return getModelOutput(track);
   }
 
+  /// Appends the track to the batch evaluated by the next runBatch() call
+  /// \return row of the track in the batch
+  template <typename T>
+  std::size_t addToBatch(const T& track)
+  {
+    std::size_t row = mBatchSize++;
+    mBatchInputs.resize(mBatchSize * mNInputs);
+    fillInputs(track, mBatchInputs.data() + row * mNInputs);
+    return row;
+  }
+
+  /// Runs the model on all tracks added since the last call, with as few inference calls as the model input shape allows
+  /// \return certainties in the order of addToBatch(), valid until the next call
+  std::vector<float> const& runBatch()
+  {
+    mBatchOutputs.resize(mBatchSize);
+    runInference(mBatchInputs.data(), mBatchSize, mBatchOutputs.data());
+    mBatchSize = 0;
+    mBatchInputs.clear();
+    return mBatchOutputs;
+  }
+
   template <typename T>
   bool applyModelBoolean(const T& track)
   {
@@ -179,38 +207,83 @@ struct PidONNXModel {
     }
   }
 
+  // Scaled input features, in the order of the json scaling parameters names below
+  enum ScaledInput {
+    kX = 0,
+    kY,
+    kZ,
+    kAlpha,
+    kTPCNClsShared,
+    kDcaXY,
+    kDcaZ,
+    kTPCSignal,
+    kTOFSignal,
+    kBeta,
+    kTRDSignal,
+    kTRDPattern,
+    kNScaledInputs
+  };
+  static constexpr std::array<const char*, kNScaledInputs> scaledInputNames{"fX", "fY", "fZ", "fAlpha", "fTPCNClsShared", "fDcaXY", "fDcaZ", "fTPCSignal", "fTOFSignal", "fBeta", "fTRDSignal", "fTRDPattern"};
+  static constexpr std::size_t nInputsTPC = 14;
+
+  // Copies the scaling parameters needed by the detector configuration into flat arrays, so that no map lookup is done per track
+  void compileScalingParams()
+  {
+    std::size_t nScaled = kTOFSignal;
+    mNInputs = nInputsTPC;
+    if (mDetector >= kTPCTOF) {
+      nScaled = kTRDSignal;
+      mNInputs += 2;
+    }
+    if (mDetector >= kTPCTOFTRD) {
+      nScaled = kNScaledInputs;
+      mNInputs += 2;
+    }
+    for (std::size_t i = 0; i < nScaled; i++) {
+      auto param = mScalingParams.find(scaledInputNames[i]);
+      if (param == mScalingParams.end()) {
+        LOG(fatal) << "Missing scaling parameters for PID ML input: " << scaledInputNames[i];
+      }
+      mScalingMean[i] = param->second.first;
+      mScalingStd[i] = param->second.second;
+    }
+  }
+
+  float scale(float value, ScaledInput input) const
+  {
+    return (value - mScalingMean[input]) / mScalingStd[input];
+  }
+
+  // Writes the mNInputs input features of the track to inputValues
   template <typename T>
-  std::vector<float> createInputsSingle(const T& track)
+  void fillInputs(const T& track, float* inputValues) const
   {
     // TODO: Hardcoded for now. Planning to implement RowView extension to get runtime access to selected columns
     // sign is short, trackType and tpcNClsShared uint8_t
-    float scaledX = (track.x() - mScalingParams.at("fX").first) / mScalingParams.at("fX").second;
-    float scaledY = (track.y() - mScalingParams.at("fY").first) / mScalingParams.at("fY").second;
-    float scaledZ = (track.z() - mScalingParams.at("fZ").first) / mScalingParams.at("fZ").second;
-    float scaledAlpha = (track.alpha() - mScalingParams.at("fAlpha").first) / mScalingParams.at("fAlpha").second;
-    float scaledTPCNClsShared = (static_cast<float>(track.tpcNClsShared()) - mScalingParams.at("fTPCNClsShared").first) / mScalingParams.at("fTPCNClsShared").second;
-    float scaledDcaXY = (track.dcaXY() - mScalingParams.at("fDcaXY").first) / mScalingParams.at("fDcaXY").second;
-    float scaledDcaZ = (track.dcaZ() - mScalingParams.at("fDcaZ").first) / mScalingParams.at("fDcaZ").second;
-
-    float scaledTPCSignal = (track.tpcSignal() - mScalingParams.at("fTPCSignal").first) / mScalingParams.at("fTPCSignal").second;
-
-    std::vector<float> inputValues{track.px(), track.py(), track.pz(), static_cast<float>(track.sign()), scaledX, scaledY, scaledZ, scaledAlpha, static_cast<float>(track.trackType()), scaledTPCNClsShared, scaledDcaXY, scaledDcaZ, track.p(), scaledTPCSignal};
+    inputValues[0] = track.px();
+    inputValues[1] = track.py();
+    inputValues[2] = track.pz();
+    inputValues[3] = static_cast<float>(track.sign());
+    inputValues[4] = scale(track.x(), kX);
+    inputValues[5] = scale(track.y(), kY);
+    inputValues[6] = scale(track.z(), kZ);
+    inputValues[7] = scale(track.alpha(), kAlpha);
+    inputValues[8] = static_cast<float>(track.trackType());
+    inputValues[9] = scale(static_cast<float>(track.tpcNClsShared()), kTPCNClsShared);
+    inputValues[10] = scale(track.dcaXY(), kDcaXY);
+    inputValues[11] = scale(track.dcaZ(), kDcaZ);
+    inputValues[12] = track.p();
+    inputValues[13] = scale(track.tpcSignal(), kTPCSignal);
 
     if (mDetector >= kTPCTOF) {
-      float scaledTOFSignal = (track.tofSignal() - mScalingParams.at("fTOFSignal").first) / mScalingParams.at("fTOFSignal").second;
-      float scaledBeta = (track.beta() - mScalingParams.at("fBeta").first) / mScalingParams.at("fBeta").second;
-      inputValues.push_back(scaledTOFSignal);
-      inputValues.push_back(scaledBeta);
+      inputValues[14] = scale(track.tofSignal(), kTOFSignal);
+      inputValues[15] = scale(track.beta(), kBeta);
     }
 
     if (mDetector >= kTPCTOFTRD) {
-      float scaledTRDSignal = (track.trdSignal() - mScalingParams.at("fTRDSignal").first) / mScalingParams.at("fTRDSignal").second;
-      float scaledTRDPattern = (track.trdPattern() - mScalingParams.at("fTRDPattern").first) / mScalingParams.at("fTRDPattern").second;
-      inputValues.push_back(scaledTRDSignal);
-      inputValues.push_back(scaledTRDPattern);
+      inputValues[16] = scale(track.trdSignal(), kTRDSignal);
+      inputValues[17] = scale(track.trdPattern(), kTRDPattern);
     }
-
-    return inputValues;
   }
 
   // FIXME: Temporary solution, new networks will have sigmoid layer added
@@ -223,31 +296,59 @@ struct PidONNXModel {
   template <typename T>
   float getModelOutput(const T& track)
   {
+    mSingleInputs.resize(mNInputs);
+    fillInputs(track, mSingleInputs.data());
+    float certainty = 0.0f;
+    runInference(mSingleInputs.data(), 1, &certainty);
+    return certainty;
+  }
+
+  // Evaluates nRows rows of mNInputs features. A model with a dynamic batch dimension is run once,
+  // a model with a fixed batch dimension is run on chunks of that size, the last one padded with zeros.
+  void runInference(float* inputs, std::size_t nRows, float* certainties)
+  {
+    if (nRows == 0) {
+      return;
+    }
     auto input_shape = mInputShapes[0];
-    std::vector<float> inputTensorValues = createInputsSingle(track);
-    std::vector<Ort::Value> inputTensors;
-    inputTensors.emplace_back(Ort::Experimental::Value::CreateTensor<float>(inputTensorValues.data(), inputTensorValues.size(), input_shape));
-
-    // Double-check the dimensions of the input tensor
-    assert(inputTensors[0].IsTensor() &&
-           inputTensors[0].GetTensorTypeAndShapeInfo().GetShape() == input_shape);
-    LOG(debug) << "input tensor shape: " << printShape(inputTensors[0].GetTensorTypeAndShapeInfo().GetShape());
-
-    try {
-      auto outputTensors = mSession->Run(mInputNames, inputTensors, mOutputNames);
-
-      // Double-check the dimensions of the output tensors
-      // The number of output tensors is equal to the number of output nodes specified in the Run() call
-      assert(outputTensors.size() == mOutputNames.size() && outputTensors[0].IsTensor());
-      LOG(debug) << "output tensor shape: " << printShape(outputTensors[0].GetTensorTypeAndShapeInfo().GetShape());
-
-      const float* output_value = outputTensors[0].GetTensorData<float>();
-      float certainty = sigmoid(*output_value); // FIXME: Temporary, sigmoid will be added as network layer
-      return certainty;
-    } catch (const Ort::Exception& exception) {
-      LOG(error) << "Error running model inference: " << exception.what();
+    const std::size_t rowsPerRun = input_shape[0] > 0 ? static_cast<std::size_t>(input_shape[0]) : nRows;
+    input_shape[0] = rowsPerRun;
+    input_shape[1] = mNInputs;
+
+    for (std::size_t firstRow = 0; firstRow < nRows; firstRow += rowsPerRun) {
+      const std::size_t nRowsRun = std::min(rowsPerRun, nRows - firstRow);
+      float* inputTensorValues = inputs + firstRow * mNInputs;
+      if (nRowsRun < rowsPerRun) {
+        mPaddedInputs.assign(rowsPerRun * mNInputs, 0.0f);
+        std::copy(inputTensorValues, inputTensorValues + nRowsRun * mNInputs, mPaddedInputs.begin());
+        inputTensorValues = mPaddedInputs.data();
+      }
+      std::vector<Ort::Value> inputTensors;
+      inputTensors.emplace_back(Ort::Experimental::Value::CreateTensor<float>(inputTensorValues, rowsPerRun * mNInputs, input_shape));
+
+      // Double-check the dimensions of the input tensor
+      assert(inputTensors[0].IsTensor() &&
+             inputTensors[0].GetTensorTypeAndShapeInfo().GetShape() == input_shape);
+      LOG(debug) << "input tensor shape: " << printShape(inputTensors[0].GetTensorTypeAndShapeInfo().GetShape());
+
+      try {
+        auto outputTensors = mSession->Run(mInputNames, inputTensors, mOutputNames);
+
+        // Double-check the dimensions of the output tensors
+        // The number of output tensors is equal to the number of output nodes specified in the Run() call
+        assert(outputTensors.size() == mOutputNames.size() && outputTensors[0].IsTensor());
+        LOG(debug) << "output tensor shape: " << printShape(outputTensors[0].GetTensorTypeAndShapeInfo().GetShape());
+
+        // One output value per row
+        const float* output_values = outputTensors[0].GetTensorData<float>();
+        for (std::size_t i = 0; i < nRowsRun; i++) {
+          certainties[firstRow + i] = sigmoid(output_values[i]); // FIXME: Temporary, sigmoid will be added as network layer
+        }
+      } catch (const Ort::Exception& exception) {
+        LOG(error) << "Error running model inference: " << exception.what();
+        std::fill(certainties + firstRow, certainties + firstRow + nRowsRun, 0.0f);
+      }
     }
-    return false; // unreachable code
   }
 
   // Pretty prints a shape dimension vector
@@ -262,6 +363,16 @@ struct PidONNXModel {
 
   std::vector<std::string> mTrainColumns;
   std::map<std::string, std::pair<float, float>> mScalingParams;
+  std::array<float, kNScaledInputs> mScalingMean{};
+  std::array<float, kNScaledInputs> mScalingStd{};
+  std::size_t mNInputs = 0;
+
+  // buffers reused between calls
+  std::vector<float> mSingleInputs;
+  std::vector<float> mBatchInputs;
+  std::vector<float> mBatchOutputs;
+  std::vector<float> mPaddedInputs;
+  std::size_t mBatchSize = 0;
 
   std::shared_ptr<Ort::Env> mEnv = nullptr;
   // No empty constructors for Session, we need a pointer
@@ -22,6 +22,7 @@
 #include "Tools/PIDML/pidOnnxInterface.h"
 
 #include <string>
+#include <vector>
 
 using namespace o2;
 using namespace o2::framework;
@@ -74,6 +75,29 @@ struct SimpleApplyOnnxInterface {
     }
   }
 
+  std::vector<std::vector<bool>> accepted; // per pid, in the order of the tracks
+
+  // Each model is run once on all tracks of the dataframe, the results are then stored in the track order
+  template <typename T>
+  void fillResults(T const& tracks)
+  {
+    accepted.resize(cfgPids.value.size());
+    for (std::size_t iPid = 0; iPid < cfgPids.value.size(); iPid++) {
+      pidInterface.applyModelBooleanBatch(tracks, cfgPids.value[iPid], accepted[iPid]);
+    }
+    std::size_t iTrack = 0;
+    for (auto& track : tracks) {
+      for (std::size_t iPid = 0; iPid < cfgPids.value.size(); iPid++) {
+        int pid = cfgPids.value[iPid];
+        bool isAccepted = accepted[iPid][iTrack];
+        LOGF(info, "collision id: %d track id: %d pid: %d accepted: %d p: %.3f; x: %.3f, y: %.3f, z: %.3f",
+             track.collisionId(), track.index(), pid, isAccepted, track.p(), track.x(), track.y(), track.z());
+        pidMLResults(track.index(), pid, isAccepted);
+      }
+      iTrack++;
+    }
+  }
+
   void processCollisions(aod::Collisions const& collisions, BigTracks const& tracks, aod::BCsWithTimestamps const&)
   {
     auto bc = collisions.iteratorAt(0).bc_as<aod::BCsWithTimestamps>();
@@ -82,27 +106,13 @@ struct SimpleApplyOnnxInterface {
       pidInterface = PidONNXInterface(cfgPathLocal.value, cfgPathCCDB.value, cfgUseCCDB.value, ccdbApi, timestamp, cfgPids.value, cfgPTCuts.value, cfgCertainties.value, cfgAutoMode.value);
     }
 
-    for (auto& track : tracks) {
-      for (int pid : cfgPids.value) {
-        bool accepted = pidInterface.applyModelBoolean(track, pid);
-        LOGF(info, "collision id: %d track id: %d pid: %d accepted: %d p: %.3f; x: %.3f, y: %.3f, z: %.3f",
-             track.collisionId(), track.index(), pid, accepted, track.p(), track.x(), track.y(), track.z());
-        pidMLResults(track.index(), pid, accepted);
-      }
-    }
+    fillResults(tracks);
   }
   PROCESS_SWITCH(SimpleApplyOnnxInterface, processCollisions, "Process with collisions and bcs for CCDB", true);
 
   void processTracksOnly(BigTracks const& tracks)
   {
-    for (auto& track : tracks) {
-      for (int pid : cfgPids.value) {
-        bool accepted = pidInterface.applyModelBoolean(track, pid);
-        LOGF(info, "collision id: %d track id: %d pid: %d accepted: %d p: %.3f; x: %.3f, y: %.3f, z: %.3f",
-             track.collisionId(), track.index(), pid, accepted, track.p(), track.x(), track.y(), track.z());
-        pidMLResults(track.index(), pid, accepted);
-      }
-    }
+    fillResults(tracks);
   }
   PROCESS_SWITCH(SimpleApplyOnnxInterface, processTracksOnly, "Process with tracks only -- faster but no CCDB", false);
 };